@@ -21,10 +21,15 @@
 
 #include "tag_c.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #ifdef HAVE_CONFIG_H
 # include "config.h"
@@ -88,9 +93,58 @@ using namespace TagLib;
 
 namespace
 {
+  // Bump allocator for the strings of one file, released as a whole.
+  class StringArena
+  {
+  public:
+    StringArena() = default;
+    StringArena(const StringArena &) = delete;
+    StringArena &operator=(const StringArena &) = delete;
+
+    ~StringArena()
+    {
+      for(char *block : blocks)
+        free(block);
+    }
+
+    char *copy(const std::string &str)
+    {
+      const size_t size = str.size() + 1;
+      if(blocks.empty() || used + size > blockSize) {
+        // Large strings get a block of their own, so that the current block
+        // can still be filled up.
+        char *block = static_cast<char *>(malloc(std::max(size, blockSize)));
+        if(!block)
+          return nullptr;
+        if(size > blockSize && !blocks.empty()) {
+          blocks.insert(blocks.end() - 1, block);
+          ::memcpy(block, str.c_str(), size);
+          return block;
+        }
+        blocks.push_back(block);
+        used = 0;
+      }
+      char *s = blocks.back() + used;
+      ::memcpy(s, str.c_str(), size);
+      used += size;
+      return s;
+    }
+
+  private:
+    static constexpr size_t blockSize = 4096;
+    std::vector<char *> blocks;
+    size_t used = 0;
+  };
+
+  // Guards strings, fileArenas and tagFiles.
+  std::mutex stringMutex;
   List<char *> strings;
-  bool unicodeStrings = true;
-  bool stringManagementEnabled = true;
+  std::unordered_map<const FileRef *, StringArena> fileArenas;
+  std::unordered_map<const Tag *, const FileRef *> tagFiles;
+
+  std::atomic<bool> unicodeStrings(true);
+  std::atomic<bool> stringManagementEnabled(true);
+  std::atomic<bool> perFileStrings(false);
 
   char *stringToCharArray(const String &s)
   {
@@ -111,6 +165,42 @@ namespace
   {
     return String(s, unicodeStrings ? String::UTF8 : String::Latin1);
   }
+
+  // Returns a copy of a tag value which is managed according to the string
+  // management settings.
+  char *managedString(const Tag *tag, const String &value)
+  {
+    if(!stringManagementEnabled)
+      return stringToCharArray(value);
+
+    std::lock_guard<std::mutex> lock(stringMutex);
+
+    if(perFileStrings) {
+      if(auto it = tagFiles.find(tag); it != tagFiles.end())
+        return fileArenas[it->second].copy(value.to8Bit(unicodeStrings));
+    }
+
+    char *s = stringToCharArray(value);
+    strings.append(s);
+    return s;
+  }
+
+  // Returns the size of a string as written by writeString(), without the
+  // terminating null byte.
+  size_t encodedSize(const String &s, bool unicode)
+  {
+    return unicode ? s.utf8Size() : s.size();
+  }
+
+  // Writes a null terminated string of the given encodedSize() to dst.
+  void writeString(char *dst, const String &s, size_t size, bool unicode)
+  {
+    if(unicode)
+      s.copyUTF8(dst, static_cast<unsigned int>(size));
+    else
+      ::memcpy(dst, s.data(String::Latin1).data(), size);
+    dst[size] = '\0';
+  }
 }  // namespace
 
 void taglib_set_strings_unicode(BOOL unicode)
@@ -123,6 +213,11 @@ void taglib_set_string_management_enabled(BOOL management)
   stringManagementEnabled = (management != 0);
 }
 
+void taglib_set_string_management_per_file(BOOL perFile)
+{
+  perFileStrings = (perFile != 0);
+}
+
 void taglib_free(void* pointer)
 {
   free(pointer);
@@ -276,7 +371,18 @@ TagLib_File *taglib_file_new_iostream(TagLib_IOStream *stream)
 
 void taglib_file_free(TagLib_File *file)
 {
-  delete reinterpret_cast<FileRef *>(file);
+  auto f = reinterpret_cast<FileRef *>(file);
+  {
+    std::lock_guard<std::mutex> lock(stringMutex);
+    fileArenas.erase(f);
+    for(auto it = tagFiles.begin(); it != tagFiles.end();) {
+      if(it->second == f)
+        it = tagFiles.erase(it);
+      else
+        ++it;
+    }
+  }
+  delete f;
 }
 
 BOOL taglib_file_is_valid(const TagLib_File *file)
@@ -287,7 +393,12 @@ BOOL taglib_file_is_valid(const TagLib_File *file)
 TagLib_Tag *taglib_file_tag(const TagLib_File *file)
 {
   auto f = reinterpret_cast<const FileRef *>(file);
-  return reinterpret_cast<TagLib_Tag *>(f->tag());
+  Tag *tag = f->tag();
+  if(tag && perFileStrings) {
+    std::lock_guard<std::mutex> lock(stringMutex);
+    tagFiles[tag] = f;
+  }
+  return reinterpret_cast<TagLib_Tag *>(tag);
 }
 
 const TagLib_AudioProperties *taglib_file_audioproperties(const TagLib_File *file)
@@ -308,46 +419,31 @@ BOOL taglib_file_save(TagLib_File *file)
 char *taglib_tag_title(const TagLib_Tag *tag)
 {
   auto t = reinterpret_cast<const Tag *>(tag);
-  char *s = stringToCharArray(t->title());
-  if(stringManagementEnabled)
-    strings.append(s);
-  return s;
+  return managedString(t, t->title());
 }
 
 char *taglib_tag_artist(const TagLib_Tag *tag)
 {
   auto t = reinterpret_cast<const Tag *>(tag);
-  char *s = stringToCharArray(t->artist());
-  if(stringManagementEnabled)
-    strings.append(s);
-  return s;
+  return managedString(t, t->artist());
 }
 
 char *taglib_tag_album(const TagLib_Tag *tag)
 {
   auto t = reinterpret_cast<const Tag *>(tag);
-  char *s = stringToCharArray(t->album());
-  if(stringManagementEnabled)
-    strings.append(s);
-  return s;
+  return managedString(t, t->album());
 }
 
 char *taglib_tag_comment(const TagLib_Tag *tag)
 {
   auto t = reinterpret_cast<const Tag *>(tag);
-  char *s = stringToCharArray(t->comment());
-  if(stringManagementEnabled)
-    strings.append(s);
-  return s;
+  return managedString(t, t->comment());
 }
 
 char *taglib_tag_genre(const TagLib_Tag *tag)
 {
   auto t = reinterpret_cast<const Tag *>(tag);
-  char *s = stringToCharArray(t->genre());
-  if(stringManagementEnabled)
-    strings.append(s);
-  return s;
+  return managedString(t, t->genre());
 }
 
 unsigned int taglib_tag_year(const TagLib_Tag *tag)
@@ -409,9 +505,11 @@ void taglib_tag_free_strings()
   if(!stringManagementEnabled)
     return;
 
+  std::lock_guard<std::mutex> lock(stringMutex);
   for(auto &string : std::as_const(strings))
     free(string);
   strings.clear();
+  fileArenas.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -567,6 +665,65 @@ void taglib_property_free(char **props)
   free(props);
 }
 
+TagLib_Property_List *taglib_property_get_all(const TagLib_File *file)
+{
+  if(file == NULL)
+    return NULL;
+
+  const PropertyMap map = reinterpret_cast<const FileRef *>(file)->properties();
+  const bool unicode = unicodeStrings;
+
+  // Size everything first, so that the list is a single allocation: the
+  // header, the key and value offsets and the string data.
+  size_t count = 0;
+  size_t dataSize = 0;
+  for(const auto &[key, values] : map) {
+    dataSize += encodedSize(key, unicode) + 1;
+    for(const auto &value : values)
+      dataSize += encodedSize(value, unicode) + 1;
+    count += values.size();
+  }
+
+  auto list = static_cast<TagLib_Property_List *>(
+    malloc(sizeof(TagLib_Property_List) + 2 * sizeof(unsigned int) * count + dataSize));
+  if(!list)
+    return NULL;
+
+  auto keyOffsets = reinterpret_cast<unsigned int *>(list + 1);
+  unsigned int *valueOffsets = keyOffsets + count;
+  char *data = reinterpret_cast<char *>(valueOffsets + count);
+
+  // Values of the same property share one copy of the key.
+  size_t entry = 0;
+  size_t position = 0;
+  for(const auto &[key, values] : map) {
+    const size_t keyPosition = position;
+    const size_t keySize = encodedSize(key, unicode);
+    writeString(data + position, key, keySize, unicode);
+    position += keySize + 1;
+
+    for(const auto &value : values) {
+      const size_t valueSize = encodedSize(value, unicode);
+      keyOffsets[entry] = static_cast<unsigned int>(keyPosition);
+      valueOffsets[entry] = static_cast<unsigned int>(position);
+      writeString(data + position, value, valueSize, unicode);
+      position += valueSize + 1;
+      ++entry;
+    }
+  }
+
+  list->count = static_cast<unsigned int>(count);
+  list->keyOffsets = keyOffsets;
+  list->valueOffsets = valueOffsets;
+  list->data = data;
+  return list;
+}
+
+void taglib_property_list_free(TagLib_Property_List *list)
+{
+  free(list);
+}
+
 
 /******************************************************************************
  * Complex Properties API
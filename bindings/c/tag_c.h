@@ -86,6 +86,18 @@ TAGLIB_C_EXPORT void taglib_set_strings_unicode(BOOL unicode);
  */
 TAGLIB_C_EXPORT void taglib_set_string_management_enabled(BOOL management);
 
+/*!
+ * If \a perFile is TRUE, the managed strings returned for a tag obtained with
+ * taglib_file_tag() belong to that file and are freed together by
+ * taglib_file_free(), so that files used on different threads do not share
+ * string storage.  They must not be freed individually.  This is disabled by
+ * default, in which case the strings are kept until
+ * taglib_tag_free_strings().
+ *
+ * All string management functions are thread-safe.
+ */
+TAGLIB_C_EXPORT void taglib_set_string_management_per_file(BOOL perFile);
+
 /*!
  * Explicitly free a string returned from TagLib
  */
@@ -168,7 +180,10 @@ TAGLIB_C_EXPORT TagLib_File *taglib_file_new_type_wchar(const wchar_t *filename,
 TAGLIB_C_EXPORT TagLib_File *taglib_file_new_iostream(TagLib_IOStream *stream);
 
 /*!
- * Frees and closes the file.
+ * Frees and closes the file, including its strings if per file string
+ * management is enabled.
+ *
+ * \see taglib_set_string_management_per_file()
  */
 TAGLIB_C_EXPORT void taglib_file_free(TagLib_File *file);
 
@@ -296,7 +311,8 @@ TAGLIB_C_EXPORT void taglib_tag_set_year(TagLib_Tag *tag, unsigned int year);
 TAGLIB_C_EXPORT void taglib_tag_set_track(TagLib_Tag *tag, unsigned int track);
 
 /*!
- * Frees all of the strings that have been created by the tag.
+ * Frees all of the strings that have been created by the tag, including the
+ * ones kept per file.
  */
 TAGLIB_C_EXPORT void taglib_tag_free_strings(void);
 
@@ -378,6 +394,33 @@ TAGLIB_C_EXPORT char** taglib_property_get(const TagLib_File *file, const char *
  */
 TAGLIB_C_EXPORT void taglib_property_free(char **props);
 
+/*!
+ * All properties of a file, as returned by taglib_property_get_all().
+ *
+ * Entry \e i has the key <tt>data + keyOffsets[i]</tt> and the value
+ * <tt>data + valueOffsets[i]</tt>, both null terminated C-strings.  A property
+ * with several values has one entry per value, in order, sharing one key.
+ */
+typedef struct {
+  unsigned int count;
+  const unsigned int *keyOffsets;
+  const unsigned int *valueOffsets;
+  const char *data;
+} TagLib_Property_List;
+
+/*!
+ * Get all properties of \a file in a single allocation.
+ *
+ * \return NULL if \a file is NULL or the memory cannot be allocated.
+ * It must be freed by the client using taglib_property_list_free().
+ */
+TAGLIB_C_EXPORT TagLib_Property_List *taglib_property_get_all(const TagLib_File *file);
+
+/*!
+ * Frees a property list returned by taglib_property_get_all().
+ */
+TAGLIB_C_EXPORT void taglib_property_list_free(TagLib_Property_List *list);
+
 /******************************************************************************
  * Complex Properties API
  ******************************************************************************/
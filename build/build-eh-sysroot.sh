@@ -5,6 +5,11 @@
 # This script clones the source and builds the sysroot with -DWASI_SDK_EXCEPTIONS=ON.
 # No manual patches required.
 #
+# The EH sysroot is installed under its own prefix ($WASI_SDK_PATH/eh by
+# default, override with TAGLIB_WASI_EH_PREFIX) and leaves the SDK's stock
+# sysroot alone: the TAGLIB_WASI_EH=none build links against the stock
+# libc++/libc++abi, which have no throw sites that need libunwind.
+#
 # Prerequisites: cmake, ninja, git, python3
 
 set -e
@@ -38,6 +43,9 @@ for cmd in cmake ninja git python3; do
     fi
 done
 
+EH_PREFIX="${TAGLIB_WASI_EH_PREFIX:-$WASI_SDK_PATH/eh}"
+EH_SYSROOT="$EH_PREFIX/share/wasi-sysroot"
+
 WASI_SDK_SRC="$SCRIPT_DIR/wasi-sdk-src"
 SYSROOT_BUILD="$SCRIPT_DIR/sysroot-build"
 
@@ -72,31 +80,31 @@ rm -rf "$SYSROOT_BUILD"
 
 cmake -G Ninja -B "$SYSROOT_BUILD" -S . \
     -DCMAKE_TOOLCHAIN_FILE="$WASI_SDK_PATH/share/cmake/wasi-sdk.cmake" \
-    -DCMAKE_INSTALL_PREFIX="$WASI_SDK_PATH" \
+    -DCMAKE_INSTALL_PREFIX="$EH_PREFIX" \
     -DWASI_SDK_EXCEPTIONS=ON \
     -DWASI_SDK_INCLUDE_TESTS=OFF \
     -DWASI_SDK_LTO=OFF
 
 cmake --build "$SYSROOT_BUILD"
 
-# Step 4: Install the EH sysroot into the SDK
+# Step 4: Install the EH sysroot next to the SDK's stock sysroot
 echo ""
-echo -e "${BLUE}Step 4: Installing EH sysroot into SDK${NC}"
+echo -e "${BLUE}Step 4: Installing EH sysroot into $EH_PREFIX${NC}"
 
-cmake --install "$SYSROOT_BUILD" --prefix "$WASI_SDK_PATH"
+cmake --install "$SYSROOT_BUILD" --prefix "$EH_PREFIX"
 
 # Step 5: Verify
 echo ""
 echo -e "${BLUE}Step 5: Verifying EH support${NC}"
 
 # Check that libunwind was built
-LIBUNWIND="$WASI_SDK_PATH/share/wasi-sysroot/lib/wasm32-wasip1/libunwind.a"
+LIBUNWIND="$EH_SYSROOT/lib/wasm32-wasip1/libunwind.a"
 if [ -f "$LIBUNWIND" ]; then
     echo -e "${GREEN}libunwind.a found${NC}"
     ls -lh "$LIBUNWIND"
 else
     # Try alternate location (some SDK versions use wasm32-wasi)
-    LIBUNWIND=$(find "$WASI_SDK_PATH" -name "libunwind.a" 2>/dev/null | head -1)
+    LIBUNWIND=$(find "$EH_SYSROOT" -name "libunwind.a" 2>/dev/null | head -1)
     if [ -n "$LIBUNWIND" ]; then
         echo -e "${GREEN}libunwind.a found at: $LIBUNWIND${NC}"
     else
@@ -106,7 +114,7 @@ else
 fi
 
 # Check that libc++abi was rebuilt with EH
-LIBCXXABI="$WASI_SDK_PATH/share/wasi-sysroot/lib/wasm32-wasip1/libc++abi.a"
+LIBCXXABI="$EH_SYSROOT/lib/wasm32-wasip1/libc++abi.a"
 if [ -f "$LIBCXXABI" ]; then
     if "$WASI_SDK_PATH/bin/llvm-objdump" --section=target_features "$LIBCXXABI" 2>/dev/null | grep -q "exception-handling"; then
         echo -e "${GREEN}libc++abi.a has exception-handling feature${NC}"
@@ -114,7 +122,7 @@ if [ -f "$LIBCXXABI" ]; then
         echo -e "${YELLOW}Could not verify exception-handling feature in libc++abi.a (may still work)${NC}"
     fi
 else
-    LIBCXXABI=$(find "$WASI_SDK_PATH" -name "libc++abi.a" 2>/dev/null | head -1)
+    LIBCXXABI=$(find "$EH_SYSROOT" -name "libc++abi.a" 2>/dev/null | head -1)
     if [ -n "$LIBCXXABI" ]; then
         echo -e "${GREEN}libc++abi.a found at: $LIBCXXABI${NC}"
         if "$WASI_SDK_PATH/bin/llvm-objdump" --section=target_features "$LIBCXXABI" 2>/dev/null | grep -q "exception-handling"; then
@@ -129,6 +137,6 @@ fi
 
 echo ""
 echo -e "${GREEN}EH-enabled sysroot build complete${NC}"
-echo "The sysroot has been installed into: $WASI_SDK_PATH"
+echo "The sysroot has been installed into: $EH_SYSROOT"
 echo ""
 echo "Next: rebuild TagLib with 'bash build/build-wasi.sh'"
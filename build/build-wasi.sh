@@ -22,6 +22,186 @@ TAGLIB_DIR="$PROJECT_ROOT/lib/taglib"
 BUILD_DIR="$PROJECT_ROOT/build/wasi"
 DIST_DIR="$PROJECT_ROOT/dist/wasi"
 
+# Exception handling variant:
+#   TAGLIB_WASI_EH=wasm (default) - Wasm EH, produces taglib_wasi.wasm
+#   TAGLIB_WASI_EH=none           - -fno-exceptions, produces taglib_wasi_noeh.wasm
+# The no-EH module has no landing pads, no libunwind and runs on engines
+# without the exception handling proposal. TagLib reports parse errors
+# through return values, so only allocation failures behave differently:
+# they abort the instance instead of returning an error code.
+# The two variants use different sysroots: Wasm EH links against the one
+# build-eh-sysroot.sh installs ($WASI_SDK_PATH/eh, TAGLIB_WASI_EH_SYSROOT
+# overrides it), no EH against the SDK's stock, exception-free sysroot.
+TAGLIB_WASI_EH="${TAGLIB_WASI_EH:-wasm}"
+case "$TAGLIB_WASI_EH" in
+    wasm)
+        VARIANT_CFLAGS="-fwasm-exceptions"
+        VARIANT_CXXFLAGS="-fwasm-exceptions -mllvm -wasm-use-legacy-eh=false"
+        EH_ENABLED=true
+        OUTPUT_NAME="taglib_wasi"
+        ;;
+    none)
+        VARIANT_CFLAGS=""
+        VARIANT_CXXFLAGS="-fno-exceptions"
+        EH_ENABLED=false
+        OUTPUT_NAME="taglib_wasi_noeh"
+        BUILD_DIR="$PROJECT_ROOT/build/wasi-noeh"
+        ;;
+    *)
+        echo -e "${RED}❌ Unknown TAGLIB_WASI_EH value: $TAGLIB_WASI_EH (expected wasm or none)${NC}"
+        exit 1
+        ;;
+esac
+
+# SIMD variant:
+#   TAGLIB_WASI_SIMD=0 (default) - portable module
+#   TAGLIB_WASI_SIMD=1           - -msimd128, adds a _simd suffix to the output
+# TagLib's kernels (transcoding, pattern search, chunk offset patching)
+# select their wasm simd128 path at compile time and keep a scalar
+# fallback. The loader picks the SIMD module only when the runtime
+# validates SIMD code, so both modules are shipped.
+TAGLIB_WASI_SIMD="${TAGLIB_WASI_SIMD:-0}"
+if [ "$TAGLIB_WASI_SIMD" = "1" ]; then
+    SIMD_FLAGS="-msimd128"
+    SIMD_ENABLED=true
+    OUTPUT_NAME="${OUTPUT_NAME}_simd"
+    BUILD_DIR="${BUILD_DIR}-simd"
+else
+    SIMD_FLAGS=""
+    SIMD_ENABLED=false
+fi
+VARIANT_CFLAGS="$VARIANT_CFLAGS $SIMD_FLAGS"
+VARIANT_CXXFLAGS="$VARIANT_CXXFLAGS $SIMD_FLAGS"
+VARIANT_LDFLAGS=($SIMD_FLAGS)
+echo -e "${BLUE}Exception handling: ${TAGLIB_WASI_EH}, SIMD: ${SIMD_ENABLED}${NC}"
+
+# Allocator:
+#   TAGLIB_WASI_ALLOCATOR=dlmalloc (default) - wasi-libc's malloc for everything
+#   TAGLIB_WASI_ALLOCATOR=slab               - operator new/delete served by the
+#                                              size-class slab allocator
+#                                              (src/capi/core/taglib_slab.cpp),
+#                                              adds a _slab suffix to the output
+# TagLib allocates nearly everything through operator new, mostly objects
+# of 16-256 bytes; the slab keeps them out of dlmalloc's heap, and malloc
+# (mpack buffers, results handed to the host) stays on dlmalloc.
+TAGLIB_WASI_ALLOCATOR="${TAGLIB_WASI_ALLOCATOR:-dlmalloc}"
+ALLOCATOR_SOURCES=()
+ALLOCATOR_DEFINES=()
+case "$TAGLIB_WASI_ALLOCATOR" in
+    dlmalloc)
+        ;;
+    slab)
+        ALLOCATOR_SOURCES=("$SRC_DIR/core/taglib_slab.cpp")
+        ALLOCATOR_DEFINES=(-DTL_SLAB_OPERATOR_NEW=1)
+        OUTPUT_NAME="${OUTPUT_NAME}_slab"
+        BUILD_DIR="${BUILD_DIR}-slab"
+        ;;
+    *)
+        echo -e "${RED}❌ Unknown TAGLIB_WASI_ALLOCATOR value: $TAGLIB_WASI_ALLOCATOR (expected dlmalloc or slab)${NC}"
+        exit 1
+        ;;
+esac
+echo -e "${BLUE}Allocator: ${TAGLIB_WASI_ALLOCATOR}${NC}"
+
+# Live bytes in tl_heap_report() for dlmalloc builds:
+#   TAGLIB_WASI_HEAP_STATS=mallinfo (default) - dlmalloc's mallinfo(), when
+#                                               wasi-libc exports it
+#   TAGLIB_WASI_HEAP_STATS=counting           - counting operator new/delete
+#                                               wrappers; every allocation
+#                                               pays a malloc_usable_size(),
+#                                               for diagnostics only
+# Slab builds always report the slab stats.
+TAGLIB_WASI_HEAP_STATS="${TAGLIB_WASI_HEAP_STATS:-mallinfo}"
+case "$TAGLIB_WASI_HEAP_STATS" in
+    mallinfo|counting)
+        ;;
+    *)
+        echo -e "${RED}❌ Unknown TAGLIB_WASI_HEAP_STATS value: $TAGLIB_WASI_HEAP_STATS (expected mallinfo or counting)${NC}"
+        exit 1
+        ;;
+esac
+
+# Profile-guided optimization (driven by build/pgo.sh):
+#   TAGLIB_WASI_PGO=off (default)
+#   TAGLIB_WASI_PGO=generate - instrumented module, _pgo_gen suffix, exports
+#                              tl_pgo_write_profile() (needs an SDK that
+#                              ships the compiler-rt profile runtime)
+#   TAGLIB_WASI_PGO=use      - optimize with TAGLIB_WASI_PGO_PROFILE (.profdata)
+# The profile applies to TagLib, zlib, mpack and the C API alike.
+TAGLIB_WASI_PGO="${TAGLIB_WASI_PGO:-off}"
+PGO_SOURCES=()
+case "$TAGLIB_WASI_PGO" in
+    off)
+        PGO_FLAGS=""
+        ;;
+    generate)
+        PGO_FLAGS="-fprofile-generate"
+        PGO_SOURCES=("$SRC_DIR/core/taglib_pgo.c")
+        OUTPUT_NAME="${OUTPUT_NAME}_pgo_gen"
+        BUILD_DIR="${BUILD_DIR}-pgo-gen"
+        ;;
+    use)
+        if [ ! -f "$TAGLIB_WASI_PGO_PROFILE" ]; then
+            echo -e "${RED}❌ TAGLIB_WASI_PGO=use needs TAGLIB_WASI_PGO_PROFILE pointing to a .profdata file${NC}"
+            exit 1
+        fi
+        PGO_FLAGS="-fprofile-use=$TAGLIB_WASI_PGO_PROFILE -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date"
+        BUILD_DIR="${BUILD_DIR}-pgo"
+        ;;
+    *)
+        echo -e "${RED}❌ Unknown TAGLIB_WASI_PGO value: $TAGLIB_WASI_PGO (expected off, generate or use)${NC}"
+        exit 1
+        ;;
+esac
+VARIANT_CFLAGS="$VARIANT_CFLAGS $PGO_FLAGS"
+VARIANT_CXXFLAGS="$VARIANT_CXXFLAGS $PGO_FLAGS"
+if [ "$TAGLIB_WASI_PGO" = "generate" ]; then
+    VARIANT_LDFLAGS+=(-fprofile-generate -Wl,--export=tl_pgo_write_profile)
+fi
+
+# wasm-opt level, TAGLIB_WASI_OPT=none skips it (build/pgo.sh tunes the
+# level against the training workload)
+TAGLIB_WASI_OPT="${TAGLIB_WASI_OPT:--Oz}"
+
+# Format selection:
+#   TAGLIB_FORMATS=all (default)  - every format TagLib supports
+#   TAGLIB_FORMATS=vorbis,mp4     - comma separated TagLib format groups
+# Groups follow TagLib's WITH_* options: vorbis (FLAC, Ogg Vorbis, Opus,
+# Speex, Ogg FLAC), mp4, riff (WAV, AIFF), ape (APE, WavPack, MPC), asf,
+# dsf (DSF, DSDIFF), trueaudio, shorten, mod (MOD, S3M, IT, XM) and
+# matroska. MPEG is always built. Disabled groups are left out of TagLib,
+# FileRef and the shim's format registry (src/capi/taglib_formats.cpp).
+TAGLIB_FORMATS="${TAGLIB_FORMATS:-all}"
+FORMAT_GROUPS=(vorbis mp4 riff ape asf dsf trueaudio shorten mod matroska)
+if [ "$TAGLIB_FORMATS" = "all" ]; then
+    ENABLED_FORMAT_GROUPS=("${FORMAT_GROUPS[@]}")
+else
+    IFS=',' read -r -a ENABLED_FORMAT_GROUPS <<< "$TAGLIB_FORMATS"
+    for group in "${ENABLED_FORMAT_GROUPS[@]}"; do
+        if [[ " ${FORMAT_GROUPS[*]} " != *" $group "* ]]; then
+            echo -e "${RED}❌ Unknown TAGLIB_FORMATS group: $group (expected one of: ${FORMAT_GROUPS[*]})${NC}"
+            exit 1
+        fi
+    done
+    BUILD_DIR="${BUILD_DIR}-formats"
+fi
+FORMAT_CMAKE_FLAGS=()
+FORMAT_SOURCES=("$SRC_DIR/formats/taglib_group_mpeg.cpp")
+for group in "${FORMAT_GROUPS[@]}"; do
+    option="WITH_$(echo "$group" | tr '[:lower:]' '[:upper:]')"
+    if [[ " ${ENABLED_FORMAT_GROUPS[*]} " == *" $group "* ]]; then
+        FORMAT_CMAKE_FLAGS+=(-D"$option"=ON)
+        FORMAT_SOURCES+=("$SRC_DIR/formats/taglib_group_$group.cpp")
+    else
+        FORMAT_CMAKE_FLAGS+=(-D"$option"=OFF)
+    fi
+done
+FORMATS_JSON="\"mpeg\""
+for group in "${ENABLED_FORMAT_GROUPS[@]}"; do
+    FORMATS_JSON="$FORMATS_JSON, \"$group\""
+done
+echo -e "${BLUE}Formats: mpeg ${ENABLED_FORMAT_GROUPS[*]}${NC}"
+
 # Extract TagLib version from source header
 TAGLIB_HEADER="$TAGLIB_DIR/taglib/toolkit/taglib.h"
 TAGLIB_MAJOR=$(grep '#define TAGLIB_MAJOR_VERSION' "$TAGLIB_HEADER" | awk '{print $3}')
@@ -43,6 +223,18 @@ fi
 echo "Found WASI SDK: $WASI_SDK_PATH"
 "$WASI_SDK_PATH/bin/clang++" --version | head -1
 
+if [ "$EH_ENABLED" = true ]; then
+    WASI_SYSROOT="${TAGLIB_WASI_EH_SYSROOT:-$WASI_SDK_PATH/eh/share/wasi-sysroot}"
+    if [ -z "$(find "$WASI_SYSROOT" -name libunwind.a 2>/dev/null | head -1)" ]; then
+        echo -e "${RED}❌ EH sysroot not found at $WASI_SYSROOT${NC}"
+        echo "Please run: ./build/build-eh-sysroot.sh"
+        exit 1
+    fi
+else
+    WASI_SYSROOT="$WASI_SDK_PATH/share/wasi-sysroot"
+fi
+echo "Sysroot: $WASI_SYSROOT"
+
 # Create build directories
 mkdir -p "$BUILD_DIR/taglib"
 mkdir -p "$DIST_DIR"
@@ -78,8 +270,8 @@ if [ ! -f "$ZLIB_BUILD_DIR/libz.a" ]; then
     for src in $ZLIB_SRCS; do
         "$WASI_SDK_PATH/bin/clang" \
             --target=wasm32-wasip1 \
-            --sysroot="$WASI_SDK_PATH/share/wasi-sysroot" \
-            -O3 -fwasm-exceptions \
+            --sysroot="$WASI_SYSROOT" \
+            -O3 $VARIANT_CFLAGS \
             -I"$ZLIB_SRC_DIR" \
             -c -o "$ZLIB_BUILD_DIR/$src.o" "$ZLIB_SRC_DIR/$src.c"
     done
@@ -117,20 +309,19 @@ cmake "$TAGLIB_DIR" \
     -DCMAKE_RANLIB="$WASI_SDK_PATH/bin/llvm-ranlib" \
     -DCMAKE_C_COMPILER_TARGET=wasm32-wasip1 \
     -DCMAKE_CXX_COMPILER_TARGET=wasm32-wasip1 \
-    -DCMAKE_SYSROOT="$WASI_SDK_PATH/share/wasi-sysroot" \
+    -DCMAKE_SYSROOT="$WASI_SYSROOT" \
     -DCMAKE_BUILD_TYPE=Release \
     -DBUILD_SHARED_LIBS=OFF \
     -DENABLE_STATIC=ON \
-    -DWITH_MP4=ON \
-    -DWITH_ASF=ON \
+    "${FORMAT_CMAKE_FLAGS[@]}" \
     -DBUILD_EXAMPLES=OFF \
     -DBUILD_TESTS=OFF \
     -DBUILD_BINDINGS=OFF \
     -DWITH_ZLIB=ON \
     -DZLIB_LIBRARY="$BUILD_DIR/zlib/libz.a" \
     -DZLIB_INCLUDE_DIR="$BUILD_DIR/zlib" \
-    -DCMAKE_CXX_FLAGS="-O3 -fwasm-exceptions -mllvm -wasm-use-legacy-eh=false" \
-    -DCMAKE_C_FLAGS="-O3 -fwasm-exceptions"
+    -DCMAKE_CXX_FLAGS="-O3 $VARIANT_CXXFLAGS" \
+    -DCMAKE_C_FLAGS="-O3 $VARIANT_CFLAGS"
 
 # Build TagLib
 echo "Building TagLib..."
@@ -167,9 +358,9 @@ if [ ! -f "$MPACK_BUILD_DIR/libmpack.a" ]; then
         "$MPACK_DIR/src/mpack/mpack-reader.c" \
         "$MPACK_DIR/src/mpack/mpack-writer.c" \
         --target=wasm32-wasip1 \
-        --sysroot="$WASI_SDK_PATH/share/wasi-sysroot" \
+        --sysroot="$WASI_SYSROOT" \
         -I"$MPACK_DIR/src" \
-        -O3 -fwasm-exceptions -c
+        -O3 $VARIANT_CFLAGS -c
 
     # Create static library
     "$WASI_SDK_PATH/bin/llvm-ar" rcs libmpack.a *.o
@@ -199,11 +390,32 @@ CAPI_SOURCES=(
     "$SRC_DIR/taglib_ratings.cpp"         # C++ rating encode/decode via format-specific APIs
     "$SRC_DIR/taglib_lyrics.cpp"          # C++ lyrics encode/decode via complexProperties
     "$SRC_DIR/taglib_chapters.cpp"        # C++ chapter encode/decode via ID3v2 CHAP frames
-    "$SRC_DIR/taglib_audio_props.cpp"     # C++ extended audio properties via dynamic_cast
+    "$SRC_DIR/taglib_overlay_stream.cpp"  # C++ write-absorbing IOStream for tl_estimate_write
+    "$SRC_DIR/taglib_structure.cpp"       # C++ recording/replay IOStreams for structural snapshots
+    "$SRC_DIR/taglib_audio_props.cpp"     # C++ extended audio properties via the format registry
+    "$SRC_DIR/taglib_formats.cpp"         # C++ format registry, groups enabled in taglib_config.h
+    "${FORMAT_SOURCES[@]}"                # C++ per-group handlers (formats/taglib_group_*.cpp)
     "$SRC_DIR/core/taglib_error.cpp"      # C++ with pure C internals - compiled with Wasm EH
     "$SRC_DIR/core/taglib_msgpack.c"      # Pure C (no exceptions) - MessagePack implementation
+    "$SRC_DIR/core/taglib_heap.cpp"       # C++ heap report (mallinfo, slab stats or counting wrappers)
+    "${PGO_SOURCES[@]}"                   # Pure C profile dump, instrumented builds only
+    "${ALLOCATOR_SOURCES[@]}"             # C++ slab allocator, TAGLIB_WASI_ALLOCATOR=slab only
 )
 
+HEAP_DEFINES=()
+if [ "$TAGLIB_WASI_ALLOCATOR" = "slab" ]; then
+    TAGLIB_WASI_HEAP_STATS="slab"
+elif [ "$TAGLIB_WASI_HEAP_STATS" = "counting" ]; then
+    HEAP_DEFINES=(-DTL_HEAP_COUNTING=1)
+elif printf '#include <malloc.h>\nint main(void) { return (int)mallinfo().uordblks; }\n' | \
+    "$WASI_SDK_PATH/bin/clang" -x c - --target=wasm32-wasip1 --sysroot="$WASI_SYSROOT" \
+        -o "$BUILD_DIR/mallinfo-check.wasm" 2> /dev/null; then
+    HEAP_DEFINES=(-DTL_HEAP_MALLINFO=1)
+else
+    TAGLIB_WASI_HEAP_STATS="none"
+    echo -e "${YELLOW}⚠️  wasi-libc has no mallinfo(), tl_heap_report() will not report live bytes${NC}"
+fi
+
 # Compile C API sources with proper flags per file type
 CAPI_OBJECTS=()
 for src in "${CAPI_SOURCES[@]}"; do
@@ -214,15 +426,19 @@ for src in "${CAPI_SOURCES[@]}"; do
         # Compile C files with -fwasm-exceptions for feature flag consistency
         "$WASI_SDK_PATH/bin/clang" "$src" \
             --target=wasm32-wasip1 \
-            --sysroot="$WASI_SDK_PATH/share/wasi-sysroot" \
+            --sysroot="$WASI_SYSROOT" \
             -I"$SRC_DIR" -I"$MPACK_DIR/src" \
-            -O3 -fwasm-exceptions -c -o "$BUILD_DIR/$obj_name"
+            -O3 $VARIANT_CFLAGS -c -o "$BUILD_DIR/$obj_name"
     elif [[ "$(basename "$src")" == "taglib_shim.cpp" ]] || \
          [[ "$(basename "$src")" == "taglib_pictures.cpp" ]] || \
          [[ "$(basename "$src")" == "taglib_ratings.cpp" ]] || \
          [[ "$(basename "$src")" == "taglib_lyrics.cpp" ]] || \
          [[ "$(basename "$src")" == "taglib_chapters.cpp" ]] || \
-         [[ "$(basename "$src")" == "taglib_audio_props.cpp" ]]; then
+         [[ "$(basename "$src")" == "taglib_overlay_stream.cpp" ]] || \
+         [[ "$(basename "$src")" == "taglib_structure.cpp" ]] || \
+         [[ "$(basename "$src")" == "taglib_audio_props.cpp" ]] || \
+         [[ "$(basename "$src")" == "taglib_formats.cpp" ]] || \
+         [[ "$(basename "$src")" == taglib_group_*.cpp ]]; then
         echo "Compiling C++ with TagLib headers + Wasm EH: $src"
         # Collect all TagLib subdirectories for include paths
         TAGLIB_INCLUDES=(-I"$SRC_DIR" -I"$TAGLIB_DIR" -I"$TAGLIB_DIR/taglib" -I"$TAGLIB_DIR/taglib/toolkit" -I"$BUILD_DIR/taglib" -I"$MPACK_DIR/src")
@@ -231,45 +447,60 @@ for src in "${CAPI_SOURCES[@]}"; do
         done < <(find "$TAGLIB_DIR/taglib" -type d)
         "$WASI_SDK_PATH/bin/clang++" "$src" \
             --target=wasm32-wasip1 \
-            --sysroot="$WASI_SDK_PATH/share/wasi-sysroot" \
+            --sysroot="$WASI_SYSROOT" \
             "${TAGLIB_INCLUDES[@]}" \
-            -O3 -std=c++17 -fwasm-exceptions -mllvm -wasm-use-legacy-eh=false \
+            -O3 -std=c++17 $VARIANT_CXXFLAGS \
             -c -o "$BUILD_DIR/$obj_name"
     else
         echo "Compiling C++ support file with Wasm EH: $src"
         # C++ support files - use Wasm EH for std::string compatibility
         "$WASI_SDK_PATH/bin/clang++" "$src" \
             --target=wasm32-wasip1 \
-            --sysroot="$WASI_SDK_PATH/share/wasi-sysroot" \
+            --sysroot="$WASI_SYSROOT" \
             -I"$SRC_DIR" \
             -I"$MPACK_DIR/src" \
             -DTAGLIB_VERSION=\"${TAGLIB_VER}\" \
-            -O3 -std=c++17 -fwasm-exceptions -mllvm -wasm-use-legacy-eh=false \
+            -DTL_FORMAT_REGISTRY=1 \
+            "${ALLOCATOR_DEFINES[@]}" \
+            "${HEAP_DEFINES[@]}" \
+            -O3 -std=c++17 $VARIANT_CXXFLAGS \
             -c -o "$BUILD_DIR/$obj_name"
     fi
     CAPI_OBJECTS+=("$BUILD_DIR/$obj_name")
 done
 
-# Compile Wasm EH tag definition (LLVM 22+ requires external __cpp_exception tag)
-echo "Compiling Wasm EH tag definition"
-"$WASI_SDK_PATH/bin/clang" "$SRC_DIR/core/wasm_eh_tag.S" \
-    --target=wasm32-wasip1 \
-    --sysroot="$WASI_SDK_PATH/share/wasi-sysroot" \
-    -mexception-handling -c -o "$BUILD_DIR/wasm_eh_tag.obj"
-CAPI_OBJECTS+=("$BUILD_DIR/wasm_eh_tag.obj")
+EH_LDFLAGS=()
+if [ "$EH_ENABLED" = true ]; then
+    # Compile Wasm EH tag definition (LLVM 22+ requires external __cpp_exception tag)
+    echo "Compiling Wasm EH tag definition"
+    "$WASI_SDK_PATH/bin/clang" "$SRC_DIR/core/wasm_eh_tag.S" \
+        --target=wasm32-wasip1 \
+        --sysroot="$WASI_SYSROOT" \
+        -mexception-handling -c -o "$BUILD_DIR/wasm_eh_tag.obj"
+    CAPI_OBJECTS+=("$BUILD_DIR/wasm_eh_tag.obj")
+    EH_LDFLAGS=(-fwasm-exceptions -lunwind)
+else
+    EH_LDFLAGS=(-fno-exceptions)
+fi
 
-# Link everything together with Wasm EH support for TagLib
+# Link everything together (with Wasm EH support unless TAGLIB_WASI_EH=none)
 "$WASI_SDK_PATH/bin/clang++" "${CAPI_OBJECTS[@]}" \
     "$BUILD_DIR/taglib/taglib/libtag.a" \
     "$MPACK_BUILD_DIR/libmpack.a" \
     "$ZLIB_BUILD_DIR/libz.a" \
     --target=wasm32-wasip1 \
-    --sysroot="$WASI_SDK_PATH/share/wasi-sysroot" \
+    --sysroot="$WASI_SYSROOT" \
     -mexec-model=reactor \
-    -o "$DIST_DIR/taglib_wasi.wasm" \
+    -o "$DIST_DIR/$OUTPUT_NAME.wasm" \
     -Wl,--export=tl_read_tags \
     -Wl,--export=tl_read_tags_ex \
+    -Wl,--export=tl_read_tags_chunked \
+    -Wl,--export=tl_snapshot_structure \
+    -Wl,--export=tl_read_tags_snapshot \
     -Wl,--export=tl_write_tags \
+    -Wl,--export=tl_update_tags \
+    -Wl,--export=tl_write_skipped \
+    -Wl,--export=tl_estimate_write \
     -Wl,--export=tl_free \
     -Wl,--export=tl_malloc \
     -Wl,--export=tl_version \
@@ -280,6 +511,8 @@ CAPI_OBJECTS+=("$BUILD_DIR/wasm_eh_tag.obj")
     -Wl,--export=tl_has_capability \
     -Wl,--export=tl_detect_format \
     -Wl,--export=tl_format_name \
+    -Wl,--export=tl_preinitialize \
+    -Wl,--export=tl_heap_report \
     -Wl,--export=malloc \
     -Wl,--export=free \
     -Wl,--export=__heap_base \
@@ -288,28 +521,102 @@ CAPI_OBJECTS+=("$BUILD_DIR/wasm_eh_tag.obj")
     -Wl,--max-memory=2147483648 \
     -O3 \
     -std=c++17 \
-    -fwasm-exceptions \
-    -lunwind
+    "${EH_LDFLAGS[@]}" \
+    "${VARIANT_LDFLAGS[@]}"
 
 # Check results
-if [ ! -f "$DIST_DIR/taglib_wasi.wasm" ]; then
+if [ ! -f "$DIST_DIR/$OUTPUT_NAME.wasm" ]; then
     echo -e "${RED}❌ WASM module build failed${NC}"
     exit 1
 fi
 
+# A no-EH module must not declare exception tags; one would mean an EH-built
+# library slipped in and the module needs the proposal after all.
+if [ "$EH_ENABLED" = false ] && \
+    "$WASI_SDK_PATH/bin/llvm-objdump" -h "$DIST_DIR/$OUTPUT_NAME.wasm" | grep -qw TAG; then
+    echo -e "${RED}❌ $OUTPUT_NAME.wasm has a tag section, exception handling was linked in${NC}"
+    exit 1
+fi
+
+# Step 2.5: Pre-initialize with Wizer
+#   TAGLIB_WASI_PREINIT=auto (default) - snapshot when wizer accepts the module
+#   TAGLIB_WASI_PREINIT=1              - require the snapshot, fail otherwise
+#   TAGLIB_WASI_PREINIT=0              - ship the module uninitialized
+# Wizer runs the reactor's _initialize (static constructors) and then
+# tl_preinitialize (TagLib's lazily built tables), and writes the
+# resulting memory back as data segments. Both exports are dropped from
+# the snapshot, so hosts skip static initialization on every instance.
+# Wizer releases that predate the exception handling proposal reject the
+# default EH=wasm module; in auto mode that build then ships without a
+# snapshot, and the metadata's "preinit" field says why.
+TAGLIB_WASI_PREINIT="${TAGLIB_WASI_PREINIT:-auto}"
+PREINIT_APPLIED=false
+PREINIT_STATUS="disabled"
+# A snapshot of an instrumented module would carry the warm-up counters
+if [ "$TAGLIB_WASI_PGO" = "generate" ]; then
+    TAGLIB_WASI_PREINIT=0
+fi
+if [ "$TAGLIB_WASI_PREINIT" != "0" ]; then
+    echo ""
+    echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+    echo "🧊 Step 2.5: Pre-initializing WASM module"
+    echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
+
+    if command -v wizer &> /dev/null; then
+        WIZER_FEATURES=(--wasm-bulk-memory true)
+        if [ "$SIMD_ENABLED" = true ]; then
+            WIZER_FEATURES+=(--wasm-simd true)
+        fi
+        # Wizer's engine may not accept the exception handling proposal;
+        # in auto mode keep the uninitialized module rather than failing.
+        if wizer "$DIST_DIR/$OUTPUT_NAME.wasm" \
+            --allow-wasi \
+            --init-func tl_preinitialize \
+            "${WIZER_FEATURES[@]}" \
+            -o "$DIST_DIR/$OUTPUT_NAME.preinit.wasm"; then
+            mv "$DIST_DIR/$OUTPUT_NAME.preinit.wasm" "$DIST_DIR/$OUTPUT_NAME.wasm"
+            PREINIT_APPLIED=true
+            PREINIT_STATUS="applied"
+            echo -e "${GREEN}✅ Snapshot written${NC}"
+        else
+            rm -f "$DIST_DIR/$OUTPUT_NAME.preinit.wasm"
+            if [ "$TAGLIB_WASI_PREINIT" = "1" ]; then
+                echo -e "${RED}❌ TAGLIB_WASI_PREINIT=1 but wizer failed${NC}"
+                exit 1
+            fi
+            PREINIT_STATUS="wizer-rejected"
+            echo -e "${YELLOW}⚠️  wizer failed, keeping the uninitialized module${NC}"
+        fi
+    elif [ "$TAGLIB_WASI_PREINIT" = "1" ]; then
+        echo -e "${RED}❌ TAGLIB_WASI_PREINIT=1 but wizer was not found${NC}"
+        exit 1
+    else
+        PREINIT_STATUS="wizer-missing"
+        echo -e "${YELLOW}⚠️  wizer not found, skipping pre-initialization${NC}"
+    fi
+fi
+
 # Step 3: Optimize with wasm-opt
 echo ""
 echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
 echo "⚡ Step 3: Optimizing WASM modules"
 echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
 
-if command -v wasm-opt &> /dev/null; then
-    echo "Optimizing with wasm-opt..."
-    wasm-opt -Oz \
-        --enable-bulk-memory \
-        --enable-exception-handling \
-        "$DIST_DIR/taglib_wasi.wasm" \
-        -o "$DIST_DIR/taglib_wasi.wasm"
+if [ "$TAGLIB_WASI_OPT" = "none" ]; then
+    echo "TAGLIB_WASI_OPT=none, skipping optimization"
+elif command -v wasm-opt &> /dev/null; then
+    echo "Optimizing with wasm-opt $TAGLIB_WASI_OPT..."
+    WASM_OPT_FEATURES=(--enable-bulk-memory)
+    if [ "$EH_ENABLED" = true ]; then
+        WASM_OPT_FEATURES+=(--enable-exception-handling)
+    fi
+    if [ "$SIMD_ENABLED" = true ]; then
+        WASM_OPT_FEATURES+=(--enable-simd)
+    fi
+    wasm-opt $TAGLIB_WASI_OPT \
+        "${WASM_OPT_FEATURES[@]}" \
+        "$DIST_DIR/$OUTPUT_NAME.wasm" \
+        -o "$DIST_DIR/$OUTPUT_NAME.wasm"
     echo -e "${GREEN}✅ Optimization complete${NC}"
 else
     echo -e "${YELLOW}⚠️  wasm-opt not found, skipping optimization${NC}"
@@ -324,7 +631,7 @@ echo "━━━━━━━━━━━━━━━━━━━━━━━━
 
 if command -v wasm-strip &> /dev/null; then
     echo "Stripping debug info..."
-    wasm-strip "$DIST_DIR/taglib_wasi.wasm"
+    wasm-strip "$DIST_DIR/$OUTPUT_NAME.wasm"
     echo -e "${GREEN}✅ Debug info stripped${NC}"
 else
     echo -e "${YELLOW}⚠️  wasm-strip not found, skipping${NC}"
@@ -337,7 +644,7 @@ echo "━━━━━━━━━━━━━━━━━━━━━━━━
 echo "📝 Step 5: Generating metadata"
 echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
 
-cat > "$DIST_DIR/taglib_wasi.json" << EOF
+cat > "$DIST_DIR/$OUTPUT_NAME.json" << EOF
 {
   "name": "taglib-wasi",
   "version": "${TAGLIB_VER}",
@@ -345,7 +652,13 @@ cat > "$DIST_DIR/taglib_wasi.json" << EOF
   "exports": [
     "tl_read_tags",
     "tl_read_tags_ex",
+    "tl_read_tags_chunked",
+    "tl_snapshot_structure",
+    "tl_read_tags_snapshot",
     "tl_write_tags",
+    "tl_update_tags",
+    "tl_write_skipped",
+    "tl_estimate_write",
     "tl_free",
     "tl_malloc",
     "tl_version",
@@ -356,9 +669,13 @@ cat > "$DIST_DIR/taglib_wasi.json" << EOF
     "tl_has_capability",
     "tl_detect_format",
     "tl_format_name",
+    "tl_heap_report",
     "malloc",
     "free"
   ],
+  "imports": [
+    "env.tl_host_chunk"
+  ],
   "memory": {
     "initial": 16777216,
     "maximum": 2147483648
@@ -366,9 +683,16 @@ cat > "$DIST_DIR/taglib_wasi.json" << EOF
   "features": {
     "filesystem": true,
     "bulk_memory": true,
-    "exception_handling": true,
+    "exception_handling": ${EH_ENABLED},
+    "simd": ${SIMD_ENABLED},
+    "preinitialized": ${PREINIT_APPLIED},
+    "preinit": "${PREINIT_STATUS}",
+    "pgo": "${TAGLIB_WASI_PGO}",
+    "allocator": "${TAGLIB_WASI_ALLOCATOR}",
+    "heap_stats": "${TAGLIB_WASI_HEAP_STATS}",
     "threads": false
   },
+  "formats": [${FORMATS_JSON}],
   "optimized_for": ["Deno", "Node.js", "Cloudflare Workers"]
 }
 EOF
@@ -379,18 +703,18 @@ echo "━━━━━━━━━━━━━━━━━━━━━━━━
 echo "✅ Build Summary"
 echo "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━"
 
-WASM_SIZE=$(ls -lh "$DIST_DIR/taglib_wasi.wasm" | awk '{print $5}')
+WASM_SIZE=$(ls -lh "$DIST_DIR/$OUTPUT_NAME.wasm" | awk '{print $5}')
 
 echo -e "${GREEN}✅ WASI SDK build successful${NC}"
 echo ""
 echo "Output files:"
-echo "  📦 WASM: $DIST_DIR/taglib_wasi.wasm ($WASM_SIZE)"
-echo "  📝 Meta: $DIST_DIR/taglib_wasi.json"
+echo "  📦 WASM: $DIST_DIR/$OUTPUT_NAME.wasm ($WASM_SIZE)"
+echo "  📝 Meta: $DIST_DIR/$OUTPUT_NAME.json"
 echo ""
 echo "Target environments: Deno, Node.js (WASI), Cloudflare Workers"
 echo "Optimizations: Size-optimized (-Oz), stripped"
 
 # Copy WASI binary to build/ for JSR publishing
-cp "$DIST_DIR/taglib_wasi.wasm" "$PROJECT_ROOT/build/taglib_wasi.wasm"
+cp "$DIST_DIR/$OUTPUT_NAME.wasm" "$PROJECT_ROOT/build/$OUTPUT_NAME.wasm"
 echo ""
-echo "Published copy: build/taglib_wasi.wasm"
+echo "Published copy: build/$OUTPUT_NAME.wasm"
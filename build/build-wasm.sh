@@ -16,6 +16,56 @@ PROJECT_ROOT="$(dirname "$BUILD_DIR")"
 TAGLIB_DIR="$PROJECT_ROOT/lib/taglib"
 OUTPUT_DIR="$BUILD_DIR"
 
+# Profile-guided optimization: TAGLIB_PGO_PROFILE=<file.profdata> applies
+# the profile build/pgo.sh collected from the instrumented WASI module.
+# Both modules compile the same TagLib sources for wasm32; functions whose
+# CFG differs between the two builds are left unprofiled.
+PGO_FLAGS=""
+if [ -n "$TAGLIB_PGO_PROFILE" ]; then
+  if [ ! -f "$TAGLIB_PGO_PROFILE" ]; then
+    echo "❌ TAGLIB_PGO_PROFILE not found: $TAGLIB_PGO_PROFILE"
+    exit 1
+  fi
+  # The indexed profile format follows LLVM's major version; pgo.sh records
+  # the clang that produced the profile next to it
+  clang_major() {
+    sed -n 's/.*clang version \([0-9]*\).*/\1/p' | head -1
+  }
+  if [ -f "$TAGLIB_PGO_PROFILE.clang-version" ]; then
+    PROFILE_CLANG=$(clang_major < "$TAGLIB_PGO_PROFILE.clang-version")
+    EMCC_CLANG=$("$(em-config LLVM_ROOT)/clang" --version | clang_major)
+    if [ "$PROFILE_CLANG" != "$EMCC_CLANG" ]; then
+      echo "❌ TAGLIB_PGO_PROFILE comes from clang $PROFILE_CLANG, emcc uses clang $EMCC_CLANG"
+      exit 1
+    fi
+  else
+    echo "⚠️  $TAGLIB_PGO_PROFILE.clang-version not found, cannot check the profile's clang version"
+  fi
+  PGO_FLAGS="-fprofile-use=$TAGLIB_PGO_PROFILE -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date -Wno-profile-instr-missing"
+  echo "📈 Using PGO profile: $TAGLIB_PGO_PROFILE"
+fi
+
+# Allocator: TAGLIB_ALLOCATOR=dlmalloc (default), emmalloc or mimalloc select
+# Emscripten's malloc; slab keeps dlmalloc and serves operator new/delete
+# from the size-class slab allocator (src/capi/core/taglib_slab.cpp).
+TAGLIB_ALLOCATOR="${TAGLIB_ALLOCATOR:-dlmalloc}"
+ALLOCATOR_FLAGS=""
+ALLOCATOR_SOURCES=""
+case "$TAGLIB_ALLOCATOR" in
+  dlmalloc|emmalloc|mimalloc)
+    ALLOCATOR_FLAGS="-sMALLOC=$TAGLIB_ALLOCATOR"
+    ;;
+  slab)
+    ALLOCATOR_FLAGS="-DTL_SLAB_OPERATOR_NEW=1"
+    ALLOCATOR_SOURCES="$PROJECT_ROOT/src/capi/core/taglib_slab.cpp"
+    ;;
+  *)
+    echo "❌ Unknown TAGLIB_ALLOCATOR value: $TAGLIB_ALLOCATOR (expected dlmalloc, emmalloc, mimalloc or slab)"
+    exit 1
+    ;;
+esac
+echo "🧮 Allocator: $TAGLIB_ALLOCATOR"
+
 # Create CMake build directory (clean rebuild to ensure flag changes take effect)
 CMAKE_BUILD_DIR="$BUILD_DIR/cmake-build"
 rm -rf "$CMAKE_BUILD_DIR"
@@ -27,7 +77,7 @@ echo "📦 Configuring TagLib with Emscripten..."
 # Configure TagLib with CMake for Emscripten
 emcmake cmake "$TAGLIB_DIR" \
   -DCMAKE_WARN_DEPRECATED=OFF \
-  -DCMAKE_CXX_FLAGS="-Wno-character-conversion -frtti -sUSE_ZLIB=1" \
+  -DCMAKE_CXX_FLAGS="-Wno-character-conversion -frtti -sUSE_ZLIB=1 $PGO_FLAGS" \
   -DCMAKE_C_FLAGS="-sUSE_ZLIB=1" \
   -DCMAKE_BUILD_TYPE=Release \
   -DBUILD_SHARED_LIBS=OFF \
@@ -52,7 +102,7 @@ cp "$BUILD_DIR/taglib_embind.cpp" "$BUILD_DIR/taglib_wasm.cpp"
 echo "🔗 Compiling Wasm module with Embind..."
 
 # Compile the Wasm module with Embind
-emcc "$BUILD_DIR/taglib_wasm.cpp" \
+emcc "$BUILD_DIR/taglib_wasm.cpp" $ALLOCATOR_SOURCES \
   -I"$CMAKE_BUILD_DIR/install/include" \
   -I"$CMAKE_BUILD_DIR/install/include/taglib" \
   "$CMAKE_BUILD_DIR/install/lib/libtag.a" \
@@ -75,6 +125,8 @@ emcc "$BUILD_DIR/taglib_wasm.cpp" \
   -frtti \
   -lembind \
   -sUSE_ZLIB=1 \
+  $PGO_FLAGS \
+  $ALLOCATOR_FLAGS \
   --no-entry \
   -O3
 
@@ -0,0 +1,246 @@
+#!/bin/bash
+# Profile-guided optimization pipeline for the WASI module, the Embind
+# module and the native C API benchmark
+#
+#   1. build the WASI module without a profile (the baseline)
+#   2. build an instrumented module (TAGLIB_WASI_PGO=generate)
+#   3. run scripts/pgo-train.ts over the read/write corpus, merge the profile
+#   4. rebuild with the profile (TAGLIB_WASI_PGO=use), then pick the wasm-opt
+#      level that runs the same workload fastest
+#   5. rebuild build/taglib-web.wasm with the profile (needs emcc built on
+#      the same LLVM major version as the WASI SDK)
+#   6. instrument, train and rebuild a native TagLib + C API build with
+#      tests/capi_pgo_train.benchmark.cpp, report baseline vs PGO per format
+#   7. report baseline vs PGO time per format for the WASI module
+#
+# Both reports are also written to build/pgo/results.txt.
+#
+# TAGLIB_WASI_EH, TAGLIB_WASI_SIMD, TAGLIB_WASI_ALLOCATOR and TAGLIB_FORMATS
+# are passed through to build-wasi.sh. Requires deno, cmake, llvm-profdata
+# and a WASI SDK whose compiler-rt includes the profile runtime.
+
+set -e
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+DIST_DIR="$PROJECT_ROOT/dist/wasi"
+PGO_DIR="$PROJECT_ROOT/build/pgo"
+PROFILE="$PGO_DIR/taglib_wasi.profdata"
+TRAIN=(deno run --allow-read --allow-write --allow-env "$PROJECT_ROOT/scripts/pgo-train.ts")
+
+source "$SCRIPT_DIR/wasi-env.sh"
+
+LLVM_PROFDATA="${LLVM_PROFDATA:-$WASI_SDK_PATH/bin/llvm-profdata}"
+if [ ! -x "$LLVM_PROFDATA" ]; then
+    LLVM_PROFDATA="$(command -v llvm-profdata || true)"
+fi
+if [ -z "$LLVM_PROFDATA" ]; then
+    echo -e "${RED}❌ llvm-profdata not found (set LLVM_PROFDATA)${NC}"
+    exit 1
+fi
+
+# Output name as chosen by build-wasi.sh for the selected variant
+MODULE_NAME="taglib_wasi"
+WASM_OPT_FEATURES=(--enable-bulk-memory)
+if [ "${TAGLIB_WASI_EH:-wasm}" = "none" ]; then
+    MODULE_NAME="${MODULE_NAME}_noeh"
+else
+    WASM_OPT_FEATURES+=(--enable-exception-handling)
+fi
+if [ "${TAGLIB_WASI_SIMD:-0}" = "1" ]; then
+    MODULE_NAME="${MODULE_NAME}_simd"
+    WASM_OPT_FEATURES+=(--enable-simd)
+fi
+if [ "${TAGLIB_WASI_ALLOCATOR:-dlmalloc}" = "slab" ]; then
+    MODULE_NAME="${MODULE_NAME}_slab"
+fi
+MODULE="$DIST_DIR/$MODULE_NAME.wasm"
+BASELINE="$PGO_DIR/$MODULE_NAME.baseline.wasm"
+
+rm -rf "$PGO_DIR"
+mkdir -p "$PGO_DIR"
+
+echo -e "${BLUE}📈 Step 1: Baseline build${NC}"
+TAGLIB_WASI_PGO=off "$SCRIPT_DIR/build-wasi.sh"
+cp "$MODULE" "$BASELINE"
+
+echo -e "${BLUE}📈 Step 2: Instrumented build${NC}"
+TAGLIB_WASI_PGO=generate "$SCRIPT_DIR/build-wasi.sh"
+
+echo -e "${BLUE}📈 Step 3: Training${NC}"
+"${TRAIN[@]}" --wasm "$DIST_DIR/${MODULE_NAME}_pgo_gen.wasm" \
+    --profile "$PGO_DIR/taglib_wasi.profraw"
+"$LLVM_PROFDATA" merge -o "$PROFILE" "$PGO_DIR"/*.profraw
+# Consumers built on another LLVM release cannot read the profile
+"$WASI_SDK_PATH/bin/clang" --version | head -1 > "$PROFILE.clang-version"
+
+echo -e "${BLUE}📈 Step 4: Optimized build${NC}"
+TAGLIB_WASI_PGO=use TAGLIB_WASI_PGO_PROFILE="$PROFILE" TAGLIB_WASI_OPT=none \
+    "$SCRIPT_DIR/build-wasi.sh"
+cp "$MODULE" "$PGO_DIR/$MODULE_NAME.unopt.wasm"
+
+# Sum of the per-format times printed by pgo-train.ts --measure
+measure() {
+    "${TRAIN[@]}" --wasm "$1" --measure \
+        | deno eval 'const t = JSON.parse(await new Response(Deno.stdin.readable).text()); console.log(Object.values(t).reduce((a, b) => a + b, 0).toFixed(1))'
+}
+
+if command -v wasm-opt &> /dev/null; then
+    BEST_LEVEL=""
+    BEST_TIME=""
+    for level in -O2 -O3 -O4 -Os -Oz; do
+        candidate="$PGO_DIR/$MODULE_NAME$level.wasm"
+        wasm-opt "$level" "${WASM_OPT_FEATURES[@]}" \
+            "$PGO_DIR/$MODULE_NAME.unopt.wasm" -o "$candidate"
+        time_ms=$(measure "$candidate")
+        echo "  wasm-opt $level: ${time_ms} ms, $(wc -c < "$candidate") bytes"
+        if [ -z "$BEST_TIME" ] || awk "BEGIN { exit !($time_ms < $BEST_TIME) }"; then
+            BEST_LEVEL="$level"
+            BEST_TIME="$time_ms"
+        fi
+    done
+    echo -e "${GREEN}✅ Fastest wasm-opt level: $BEST_LEVEL${NC}"
+    cp "$PGO_DIR/$MODULE_NAME$BEST_LEVEL.wasm" "$MODULE"
+    echo "$BEST_LEVEL" > "$PGO_DIR/wasm-opt-level"
+else
+    echo -e "${YELLOW}⚠️  wasm-opt not found, keeping the unoptimized PGO module${NC}"
+fi
+cp "$MODULE" "$PROJECT_ROOT/build/$MODULE_NAME.wasm"
+
+echo -e "${BLUE}📈 Step 5: Embind module${NC}"
+clang_major() {
+    sed -n 's/.*clang version \([0-9]*\).*/\1/p' | head -1
+}
+if command -v emcc &> /dev/null; then
+    PROFILE_CLANG=$(clang_major < "$PROFILE.clang-version")
+    EMCC_CLANG=$("$(em-config LLVM_ROOT)/clang" --version | clang_major)
+    if [ "$PROFILE_CLANG" = "$EMCC_CLANG" ]; then
+        TAGLIB_PGO_PROFILE="$PROFILE" "$SCRIPT_DIR/build-wasm.sh"
+    else
+        echo -e "${YELLOW}⚠️  emcc uses clang $EMCC_CLANG, the profile comes from clang $PROFILE_CLANG; skipping taglib-web.wasm${NC}"
+    fi
+else
+    echo -e "${YELLOW}⚠️  emcc not found, skipping taglib-web.wasm${NC}"
+fi
+
+# Per-format baseline vs PGO table from two --measure JSON files
+compare() {
+    deno eval '
+const [base, pgo] = Deno.args.map((p) => JSON.parse(Deno.readTextFileSync(p)));
+for (const format of Object.keys(base)) {
+  const change = ((pgo[format] - base[format]) / base[format]) * 100;
+  console.log(`${format.padEnd(6)} ${base[format].toFixed(1).padStart(9)} ${pgo[format].toFixed(1).padStart(9)} ${change.toFixed(1).padStart(7)}%`);
+}' "$1" "$2"
+}
+
+echo -e "${BLUE}📈 Step 6: Native TagLib + C API${NC}"
+SRC_DIR="$PROJECT_ROOT/src/capi"
+TAGLIB_DIR="$PROJECT_ROOT/lib/taglib"
+MPACK_DIR="$PROJECT_ROOT/lib/mpack"
+NATIVE_DIR="$PGO_DIR/native"
+NATIVE_PROFILE_DIR="$NATIVE_DIR/profile"
+if command -v clang++ &> /dev/null; then
+    NATIVE_CC="clang"
+    NATIVE_CXX="clang++"
+else
+    NATIVE_CC="gcc"
+    NATIVE_CXX="g++"
+fi
+NATIVE_SOURCES=(
+    "$MPACK_DIR"/src/mpack/mpack-*.c
+    "$SRC_DIR/taglib_shim.cpp"
+    "$SRC_DIR/taglib_pictures.cpp"
+    "$SRC_DIR/taglib_ratings.cpp"
+    "$SRC_DIR/taglib_lyrics.cpp"
+    "$SRC_DIR/taglib_chapters.cpp"
+    "$SRC_DIR/taglib_overlay_stream.cpp"
+    "$SRC_DIR/taglib_structure.cpp"
+    "$SRC_DIR/taglib_audio_props.cpp"
+    "$SRC_DIR/taglib_formats.cpp"
+    "$SRC_DIR"/formats/taglib_group_*.cpp
+    "$SRC_DIR/core/taglib_error.cpp"
+    "$SRC_DIR/core/taglib_msgpack.c"
+    "$PROJECT_ROOT/tests/capi_pgo_train.benchmark.cpp"
+)
+# TagLib (all formats, no zlib: the corpus has no compressed frames), mpack
+# and the shim, compiled with the profile flags in $2. The instrumented and
+# optimized builds reuse one build tree: gcc names its .gcda files after
+# the object paths.
+build_native() {
+    local suffix="$1"
+    local flags="$2"
+    local dir="$NATIVE_DIR/build"
+    rm -rf "$dir"
+    mkdir -p "$dir/obj"
+    cmake -S "$TAGLIB_DIR" -B "$dir/taglib" \
+        -DCMAKE_C_COMPILER="$NATIVE_CC" \
+        -DCMAKE_CXX_COMPILER="$NATIVE_CXX" \
+        -DCMAKE_BUILD_TYPE=Release \
+        -DBUILD_SHARED_LIBS=OFF \
+        -DBUILD_EXAMPLES=OFF \
+        -DBUILD_TESTS=OFF \
+        -DBUILD_BINDINGS=OFF \
+        -DWITH_ZLIB=OFF \
+        -DCMAKE_C_FLAGS="-O2 $flags" \
+        -DCMAKE_CXX_FLAGS="-O2 $flags" > /dev/null
+    cmake --build "$dir/taglib" -j"$(nproc 2>/dev/null || sysctl -n hw.ncpu 2>/dev/null || echo 4)" > /dev/null
+
+    local includes=(-I"$SRC_DIR" -I"$SRC_DIR/core" -I"$TAGLIB_DIR" -I"$dir/taglib" -I"$MPACK_DIR/src")
+    while IFS= read -r d; do
+        includes+=(-I"$d")
+    done < <(find "$TAGLIB_DIR/taglib" -type d)
+    local objects=()
+    for src in "${NATIVE_SOURCES[@]}"; do
+        local obj="$dir/obj/$(basename "$src").o"
+        if [[ "$src" == *.c ]]; then
+            $NATIVE_CC "$src" "${includes[@]}" -O2 $flags -c -o "$obj"
+        else
+            $NATIVE_CXX "$src" "${includes[@]}" \
+                -DTAGLIB_VERSION=\"native\" -DTL_FORMAT_REGISTRY=1 \
+                -std=c++17 -O2 $flags -c -o "$obj"
+        fi
+        objects+=("$obj")
+    done
+    $NATIVE_CXX "${objects[@]}" "$dir/taglib/taglib/libtag.a" $flags \
+        -o "$dir/capi_pgo_train"
+    cp "$dir/capi_pgo_train" "$NATIVE_DIR/capi_pgo_train.$suffix"
+}
+TRAIN_NATIVE_ARGS=("$PROJECT_ROOT/tests/test-files" 20)
+build_native baseline ""
+build_native gen "-fprofile-generate=$NATIVE_PROFILE_DIR"
+"$NATIVE_DIR/capi_pgo_train.gen" "${TRAIN_NATIVE_ARGS[@]}" > /dev/null
+if [ "$NATIVE_CXX" = "clang++" ]; then
+    # The host clang may be another LLVM release than the WASI SDK's
+    NATIVE_PROFDATA="$(command -v llvm-profdata || echo "$LLVM_PROFDATA")"
+    "$NATIVE_PROFDATA" merge -o "$NATIVE_PROFILE_DIR/native.profdata" "$NATIVE_PROFILE_DIR"/*.profraw
+    build_native pgo "-fprofile-use=$NATIVE_PROFILE_DIR/native.profdata"
+else
+    build_native pgo "-fprofile-use=$NATIVE_PROFILE_DIR -fprofile-partial-training"
+fi
+"$NATIVE_DIR/capi_pgo_train.baseline" "${TRAIN_NATIVE_ARGS[@]}" > "$NATIVE_DIR/baseline.json"
+"$NATIVE_DIR/capi_pgo_train.pgo" "${TRAIN_NATIVE_ARGS[@]}" > "$NATIVE_DIR/pgo.json"
+{
+    echo "Native $NATIVE_CXX (ms for the training workload): format, baseline, PGO, change"
+    compare "$NATIVE_DIR/baseline.json" "$NATIVE_DIR/pgo.json"
+    echo ""
+} | tee "$PGO_DIR/results.txt"
+
+echo -e "${BLUE}📈 Step 7: Baseline vs PGO (ms for the training workload)${NC}"
+"${TRAIN[@]}" --wasm "$BASELINE" --measure > "$PGO_DIR/baseline.json"
+"${TRAIN[@]}" --wasm "$MODULE" --measure > "$PGO_DIR/pgo.json"
+{
+    echo "WASI $MODULE_NAME (ms for the training workload): format, baseline, PGO, change"
+    compare "$PGO_DIR/baseline.json" "$PGO_DIR/pgo.json"
+} | tee -a "$PGO_DIR/results.txt"
+
+echo ""
+echo -e "${GREEN}✅ PGO build complete: $MODULE${NC}"
+echo "Profile: $PROFILE"
+echo "Results: $PGO_DIR/results.txt"
+echo "Compare with: deno task bench:pgo"
@@ -62,23 +62,23 @@ public:
     TagWrapper(TagLib::Tag* t) : tag(t) {}
     
     std::string title() const {
-        return tag ? tag->title().toCString(true) : "";
+        return tag ? tag->title().to8Bit(true) : "";
     }
     
     std::string artist() const {
-        return tag ? tag->artist().toCString(true) : "";
+        return tag ? tag->artist().to8Bit(true) : "";
     }
     
     std::string album() const {
-        return tag ? tag->album().toCString(true) : "";
+        return tag ? tag->album().to8Bit(true) : "";
     }
     
     std::string comment() const {
-        return tag ? tag->comment().toCString(true) : "";
+        return tag ? tag->comment().to8Bit(true) : "";
     }
     
     std::string genre() const {
-        return tag ? tag->genre().toCString(true) : "";
+        return tag ? tag->genre().to8Bit(true) : "";
     }
     
     unsigned int year() const {
@@ -621,9 +621,9 @@ public:
             for (const auto& prop : properties) {
                 val array = val::array();
                 for (const auto& value : prop.second) {
-                    array.call<void>("push", std::string(value.toCString(true)));
+                    array.call<void>("push", value.to8Bit(true));
                 }
-                obj.set(std::string(prop.first.toCString(true)), array);
+                obj.set(prop.first.to8Bit(true), array);
             }
         }
         
@@ -665,7 +665,7 @@ public:
         TagLib::String tagKey(key, TagLib::String::UTF8);
         
         if (properties.contains(tagKey) && !properties[tagKey].isEmpty()) {
-            return std::string(properties[tagKey].front().toCString(true));
+            return properties[tagKey].front().to8Bit(true);
         }
         
         return "";
@@ -701,7 +701,7 @@ public:
                 if (item.type() == TagLib::MP4::Item::Type::Int) {
                     return std::to_string(item.toInt());
                 } else if (item.type() == TagLib::MP4::Item::Type::StringList && !item.toStringList().isEmpty()) {
-                    return std::string(item.toStringList().front().toCString(true));
+                    return item.toStringList().front().to8Bit(true);
                 } else if (item.type() == TagLib::MP4::Item::Type::Bool) {
                     return item.toBool() ? "true" : "false";
                 } else if (item.type() == TagLib::MP4::Item::Type::Byte) {
@@ -850,9 +850,9 @@ public:
                         dynamic_cast<TagLib::ID3v2::AttachedPictureFrame*>(frame)) {
                         
                         val pictureObj = val::object();
-                        pictureObj.set("mimeType", std::string(pictureFrame->mimeType().toCString(true)));
+                        pictureObj.set("mimeType", pictureFrame->mimeType().to8Bit(true));
                         pictureObj.set("type", static_cast<int>(pictureFrame->type()));
-                        pictureObj.set("description", std::string(pictureFrame->description().toCString(true)));
+                        pictureObj.set("description", pictureFrame->description().to8Bit(true));
                         
                         // Convert picture data to Uint8Array (fast bulk copy)
                         TagLib::ByteVector picData = pictureFrame->picture();
@@ -911,9 +911,9 @@ public:
             
             for (const auto& picture : pictureList) {
                 val pictureObj = val::object();
-                pictureObj.set("mimeType", std::string(picture->mimeType().toCString(true)));
+                pictureObj.set("mimeType", picture->mimeType().to8Bit(true));
                 pictureObj.set("type", static_cast<int>(picture->type()));
-                pictureObj.set("description", std::string(picture->description().toCString(true)));
+                pictureObj.set("description", picture->description().to8Bit(true));
                 
                 // Convert picture data to Uint8Array (fast bulk copy)
                 TagLib::ByteVector picData = picture->data();
@@ -929,9 +929,9 @@ public:
                 
                 for (const auto& picture : pictureList) {
                     val pictureObj = val::object();
-                    pictureObj.set("mimeType", std::string(picture->mimeType().toCString(true)));
+                    pictureObj.set("mimeType", picture->mimeType().to8Bit(true));
                     pictureObj.set("type", static_cast<int>(picture->type()));
-                    pictureObj.set("description", std::string(picture->description().toCString(true)));
+                    pictureObj.set("description", picture->description().to8Bit(true));
                     
                     // Convert picture data to Uint8Array (fast bulk copy)
                     TagLib::ByteVector picData = picture->data();
@@ -1102,7 +1102,7 @@ public:
                         val ratingObj = val::object();
                         // Normalize rating from 0-255 to 0.0-1.0
                         ratingObj.set("rating", popmFrame->rating() / 255.0);
-                        ratingObj.set("email", std::string(popmFrame->email().toCString(true)));
+                        ratingObj.set("email", popmFrame->email().to8Bit(true));
                         ratingObj.set("counter", static_cast<unsigned int>(popmFrame->counter()));
 
                         ratings.call<void>("push", ratingObj);
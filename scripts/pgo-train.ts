@@ -0,0 +1,112 @@
+#!/usr/bin/env -S deno run --allow-read --allow-write --allow-env
+
+/**
+ * @fileoverview PGO training and measurement workload for the WASI module
+ *
+ * Runs the read/write corpus (tests/test-files, one file per format)
+ * through a WASI module:
+ * - path reads, buffer reads and path writes, per format
+ * - with --profile, writes the raw profile of an instrumented
+ *   (TAGLIB_WASI_PGO=generate) module afterwards
+ * - with --measure, prints the time per format as JSON, which
+ *   build/pgo.sh uses to tune wasm-opt and to report before/after numbers
+ *
+ * Usage:
+ *   deno run -A scripts/pgo-train.ts --wasm dist/wasi/taglib_wasi_pgo_gen.wasm \
+ *     --profile build/pgo/taglib_wasi.profraw
+ *   deno run -A scripts/pgo-train.ts --wasm dist/wasi/taglib_wasi.wasm --measure
+ */
+
+import { basename, dirname, resolve } from "@std/path";
+import { loadWasiHost } from "../src/runtime/wasi-host-loader.ts";
+import { WasmArena, type WasmExports } from "../src/runtime/wasi-memory.ts";
+import {
+  FORMAT_FILES,
+  readTagsViaBuffer,
+  readTagsViaPath,
+  writeTagsWasi,
+} from "../tests/wasi-test-helpers.ts";
+
+function option(name: string): string | undefined {
+  const index = Deno.args.indexOf(`--${name}`);
+  return index >= 0 ? Deno.args[index + 1] : undefined;
+}
+
+const args = {
+  wasm: option("wasm"),
+  profile: option("profile"),
+  iterations: option("iterations") ?? "20",
+  measure: Deno.args.includes("--measure"),
+};
+
+if (!args.wasm) {
+  console.error(
+    "Usage: pgo-train.ts --wasm <module> [--profile <file.profraw>] [--measure] [--iterations N]",
+  );
+  Deno.exit(1);
+}
+
+const PROJECT_ROOT = resolve(Deno.cwd());
+const TEST_FILES_DIR = resolve(PROJECT_ROOT, "tests/test-files");
+const iterations = Number(args.iterations);
+
+// Writes go to copies, the corpus itself stays untouched
+const scratchDir = await Deno.makeTempDir({ prefix: "taglib-pgo-" });
+for (const paths of Object.values(FORMAT_FILES)) {
+  const target = resolve(scratchDir, paths.real);
+  await Deno.mkdir(dirname(target), { recursive: true });
+  await Deno.copyFile(resolve(TEST_FILES_DIR, paths.real), target);
+}
+
+const profilePath = args.profile ? resolve(args.profile) : undefined;
+const preopens: Record<string, string> = {
+  "/test": TEST_FILES_DIR,
+  "/scratch": scratchDir,
+};
+if (profilePath) {
+  await Deno.mkdir(dirname(profilePath), { recursive: true });
+  preopens["/profile"] = dirname(profilePath);
+}
+
+using wasi = await loadWasiHost({ wasmPath: resolve(args.wasm), preopens });
+
+const timings: Record<string, number> = {};
+try {
+  for (const [format, paths] of Object.entries(FORMAT_FILES)) {
+    const data = await Deno.readFile(resolve(TEST_FILES_DIR, paths.real));
+    const scratchPath = `/scratch/${paths.real}`;
+    const start = performance.now();
+    for (let i = 0; i < iterations; i++) {
+      const tags = readTagsViaPath(wasi, paths.virtual);
+      readTagsViaBuffer(wasi, data);
+      writeTagsWasi(wasi, scratchPath, {
+        ...tags,
+        title: [`PGO ${format} ${i}`],
+        comment: ["pgo-train"],
+      });
+    }
+    timings[format] = performance.now() - start;
+  }
+} finally {
+  await Deno.remove(scratchDir, { recursive: true });
+}
+
+if (profilePath) {
+  if (!wasi.tl_pgo_write_profile) {
+    console.error(
+      `${args.wasm} is not instrumented (build it with TAGLIB_WASI_PGO=generate)`,
+    );
+    Deno.exit(1);
+  }
+  using arena = new WasmArena(wasi as WasmExports);
+  const path = arena.allocString(`/profile/${basename(profilePath)}`);
+  if (wasi.tl_pgo_write_profile(path.ptr) !== 0) {
+    console.error(`Failed to write profile to ${profilePath}`);
+    Deno.exit(1);
+  }
+  console.error(`Profile written to ${profilePath}`);
+}
+
+if (args.measure) {
+  console.log(JSON.stringify(timings));
+}
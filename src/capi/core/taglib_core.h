@@ -60,6 +60,22 @@ typedef enum {
     TL_FORMAT_MATROSKA
 } tl_format;
 
+// Cost of a write, filled by tl_estimate_write. The region is the span of
+// the file the save rewrites (tags, plus their padding and any headers
+// that change with them).
+typedef struct {
+    uint64_t file_size;
+    uint64_t new_file_size;
+    uint64_t region_offset;
+    uint64_t region_size;      // before the write
+    uint64_t new_region_size;  // after the write
+    uint64_t bytes_moved;      // audio/payload shifted because the region changed size
+    uint64_t bytes_read;       // read back while saving, to move that payload
+    uint64_t bytes_written;    // written while saving, moved payload included
+    uint32_t fits_in_place;    // 1 if no payload moves
+    uint32_t unchanged;        // 1 if tl_write_tags would skip the save
+} tl_write_estimate;
+
 // Core memory management functions
 tl_pool_t tl_pool_create(size_t initial_size);
 void* tl_pool_alloc(tl_pool_t pool, size_t size);
@@ -1,5 +1,8 @@
 // Error handling for TagLib-Wasm - Pure C to avoid std::string EH symbols
 #include "taglib_core.h"
+#ifdef TL_FORMAT_REGISTRY
+#include "../taglib_formats.h"
+#endif
 #include <string.h>
 #include <stdlib.h>
 
@@ -91,6 +94,12 @@ bool tl_has_capability(const char* capability) {
     if (strcmp(capability, "json") == 0) return true;  // Legacy support
     if (strcmp(capability, "streaming") == 0) return true;
     if (strcmp(capability, "memory-pool") == 0) return true;
+#ifdef TL_FORMAT_REGISTRY
+    // Modular builds only report the format groups they were built with
+    if (strncmp(capability, "format-", 7) == 0) {
+        return tl_format_capability_enabled(capability);
+    }
+#endif
     if (strcmp(capability, "format-mp3") == 0) return true;
     if (strcmp(capability, "format-flac") == 0) return true;
     if (strcmp(capability, "format-m4a") == 0) return true;
@@ -0,0 +1,99 @@
+// Heap report for the WASI module
+#include "taglib_heap.h"
+
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+#ifdef TL_SLAB_OPERATOR_NEW
+#include "taglib_slab.h"
+#endif
+
+extern "C" unsigned char __heap_base;
+
+// Live bytes come from the slab stats in slab builds and from dlmalloc's
+// mallinfo() when the libc exports it (TL_HEAP_MALLINFO). Counting
+// operator new/delete wrappers (TL_HEAP_COUNTING) cost a
+// malloc_usable_size() per allocation and are for diagnostic builds only.
+#if defined(TL_HEAP_COUNTING) && !defined(TL_SLAB_OPERATOR_NEW)
+
+static size_t g_live_bytes;
+static size_t g_peak_live_bytes;
+
+static void* counting_alloc(size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr) {
+        g_live_bytes += malloc_usable_size(ptr);
+        if (g_live_bytes > g_peak_live_bytes) g_peak_live_bytes = g_live_bytes;
+    }
+    return ptr;
+}
+
+static void counting_free(void* ptr) {
+    if (!ptr) return;
+    g_live_bytes -= malloc_usable_size(ptr);
+    std::free(ptr);
+}
+
+static void* counting_new(size_t size) {
+    void* ptr = counting_alloc(size);
+    if (!ptr) {
+#ifdef __cpp_exceptions
+        throw std::bad_alloc();
+#else
+        std::abort();
+#endif
+    }
+    return ptr;
+}
+
+void* operator new(size_t size) { return counting_new(size); }
+void* operator new[](size_t size) { return counting_new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counting_alloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counting_alloc(size); }
+
+void operator delete(void* ptr) noexcept { counting_free(ptr); }
+void operator delete[](void* ptr) noexcept { counting_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counting_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counting_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counting_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counting_free(ptr); }
+#endif
+
+int tl_heap_report(tl_heap_stats* stats) {
+    if (!stats) return -1;
+
+    size_t memory_bytes = __builtin_wasm_memory_size(0) * 65536;
+    size_t heap_base = reinterpret_cast<size_t>(&__heap_base);
+    size_t live_bytes = 0;
+    size_t peak_live_bytes = 0;
+    bool live_known = true;
+#ifdef TL_SLAB_OPERATOR_NEW
+    tl_slab_stats slab;
+    tl_slab_get_stats(&slab);
+    live_bytes = slab.small_bytes + slab.large_bytes;
+    peak_live_bytes = slab.peak_bytes;
+#elif defined(TL_HEAP_COUNTING)
+    live_bytes = g_live_bytes;
+    peak_live_bytes = g_peak_live_bytes;
+#elif defined(TL_HEAP_MALLINFO)
+    // The peak is sampled: it is the highest value seen by a report
+    static size_t peak_reported;
+    live_bytes = mallinfo().uordblks;
+    if (live_bytes > peak_reported) peak_reported = live_bytes;
+    peak_live_bytes = peak_reported;
+#else
+    live_known = false;
+#endif
+
+    size_t heap_bytes = memory_bytes - heap_base;
+    stats->memory_bytes = static_cast<uint32_t>(memory_bytes);
+    stats->heap_base = static_cast<uint32_t>(heap_base);
+    stats->heap_bytes = static_cast<uint32_t>(heap_bytes);
+    stats->live_bytes = static_cast<uint32_t>(live_bytes);
+    stats->peak_live_bytes = static_cast<uint32_t>(peak_live_bytes);
+    stats->free_permille = live_known && heap_bytes > live_bytes
+        ? static_cast<uint32_t>((uint64_t(heap_bytes - live_bytes) * 1000) / heap_bytes)
+        : 0;
+    return 0;
+}
@@ -0,0 +1,39 @@
+/**
+ * @fileoverview Heap report for the WASI module
+ *
+ * Linear memory only grows, so a module that once parsed a large buffer
+ * keeps that footprint for the rest of its life. tl_heap_report() lets
+ * the host compare the memory it holds with what is still in use and
+ * retire the instance (see src/runtime/unified-loader/instance-recycling.ts).
+ */
+
+#ifndef TAGLIB_HEAP_H
+#define TAGLIB_HEAP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Layout is read by the host: six little-endian u32 fields.
+typedef struct {
+    uint32_t memory_bytes;      // linear memory size
+    uint32_t heap_base;         // start of the malloc heap (__heap_base)
+    uint32_t heap_bytes;        // memory_bytes - heap_base
+    uint32_t live_bytes;        // bytes in live allocations, 0 if unknown
+    uint32_t peak_live_bytes;   // high-water mark of live_bytes
+    uint32_t free_permille;     // share of heap_bytes not live, 0 if unknown
+} tl_heap_stats;
+
+/**
+ * Fill stats with the current heap usage.
+ * @return 0 on success, -1 if stats is NULL
+ */
+int tl_heap_report(tl_heap_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TAGLIB_HEAP_H
@@ -467,17 +467,42 @@ mp_status tags_decode(const uint8_t* buf, size_t len, Arena* arena, TagData** ou
     return MP_OK;
 }
 
+static void chunked_flush(mpack_writer_t* writer, const char* data, size_t count) {
+    mp_chunk_sink* sink = (mp_chunk_sink*)mpack_writer_context(writer);
+    while (count > 0) {
+        size_t n = count < sink->chunk_size ? count : sink->chunk_size;
+        if (sink->write((const uint8_t*)data, n, sink->ctx) != n) {
+            mpack_writer_flag_error(writer, mpack_error_io);
+            return;
+        }
+        data += n;
+        count -= n;
+    }
+}
+
+mp_status mp_writer_init_chunked(mpack_writer_t* writer, char* chunk,
+                                 size_t chunk_size, mp_chunk_sink* sink) {
+    if (!writer || !chunk || !sink || !sink->write || chunk_size < MP_CHUNK_MIN_SIZE) {
+        return MP_ERR_INVALID_DATA;
+    }
+    sink->chunk_size = chunk_size;
+    mpack_writer_init(writer, chunk, chunk_size);
+    mpack_writer_set_context(writer, sink);
+    mpack_writer_set_flush(writer, chunked_flush);
+    return MP_OK;
+}
+
 // Stream encoding variant
 mp_status tags_encode_stream(const TagData* tags, mp_write_fn write, void* ctx) {
     if (!tags || !write) {
         return MP_ERR_INVALID_DATA;
     }
     
-    // Use growable buffer first
+    // Fixed chunk: the encoded map never exists in one piece
     mpack_writer_t writer;
-    char* data = NULL;
-    size_t size = 0;
-    mpack_writer_init_growable(&writer, &data, &size);
+    char chunk[256];
+    mp_chunk_sink sink = {write, ctx, sizeof(chunk)};
+    mp_writer_init_chunked(&writer, chunk, sizeof(chunk), &sink);
     
     // Encode as before
     mpack_start_map(&writer, 16);
@@ -517,26 +542,8 @@ mp_status tags_encode_stream(const TagData* tags, mp_write_fn write, void* ctx)
     
     mpack_finish_map(&writer);
     
-    mpack_error_t error = mpack_writer_error(&writer);
-    if (error != mpack_ok) {
-        mpack_writer_destroy(&writer);
-        return MP_ERR_INTERNAL;
-    }
-    
-    // Destroy the writer to get the data buffer
-    mpack_writer_destroy(&writer);
-    
-    if (!data || size == 0) {
-        return MP_ERR_INTERNAL;
-    }
-    
-    // Stream the data
-    size_t written = write((const uint8_t*)data, size, ctx);
-    
-    // Free the allocated buffer
-    free(data);
-    
-    return (written == size) ? MP_OK : MP_ERR_INTERNAL;
+    // Destroy flushes the last partial chunk
+    return mpack_writer_destroy(&writer) == mpack_ok ? MP_OK : MP_ERR_INTERNAL;
 }
 
 // Format-specific optimizations - for now, use same implementation
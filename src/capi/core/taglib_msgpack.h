@@ -71,6 +71,23 @@ mp_status tags_decode(const uint8_t* buf, size_t len, Arena* arena, TagData** ou
 typedef size_t (*mp_write_fn)(const uint8_t* data, size_t len, void* ctx);
 mp_status tags_encode_stream(const TagData* tags, mp_write_fn write, void* ctx);
 
+// Chunked writer: an mpack writer over a fixed chunk buffer that hands
+// every full chunk, and the rest on mpack_writer_destroy, to sink->write.
+// No call gets more than chunk_size bytes; writes larger than the chunk
+// are passed through in chunk_size pieces without copying. A short count
+// from write stops the writer with mpack_error_io.
+#define MP_CHUNK_MIN_SIZE 64
+
+typedef struct {
+    mp_write_fn write;
+    void* ctx;
+    size_t chunk_size;
+} mp_chunk_sink;
+
+struct mpack_writer_t;
+mp_status mp_writer_init_chunked(struct mpack_writer_t* writer, char* chunk,
+                                 size_t chunk_size, mp_chunk_sink* sink);
+
 // Format-specific optimizations (preserve existing perf)
 mp_status encode_mp3_tags(const TagData* tags, uint8_t* buf, size_t buf_cap, size_t* out_len);
 mp_status encode_flac_tags(const TagData* tags, uint8_t* buf, size_t buf_cap, size_t* out_len);
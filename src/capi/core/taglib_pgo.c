@@ -0,0 +1,22 @@
+/**
+ * @fileoverview Profile dump for instrumented WASI builds
+ *
+ * Only linked with TAGLIB_WASI_PGO=generate. The module is a reactor, so
+ * the profile runtime's exit hook never runs; the training driver
+ * (scripts/pgo-train.ts) calls tl_pgo_write_profile() once the workload
+ * is done.
+ */
+
+// compiler-rt profile runtime
+int __llvm_profile_write_file(void);
+void __llvm_profile_set_filename(const char* name);
+
+/**
+ * Write the raw profile to path, a file under a preopened directory.
+ * @return 0 on success
+ */
+int tl_pgo_write_profile(const char* path) {
+    if (!path || path[0] == '\0') return -1;
+    __llvm_profile_set_filename(path);
+    return __llvm_profile_write_file();
+}
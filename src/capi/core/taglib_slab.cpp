@@ -0,0 +1,279 @@
+// Size-class slab allocator for the wasm builds
+#include "taglib_slab.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+constexpr size_t kChunkSize = TL_SLAB_CHUNK_SIZE;
+constexpr unsigned kChunkShift = 16;
+static_assert((size_t(1) << kChunkShift) == kChunkSize, "chunk size must match shift");
+
+// Every slot is 16-byte aligned, as operator new promises
+// (__STDCPP_DEFAULT_NEW_ALIGNMENT__ is 16 on wasm32 as well).
+constexpr size_t kAlign = 16;
+constexpr size_t kClassCount = TL_SLAB_MAX_SIZE / kAlign;
+
+// Chunk header, followed by equally sized slots. The partial list links
+// chunks of a size class that have free slots, other than the current one.
+struct Chunk {
+    Chunk* prev;
+    Chunk* next;
+    void* free_list;
+    char* bump;
+    uint32_t live;
+    uint32_t size_class;
+    bool listed;
+};
+constexpr size_t kHeaderSize = 64;
+static_assert(sizeof(Chunk) <= kHeaderSize, "chunk header too large");
+
+struct SizeClass {
+    Chunk* current;
+    Chunk* partial;
+};
+
+// malloc-backed allocations carry their size so that unsized delete and
+// tl_slab_usable_size work.
+struct alignas(kAlign) LargeHeader {
+    size_t size;
+};
+
+// Chunk map: size class + 1 for every 64 KiB region owned by a slab
+// chunk, 0 otherwise. wasm32 has 65536 such regions, so one leaf covers
+// the whole address space; native builds (tests, benchmarks) use 48-bit
+// addresses and a root of 65536 lazily allocated leaves.
+constexpr unsigned kAddressBits = sizeof(void*) == 4 ? 32 : 48;
+constexpr unsigned kLeafBits = 16;
+constexpr size_t kLeafSize = size_t(1) << kLeafBits;
+constexpr size_t kRootSize = size_t(1) << (kAddressBits - kChunkShift - kLeafBits);
+
+uint8_t* g_leaves[kRootSize];
+SizeClass g_classes[kClassCount];
+tl_slab_stats g_stats;
+
+inline size_t class_index(size_t size) {
+    return (size + kAlign - 1) / kAlign - 1;
+}
+
+inline size_t class_size(size_t index) {
+    return (index + 1) * kAlign;
+}
+
+inline uint8_t* map_slot(uintptr_t addr, bool create) {
+    uintptr_t chunk = addr >> kChunkShift;
+    size_t root = static_cast<size_t>(chunk >> kLeafBits);
+    if (root >= kRootSize) return nullptr;
+    uint8_t*& leaf = g_leaves[root];
+    if (!leaf) {
+        if (!create) return nullptr;
+        leaf = static_cast<uint8_t*>(std::calloc(kLeafSize, 1));
+        if (!leaf) return nullptr;
+    }
+    return &leaf[chunk & (kLeafSize - 1)];
+}
+
+// Size class + 1 of the chunk owning ptr, 0 for malloc-backed memory.
+inline unsigned chunk_tag(const void* ptr) {
+    uint8_t* slot = map_slot(reinterpret_cast<uintptr_t>(ptr), false);
+    return slot ? *slot : 0;
+}
+
+inline Chunk* chunk_of(const void* ptr) {
+    return reinterpret_cast<Chunk*>(
+        reinterpret_cast<uintptr_t>(ptr) & ~uintptr_t(kChunkSize - 1));
+}
+
+inline bool chunk_full(const Chunk* chunk, size_t size) {
+    return !chunk->free_list &&
+           chunk->bump + size > reinterpret_cast<const char*>(chunk) + kChunkSize;
+}
+
+void list_push(SizeClass& sc, Chunk* chunk) {
+    chunk->prev = nullptr;
+    chunk->next = sc.partial;
+    if (sc.partial) sc.partial->prev = chunk;
+    sc.partial = chunk;
+    chunk->listed = true;
+}
+
+void list_remove(SizeClass& sc, Chunk* chunk) {
+    if (chunk->prev) chunk->prev->next = chunk->next;
+    else sc.partial = chunk->next;
+    if (chunk->next) chunk->next->prev = chunk->prev;
+    chunk->prev = chunk->next = nullptr;
+    chunk->listed = false;
+}
+
+Chunk* chunk_create(size_t index) {
+    void* memory = std::aligned_alloc(kChunkSize, kChunkSize);
+    if (!memory) return nullptr;
+    uint8_t* slot = map_slot(reinterpret_cast<uintptr_t>(memory), true);
+    if (!slot) {
+        std::free(memory);
+        return nullptr;
+    }
+    *slot = static_cast<uint8_t>(index + 1);
+
+    Chunk* chunk = static_cast<Chunk*>(memory);
+    chunk->prev = chunk->next = nullptr;
+    chunk->free_list = nullptr;
+    chunk->bump = static_cast<char*>(memory) + kHeaderSize;
+    chunk->live = 0;
+    chunk->size_class = static_cast<uint32_t>(index);
+    chunk->listed = false;
+
+    if (++g_stats.chunks > g_stats.peak_chunks) g_stats.peak_chunks = g_stats.chunks;
+    return chunk;
+}
+
+void chunk_release(Chunk* chunk) {
+    *map_slot(reinterpret_cast<uintptr_t>(chunk), false) = 0;
+    std::free(chunk);
+    g_stats.chunks--;
+}
+
+inline void note_alloc(size_t& counter, size_t bytes) {
+    counter += bytes;
+    size_t total = g_stats.small_bytes + g_stats.large_bytes;
+    if (total > g_stats.peak_bytes) g_stats.peak_bytes = total;
+}
+
+void* small_alloc(size_t index) {
+    SizeClass& sc = g_classes[index];
+    size_t size = class_size(index);
+
+    Chunk* chunk = sc.current;
+    if (!chunk || chunk_full(chunk, size)) {
+        // A full current chunk is dropped; its first free() lists it again.
+        if (sc.partial) {
+            chunk = sc.partial;
+            list_remove(sc, chunk);
+        } else {
+            chunk = chunk_create(index);
+            if (!chunk) return nullptr;
+        }
+        sc.current = chunk;
+    }
+
+    void* ptr;
+    if (chunk->free_list) {
+        ptr = chunk->free_list;
+        chunk->free_list = *static_cast<void**>(ptr);
+    } else {
+        ptr = chunk->bump;
+        chunk->bump += size;
+    }
+    chunk->live++;
+    note_alloc(g_stats.small_bytes, size);
+    return ptr;
+}
+
+void small_free(void* ptr, size_t index) {
+    SizeClass& sc = g_classes[index];
+    Chunk* chunk = chunk_of(ptr);
+
+    *static_cast<void**>(ptr) = chunk->free_list;
+    chunk->free_list = ptr;
+    chunk->live--;
+    g_stats.small_bytes -= class_size(index);
+
+    if (chunk == sc.current) return;
+    if (chunk->live == 0) {
+        // Empty chunks go back to malloc, where any size class or large
+        // allocation can reuse them; the current chunk is kept.
+        if (chunk->listed) list_remove(sc, chunk);
+        chunk_release(chunk);
+    } else if (!chunk->listed) {
+        list_push(sc, chunk);
+    }
+}
+
+} // namespace
+
+void* tl_slab_alloc(size_t size) {
+    if (size == 0) size = 1;
+    if (size <= TL_SLAB_MAX_SIZE) return small_alloc(class_index(size));
+
+    if (size > SIZE_MAX - sizeof(LargeHeader)) return nullptr;
+    auto* header = static_cast<LargeHeader*>(std::malloc(sizeof(LargeHeader) + size));
+    if (!header) return nullptr;
+    header->size = size;
+    note_alloc(g_stats.large_bytes, size);
+    return header + 1;
+}
+
+void tl_slab_free(void* ptr) {
+    if (!ptr) return;
+    unsigned tag = chunk_tag(ptr);
+    if (tag) {
+        small_free(ptr, tag - 1);
+        return;
+    }
+    LargeHeader* header = static_cast<LargeHeader*>(ptr) - 1;
+    g_stats.large_bytes -= header->size;
+    std::free(header);
+}
+
+size_t tl_slab_usable_size(const void* ptr) {
+    if (!ptr) return 0;
+    unsigned tag = chunk_tag(ptr);
+    if (tag) return class_size(tag - 1);
+    return (static_cast<const LargeHeader*>(ptr) - 1)->size;
+}
+
+void* tl_slab_realloc(void* ptr, size_t size) {
+    if (!ptr) return tl_slab_alloc(size);
+    if (size == 0) {
+        tl_slab_free(ptr);
+        return nullptr;
+    }
+
+    size_t old_size = tl_slab_usable_size(ptr);
+    bool small = chunk_tag(ptr) != 0;
+    if (small && size <= old_size && class_index(size) == class_index(old_size)) {
+        return ptr;
+    }
+
+    void* resized = tl_slab_alloc(size);
+    if (!resized) return nullptr;
+    std::memcpy(resized, ptr, old_size < size ? old_size : size);
+    tl_slab_free(ptr);
+    return resized;
+}
+
+void tl_slab_get_stats(tl_slab_stats* stats) {
+    if (stats) *stats = g_stats;
+}
+
+#ifdef TL_SLAB_OPERATOR_NEW
+// Global replacements (TAGLIB_WASI_ALLOCATOR=slab). The over-aligned
+// overloads keep the C++ library's aligned_alloc-based versions.
+
+static void* slab_new(size_t size) {
+    void* ptr = tl_slab_alloc(size);
+    if (!ptr) {
+#ifdef __cpp_exceptions
+        throw std::bad_alloc();
+#else
+        std::abort();
+#endif
+    }
+    return ptr;
+}
+
+void* operator new(size_t size) { return slab_new(size); }
+void* operator new[](size_t size) { return slab_new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return tl_slab_alloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return tl_slab_alloc(size); }
+
+void operator delete(void* ptr) noexcept { tl_slab_free(ptr); }
+void operator delete[](void* ptr) noexcept { tl_slab_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { tl_slab_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { tl_slab_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { tl_slab_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { tl_slab_free(ptr); }
+#endif
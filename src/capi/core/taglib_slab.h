@@ -0,0 +1,55 @@
+/**
+ * @fileoverview Size-class slab allocator for the wasm builds
+ *
+ * TagLib allocates mostly small, short-lived objects through operator
+ * new: shared_ptr control blocks, List/Map nodes, String and ByteVector
+ * privates. dlmalloc serves them from one heap with per-block headers and
+ * fragments it over a long scan. The slab allocator serves requests up to
+ * TL_SLAB_MAX_SIZE from 64 KiB chunks (one wasm page) holding a single
+ * size class each; larger requests go to malloc.
+ *
+ * Built with TL_SLAB_OPERATOR_NEW, taglib_slab.cpp also replaces the
+ * global operator new/delete (TAGLIB_WASI_ALLOCATOR=slab). Not thread
+ * safe: the wasm builds are single threaded.
+ */
+
+#ifndef TAGLIB_SLAB_H
+#define TAGLIB_SLAB_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TL_SLAB_CHUNK_SIZE 65536
+#define TL_SLAB_MAX_SIZE 256
+
+typedef struct {
+    size_t chunks;          // slab chunks currently held
+    size_t peak_chunks;     // high-water mark of chunks
+    size_t small_bytes;     // bytes in live slab objects (size-class rounded)
+    size_t large_bytes;     // bytes in live malloc-backed allocations
+    size_t peak_bytes;      // high-water mark of small_bytes + large_bytes
+} tl_slab_stats;
+
+/** Allocate size bytes, 16-byte aligned. Returns NULL on failure. */
+void* tl_slab_alloc(size_t size);
+
+/** Free memory from tl_slab_alloc or tl_slab_realloc. NULL is ignored. */
+void tl_slab_free(void* ptr);
+
+/** Resize an allocation, preserving its contents. */
+void* tl_slab_realloc(void* ptr, size_t size);
+
+/** Usable size of an allocation. */
+size_t tl_slab_usable_size(const void* ptr);
+
+/** Current and peak usage. */
+void tl_slab_get_stats(tl_slab_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TAGLIB_SLAB_H
@@ -0,0 +1,55 @@
+// Monkey's Audio, WavPack and Musepack format group (TagLib WITH_APE)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+
+#include <ape/apefile.h>
+#include <ape/apeproperties.h>
+#include <wavpack/wavpackfile.h>
+#include <wavpack/wavpackproperties.h>
+#include <mpc/mpcfile.h>
+#include <mpc/mpcproperties.h>
+
+#include <iterator>
+
+static void ape_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::APE::File*>(file)->audioProperties();
+    if (props) {
+        info->bitsPerSample = props->bitsPerSample();
+        info->version = props->version();
+    }
+    info->codec = "APE";
+    info->container = "APE";
+    info->isLossless = true;
+}
+
+static void wavpack_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::WavPack::File*>(file)->audioProperties();
+    if (props) {
+        info->bitsPerSample = props->bitsPerSample();
+        info->isLossless = props->isLossless();
+        info->version = props->version();
+    }
+    info->codec = "WavPack";
+    info->container = "WavPack";
+}
+
+static void mpc_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::MPC::File*>(file)->audioProperties();
+    if (props) info->version = props->mpcVersion();
+    info->codec = "MPC";
+    info->container = "MPC";
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_APE, "format-ape",
+     create_format_file<TagLib::APE::File>, is_format_file<TagLib::APE::File>,
+     ape_audio_info, nullptr, nullptr, false},
+    {TL_FORMAT_WV, "format-wavpack",
+     create_format_file<TagLib::WavPack::File>, is_format_file<TagLib::WavPack::File>,
+     wavpack_audio_info, nullptr, nullptr, false},
+    {TL_FORMAT_MPC, "format-mpc",
+     create_format_file<TagLib::MPC::File>, is_format_file<TagLib::MPC::File>,
+     mpc_audio_info, nullptr, nullptr, false},
+};
+
+const FormatGroup tl_formats_ape = {kHandlers, std::size(kHandlers)};
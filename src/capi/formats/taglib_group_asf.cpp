@@ -0,0 +1,31 @@
+// ASF format group (TagLib WITH_ASF)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+
+#include <asf/asffile.h>
+#include <asf/asfproperties.h>
+
+#include <iterator>
+
+static void asf_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::ASF::File*>(file)->audioProperties();
+    if (props) {
+        info->bitsPerSample = props->bitsPerSample();
+        info->isEncrypted = props->isEncrypted();
+        if (props->codec() == TagLib::ASF::Properties::WMA9Lossless) {
+            info->codec = "WMALossless";
+            info->isLossless = true;
+        } else {
+            info->codec = "WMA";
+        }
+    }
+    info->container = "ASF";
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_ASF, "format-asf",
+     create_format_file<TagLib::ASF::File>, is_format_file<TagLib::ASF::File>,
+     asf_audio_info, nullptr, nullptr, false},
+};
+
+const FormatGroup tl_formats_asf = {kHandlers, std::size(kHandlers)};
@@ -0,0 +1,75 @@
+// DSF and DSDIFF format group (TagLib WITH_DSF)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+#include "../taglib_structure.h"
+
+#include <dsf/dsffile.h>
+#include <dsf/dsfproperties.h>
+#include <dsdiff/dsdifffile.h>
+#include <dsdiff/dsdiffproperties.h>
+
+#include <iterator>
+
+static void dsf_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::DSF::File*>(file)->audioProperties();
+    if (props) info->bitsPerSample = props->bitsPerSample();
+    info->codec = "DSD";
+    info->container = "DSF";
+    info->isLossless = true;
+}
+
+static void dsdiff_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::DSDIFF::File*>(file)->audioProperties();
+    if (props) info->bitsPerSample = props->bitsPerSample();
+    info->codec = "DSD";
+    info->container = "DSDIFF";
+    info->isLossless = true;
+}
+
+// Records the chunk headers in [offset, end) the way DSDIFF::File indexes
+// them, with the child chunks of PROP (after its "SND " marker) and DIIN
+static bool walk_dsdiff_chunks(TagLib::IOStream* stream, StructureSnapshot* snapshot,
+                               TagLib::offset_t offset, TagLib::offset_t end, bool root) {
+    while (offset + 12 <= end) {
+        TagLib::ByteVector header = read_structure_bytes(stream, offset, 12);
+        if (header.size() != 12) return false;
+        const TagLib::ByteVector name = header.mid(0, 4);
+        const TagLib::offset_t size = header.toLongLong(4U);
+        if (size < 0 || offset + 12 + size > end) return false;
+
+        const bool prop = root && name == "PROP";
+        if (prop) header.append(read_structure_bytes(stream, offset + 12, 4));
+        if (!add_structure_entry(snapshot, header.toUInt(0U), offset, header)) return false;
+        if ((prop || (root && name == "DIIN")) &&
+            !walk_dsdiff_chunks(stream, snapshot, offset + header.size(),
+                                offset + 12 + size, false)) {
+            return false;
+        }
+
+        offset += 12 + size;
+        // Odd chunks are followed by a zero pad byte, unless malformed
+        if ((offset & 1) != 0) {
+            const TagLib::ByteVector pad = read_structure_bytes(stream, offset, 1);
+            if (pad.size() == 1 && pad[0] == 0) offset++;
+        }
+    }
+    return true;
+}
+
+static bool walk_dsdiff_structure(TagLib::IOStream* stream, StructureSnapshot* snapshot) {
+    const TagLib::ByteVector header = read_structure_bytes(stream, 0, 16);
+    return header.size() == 16 && header.startsWith("FRM8") &&
+           add_structure_entry(snapshot, header.toUInt(0U), 0, header) &&
+           walk_dsdiff_chunks(stream, snapshot, 16, stream->length(), true);
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_DSF, "format-dsf",
+     create_format_file<TagLib::DSF::File>, is_format_file<TagLib::DSF::File>,
+     dsf_audio_info, nullptr, nullptr, false},
+    {TL_FORMAT_DSDIFF, "format-dsdiff",
+     create_format_file<TagLib::DSDIFF::File>, is_format_file<TagLib::DSDIFF::File>,
+     dsdiff_audio_info, nullptr, nullptr, false, walk_dsdiff_structure, nullptr},
+};
+
+const FormatGroup tl_formats_dsf = {kHandlers, std::size(kHandlers)};
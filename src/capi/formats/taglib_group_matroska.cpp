@@ -0,0 +1,145 @@
+// Matroska format group (TagLib WITH_MATROSKA)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+#include "../taglib_structure.h"
+
+#include <tlist.h>
+#include <tstring.h>
+#include <matroska/matroskafile.h>
+#include <matroska/matroskaproperties.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+static void matroska_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = dynamic_cast<TagLib::Matroska::Properties*>(
+        static_cast<TagLib::Matroska::File*>(file)->audioProperties());
+    if (props) {
+        info->bitsPerSample = props->bitsPerSample();
+        TagLib::String cn = props->codecName();
+        if (!cn.isEmpty()) {
+            std::string name = cn.to8Bit(true);
+            if (name.find("OPUS") != std::string::npos) info->codec = "Opus";
+            else if (name.find("VORBIS") != std::string::npos) info->codec = "Vorbis";
+            else if (name.find("FLAC") != std::string::npos) { info->codec = "FLAC"; info->isLossless = true; }
+            else if (name.find("PCM") != std::string::npos) { info->codec = "PCM"; info->isLossless = true; }
+            else if (name.find("TRUEHD") != std::string::npos) { info->codec = "TrueHD"; info->isLossless = true; }
+            else if (name.find("AAC") != std::string::npos) info->codec = "AAC";
+            else if (name.find("MPEG") != std::string::npos) info->codec = "MP3";
+        }
+    }
+    info->container = "Matroska";
+}
+
+static const uint32_t kEBMLHeaderId = 0x1A45DFA3;
+static const uint32_t kSegmentId = 0x18538067;
+static const uint32_t kSeekHeadId = 0x114D9B74;
+static const uint32_t kVoidId = 0xEC;
+
+// The top level elements Matroska::File reads, in addition to the
+// SeekHead and a Void element directly following it
+static const uint32_t kReadIds[] = {
+    0x1549A966,  // Info
+    0x1654AE6B,  // Tracks
+    0x1254C367,  // Tags
+    0x1941A469,  // Attachments
+    0x1043A770,  // Chapters
+    0x1C53BB6B,  // Cues
+};
+
+static bool is_read_id(uint32_t id) {
+    return std::find(std::begin(kReadIds), std::end(kReadIds), id) != std::end(kReadIds);
+}
+
+struct EBMLHeader {
+    uint32_t id;
+    TagLib::offset_t dataSize;  // -1 for unknown size
+    TagLib::ByteVector bytes;   // ID and size VINTs
+};
+
+// Parses the ID (1-4 bytes, marker kept) and data size (1-8 bytes) at offset.
+static bool read_ebml_header(TagLib::IOStream* stream, TagLib::offset_t offset,
+                             EBMLHeader* header) {
+    const TagLib::ByteVector data = read_structure_bytes(stream, offset, 12);
+    if (data.isEmpty()) return false;
+    const auto vint_length = [](uint8_t first) {
+        unsigned int n = 1;
+        for (uint8_t mask = 0x80; mask && !(first & mask); mask >>= 1) n++;
+        return n;
+    };
+    const unsigned int id_length = vint_length(static_cast<uint8_t>(data[0]));
+    if (id_length > 4 || data.size() < id_length + 1) return false;
+    const unsigned int size_length = vint_length(static_cast<uint8_t>(data[id_length]));
+    if (size_length > 8 || data.size() < id_length + size_length) return false;
+
+    header->id = 0;
+    for (unsigned int i = 0; i < id_length; i++) {
+        header->id = (header->id << 8) | static_cast<uint8_t>(data[i]);
+    }
+    uint64_t size = static_cast<uint8_t>(data[id_length]) & (0xff >> size_length);
+    bool unknown = size == (0xffu >> size_length);
+    for (unsigned int i = 1; i < size_length; i++) {
+        const auto byte = static_cast<uint8_t>(data[id_length + i]);
+        size = (size << 8) | byte;
+        unknown = unknown && byte == 0xff;
+    }
+    header->dataSize = unknown ? -1 : static_cast<TagLib::offset_t>(size);
+    header->bytes = data.mid(0, id_length + size_length);
+    return true;
+}
+
+// EBML header and Segment headers, then the headers of the top level
+// elements Matroska::File reads. Clusters are stepped over, a child of
+// unknown size cannot be, and the walk falls back to the generic snapshot.
+static bool walk_matroska_structure(TagLib::IOStream* stream, StructureSnapshot* snapshot) {
+    const TagLib::offset_t length = stream->length();
+    EBMLHeader header;
+    if (!read_ebml_header(stream, 0, &header) || header.id != kEBMLHeaderId ||
+        header.dataSize < 0 || !add_structure_entry(snapshot, header.id, 0, header.bytes)) {
+        return false;
+    }
+    TagLib::offset_t offset = header.bytes.size() + header.dataSize;
+    if (!read_ebml_header(stream, offset, &header) || header.id != kSegmentId ||
+        !add_structure_entry(snapshot, header.id, offset, header.bytes)) {
+        return false;
+    }
+    offset += header.bytes.size();
+    const TagLib::offset_t end =
+        header.dataSize < 0 ? length : std::min(length, offset + header.dataSize);
+
+    bool after_seek_head = false;
+    while (offset < end) {
+        if (!read_ebml_header(stream, offset, &header) || header.dataSize < 0) return false;
+        if (header.id == kSeekHeadId || is_read_id(header.id) ||
+            (header.id == kVoidId && after_seek_head)) {
+            if (!add_structure_entry(snapshot, header.id, offset, header.bytes)) return false;
+        }
+        after_seek_head = header.id == kSeekHeadId;
+        offset += header.bytes.size() + header.dataSize;
+    }
+    return true;
+}
+
+// Reads only the recorded top level elements instead of scanning the
+// segment for them, which steps over every cluster.
+static TagLib::File* open_matroska_structure(TagLib::IOStream* stream,
+                                             const StructureSnapshot& snapshot) {
+    TagLib::List<TagLib::offset_t> offsets;
+    for (const StructureEntry& entry : snapshot.entries) {
+        if (entry.id == kSeekHeadId || entry.id == kVoidId || is_read_id(entry.id)) {
+            offsets.append(entry.offset);
+        }
+    }
+    if (offsets.isEmpty()) return nullptr;
+    return new TagLib::Matroska::File(stream, offsets, true);
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_MATROSKA, "format-matroska",
+     create_format_file<TagLib::Matroska::File>, is_format_file<TagLib::Matroska::File>,
+     matroska_audio_info, nullptr, nullptr, false,
+     walk_matroska_structure, open_matroska_structure},
+};
+
+const FormatGroup tl_formats_matroska = {kHandlers, std::size(kHandlers)};
@@ -0,0 +1,47 @@
+// Tracker module format group (TagLib WITH_MOD)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+
+#include <mod/modfile.h>
+#include <s3m/s3mfile.h>
+#include <it/itfile.h>
+#include <xm/xmfile.h>
+
+#include <iterator>
+
+static void mod_audio_info(TagLib::File*, ExtendedAudioInfo* info) {
+    info->codec = "MOD";
+    info->container = "MOD";
+}
+
+static void s3m_audio_info(TagLib::File*, ExtendedAudioInfo* info) {
+    info->codec = "S3M";
+    info->container = "S3M";
+}
+
+static void it_audio_info(TagLib::File*, ExtendedAudioInfo* info) {
+    info->codec = "IT";
+    info->container = "IT";
+}
+
+static void xm_audio_info(TagLib::File*, ExtendedAudioInfo* info) {
+    info->codec = "XM";
+    info->container = "XM";
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_MOD, "format-mod",
+     create_format_file<TagLib::Mod::File>, is_format_file<TagLib::Mod::File>,
+     mod_audio_info, nullptr, nullptr, false},
+    {TL_FORMAT_S3M, "format-s3m",
+     create_format_file<TagLib::S3M::File>, is_format_file<TagLib::S3M::File>,
+     s3m_audio_info, nullptr, nullptr, false},
+    {TL_FORMAT_IT, "format-it",
+     create_format_file<TagLib::IT::File>, is_format_file<TagLib::IT::File>,
+     it_audio_info, nullptr, nullptr, false},
+    {TL_FORMAT_XM, "format-xm",
+     create_format_file<TagLib::XM::File>, is_format_file<TagLib::XM::File>,
+     xm_audio_info, nullptr, nullptr, false},
+};
+
+const FormatGroup tl_formats_mod = {kHandlers, std::size(kHandlers)};
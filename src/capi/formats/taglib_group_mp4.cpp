@@ -0,0 +1,167 @@
+// MP4 format group (TagLib WITH_MP4)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+#include "../taglib_ratings.h"
+#include "../taglib_structure.h"
+
+#include <tstring.h>
+#include <tstringlist.h>
+#include <mp4/mp4file.h>
+#include <mp4/mp4properties.h>
+#include <mp4/mp4tag.h>
+#include <mp4/mp4item.h>
+#include <mp4/mp4itemfactory.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+
+static const char* const kRatingItem = "----:com.apple.iTunes:RATING";
+
+static void mp4_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::MP4::File*>(file)->audioProperties();
+    if (props) {
+        info->bitsPerSample = props->bitsPerSample();
+        info->isEncrypted = props->isEncrypted();
+        if (props->codec() == TagLib::MP4::Properties::ALAC) {
+            info->codec = "ALAC";
+            info->isLossless = true;
+        } else {
+            info->codec = "AAC";
+        }
+    }
+    info->container = "MP4";
+}
+
+static uint32_t read_mp4_ratings(TagLib::File* file,
+                                 RatingEntry* entries, uint32_t max_entries)
+{
+    TagLib::MP4::Tag* tag = static_cast<TagLib::MP4::File*>(file)->tag();
+    if (!tag || !tag->contains(kRatingItem) || max_entries == 0) return 0;
+
+    TagLib::MP4::Item item = tag->item(kRatingItem);
+    if (!item.isValid()) return 0;
+
+    double r = 0.0;
+    if (item.type() == TagLib::MP4::Item::Type::Int) {
+        int v = item.toInt();
+        r = (v > 100) ? v / 255.0 : v / 100.0;
+    } else if (item.type() == TagLib::MP4::Item::Type::StringList) {
+        TagLib::StringList sl = item.toStringList();
+        if (!sl.isEmpty()) {
+            r = std::strtod(sl.front().to8Bit(true).c_str(), nullptr);
+            if (r > 1.0) r = r / 100.0;
+        }
+    }
+    if (r < 0.0) r = 0.0;
+    if (r > 1.0) r = 1.0;
+    entries[0].rating = r;
+    entries[0].email[0] = '\0';
+    entries[0].counter = 0;
+    return 1;
+}
+
+static void write_mp4_ratings(TagLib::File* file,
+                              const RatingEntry* entries, uint32_t count)
+{
+    TagLib::MP4::Tag* tag = static_cast<TagLib::MP4::File*>(file)->tag();
+    if (!tag) return;
+    tag->removeItem(kRatingItem);
+    // MP4 freeform atoms support only a single rating value
+    if (count > 0) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.6g", entries[0].rating);
+        TagLib::StringList sl;
+        sl.append(TagLib::String(buf, TagLib::String::UTF8));
+        tag->setItem(kRatingItem, TagLib::MP4::Item(sl));
+    }
+}
+
+// The item factory builds its atom name and property key maps on first
+// use; a track number round trip and a reverse lookup fill all three.
+static void preinit_mp4() {
+    const TagLib::MP4::ItemFactory* factory = TagLib::MP4::ItemFactory::instance();
+    factory->itemToProperty("trkn", TagLib::MP4::Item(1, 0));
+    factory->nameForPropertyKey("TITLE");
+}
+
+// Same container list as TagLib's MP4::Atom; stem is skipped there
+static const char* const kContainers[] = {
+    "moov", "udta", "mdia", "meta", "ilst", "stbl",
+    "minf", "moof", "traf", "trak", "stsd",
+};
+static const char* const kMetaChildren[] = {"hdlr", "ilst", "mhdr", "ctry", "lang"};
+
+static bool is_mp4_container(const TagLib::ByteVector& name) {
+    for (const char* c : kContainers) {
+        if (name == c) return true;
+    }
+    return false;
+}
+
+// Walks the atoms in [offset, end) the way MP4::Atom parses them. An
+// invalid atom ends TagLib's parse, and sets stop to end the walk there.
+static bool walk_mp4_atoms(TagLib::IOStream* stream, StructureSnapshot* snapshot,
+                           TagLib::offset_t offset, TagLib::offset_t end,
+                           int depth, bool* stop) {
+    const TagLib::offset_t file_length = stream->length();
+    // Top level atoms need a full header, children run to their parent's end
+    while (!*stop && (depth == 0 ? offset + 8 <= end : offset < end)) {
+        TagLib::ByteVector header = read_structure_bytes(stream, offset, 8);
+        if (header.size() != 8) {
+            *stop = true;
+            break;
+        }
+        TagLib::offset_t length = header.toUInt();
+        if (length == 0) {
+            length = file_length - offset;
+        } else if (length == 1) {
+            header = read_structure_bytes(stream, offset, 16);
+            length = header.size() == 16 ? header.toLongLong(8) : 0;
+        }
+        if (length < 8 || length > file_length - offset) {
+            *stop = true;
+            break;
+        }
+
+        const TagLib::ByteVector name = header.mid(4, 4);
+        const bool container = is_mp4_container(name) && depth < 32;
+        if (container && name == "meta") {
+            // Version and flags follow unless meta is directly followed by
+            // its first child, as in QuickTime files
+            const TagLib::ByteVector next =
+                read_structure_bytes(stream, offset + header.size(), 8).mid(4, 4);
+            bool full = true;
+            for (const char* child : kMetaChildren) {
+                if (next == child) full = false;
+            }
+            if (full) header.append(read_structure_bytes(stream, offset + header.size(), 4));
+        } else if (container && name == "stsd") {
+            header.append(read_structure_bytes(stream, offset + header.size(), 8));
+        }
+
+        const TagLib::offset_t child_offset = offset + header.size();
+        if (!add_structure_entry(snapshot, header.toUInt(4U), offset, header)) return false;
+        if (container &&
+            !walk_mp4_atoms(stream, snapshot, child_offset, offset + length, depth + 1, stop)) {
+            return false;
+        }
+        offset += length;
+    }
+    return true;
+}
+
+static bool walk_mp4_structure(TagLib::IOStream* stream, StructureSnapshot* snapshot) {
+    bool stop = false;
+    return walk_mp4_atoms(stream, snapshot, 0, stream->length(), 0, &stop) &&
+           !snapshot->entries.empty();
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_M4A, "format-m4a",
+     create_format_file<TagLib::MP4::File>, is_format_file<TagLib::MP4::File>,
+     mp4_audio_info, read_mp4_ratings, write_mp4_ratings, true,
+     walk_mp4_structure, nullptr},
+};
+
+const FormatGroup tl_formats_mp4 = {kHandlers, std::size(kHandlers), preinit_mp4};
@@ -0,0 +1,75 @@
+// MPEG format group (always built)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+#include "../taglib_ratings.h"
+
+#include <tstring.h>
+#include <mpeg/mpegfile.h>
+#include <mpeg/mpegproperties.h>
+#include <mpeg/mpegheader.h>
+#include <mpeg/id3v2/id3v2tag.h>
+#include <mpeg/id3v2/frames/popularimeterframe.h>
+
+#include <cstring>
+#include <iterator>
+
+static void mpeg_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* f = static_cast<TagLib::MPEG::File*>(file);
+    auto* props = f->audioProperties();
+    if (props) {
+        info->mpegVersion = props->version() == TagLib::MPEG::Header::Version1 ? 1 : 2;
+        info->mpegLayer = props->layer();
+    }
+    info->codec = "MP3";
+    info->container = "MP3";
+}
+
+static uint32_t read_mpeg_ratings(TagLib::File* file,
+                                  RatingEntry* entries, uint32_t max_entries)
+{
+    auto* f = static_cast<TagLib::MPEG::File*>(file);
+    if (!f->hasID3v2Tag()) return 0;
+
+    uint32_t count = 0;
+    const auto& frames = f->ID3v2Tag()->frameList("POPM");
+    for (const auto& frame : frames) {
+        if (count >= max_entries) break;
+        auto* popm = dynamic_cast<TagLib::ID3v2::PopularimeterFrame*>(frame);
+        if (!popm) continue;
+        entries[count].rating = popm->rating() / 255.0;
+        std::string email = popm->email().to8Bit(true);
+        strncpy(entries[count].email, email.c_str(), sizeof(entries[count].email) - 1);
+        entries[count].email[sizeof(entries[count].email) - 1] = '\0';
+        entries[count].counter = popm->counter();
+        count++;
+    }
+    return count;
+}
+
+static void write_mpeg_ratings(TagLib::File* file,
+                               const RatingEntry* entries, uint32_t count)
+{
+    auto* f = static_cast<TagLib::MPEG::File*>(file);
+    TagLib::ID3v2::Tag* tag = f->ID3v2Tag(true);
+    tag->removeFrames("POPM");
+    for (uint32_t i = 0; i < count; i++) {
+        auto* popm = new TagLib::ID3v2::PopularimeterFrame();
+        int popmRating = static_cast<int>(entries[i].rating * 255.0 + 0.5);
+        if (popmRating < 0) popmRating = 0;
+        if (popmRating > 255) popmRating = 255;
+        popm->setRating(popmRating);
+        if (entries[i].email[0] != '\0') {
+            popm->setEmail(TagLib::String(entries[i].email, TagLib::String::UTF8));
+        }
+        popm->setCounter(entries[i].counter);
+        tag->addFrame(popm);
+    }
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_MP3, "format-mp3",
+     create_format_file<TagLib::MPEG::File>, is_format_file<TagLib::MPEG::File>,
+     mpeg_audio_info, read_mpeg_ratings, write_mpeg_ratings, true},
+};
+
+const FormatGroup tl_formats_mpeg = {kHandlers, std::size(kHandlers)};
@@ -0,0 +1,37 @@
+// WAV and AIFF format group (TagLib WITH_RIFF)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+
+#include <riff/wav/wavfile.h>
+#include <riff/wav/wavproperties.h>
+#include <riff/aiff/aifffile.h>
+#include <riff/aiff/aiffproperties.h>
+
+#include <iterator>
+
+static void wav_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::RIFF::WAV::File*>(file)->audioProperties();
+    if (props) info->bitsPerSample = props->bitsPerSample();
+    info->codec = "PCM";
+    info->container = "WAV";
+    info->isLossless = true;
+}
+
+static void aiff_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::RIFF::AIFF::File*>(file)->audioProperties();
+    if (props) info->bitsPerSample = props->bitsPerSample();
+    info->codec = "PCM";
+    info->container = "AIFF";
+    info->isLossless = true;
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_WAV, "format-wav",
+     create_format_file<TagLib::RIFF::WAV::File>, is_format_file<TagLib::RIFF::WAV::File>,
+     wav_audio_info, nullptr, nullptr, false},
+    {TL_FORMAT_AIFF, "format-aiff",
+     create_format_file<TagLib::RIFF::AIFF::File>, is_format_file<TagLib::RIFF::AIFF::File>,
+     aiff_audio_info, nullptr, nullptr, false},
+};
+
+const FormatGroup tl_formats_riff = {kHandlers, std::size(kHandlers)};
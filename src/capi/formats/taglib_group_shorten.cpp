@@ -0,0 +1,27 @@
+// Shorten format group (TagLib WITH_SHORTEN)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+
+#include <shorten/shortenfile.h>
+#include <shorten/shortenproperties.h>
+
+#include <iterator>
+
+static void shorten_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::Shorten::File*>(file)->audioProperties();
+    if (props) {
+        info->bitsPerSample = props->bitsPerSample();
+        info->version = props->shortenVersion();
+    }
+    info->codec = "Shorten";
+    info->container = "Shorten";
+    info->isLossless = true;
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_SHN, "format-shorten",
+     create_format_file<TagLib::Shorten::File>, is_format_file<TagLib::Shorten::File>,
+     shorten_audio_info, nullptr, nullptr, false},
+};
+
+const FormatGroup tl_formats_shorten = {kHandlers, std::size(kHandlers)};
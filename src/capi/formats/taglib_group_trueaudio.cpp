@@ -0,0 +1,27 @@
+// TrueAudio format group (TagLib WITH_TRUEAUDIO)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+
+#include <trueaudio/trueaudiofile.h>
+#include <trueaudio/trueaudioproperties.h>
+
+#include <iterator>
+
+static void tta_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::TrueAudio::File*>(file)->audioProperties();
+    if (props) {
+        info->bitsPerSample = props->bitsPerSample();
+        info->version = props->ttaVersion();
+    }
+    info->codec = "TTA";
+    info->container = "TTA";
+    info->isLossless = true;
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_TTA, "format-tta",
+     create_format_file<TagLib::TrueAudio::File>, is_format_file<TagLib::TrueAudio::File>,
+     tta_audio_info, nullptr, nullptr, false},
+};
+
+const FormatGroup tl_formats_trueaudio = {kHandlers, std::size(kHandlers)};
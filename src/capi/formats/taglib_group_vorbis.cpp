@@ -0,0 +1,210 @@
+// FLAC and Ogg format group (TagLib WITH_VORBIS)
+#include "../taglib_formats.h"
+#include "../taglib_audio_props.h"
+#include "../taglib_ratings.h"
+#include "../taglib_structure.h"
+
+#include <tstring.h>
+#include <flac/flacfile.h>
+#include <flac/flacproperties.h>
+#include <ogg/xiphcomment.h>
+#include <ogg/vorbis/vorbisfile.h>
+#include <ogg/opus/opusfile.h>
+#include <ogg/flac/oggflacfile.h>
+#include <ogg/speex/speexfile.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+
+static void flac_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = static_cast<TagLib::FLAC::File*>(file)->audioProperties();
+    if (props) info->bitsPerSample = props->bitsPerSample();
+    info->codec = "FLAC";
+    info->container = "FLAC";
+    info->isLossless = true;
+}
+
+static void vorbis_audio_info(TagLib::File*, ExtendedAudioInfo* info) {
+    info->codec = "Vorbis";
+    info->container = "OGG";
+}
+
+static void opus_audio_info(TagLib::File*, ExtendedAudioInfo* info) {
+    info->codec = "Opus";
+    info->container = "OGG";
+}
+
+static void ogg_flac_audio_info(TagLib::File* file, ExtendedAudioInfo* info) {
+    auto* props = dynamic_cast<TagLib::FLAC::Properties*>(
+        static_cast<TagLib::Ogg::FLAC::File*>(file)->audioProperties());
+    if (props) info->bitsPerSample = props->bitsPerSample();
+    info->codec = "FLAC";
+    info->container = "OGG";
+    info->isLossless = true;
+}
+
+static void speex_audio_info(TagLib::File*, ExtendedAudioInfo* info) {
+    info->codec = "Speex";
+    info->container = "OGG";
+}
+
+// FLAC, Ogg Vorbis and Opus store ratings in the XiphComment RATING field.
+static uint32_t read_xiph_ratings(TagLib::Ogg::XiphComment* xiph,
+                                  RatingEntry* entries, uint32_t max_entries)
+{
+    if (!xiph || !xiph->contains("RATING")) return 0;
+
+    uint32_t count = 0;
+    const auto& values = xiph->fieldListMap()["RATING"];
+    for (const auto& val : values) {
+        if (count >= max_entries) break;
+        std::string s = val.to8Bit(true);
+        double r = s.empty() ? 0.0 : std::strtod(s.c_str(), nullptr);
+        if (r > 1.0) r = r / 100.0;  // handle 0-100 percentages
+        if (r < 0.0) r = 0.0;
+        if (r > 1.0) r = 1.0;
+        entries[count].rating = r;
+        entries[count].email[0] = '\0';
+        entries[count].counter = 0;
+        count++;
+    }
+    return count;
+}
+
+static void write_xiph_ratings(TagLib::Ogg::XiphComment* xiph,
+                               const RatingEntry* entries, uint32_t count)
+{
+    if (!xiph) return;
+    xiph->removeFields("RATING");
+    for (uint32_t i = 0; i < count; i++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.6g", entries[i].rating);
+        xiph->addField("RATING", TagLib::String(buf, TagLib::String::UTF8), false);
+    }
+}
+
+static uint32_t read_flac_ratings(TagLib::File* file,
+                                  RatingEntry* entries, uint32_t max_entries)
+{
+    return read_xiph_ratings(static_cast<TagLib::FLAC::File*>(file)->xiphComment(),
+                             entries, max_entries);
+}
+
+static void write_flac_ratings(TagLib::File* file,
+                               const RatingEntry* entries, uint32_t count)
+{
+    write_xiph_ratings(static_cast<TagLib::FLAC::File*>(file)->xiphComment(true),
+                       entries, count);
+}
+
+template <typename T>
+static uint32_t read_ogg_ratings(TagLib::File* file,
+                                 RatingEntry* entries, uint32_t max_entries)
+{
+    return read_xiph_ratings(static_cast<T*>(file)->tag(), entries, max_entries);
+}
+
+template <typename T>
+static void write_ogg_ratings(TagLib::File* file,
+                              const RatingEntry* entries, uint32_t count)
+{
+    write_xiph_ratings(static_cast<T*>(file)->tag(), entries, count);
+}
+
+// FLAC structure: an optional ID3v2 header, the "fLaC" marker, the
+// metadata block headers up to the last one and an ID3v1 marker
+static bool walk_flac_structure(TagLib::IOStream* stream, StructureSnapshot* snapshot) {
+    TagLib::offset_t offset = 0;
+    const TagLib::ByteVector id3 = read_structure_bytes(stream, 0, 10);
+    if (id3.size() == 10 && id3.startsWith("ID3")) {
+        uint32_t size = 0;
+        for (unsigned int i = 6; i < 10; i++) {
+            size = (size << 7) | (static_cast<uint8_t>(id3[i]) & 0x7f);
+        }
+        if (!add_structure_entry(snapshot, 0, 0, id3)) return false;
+        offset = 10 + size + ((id3[5] & 0x10) ? 10 : 0);
+    }
+
+    const TagLib::ByteVector marker = read_structure_bytes(stream, offset, 4);
+    if (marker != "fLaC" || !add_structure_entry(snapshot, 0, offset, marker)) return false;
+    offset += 4;
+
+    for (;;) {
+        const TagLib::ByteVector header = read_structure_bytes(stream, offset, 4);
+        if (header.size() != 4) break;
+        const uint8_t type = static_cast<uint8_t>(header[0]) & 0x7f;
+        if (type == 127 || !add_structure_entry(snapshot, type, offset, header)) return false;
+        offset += 4 + (header.toUInt() & 0xffffff);
+        if (header[0] & 0x80) break;
+    }
+
+    const TagLib::offset_t id3v1 = stream->length() - 128;
+    const TagLib::ByteVector tag = read_structure_bytes(stream, id3v1, 3);
+    if (id3v1 >= offset && tag == "TAG") add_structure_entry(snapshot, 0, id3v1, tag);
+    return true;
+}
+
+// Ogg structure: the pages holding the header packets (granule position 0
+// or -1) and the first audio page, where Ogg::File reads packets, and the
+// last page, whose granule position gives the length
+static const unsigned int kMaxOggHeaderPages = 64;
+
+static bool add_ogg_page(TagLib::IOStream* stream, StructureSnapshot* snapshot,
+                         TagLib::offset_t offset, TagLib::ByteVector* header) {
+    *header = read_structure_bytes(stream, offset, 27);
+    if (header->size() != 27 || !header->startsWith("OggS")) return false;
+    header->append(read_structure_bytes(stream, offset + 27,
+                                        static_cast<uint8_t>((*header)[26])));
+    if (header->size() != 27u + static_cast<uint8_t>((*header)[26])) return false;
+    return add_structure_entry(snapshot, header->toUInt(18U, false), offset, *header);
+}
+
+static bool walk_ogg_structure(TagLib::IOStream* stream, StructureSnapshot* snapshot) {
+    TagLib::offset_t offset = 0;
+    TagLib::ByteVector header;
+    for (unsigned int page = 0; page < kMaxOggHeaderPages; page++) {
+        if (!add_ogg_page(stream, snapshot, offset, &header)) return page > 0;
+        for (unsigned int i = 27; i < header.size(); i++) {
+            offset += static_cast<uint8_t>(header[i]);
+        }
+        offset += header.size();
+        const long long granule = header.toLongLong(6U, false);
+        if (granule != 0 && granule != -1) break;
+    }
+
+    // A page is at most 27 + 255 + 255 * 255 bytes long
+    const TagLib::offset_t length = stream->length();
+    const TagLib::offset_t tail = std::max<TagLib::offset_t>(offset, length - 65307);
+    const TagLib::ByteVector data = read_structure_bytes(stream, tail,
+                                                         static_cast<size_t>(length - tail));
+    const int last = data.rfind("OggS");
+    if (last >= 0) add_ogg_page(stream, snapshot, tail + last, &header);
+    return true;
+}
+
+static const FormatHandler kHandlers[] = {
+    {TL_FORMAT_FLAC, "format-flac",
+     create_format_file<TagLib::FLAC::File>, is_format_file<TagLib::FLAC::File>,
+     flac_audio_info, read_flac_ratings, write_flac_ratings, false,
+     walk_flac_structure, nullptr},
+    {TL_FORMAT_OGG, "format-ogg",
+     create_format_file<TagLib::Ogg::Vorbis::File>, is_format_file<TagLib::Ogg::Vorbis::File>,
+     vorbis_audio_info,
+     read_ogg_ratings<TagLib::Ogg::Vorbis::File>, write_ogg_ratings<TagLib::Ogg::Vorbis::File>,
+     false, walk_ogg_structure, nullptr},
+    {TL_FORMAT_OPUS, "format-opus",
+     create_format_file<TagLib::Ogg::Opus::File>, is_format_file<TagLib::Ogg::Opus::File>,
+     opus_audio_info,
+     read_ogg_ratings<TagLib::Ogg::Opus::File>, write_ogg_ratings<TagLib::Ogg::Opus::File>,
+     false, walk_ogg_structure, nullptr},
+    {TL_FORMAT_OGG_FLAC, "format-ogg-flac",
+     create_format_file<TagLib::Ogg::FLAC::File>, is_format_file<TagLib::Ogg::FLAC::File>,
+     ogg_flac_audio_info, nullptr, nullptr, false, walk_ogg_structure, nullptr},
+    {TL_FORMAT_SPEEX, "format-speex",
+     create_format_file<TagLib::Ogg::Speex::File>, is_format_file<TagLib::Ogg::Speex::File>,
+     speex_audio_info, nullptr, nullptr, false, walk_ogg_structure, nullptr},
+};
+
+const FormatGroup tl_formats_vorbis = {kHandlers, std::size(kHandlers)};
@@ -83,11 +83,11 @@ uint8_t* pack_tags_to_msgpack(TagLib::Tag* tag,
     TagData tag_data = {0};
     
     // Basic tags - safely convert strings
-    std::string title_str = tag->title().toCString(true);
-    std::string artist_str = tag->artist().toCString(true);
-    std::string album_str = tag->album().toCString(true);
-    std::string genre_str = tag->genre().toCString(true);
-    std::string comment_str = tag->comment().toCString(true);
+    std::string title_str = tag->title().to8Bit(true);
+    std::string artist_str = tag->artist().to8Bit(true);
+    std::string album_str = tag->album().to8Bit(true);
+    std::string genre_str = tag->genre().to8Bit(true);
+    std::string comment_str = tag->comment().to8Bit(true);
     
     tag_data.title = title_str.c_str();
     tag_data.artist = artist_str.c_str();
@@ -102,12 +102,12 @@ uint8_t* pack_tags_to_msgpack(TagLib::Tag* tag,
     std::string album_artist_str, composer_str;
     
     if (properties.contains("ALBUMARTIST")) {
-        album_artist_str = properties["ALBUMARTIST"].front().toCString(true);
+        album_artist_str = properties["ALBUMARTIST"].front().to8Bit(true);
         tag_data.albumArtist = album_artist_str.c_str();
     }
     
     if (properties.contains("COMPOSER")) {
-        composer_str = properties["COMPOSER"].front().toCString(true);
+        composer_str = properties["COMPOSER"].front().to8Bit(true);
         tag_data.composer = composer_str.c_str();
     }
     
@@ -344,6 +344,42 @@ int tl_write_tags(const char* path, const uint8_t* buf, size_t len,
     }
 }
 
+// This implementation always saves
+int tl_write_skipped(void) {
+    return 0;
+}
+
+int tl_update_tags(const char*, const uint8_t*, size_t,
+                   const uint8_t*, size_t, uint8_t**, size_t*,
+                   uint8_t**, size_t*) {
+    tl_set_error(TL_ERROR_NOT_IMPLEMENTED, "Tag updates require the WASI build");
+    return TL_ERROR_NOT_IMPLEMENTED;
+}
+
+int tl_snapshot_structure(const char*, uint8_t**, size_t*) {
+    tl_set_error(TL_ERROR_NOT_IMPLEMENTED, "Structural snapshots require the WASI build");
+    return TL_ERROR_NOT_IMPLEMENTED;
+}
+
+uint8_t* tl_read_tags_snapshot(const char* path, const uint8_t*, size_t,
+                               size_t* out_size, int* out_snapshot_used) {
+    // No snapshot support: read the regular way
+    if (out_snapshot_used) *out_snapshot_used = 0;
+    return tl_read_tags(path, nullptr, 0, out_size);
+}
+
+int tl_read_tags_chunked(const char*, const uint8_t*, size_t,
+                         tl_format, uint32_t, uint32_t) {
+    tl_set_error(TL_ERROR_NOT_IMPLEMENTED, "Chunked reads require the WASI build");
+    return TL_ERROR_NOT_IMPLEMENTED;
+}
+
+int tl_estimate_write(const char*, const uint8_t*, size_t,
+                      const uint8_t*, size_t, tl_write_estimate*) {
+    tl_set_error(TL_ERROR_NOT_IMPLEMENTED, "Write estimates require the WASI build");
+    return TL_ERROR_NOT_IMPLEMENTED;
+}
+
 // Format detection
 tl_format tl_detect_format(const uint8_t* buf, size_t len) {
     return detect_format_from_buffer(buf, len);
@@ -25,6 +25,32 @@ uint8_t* tl_read_tags(const char* path, const uint8_t* buf, size_t len,
 uint8_t* tl_read_tags_ex(const char* path, const uint8_t* buf, size_t len,
                          tl_format format, size_t* out_size);
 
+// Read tags without building the result in one buffer: the MessagePack
+// encoding is handed to the host import env.tl_host_chunk(stream_id,
+// data, len) in order, at most chunk_size bytes (>= 64) per call. data is
+// only valid during the call; a nonzero return aborts the read.
+// Returns 0 on success, error code on failure
+int tl_read_tags_chunked(const char* path, const uint8_t* buf, size_t len,
+                         tl_format format, uint32_t chunk_size, uint32_t stream_id);
+
+// Structural snapshot of the file at path: the offsets of the headers
+// TagLib walks to open it (atoms, pages, metadata blocks, chunks, top level
+// elements), the detected format, the file size and a digest of the header
+// bytes. Opaque MessagePack, caller must free with tl_free()
+// Returns 0 on success, error code on failure
+int tl_snapshot_structure(const char* path, uint8_t** out_buf, size_t* out_size);
+
+// tl_read_tags for path with a snapshot from tl_snapshot_structure. When
+// the file size, TagLib version and header digest still match, the file is
+// opened as the recorded format, without detection, with the headers served
+// from memory (Matroska reads only the recorded elements); otherwise it is
+// read the regular way.
+// out_snapshot_used (optional, may be NULL) receives 1 if the snapshot
+// was used, 0 if it was stale
+uint8_t* tl_read_tags_snapshot(const char* path, const uint8_t* snapshot,
+                               size_t snapshot_size, size_t* out_size,
+                               int* out_snapshot_used);
+
 // Write tags to file or buffer
 // tags_data: MessagePack encoded tag data
 // Returns 0 on success, error code on failure
@@ -33,6 +59,36 @@ int tl_write_tags(const char* path, const uint8_t* buf, size_t len,
                   const uint8_t* tags_data, size_t tags_size,
                   uint8_t** out_buf, size_t* out_size);
 
+// Update tags with patch semantics on a single parse
+// patch_data: MessagePack map with optional
+//   "set":    tag map as for tl_write_tags; only the keys present change
+//   "append": tag map; values (and pictures) are added to the existing ones
+//   "remove": array of keys; "pictures", "ratings", "lyrics" and
+//             "chapters" clear those lists
+// For buffer mode: out_buf and out_size receive the modified data
+// out_tags (optional, may be NULL) receives the tags after the update,
+// encoded as by tl_read_tags; caller must free with tl_free()
+// Returns 0 on success, error code on failure
+int tl_update_tags(const char* path, const uint8_t* buf, size_t len,
+                   const uint8_t* patch_data, size_t patch_size,
+                   uint8_t** out_buf, size_t* out_size,
+                   uint8_t** out_tags, size_t* out_tags_size);
+
+// Returns 1 if the last tl_write_tags or tl_update_tags call succeeded
+// without saving because the tags already matched the request (path mode
+// leaves the file untouched, buffer mode returns a copy of the input),
+// 0 otherwise. Only meaningful after a call that returned TL_SUCCESS.
+int tl_write_skipped(void);
+
+// Dry run of tl_write_tags: applies and renders the tags against an
+// overlay of the file or buffer and fills out with the size of the
+// rewritten region, whether it fits in place and the expected I/O.
+// Nothing is written; path mode opens the file read-only.
+// Returns 0 on success, error code on failure
+int tl_estimate_write(const char* path, const uint8_t* buf, size_t len,
+                      const uint8_t* tags_data, size_t tags_size,
+                      tl_write_estimate* out);
+
 // ============================================================================
 // Streaming API for Large Files
 // ============================================================================
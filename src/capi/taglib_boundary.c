@@ -8,6 +8,7 @@
 #include "taglib_shim.h"
 #include "core/taglib_core.h" 
 #include "core/taglib_msgpack.h"
+#include "taglib_formats.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -19,6 +20,42 @@ uint8_t* tl_read_tags_ex(const char* path, const uint8_t* buf, size_t len,
 extern void tl_set_error(tl_error_code code, const char* message);
 extern void tl_clear_error(void);
 
+// Snapshot initializer: build-wasi.sh runs it under Wizer and saves the
+// resulting memory, so instances start with TagLib's tables in place.
+// Calling it on a live instance is harmless.
+void tl_preinitialize(void) {
+    taglib_preinit_shim();
+}
+
+// Error message for a failed read
+static const char* read_error_message(tl_error_code status) {
+    const char* error_msg = "Failed to read tags";
+    switch (status) {
+        case TL_ERROR_INVALID_INPUT:
+            error_msg = "Invalid input parameters";
+            break;
+        case TL_ERROR_IO_READ:
+            error_msg = "Failed to open file for reading";
+            break;
+        case TL_ERROR_UNSUPPORTED_FORMAT:
+            error_msg = "Unsupported audio format";
+            break;
+        case TL_ERROR_PARSE_FAILED:
+            error_msg = "Failed to parse audio file";
+            break;
+        case TL_ERROR_MEMORY_ALLOCATION:
+            error_msg = "Memory allocation failed";
+            break;
+        case TL_ERROR_SERIALIZE_FAILED:
+            error_msg = "Failed to serialize tag data";
+            break;
+        default:
+            error_msg = "Unknown error occurred";
+            break;
+    }
+    return error_msg;
+}
+
 // Main read function with MessagePack
 uint8_t* tl_read_tags(const char* path, const uint8_t* buf, size_t len, 
                       size_t* out_size) {
@@ -41,31 +78,7 @@ uint8_t* tl_read_tags_ex(const char* path, const uint8_t* buf, size_t len,
     tl_error_code status = taglib_read_shim(path, buf, len, format, &result, out_size);
     
     if (status != TL_SUCCESS) {
-        const char* error_msg = "Failed to read tags";
-        switch (status) {
-            case TL_ERROR_INVALID_INPUT:
-                error_msg = "Invalid input parameters";
-                break;
-            case TL_ERROR_IO_READ:
-                error_msg = "Failed to open file for reading";
-                break;
-            case TL_ERROR_UNSUPPORTED_FORMAT:
-                error_msg = "Unsupported audio format";
-                break;
-            case TL_ERROR_PARSE_FAILED:
-                error_msg = "Failed to parse audio file";
-                break;
-            case TL_ERROR_MEMORY_ALLOCATION:
-                error_msg = "Memory allocation failed";
-                break;
-            case TL_ERROR_SERIALIZE_FAILED:
-                error_msg = "Failed to serialize tag data";
-                break;
-            default:
-                error_msg = "Unknown error occurred";
-                break;
-        }
-        tl_set_error(status, error_msg);
+        tl_set_error(status, read_error_message(status));
         *out_size = 0;
         return NULL;
     }
@@ -73,6 +86,73 @@ uint8_t* tl_read_tags_ex(const char* path, const uint8_t* buf, size_t len,
     return result;
 }
 
+// Structural snapshot for tl_read_tags_snapshot()
+int tl_snapshot_structure(const char* path, uint8_t** out_buf, size_t* out_size) {
+    tl_clear_error();
+
+    tl_error_code status = taglib_snapshot_shim(path, out_buf, out_size);
+    if (status != TL_SUCCESS) {
+        tl_set_error(status, read_error_message(status));
+        return status;
+    }
+    return TL_SUCCESS;
+}
+
+// Read that reopens the file from a structural snapshot while it matches
+uint8_t* tl_read_tags_snapshot(const char* path, const uint8_t* snapshot,
+                               size_t snapshot_size, size_t* out_size,
+                               int* out_snapshot_used) {
+    tl_clear_error();
+
+    if (out_snapshot_used) *out_snapshot_used = 0;
+    if (!out_size) {
+        tl_set_error(TL_ERROR_INVALID_INPUT, "out_size cannot be NULL");
+        return NULL;
+    }
+    *out_size = 0;
+
+    uint8_t* result = NULL;
+    tl_error_code status = taglib_read_snapshot_shim(path, snapshot, snapshot_size,
+                                                     &result, out_size, out_snapshot_used);
+    if (status != TL_SUCCESS) {
+        tl_set_error(status, read_error_message(status));
+        *out_size = 0;
+        return NULL;
+    }
+    return result;
+}
+
+// Host import receiving tl_read_tags_chunked() output. Returns 0 to take
+// the next chunk, nonzero to abort the read.
+__attribute__((import_module("env"), import_name("tl_host_chunk")))
+extern int tl_host_chunk(uint32_t stream_id, const uint8_t* data, size_t len);
+
+static size_t host_chunk_write(const uint8_t* data, size_t len, void* ctx) {
+    uint32_t stream_id = (uint32_t)(uintptr_t)ctx;
+    return tl_host_chunk(stream_id, data, len) == 0 ? len : 0;
+}
+
+// Chunked read: the msgpack result goes to the host in chunk_size pieces
+// instead of one malloc'd buffer
+int tl_read_tags_chunked(const char* path, const uint8_t* buf, size_t len,
+                         tl_format format, uint32_t chunk_size, uint32_t stream_id) {
+    tl_clear_error();
+
+    if (chunk_size < MP_CHUNK_MIN_SIZE) {
+        tl_set_error(TL_ERROR_INVALID_INPUT, "Chunk size too small");
+        return TL_ERROR_INVALID_INPUT;
+    }
+
+    tl_error_code status = taglib_read_chunked_shim(path, buf, len, format, chunk_size,
+                                                    host_chunk_write,
+                                                    (void*)(uintptr_t)stream_id);
+    if (status != TL_SUCCESS) {
+        tl_set_error(status, read_error_message(status));
+        return status;
+    }
+    return TL_SUCCESS;
+}
+
 // Write tags implementation
 int tl_write_tags(const char* path, const uint8_t* buf, size_t len,
                   const uint8_t* tags_data, size_t tags_size,
@@ -123,11 +203,99 @@ int tl_write_tags(const char* path, const uint8_t* buf, size_t len,
     return TL_SUCCESS;
 }
 
+// Update tags in place: set/append/remove per key on a single parse
+int tl_update_tags(const char* path, const uint8_t* buf, size_t len,
+                   const uint8_t* patch_data, size_t patch_size,
+                   uint8_t** out_buf, size_t* out_size,
+                   uint8_t** out_tags, size_t* out_tags_size) {
+    tl_clear_error();
+
+    if (!patch_data || patch_size == 0) {
+        tl_set_error(TL_ERROR_INVALID_INPUT, "No patch data provided");
+        return TL_ERROR_INVALID_INPUT;
+    }
+
+    uint8_t* result_buf = NULL;
+    size_t result_size = 0;
+    tl_error_code status = taglib_update_shim(path, buf, len, patch_data, patch_size,
+                                              &result_buf, &result_size,
+                                              out_tags, out_tags_size);
+    if (status != TL_SUCCESS) {
+        const char* error_msg = "Failed to update tags";
+        switch (status) {
+            case TL_ERROR_INVALID_INPUT:
+                error_msg = "Invalid input for updating";
+                break;
+            case TL_ERROR_IO_WRITE:
+                error_msg = "Failed to write updated tags";
+                break;
+            case TL_ERROR_PARSE_FAILED:
+                error_msg = "Failed to parse patch or access tags for updating";
+                break;
+            case TL_ERROR_SERIALIZE_FAILED:
+                error_msg = "Tags were updated but could not be encoded";
+                break;
+            case TL_ERROR_MEMORY_ALLOCATION:
+                error_msg = "Memory allocation failed during update";
+                break;
+            default:
+                break;
+        }
+        tl_set_error(status, error_msg);
+        return status;
+    }
+
+    if (out_buf) *out_buf = result_buf;
+    else free(result_buf);
+    if (out_size) *out_size = result_size;
+    return TL_SUCCESS;
+}
+
+int tl_write_skipped(void) {
+    return taglib_write_skipped_shim();
+}
+
+// Write dry run: same inputs as tl_write_tags, nothing is persisted
+int tl_estimate_write(const char* path, const uint8_t* buf, size_t len,
+                      const uint8_t* tags_data, size_t tags_size,
+                      tl_write_estimate* out) {
+    tl_clear_error();
+
+    if (!tags_data || tags_size == 0 || !out) {
+        tl_set_error(TL_ERROR_INVALID_INPUT, "No tag data or estimate output provided");
+        return TL_ERROR_INVALID_INPUT;
+    }
+
+    tl_error_code status = taglib_estimate_shim(path, buf, len, tags_data, tags_size, out);
+    if (status != TL_SUCCESS) {
+        const char* error_msg = "Failed to estimate write";
+        switch (status) {
+            case TL_ERROR_INVALID_INPUT:
+                error_msg = "Invalid input for estimating a write";
+                break;
+            case TL_ERROR_IO_READ:
+                error_msg = "Failed to open file for estimating a write";
+                break;
+            case TL_ERROR_IO_WRITE:
+                error_msg = "Tags could not be rendered for writing";
+                break;
+            case TL_ERROR_PARSE_FAILED:
+                error_msg = "Failed to access tags for estimating a write";
+                break;
+            default:
+                break;
+        }
+        tl_set_error(status, error_msg);
+        return status;
+    }
+    return TL_SUCCESS;
+}
+
 // Forward declaration for recursive call after ID3 skip
 static tl_format detect_format_at(const uint8_t* buf, size_t len);
 
 // Format detection
-tl_format tl_detect_format(const uint8_t* buf, size_t len) {
+static tl_format detect_format(const uint8_t* buf, size_t len) {
     if (len < 12) return TL_FORMAT_AUTO;
 
     // ID3v2 header: skip past it to detect the actual audio format.
@@ -149,6 +317,13 @@ tl_format tl_detect_format(const uint8_t* buf, size_t len) {
     return detect_format_at(buf, len);
 }
 
+// Formats left out of the build report TL_FORMAT_AUTO, so callers fall
+// back to FileRef instead of asking for a handler that is not linked in.
+tl_format tl_detect_format(const uint8_t* buf, size_t len) {
+    tl_format format = detect_format(buf, len);
+    return tl_format_enabled(format) ? format : TL_FORMAT_AUTO;
+}
+
 static tl_format detect_format_at(const uint8_t* buf, size_t len) {
     if (len < 4) return TL_FORMAT_AUTO;
 
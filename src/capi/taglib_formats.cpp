@@ -0,0 +1,80 @@
+#include "taglib_formats.h"
+
+#include <taglib_config.h>
+
+#include <cstring>
+
+// MPEG is always built; every other group follows TagLib's WITH_* options.
+static const FormatGroup* const kFormatGroups[] = {
+    &tl_formats_mpeg,
+#ifdef TAGLIB_WITH_VORBIS
+    &tl_formats_vorbis,
+#endif
+#ifdef TAGLIB_WITH_MP4
+    &tl_formats_mp4,
+#endif
+#ifdef TAGLIB_WITH_RIFF
+    &tl_formats_riff,
+#endif
+#ifdef TAGLIB_WITH_APE
+    &tl_formats_ape,
+#endif
+#ifdef TAGLIB_WITH_ASF
+    &tl_formats_asf,
+#endif
+#ifdef TAGLIB_WITH_DSF
+    &tl_formats_dsf,
+#endif
+#ifdef TAGLIB_WITH_TRUEAUDIO
+    &tl_formats_trueaudio,
+#endif
+#ifdef TAGLIB_WITH_SHORTEN
+    &tl_formats_shorten,
+#endif
+#ifdef TAGLIB_WITH_MOD
+    &tl_formats_mod,
+#endif
+#ifdef TAGLIB_WITH_MATROSKA
+    &tl_formats_matroska,
+#endif
+};
+
+template <typename Predicate>
+static const FormatHandler* find_handler(Predicate predicate) {
+    for (const FormatGroup* group : kFormatGroups) {
+        for (size_t i = 0; i < group->count; i++) {
+            if (predicate(group->handlers[i])) return &group->handlers[i];
+        }
+    }
+    return nullptr;
+}
+
+const FormatHandler* find_format_handler(tl_format format) {
+    return find_handler([format](const FormatHandler& h) {
+        return h.format == format;
+    });
+}
+
+const FormatHandler* find_format_handler(TagLib::File* file) {
+    if (!file) return nullptr;
+    return find_handler([file](const FormatHandler& h) {
+        return h.matches(file);
+    });
+}
+
+void preinit_format_groups() {
+    for (const FormatGroup* group : kFormatGroups) {
+        if (group->preinit) group->preinit();
+    }
+}
+
+bool tl_format_enabled(tl_format format) {
+    return find_format_handler(format) != nullptr;
+}
+
+bool tl_format_capability_enabled(const char* capability) {
+    if (!capability) return false;
+    return find_handler([capability](const FormatHandler& h) {
+        return strcmp(h.capability, capability) == 0;
+    }) != nullptr;
+}
@@ -0,0 +1,102 @@
+/**
+ * @fileoverview Format registry for the WASI shim
+ *
+ * Every format the shim can open is described by a FormatHandler. Handlers
+ * are grouped like TagLib's WITH_* build options (one source file per
+ * group in formats/), and the registry lists the groups enabled in
+ * taglib_config.h. A module built with TAGLIB_FORMATS=mp4,vorbis only
+ * links the MPEG, MP4 and Ogg/FLAC code; the shim, audio properties,
+ * ratings, capability checks and detection all go through the registry,
+ * so disabled formats need no further #ifdefs.
+ */
+
+#ifndef TAGLIB_FORMATS_H
+#define TAGLIB_FORMATS_H
+
+#include "core/taglib_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** True if the module was built with support for format. */
+bool tl_format_enabled(tl_format format);
+
+/** True if capability names an enabled format, e.g. "format-mp3". */
+bool tl_format_capability_enabled(const char* capability);
+
+#ifdef __cplusplus
+}
+
+namespace TagLib {
+  class File;
+  class IOStream;
+}
+
+struct ExtendedAudioInfo;
+struct RatingEntry;
+struct StructureSnapshot;
+
+struct FormatHandler {
+    tl_format format;
+    const char* capability;
+    // Write-only opens pass readProperties false to skip the audio scan.
+    TagLib::File* (*create)(TagLib::IOStream* stream, bool readProperties);
+    // True if file is an instance of this format's File class.
+    bool (*matches)(TagLib::File* file);
+    void (*audioInfo)(TagLib::File* file, ExtendedAudioInfo* info);
+    // Rating hooks, nullptr for formats without rating support.
+    uint32_t (*readRatings)(TagLib::File* file, RatingEntry* entries, uint32_t max_entries);
+    void (*writeRatings)(TagLib::File* file, const RatingEntry* entries, uint32_t count);
+    // Track and disc numbers are stored as "number/total" pairs.
+    bool intPairNumbers;
+    // Structural snapshot hooks, nullptr for formats without a walker.
+    // walkStructure records the headers of the format's structure;
+    // openStructure opens the file with the structure a valid snapshot
+    // recorded, nullptr to open it with create.
+    bool (*walkStructure)(TagLib::IOStream* stream, StructureSnapshot* snapshot);
+    TagLib::File* (*openStructure)(TagLib::IOStream* stream, const StructureSnapshot& snapshot);
+};
+
+struct FormatGroup {
+    const FormatHandler* handlers;
+    size_t count;
+    // Builds the group's lazily constructed tables, nullptr if it has none.
+    void (*preinit)();
+};
+
+/** Returns the handler for format, or nullptr if it is not enabled. */
+const FormatHandler* find_format_handler(tl_format format);
+
+/** Returns the handler whose File class file belongs to, or nullptr. */
+const FormatHandler* find_format_handler(TagLib::File* file);
+
+/** Runs the preinit hook of every enabled group. */
+void preinit_format_groups();
+
+template <typename T>
+TagLib::File* create_format_file(TagLib::IOStream* stream, bool readProperties) {
+    return new T(stream, readProperties);
+}
+
+template <typename T>
+bool is_format_file(TagLib::File* file) {
+    return dynamic_cast<T*>(file) != nullptr;
+}
+
+// Defined in formats/taglib_group_*.cpp, one per TagLib WITH_* option.
+extern const FormatGroup tl_formats_mpeg;
+extern const FormatGroup tl_formats_vorbis;
+extern const FormatGroup tl_formats_mp4;
+extern const FormatGroup tl_formats_riff;
+extern const FormatGroup tl_formats_ape;
+extern const FormatGroup tl_formats_asf;
+extern const FormatGroup tl_formats_dsf;
+extern const FormatGroup tl_formats_trueaudio;
+extern const FormatGroup tl_formats_shorten;
+extern const FormatGroup tl_formats_mod;
+extern const FormatGroup tl_formats_matroska;
+
+#endif
+
+#endif // TAGLIB_FORMATS_H
@@ -0,0 +1,266 @@
+#include "taglib_overlay_stream.h"
+
+#include <algorithm>
+
+using TagLib::ByteVector;
+using TagLib::offset_t;
+
+OverlayStream::OverlayStream(TagLib::IOStream* base)
+    : base_(base), base_length_(base->length()), length_(base_length_),
+      position_(0), cost_{0, 0, 0} {
+    if (base_length_ > 0) {
+        pieces_.push_back(Piece{true, 0, base_length_, ByteVector()});
+    }
+}
+
+TagLib::FileName OverlayStream::name() const {
+    return base_->name();
+}
+
+ByteVector OverlayStream::readBlock(size_t length) {
+    ByteVector out;
+    offset_t want_end = std::min(position_ + static_cast<offset_t>(length), length_);
+    offset_t pos = 0;
+    for (const Piece& piece : pieces_) {
+        offset_t p0 = pos;
+        offset_t p1 = pos + piece.size;
+        pos = p1;
+        if (p1 <= position_) continue;
+        if (p0 >= want_end) break;
+
+        offset_t from = std::max(p0, position_) - p0;
+        offset_t to = std::min(p1, want_end) - p0;
+        if (piece.from_base) {
+            base_->seek(piece.base_offset + from);
+            out.append(base_->readBlock(static_cast<size_t>(to - from)));
+        } else {
+            out.append(piece.data.mid(static_cast<unsigned int>(from),
+                                      static_cast<unsigned int>(to - from)));
+        }
+    }
+    position_ += out.size();
+    return out;
+}
+
+void OverlayStream::writeBlock(const ByteVector& data) {
+    cost_.bytes_written += data.size();
+    if (position_ > length_) {
+        replace(length_, length_, ByteVector(static_cast<unsigned int>(position_ - length_), '\0'));
+    }
+    replace(position_, std::min(position_ + static_cast<offset_t>(data.size()), length_), data);
+    position_ += data.size();
+}
+
+void OverlayStream::insert(const ByteVector& data, offset_t start, size_t replace_size) {
+    if (data.size() == replace_size) {
+        cost_.bytes_written += data.size();
+    } else {
+        // FileStream moves everything after the replaced span
+        offset_t tail = tailFrom(start + static_cast<offset_t>(replace_size));
+        cost_.bytes_moved += tail;
+        cost_.bytes_read += tail;
+        cost_.bytes_written += data.size() + tail;
+    }
+    replace(start, std::min(start + static_cast<offset_t>(replace_size), length_), data);
+    position_ = start + data.size();
+}
+
+void OverlayStream::removeBlock(offset_t start, size_t length) {
+    offset_t tail = tailFrom(start + static_cast<offset_t>(length));
+    cost_.bytes_moved += tail;
+    cost_.bytes_read += tail;
+    cost_.bytes_written += tail;
+    replace(start, std::min(start + static_cast<offset_t>(length), length_), ByteVector());
+}
+
+bool OverlayStream::readOnly() const {
+    return false;
+}
+
+bool OverlayStream::isOpen() const {
+    return base_->isOpen();
+}
+
+void OverlayStream::seek(offset_t offset, Position p) {
+    switch (p) {
+        case Beginning: position_ = offset; break;
+        case Current: position_ += offset; break;
+        case End: position_ = length_ + offset; break;
+    }
+    if (position_ < 0) position_ = 0;
+}
+
+void OverlayStream::clear() {
+    base_->clear();
+}
+
+offset_t OverlayStream::tell() const {
+    return position_;
+}
+
+offset_t OverlayStream::length() {
+    return length_;
+}
+
+void OverlayStream::truncate(offset_t length) {
+    if (length < length_) {
+        replace(length, length_, ByteVector());
+    } else if (length > length_) {
+        replace(length_, length_, ByteVector(static_cast<unsigned int>(length - length_), '\0'));
+    }
+}
+
+void OverlayStream::changedRegion(offset_t* offset, offset_t* old_size,
+                                  offset_t* new_size) const {
+    // Leading pieces still at their base offset, trailing pieces still at
+    // their distance from the end
+    offset_t prefix = 0;
+    for (const Piece& piece : pieces_) {
+        if (!piece.from_base || piece.base_offset != prefix) break;
+        prefix += piece.size;
+    }
+    offset_t suffix = 0;
+    for (auto it = pieces_.rbegin(); it != pieces_.rend(); ++it) {
+        if (!it->from_base || it->base_offset + it->size != base_length_ - suffix) break;
+        suffix += it->size;
+    }
+    suffix = std::min(suffix, std::min(length_, base_length_) - prefix);
+
+    *offset = prefix;
+    *old_size = base_length_ - prefix - suffix;
+    *new_size = length_ - prefix - suffix;
+}
+
+bool OverlayStream::inPlace() const {
+    return length_ == base_length_ && cost_.bytes_moved == 0;
+}
+
+offset_t OverlayStream::patch(TagLib::IOStream* target) {
+    // Without moves every base piece is still at its offset; written
+    // pieces are narrowed to the bytes that actually differ.
+    offset_t written = 0;
+    offset_t pos = 0;
+    for (const Piece& piece : pieces_) {
+        offset_t offset = pos;
+        pos += piece.size;
+        if (piece.from_base) continue;
+
+        base_->seek(offset);
+        ByteVector old = base_->readBlock(static_cast<size_t>(piece.size));
+        unsigned int first = 0;
+        unsigned int last = piece.data.size();
+        while (first < last && first < old.size() && piece.data[first] == old[first]) first++;
+        while (last > first && last <= old.size() && piece.data[last - 1] == old[last - 1]) last--;
+        if (first == last) continue;
+
+        if (target) {
+            target->seek(offset + first);
+            target->writeBlock(piece.data.mid(first, last - first));
+        }
+        written += last - first;
+    }
+    return written;
+}
+
+offset_t OverlayStream::writeTo(TagLib::IOStream* target) {
+    // Base pieces keep their base order, so pieces moving towards the
+    // start never land on the source of one moving towards the end and
+    // vice versa: copy the former front to back, then the latter back to
+    // front, then write the data pieces, which read nothing.
+    std::vector<offset_t> offsets;
+    offsets.reserve(pieces_.size());
+    offset_t pos = 0;
+    for (const Piece& piece : pieces_) {
+        offsets.push_back(pos);
+        pos += piece.size;
+    }
+
+    offset_t written = 0;
+    for (size_t i = 0; i < pieces_.size(); i++) {
+        const Piece& piece = pieces_[i];
+        if (piece.from_base && offsets[i] < piece.base_offset) {
+            move(target, piece.base_offset, offsets[i], piece.size);
+            written += piece.size;
+        }
+    }
+    for (size_t i = pieces_.size(); i-- > 0;) {
+        const Piece& piece = pieces_[i];
+        if (piece.from_base && offsets[i] > piece.base_offset) {
+            move(target, piece.base_offset, offsets[i], piece.size);
+            written += piece.size;
+        }
+    }
+    for (size_t i = 0; i < pieces_.size(); i++) {
+        const Piece& piece = pieces_[i];
+        if (piece.from_base) continue;
+        target->seek(offsets[i]);
+        target->writeBlock(piece.data);
+        written += piece.size;
+    }
+    if (length_ < base_length_) target->truncate(length_);
+    return written;
+}
+
+// Copies size bytes within target from from to to, in chunks ordered so
+// that an overlapping source is read before it is overwritten.
+void OverlayStream::move(TagLib::IOStream* target, offset_t from, offset_t to, offset_t size) {
+    constexpr offset_t chunk = 64 * 1024;
+    if (to < from) {
+        for (offset_t done = 0; done < size; done += chunk) {
+            offset_t n = std::min(chunk, size - done);
+            target->seek(from + done);
+            ByteVector data = target->readBlock(static_cast<size_t>(n));
+            target->seek(to + done);
+            target->writeBlock(data);
+        }
+    } else {
+        for (offset_t left = size; left > 0;) {
+            offset_t n = std::min(chunk, left);
+            left -= n;
+            target->seek(from + left);
+            ByteVector data = target->readBlock(static_cast<size_t>(n));
+            target->seek(to + left);
+            target->writeBlock(data);
+        }
+    }
+}
+
+OverlayStream::Piece OverlayStream::slice(const Piece& piece, offset_t offset, offset_t size) {
+    if (piece.from_base) return Piece{true, piece.base_offset + offset, size, ByteVector()};
+    return Piece{false, 0, size,
+                 piece.data.mid(static_cast<unsigned int>(offset), static_cast<unsigned int>(size))};
+}
+
+// Replaces [start, end) with data; start may equal length_ to append.
+void OverlayStream::replace(offset_t start, offset_t end, const ByteVector& data) {
+    std::vector<Piece> out;
+    out.reserve(pieces_.size() + 2);
+    bool inserted = false;
+    auto insert_data = [&]() {
+        if (!data.isEmpty()) out.push_back(Piece{false, 0, static_cast<offset_t>(data.size()), data});
+        inserted = true;
+    };
+
+    offset_t pos = 0;
+    for (const Piece& piece : pieces_) {
+        offset_t p0 = pos;
+        offset_t p1 = pos + piece.size;
+        pos = p1;
+        if (p0 < start) {
+            out.push_back(slice(piece, 0, std::min(p1, start) - p0));
+        }
+        if (p1 > end) {
+            if (!inserted) insert_data();
+            offset_t from = std::max(p0, end);
+            out.push_back(slice(piece, from - p0, p1 - from));
+        }
+    }
+    if (!inserted) insert_data();
+
+    pieces_.swap(out);
+    length_ += static_cast<offset_t>(data.size()) - (end - start);
+}
+
+offset_t OverlayStream::tailFrom(offset_t offset) const {
+    return offset < length_ ? length_ - offset : 0;
+}
@@ -0,0 +1,90 @@
+#ifndef TAGLIB_OVERLAY_STREAM_H
+#define TAGLIB_OVERLAY_STREAM_H
+
+#include "core/taglib_core.h"
+
+#ifdef __cplusplus
+
+#include <tiostream.h>
+#include <tbytevector.h>
+
+#include <vector>
+
+// Write-absorbing stream over a read-only base stream. Writes, inserts and
+// removals land in a piece table instead of the base, so a TagLib save can
+// run to completion without persisting anything. The stream tallies the
+// I/O a FileStream would have done for the same calls.
+class OverlayStream : public TagLib::IOStream {
+public:
+    struct Cost {
+        TagLib::offset_t bytes_moved;    // payload shifted by size-changing inserts/removals
+        TagLib::offset_t bytes_read;     // read back to move that payload
+        TagLib::offset_t bytes_written;  // new data plus moved payload
+    };
+
+    explicit OverlayStream(TagLib::IOStream* base);
+
+    TagLib::FileName name() const override;
+    TagLib::ByteVector readBlock(size_t length) override;
+    void writeBlock(const TagLib::ByteVector& data) override;
+    void insert(const TagLib::ByteVector& data,
+                TagLib::offset_t start = 0, size_t replace = 0) override;
+    void removeBlock(TagLib::offset_t start = 0, size_t length = 0) override;
+    bool readOnly() const override;
+    bool isOpen() const override;
+    void seek(TagLib::offset_t offset, Position p = Beginning) override;
+    void clear() override;
+    TagLib::offset_t tell() const override;
+    TagLib::offset_t length() override;
+    void truncate(TagLib::offset_t length) override;
+
+    TagLib::offset_t baseLength() const { return base_length_; }
+    const Cost& cost() const { return cost_; }
+
+    // Whether the length is unchanged and nothing was moved, so the result
+    // can be applied to the base by overwriting bytes in place.
+    bool inPlace() const;
+
+    // Writes the bytes that differ from the base to target, one writeBlock
+    // per changed span, and returns how many bytes that is. Only valid
+    // when inPlace(); a null target just counts.
+    TagLib::offset_t patch(TagLib::IOStream* target);
+
+    // Applies any result to target, which must hold the base's bytes (the
+    // same file opened for writing): base spans that moved are copied
+    // within target in an order that reads every span before it is
+    // overwritten, new data is written over the changed region, and
+    // target is truncated to length(). Returns the bytes written.
+    TagLib::offset_t writeTo(TagLib::IOStream* target);
+
+    // Span that differs from the base: its offset, its length in the base
+    // and its length now. Bytes rewritten with the same content count as
+    // changed, as they would be written.
+    void changedRegion(TagLib::offset_t* offset, TagLib::offset_t* old_size,
+                       TagLib::offset_t* new_size) const;
+
+private:
+    struct Piece {
+        bool from_base;
+        TagLib::offset_t base_offset;  // from_base only
+        TagLib::offset_t size;
+        TagLib::ByteVector data;       // !from_base only
+    };
+
+    static Piece slice(const Piece& piece, TagLib::offset_t offset, TagLib::offset_t size);
+    static void move(TagLib::IOStream* target, TagLib::offset_t from,
+                     TagLib::offset_t to, TagLib::offset_t size);
+    void replace(TagLib::offset_t start, TagLib::offset_t end, const TagLib::ByteVector& data);
+    TagLib::offset_t tailFrom(TagLib::offset_t offset) const;
+
+    TagLib::IOStream* base_;
+    TagLib::offset_t base_length_;
+    TagLib::offset_t length_;
+    TagLib::offset_t position_;
+    std::vector<Piece> pieces_;
+    Cost cost_;
+};
+
+#endif
+
+#endif // TAGLIB_OVERLAY_STREAM_H
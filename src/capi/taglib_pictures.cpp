@@ -87,7 +87,10 @@ void encode_pictures(mpack_writer_t* writer, TagLib::File* file) {
         mpack_write_cstr(writer, "data");
         auto dataIt = pic.find("data");
         if (dataIt != pic.end()) {
-            TagLib::ByteVector bv = dataIt->second.toByteVector();
+            // The ByteVector shares the Variant's storage. Keep it const so
+            // that data() does not detach it into a private copy: the bytes
+            // are copied once, into the output buffer.
+            const TagLib::ByteVector bv = dataIt->second.toByteVector();
             mpack_write_bin(writer, bv.data(),
                             static_cast<uint32_t>(bv.size()));
         } else {
@@ -1,114 +1,18 @@
 #include "taglib_ratings.h"
 
 #include <tfile.h>
-#include <tstring.h>
-#include <tstringlist.h>
 #include <mpack/mpack.h>
 
-#include <mpeg/mpegfile.h>
-#include <mpeg/id3v2/id3v2tag.h>
-#include <mpeg/id3v2/frames/popularimeterframe.h>
-#include <flac/flacfile.h>
-#include <ogg/xiphcomment.h>
-#include <ogg/vorbis/vorbisfile.h>
-#include <ogg/opus/opusfile.h>
-#include <mp4/mp4file.h>
-#include <mp4/mp4tag.h>
-#include <mp4/mp4item.h>
+#include "taglib_formats.h"
 
 #include <cstring>
-#include <cstdlib>
-#include <cstdio>
-
-static constexpr uint32_t MAX_RATING_ENTRIES = 16;
-
-struct RatingEntry {
-    double rating;   // 0.0-1.0 normalized
-    char email[256];
-    uint32_t counter;
-};
 
 static uint32_t collect_ratings(TagLib::File* file,
                                 RatingEntry* entries, uint32_t max_entries)
 {
-    uint32_t count = 0;
-
-    if (auto* f = dynamic_cast<TagLib::MPEG::File*>(file)) {
-        if (f->hasID3v2Tag()) {
-            TagLib::ID3v2::Tag* tag = f->ID3v2Tag();
-            const auto& frames = tag->frameList("POPM");
-            for (const auto& frame : frames) {
-                if (count >= max_entries) break;
-                auto* popm =
-                    dynamic_cast<TagLib::ID3v2::PopularimeterFrame*>(frame);
-                if (!popm) continue;
-                entries[count].rating = popm->rating() / 255.0;
-                std::string email = popm->email().to8Bit(true);
-                strncpy(entries[count].email, email.c_str(), sizeof(entries[count].email) - 1);
-                entries[count].email[sizeof(entries[count].email) - 1] = '\0';
-                entries[count].counter = popm->counter();
-                count++;
-            }
-        }
-        return count;
-    }
-
-    // FLAC, OGG Vorbis, Opus all use XiphComment RATING field
-    TagLib::Ogg::XiphComment* xiph = nullptr;
-
-    if (auto* f = dynamic_cast<TagLib::FLAC::File*>(file)) {
-        xiph = f->xiphComment();
-    } else if (auto* f = dynamic_cast<TagLib::Ogg::Vorbis::File*>(file)) {
-        xiph = f->tag();
-    } else if (auto* f = dynamic_cast<TagLib::Ogg::Opus::File*>(file)) {
-        xiph = f->tag();
-    }
-
-    if (xiph && xiph->contains("RATING")) {
-        const auto& values = xiph->fieldListMap()["RATING"];
-        for (const auto& val : values) {
-            if (count >= max_entries) break;
-            std::string s = val.to8Bit(true);
-            double r = s.empty() ? 0.0 : std::strtod(s.c_str(), nullptr);
-            if (r > 1.0) r = r / 100.0;  // handle 0-100 percentages
-            if (r < 0.0) r = 0.0;
-            if (r > 1.0) r = 1.0;
-            entries[count].rating = r;
-            entries[count].email[0] = '\0';
-            entries[count].counter = 0;
-            count++;
-        }
-        return count;
-    }
-
-    if (auto* f = dynamic_cast<TagLib::MP4::File*>(file)) {
-        TagLib::MP4::Tag* tag = f->tag();
-        if (tag && tag->contains("----:com.apple.iTunes:RATING")) {
-            TagLib::MP4::Item item = tag->item("----:com.apple.iTunes:RATING");
-            if (item.isValid() && count < max_entries) {
-                double r = 0.0;
-                if (item.type() == TagLib::MP4::Item::Type::Int) {
-                    int v = item.toInt();
-                    r = (v > 100) ? v / 255.0 : v / 100.0;
-                } else if (item.type() == TagLib::MP4::Item::Type::StringList) {
-                    TagLib::StringList sl = item.toStringList();
-                    if (!sl.isEmpty()) {
-                        r = std::strtod(sl.front().to8Bit(true).c_str(), nullptr);
-                        if (r > 1.0) r = r / 100.0;
-                    }
-                }
-                if (r < 0.0) r = 0.0;
-                if (r > 1.0) r = 1.0;
-                entries[count].rating = r;
-                entries[count].email[0] = '\0';
-                entries[count].counter = 0;
-                count++;
-            }
-        }
-        return count;
-    }
-
-    return count;
+    const FormatHandler* handler = find_format_handler(file);
+    if (!handler || !handler->readRatings) return 0;
+    return handler->readRatings(file, entries, max_entries);
 }
 
 uint32_t count_ratings(TagLib::File* file) {
@@ -145,56 +49,9 @@ void encode_ratings(mpack_writer_t* writer, TagLib::File* file) {
 static void apply_ratings_to_file(TagLib::File* file,
                                   const RatingEntry* entries, uint32_t count)
 {
-    if (auto* f = dynamic_cast<TagLib::MPEG::File*>(file)) {
-        TagLib::ID3v2::Tag* tag = f->ID3v2Tag(true);
-        tag->removeFrames("POPM");
-        for (uint32_t i = 0; i < count; i++) {
-            auto* popm = new TagLib::ID3v2::PopularimeterFrame();
-            int popmRating = static_cast<int>(entries[i].rating * 255.0 + 0.5);
-            if (popmRating < 0) popmRating = 0;
-            if (popmRating > 255) popmRating = 255;
-            popm->setRating(popmRating);
-            if (entries[i].email[0] != '\0') {
-                popm->setEmail(TagLib::String(entries[i].email, TagLib::String::UTF8));
-            }
-            popm->setCounter(entries[i].counter);
-            tag->addFrame(popm);
-        }
-        return;
-    }
-
-    TagLib::Ogg::XiphComment* xiph = nullptr;
-    if (auto* f = dynamic_cast<TagLib::FLAC::File*>(file)) {
-        xiph = f->xiphComment(true);
-    } else if (auto* f = dynamic_cast<TagLib::Ogg::Vorbis::File*>(file)) {
-        xiph = f->tag();
-    } else if (auto* f = dynamic_cast<TagLib::Ogg::Opus::File*>(file)) {
-        xiph = f->tag();
-    }
-
-    if (xiph) {
-        xiph->removeFields("RATING");
-        for (uint32_t i = 0; i < count; i++) {
-            char buf[32];
-            snprintf(buf, sizeof(buf), "%.6g", entries[i].rating);
-            xiph->addField("RATING",
-                TagLib::String(buf, TagLib::String::UTF8), false);
-        }
-        return;
-    }
-
-    if (auto* f = dynamic_cast<TagLib::MP4::File*>(file)) {
-        TagLib::MP4::Tag* tag = f->tag();
-        if (!tag) return;
-        tag->removeItem("----:com.apple.iTunes:RATING");
-        // MP4 freeform atoms support only a single rating value
-        if (count > 0) {
-            char buf[32];
-            snprintf(buf, sizeof(buf), "%.6g", entries[0].rating);
-            TagLib::StringList sl;
-            sl.append(TagLib::String(buf, TagLib::String::UTF8));
-            tag->setItem("----:com.apple.iTunes:RATING", TagLib::MP4::Item(sl));
-        }
+    const FormatHandler* handler = find_format_handler(file);
+    if (handler && handler->writeRatings) {
+        handler->writeRatings(file, entries, count);
     }
 }
 
@@ -8,6 +8,14 @@
 
 namespace TagLib { class File; }
 
+constexpr uint32_t MAX_RATING_ENTRIES = 16;
+
+struct RatingEntry {
+    double rating;   // 0.0-1.0 normalized
+    char email[256];
+    uint32_t counter;
+};
+
 uint32_t count_ratings(TagLib::File* file);
 void encode_ratings(mpack_writer_t* writer, TagLib::File* file);
 tl_error_code apply_ratings_from_msgpack(
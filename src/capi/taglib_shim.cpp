@@ -16,6 +16,9 @@
 #include "taglib_lyrics.h"
 #include "taglib_chapters.h"
 #include "taglib_audio_props.h"
+#include "taglib_formats.h"
+#include "taglib_overlay_stream.h"
+#include "taglib_structure.h"
 #include "core/taglib_msgpack.h"
 #include "core/taglib_core.h"
 
@@ -26,36 +29,28 @@
 #include <tbytevectorstream.h>
 #include <tfilestream.h>
 #include <audioproperties.h>
-#include <mpegfile.h>
-#include <flacfile.h>
-#include <mp4file.h>
-#include <oggfile.h>
-#include <vorbisfile.h>
-#include <wavfile.h>
-#include <opusfile.h>
-#include <aifffile.h>
-#include <apefile.h>
-#include <wavpackfile.h>
-#include <mpcfile.h>
-#include <asffile.h>
-#include <dsffile.h>
-#include <trueaudiofile.h>
-#include <oggflacfile.h>
-#include <speexfile.h>
-#include <dsdifffile.h>
-#include <shortenfile.h>
-#include <modfile.h>
-#include <s3mfile.h>
-#include <itfile.h>
-#include <xmfile.h>
-#include <matroskafile.h>
 
 #include <mpack/mpack.h>
 
+#include <algorithm>
 #include <memory>
+#include <string>
+#include <vector>
 #include <cstring>
 #include <cstdlib>
 
+// TagLib reports parse errors through return values and isValid(); the
+// handlers below only guard against allocation failures and stray throws.
+// The no-EH WASI build (-fno-exceptions) compiles them away, there an
+// allocation failure aborts the instance instead.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define TL_TRY try
+#define TL_CATCH_ALL catch (...)
+#else
+#define TL_TRY if (true)
+#define TL_CATCH_ALL else
+#endif
+
 enum FieldType : uint8_t {
     FIELD_STRING  = 0,
     FIELD_NUMERIC = 1,
@@ -68,7 +63,7 @@ struct FieldMapping {
     FieldType type;     // how to encode/decode the value
 };
 
-static const FieldMapping FIELD_MAP[] = {
+static constexpr FieldMapping FIELD_MAP[] = {
     {"ACOUSTID_FINGERPRINT", "acoustidFingerprint", FIELD_STRING},
     {"ACOUSTID_ID",          "acoustidId",          FIELD_STRING},
     {"ALBUM",                "album",               FIELD_STRING},
@@ -103,67 +98,169 @@ static const FieldMapping FIELD_MAP[] = {
     {"TRACKTOTAL",           "totalTracks",         FIELD_NUMERIC},
 };
 
-static const size_t FIELD_MAP_SIZE = sizeof(FIELD_MAP) / sizeof(FIELD_MAP[0]);
+static constexpr size_t FIELD_MAP_SIZE = sizeof(FIELD_MAP) / sizeof(FIELD_MAP[0]);
 
-static const FieldMapping* find_by_prop(const char* key) {
-    int left = 0, right = static_cast<int>(FIELD_MAP_SIZE) - 1;
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-        int cmp = strcmp(key, FIELD_MAP[mid].prop);
-        if (cmp == 0) return &FIELD_MAP[mid];
-        if (cmp < 0) right = mid - 1;
-        else left = mid + 1;
+static constexpr bool prop_equal(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// FIELD_MAP index of a property name, -1 if it has no entry. Only used in
+// constant expressions, so the scan costs nothing at run time.
+static constexpr int field_index(const char* prop) {
+    for (size_t i = 0; i < FIELD_MAP_SIZE; i++) {
+        if (prop_equal(FIELD_MAP[i].prop, prop)) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// FIELD_MAP indices of the keys the shim reads and writes itself
+enum WellKnownKey : int {
+    KEY_TITLE = field_index("TITLE"),
+    KEY_ARTIST = field_index("ARTIST"),
+    KEY_ALBUM = field_index("ALBUM"),
+    KEY_COMMENT = field_index("COMMENT"),
+    KEY_GENRE = field_index("GENRE"),
+    KEY_DATE = field_index("DATE"),
+    KEY_TRACKNUMBER = field_index("TRACKNUMBER"),
+    KEY_TRACKTOTAL = field_index("TRACKTOTAL"),
+    KEY_DISCNUMBER = field_index("DISCNUMBER"),
+    KEY_DISCTOTAL = field_index("DISCTOTAL"),
+};
+static_assert(KEY_TITLE >= 0 && KEY_ARTIST >= 0 && KEY_ALBUM >= 0 && KEY_COMMENT >= 0 &&
+              KEY_GENRE >= 0 && KEY_DATE >= 0 && KEY_TRACKNUMBER >= 0 &&
+              KEY_TRACKTOTAL >= 0 && KEY_DISCNUMBER >= 0 && KEY_DISCTOTAL >= 0,
+              "well-known key missing from FIELD_MAP");
+
+// Interned property keys: one TagLib::String per FIELD_MAP entry, created
+// once and shared (copy-on-write) by every PropertyMap that uses it, so
+// well-known keys are not rebuilt for each file.
+static const TagLib::String* interned_keys() {
+    static const std::unique_ptr<TagLib::String[]> keys = [] {
+        std::unique_ptr<TagLib::String[]> k(new TagLib::String[FIELD_MAP_SIZE]);
+        for (size_t i = 0; i < FIELD_MAP_SIZE; i++) {
+            k[i] = TagLib::String(FIELD_MAP[i].prop);
+        }
+        return k;
+    }();
+    return keys.get();
+}
+
+static const TagLib::String& interned_key(WellKnownKey key) {
+    return interned_keys()[key];
+}
+
+// FNV-1a over the UTF-16 code units, so keys are hashed without first
+// converting them to UTF-8.
+static uint32_t hash_key(const TagLib::String& key) {
+    uint32_t h = 2166136261u;
+    for (wchar_t c : key) {
+        h = (h ^ static_cast<uint32_t>(c)) * 16777619u;
+    }
+    return h;
+}
+
+static const size_t KEY_TABLE_SIZE = 128;  // power of two, > 2x FIELD_MAP_SIZE
+
+// Open-addressing table from key hash to FIELD_MAP index (-1 when empty).
+struct KeyTable {
+    uint32_t hashes[KEY_TABLE_SIZE];
+    int8_t indices[KEY_TABLE_SIZE];
+};
+
+static const KeyTable& key_table() {
+    static const KeyTable table = [] {
+        static_assert(FIELD_MAP_SIZE * 2 < KEY_TABLE_SIZE, "key table too small");
+        KeyTable t;
+        memset(t.indices, -1, sizeof(t.indices));
+        for (size_t i = 0; i < FIELD_MAP_SIZE; i++) {
+            const uint32_t h = hash_key(interned_keys()[i]);
+            size_t slot = h & (KEY_TABLE_SIZE - 1);
+            while (t.indices[slot] >= 0) slot = (slot + 1) & (KEY_TABLE_SIZE - 1);
+            t.hashes[slot] = h;
+            t.indices[slot] = static_cast<int8_t>(i);
+        }
+        return t;
+    }();
+    return table;
+}
+
+// Constant-time lookup of a property key read from a file.
+static const FieldMapping* find_by_key(const TagLib::String& key) {
+    const KeyTable& t = key_table();
+    const uint32_t h = hash_key(key);
+    for (size_t slot = h & (KEY_TABLE_SIZE - 1); t.indices[slot] >= 0;
+         slot = (slot + 1) & (KEY_TABLE_SIZE - 1)) {
+        if (t.hashes[slot] == h && interned_keys()[t.indices[slot]] == key) {
+            return &FIELD_MAP[t.indices[slot]];
+        }
     }
     return nullptr;
 }
 
 static void write_mpack_string(mpack_writer_t* w, const TagLib::String& s) {
-    std::string utf8 = s.to8Bit(true);
-    mpack_write_str(w, utf8.c_str(), static_cast<uint32_t>(utf8.size()));
+    // A UTF-16 unit takes at most 3 bytes in UTF-8, so the value is encoded
+    // in one pass into a buffer of that bound; only long values need the heap.
+    char stack_buf[256];
+    const size_t max_len = static_cast<size_t>(s.size()) * 3;
+    if (max_len <= sizeof(stack_buf)) {
+        mpack_write_str(w, stack_buf, s.copyUTF8(stack_buf, sizeof(stack_buf)));
+    } else {
+        std::unique_ptr<char[]> heap_buf(new char[max_len]);
+        const unsigned int len = s.copyUTF8(heap_buf.get(), static_cast<unsigned int>(max_len));
+        mpack_write_str(w, heap_buf.get(), len);
+    }
 }
 
 static bool uses_intpair_format(TagLib::File* file) {
-    return dynamic_cast<TagLib::MP4::File*>(file) ||
-           dynamic_cast<TagLib::MPEG::File*>(file);
+    const FormatHandler* handler = find_format_handler(file);
+    return handler && handler->intPairNumbers;
 }
 
 static void split_intpair_properties(TagLib::PropertyMap& props) {
-    auto splitPair = [&props](const char* numberKey, const char* totalKey) {
-        auto it = props.find(numberKey);
+    auto splitPair = [&props](WellKnownKey numberKey, WellKnownKey totalKey) {
+        auto it = props.find(interned_key(numberKey));
         if (it == props.end() || it->second.isEmpty()) return;
         TagLib::String val = it->second.front();
         int slash = val.find("/");
         if (slash == -1) return;
         TagLib::String number = val.substr(0, slash);
         TagLib::String total = val.substr(slash + 1);
-        props[numberKey] = TagLib::StringList(number);
+        props[interned_key(numberKey)] = TagLib::StringList(number);
         if (total.toInt() > 0) {
-            props[totalKey] = TagLib::StringList(total);
+            props[interned_key(totalKey)] = TagLib::StringList(total);
         }
     };
-    splitPair("TRACKNUMBER", "TRACKTOTAL");
-    splitPair("DISCNUMBER", "DISCTOTAL");
+    splitPair(KEY_TRACKNUMBER, KEY_TRACKTOTAL);
+    splitPair(KEY_DISCNUMBER, KEY_DISCTOTAL);
 }
 
 static void merge_intpair_properties(TagLib::PropertyMap& propMap) {
-    auto mergePair = [&propMap](const char* numberKey, const char* totalKey) {
-        auto totalIt = propMap.find(totalKey);
+    auto mergePair = [&propMap](WellKnownKey numberKey, WellKnownKey totalKey) {
+        auto totalIt = propMap.find(interned_key(totalKey));
         if (totalIt == propMap.end() || totalIt->second.isEmpty()) return;
         TagLib::String total = totalIt->second.front();
         TagLib::String number = "0";
-        auto numIt = propMap.find(numberKey);
+        auto numIt = propMap.find(interned_key(numberKey));
         if (numIt != propMap.end() && !numIt->second.isEmpty()) {
             number = numIt->second.front();
         }
-        propMap[numberKey] = TagLib::StringList(number + "/" + total);
-        propMap.erase(totalKey);
+        propMap[interned_key(numberKey)] = TagLib::StringList(number + "/" + total);
+        propMap.erase(interned_key(totalKey));
     };
-    mergePair("TRACKNUMBER", "TRACKTOTAL");
-    mergePair("DISCNUMBER", "DISCTOTAL");
+    mergePair(KEY_TRACKNUMBER, KEY_TRACKTOTAL);
+    mergePair(KEY_DISCNUMBER, KEY_DISCTOTAL);
 }
 
-static tl_error_code encode_file_to_msgpack(TagLib::File* file,
-                                            uint8_t** out_buf, size_t* out_size) {
+// Writes the tl_read_tags map for file. with_pictures false leaves out
+// the "pictures" entry, which for cover art is most of the encoding work.
+// with_lyrics false leaves out "lyrics"; for Matroska, looking them up
+// reads the attachments, which a write-only open leaves unread.
+static void write_file_tags(mpack_writer_t* writer, TagLib::File* file,
+                            bool with_pictures, bool with_lyrics) {
     TagLib::PropertyMap props = file->properties();
     if (uses_intpair_format(file)) {
         split_intpair_properties(props);
@@ -176,13 +273,13 @@ static tl_error_code encode_file_to_msgpack(TagLib::File* file,
     }
     if (audio) count += 5;
 
-    uint32_t pic_count = count_pictures(file);
+    uint32_t pic_count = with_pictures ? count_pictures(file) : 0;
     if (pic_count > 0) count++;  // "pictures" key + array
 
     uint32_t rating_count = count_ratings(file);
     if (rating_count > 0) count++;  // "ratings" key + array
 
-    uint32_t lyrics_count = count_lyrics(file);
+    uint32_t lyrics_count = with_lyrics ? count_lyrics(file) : 0;
     if (lyrics_count > 0) count++;  // "lyrics" key + array
 
     uint32_t chapter_count = count_chapters(file);
@@ -194,117 +291,121 @@ static tl_error_code encode_file_to_msgpack(TagLib::File* file,
         count += count_extended_audio_fields(ext_info);
     }
 
-    mpack_writer_t writer;
-    char* data = nullptr;
-    size_t size = 0;
-    mpack_writer_init_growable(&writer, &data, &size);
-    mpack_start_map(&writer, count);
+    mpack_start_map(writer, count);
 
     for (auto it = props.begin(); it != props.end(); ++it) {
         if (it->second.isEmpty()) continue;
 
-        std::string propKey = it->first.to8Bit(true);
-        const FieldMapping* mapping = find_by_prop(propKey.c_str());
-        const char* outKey = mapping ? mapping->camel : propKey.c_str();
-
-        mpack_write_cstr(&writer, outKey);
+        const FieldMapping* mapping = find_by_key(it->first);
+        if (mapping) {
+            mpack_write_cstr(writer, mapping->camel);
+        } else {
+            write_mpack_string(writer, it->first);
+        }
 
         if (mapping && mapping->type == FIELD_NUMERIC) {
             int val = it->second.front().toInt();
-            mpack_write_uint(&writer, static_cast<uint32_t>(val));
+            mpack_write_uint(writer, static_cast<uint32_t>(val));
         } else if (mapping && mapping->type == FIELD_BOOLEAN) {
             TagLib::String raw = it->second.front();
-            mpack_write_bool(&writer, raw == "1" || raw == "true");
+            mpack_write_bool(writer, raw == "1" || raw == "true");
         } else {
             const TagLib::StringList& values = it->second;
             if (values.size() == 1) {
-                write_mpack_string(&writer, values.front());
+                write_mpack_string(writer, values.front());
             } else {
-                mpack_start_array(&writer, static_cast<uint32_t>(values.size()));
+                mpack_start_array(writer, static_cast<uint32_t>(values.size()));
                 for (const auto& s : values) {
-                    write_mpack_string(&writer, s);
+                    write_mpack_string(writer, s);
                 }
-                mpack_finish_array(&writer);
+                mpack_finish_array(writer);
             }
         }
     }
 
     if (audio) {
-        mpack_write_cstr(&writer, "bitrate");
-        mpack_write_uint(&writer, audio->bitrate());
-        mpack_write_cstr(&writer, "sampleRate");
-        mpack_write_uint(&writer, audio->sampleRate());
-        mpack_write_cstr(&writer, "channels");
-        mpack_write_uint(&writer, audio->channels());
-        mpack_write_cstr(&writer, "length");
-        mpack_write_uint(&writer, audio->lengthInSeconds());
-        mpack_write_cstr(&writer, "lengthMs");
-        mpack_write_uint(&writer, audio->lengthInMilliseconds());
-
-        encode_extended_audio(&writer, ext_info);
+        mpack_write_cstr(writer, "bitrate");
+        mpack_write_uint(writer, audio->bitrate());
+        mpack_write_cstr(writer, "sampleRate");
+        mpack_write_uint(writer, audio->sampleRate());
+        mpack_write_cstr(writer, "channels");
+        mpack_write_uint(writer, audio->channels());
+        mpack_write_cstr(writer, "length");
+        mpack_write_uint(writer, audio->lengthInSeconds());
+        mpack_write_cstr(writer, "lengthMs");
+        mpack_write_uint(writer, audio->lengthInMilliseconds());
+
+        encode_extended_audio(writer, ext_info);
     }
 
     if (pic_count > 0) {
-        encode_pictures(&writer, file);
+        encode_pictures(writer, file);
     }
 
     if (rating_count > 0) {
-        encode_ratings(&writer, file);
+        encode_ratings(writer, file);
     }
 
     if (lyrics_count > 0) {
-        encode_lyrics(&writer, file);
+        encode_lyrics(writer, file);
     }
 
     if (chapter_count > 0) {
-        encode_chapters(&writer, file);
+        encode_chapters(writer, file);
     }
 
-    mpack_finish_map(&writer);
+    mpack_finish_map(writer);
+}
 
-    if (mpack_writer_error(&writer) != mpack_ok) {
-        mpack_writer_destroy(&writer);
-        return TL_ERROR_SERIALIZE_FAILED;
-    }
-    mpack_writer_destroy(&writer);
+
+static tl_error_code encode_file_to_msgpack(TagLib::File* file,
+                                            uint8_t** out_buf, size_t* out_size,
+                                            bool with_pictures = true,
+                                            bool with_lyrics = true) {
+    mpack_writer_t writer;
+    char* data = nullptr;
+    size_t size = 0;
+    mpack_writer_init_growable(&writer, &data, &size);
+    write_file_tags(&writer, file, with_pictures, with_lyrics);
+
+    if (mpack_writer_destroy(&writer) != mpack_ok) return TL_ERROR_SERIALIZE_FAILED;
 
     *out_buf = reinterpret_cast<uint8_t*>(data);
     *out_size = size;
     return TL_SUCCESS;
 }
 
-static TagLib::File* create_file_for_format(tl_format format, TagLib::IOStream* stream) {
-    switch (format) {
-        case TL_FORMAT_MP3:      return new TagLib::MPEG::File(stream);
-        case TL_FORMAT_FLAC:     return new TagLib::FLAC::File(stream);
-        case TL_FORMAT_M4A:      return new TagLib::MP4::File(stream);
-        case TL_FORMAT_OGG:      return new TagLib::Ogg::Vorbis::File(stream);
-        case TL_FORMAT_WAV:      return new TagLib::RIFF::WAV::File(stream);
-        case TL_FORMAT_OPUS:     return new TagLib::Ogg::Opus::File(stream);
-        case TL_FORMAT_AIFF:     return new TagLib::RIFF::AIFF::File(stream);
-        case TL_FORMAT_APE:      return new TagLib::APE::File(stream);
-        case TL_FORMAT_WV:       return new TagLib::WavPack::File(stream);
-        case TL_FORMAT_MPC:      return new TagLib::MPC::File(stream);
-        case TL_FORMAT_ASF:      return new TagLib::ASF::File(stream);
-        case TL_FORMAT_DSF:      return new TagLib::DSF::File(stream);
-        case TL_FORMAT_TTA:      return new TagLib::TrueAudio::File(stream);
-        case TL_FORMAT_OGG_FLAC: return new TagLib::Ogg::FLAC::File(stream);
-        case TL_FORMAT_SPEEX:    return new TagLib::Ogg::Speex::File(stream);
-        case TL_FORMAT_DSDIFF:   return new TagLib::DSDIFF::File(stream);
-        case TL_FORMAT_SHN:      return new TagLib::Shorten::File(stream);
-        case TL_FORMAT_MOD:      return new TagLib::Mod::File(stream);
-        case TL_FORMAT_S3M:      return new TagLib::S3M::File(stream);
-        case TL_FORMAT_IT:       return new TagLib::IT::File(stream);
-        case TL_FORMAT_XM:       return new TagLib::XM::File(stream);
-        case TL_FORMAT_MATROSKA: return new TagLib::Matroska::File(stream);
-        default:                 return nullptr;
+// Streams the same map in chunk_size pieces through write, so the result
+// never has to fit in wasm memory at once. Picture data larger than a
+// chunk goes straight from TagLib's buffer to write.
+static tl_error_code encode_file_to_chunks(TagLib::File* file, size_t chunk_size,
+                                           mp_write_fn write, void* ctx) {
+    std::unique_ptr<char, decltype(&free)> chunk(
+        static_cast<char*>(malloc(chunk_size)), free);
+    if (!chunk) return TL_ERROR_MEMORY_ALLOCATION;
+
+    mpack_writer_t writer;
+    mp_chunk_sink sink = {write, ctx, chunk_size};
+    if (mp_writer_init_chunked(&writer, chunk.get(), chunk_size, &sink) != MP_OK) {
+        return TL_ERROR_INVALID_INPUT;
     }
+    write_file_tags(&writer, file, true, true);
+    return mpack_writer_destroy(&writer) == mpack_ok ? TL_SUCCESS : TL_ERROR_SERIALIZE_FAILED;
+}
+
+// Returns nullptr for TL_FORMAT_AUTO and for formats left out of the build.
+static TagLib::File* create_file_for_format(tl_format format, TagLib::IOStream* stream,
+                                            bool read_properties = true) {
+    const FormatHandler* handler = find_format_handler(format);
+    return handler ? handler->create(stream, read_properties) : nullptr;
 }
 
+// encode(file) turns the opened file into the result: one msgpack buffer
+// for tl_read_tags, a chunk stream for tl_read_tags_chunked.
+template <typename Encode>
 static tl_error_code read_from_buffer(const uint8_t* buf, size_t len,
-                                      tl_format format,
-                                      uint8_t** out_buf, size_t* out_size) {
-    try {
+                                      tl_format format, Encode& encode) {
+    TL_TRY {
         TagLib::ByteVector bv(reinterpret_cast<const char*>(buf),
                               static_cast<unsigned int>(len));
         TagLib::ByteVectorStream stream(bv);
@@ -316,26 +417,26 @@ static tl_error_code read_from_buffer(const uint8_t* buf, size_t len,
         std::unique_ptr<TagLib::File> file(create_file_for_format(format, &stream));
 
         if (file && file->isValid()) {
-            return encode_file_to_msgpack(file.get(), out_buf, out_size);
+            return encode(file.get());
         }
 
         file.reset();
         TagLib::FileRef ref(&stream);
         if (ref.isNull()) return TL_ERROR_PARSE_FAILED;
-        return encode_file_to_msgpack(ref.file(), out_buf, out_size);
-    } catch (...) {
+        return encode(ref.file());
+    } TL_CATCH_ALL {
         return TL_ERROR_PARSE_FAILED;
     }
 }
 
-static tl_error_code read_from_path(const char* path,
-                                    uint8_t** out_buf, size_t* out_size) {
-    try {
+template <typename Encode>
+static tl_error_code read_from_path(const char* path, Encode& encode) {
+    TL_TRY {
         TagLib::FileRef ref(path);
         if (ref.isNull()) return TL_ERROR_IO_READ;
 
-        return encode_file_to_msgpack(ref.file(), out_buf, out_size);
-    } catch (...) {
+        return encode(ref.file());
+    } TL_CATCH_ALL {
         return TL_ERROR_PARSE_FAILED;
     }
 }
@@ -361,9 +462,9 @@ static bool should_skip(const char* key) {
     return false;
 }
 
-static const char* map_camel_to_prop(const char* key) {
+static const TagLib::String* map_camel_to_prop(const char* key) {
     for (size_t i = 0; i < FIELD_MAP_SIZE; i++) {
-        if (strcmp(key, FIELD_MAP[i].camel) == 0) return FIELD_MAP[i].prop;
+        if (strcmp(key, FIELD_MAP[i].camel) == 0) return &interned_keys()[i];
     }
     return nullptr;
 }
@@ -436,9 +537,9 @@ static tl_error_code decode_msgpack_to_propmap(
             mpack_done_array(&reader);
             if (mpack_reader_error(&reader) != mpack_ok) break;
             if (!list.isEmpty()) {
-                const char* mapped = map_camel_to_prop(key);
+                const TagLib::String* mapped = map_camel_to_prop(key);
                 if (mapped) {
-                    propMap[mapped] = list;
+                    propMap[*mapped] = list;
                 } else if (is_uppercase_key(key)) {
                     propMap[key] = list;
                 }
@@ -498,9 +599,9 @@ static tl_error_code decode_msgpack_to_propmap(
         if (mpack_reader_error(&reader) != mpack_ok) break;
         if (!has_value) continue;
 
-        const char* mapped = map_camel_to_prop(key);
+        const TagLib::String* mapped = map_camel_to_prop(key);
         if (mapped) {
-            propMap[mapped] = TagLib::StringList(value);
+            propMap[*mapped] = TagLib::StringList(value);
         } else if (is_uppercase_key(key)) {
             propMap[key] = TagLib::StringList(value);
         }
@@ -516,51 +617,298 @@ static void apply_propmap(TagLib::File* file, const TagLib::PropertyMap& propMap
 
     TagLib::Tag* tag = file->tag();
     if (!tag) return;
-    auto it = propMap.find("TITLE");
+    auto it = propMap.find(interned_key(KEY_TITLE));
     if (it != propMap.end() && it->second.size() == 1)
         tag->setTitle(it->second.front());
-    it = propMap.find("ARTIST");
+    it = propMap.find(interned_key(KEY_ARTIST));
     if (it != propMap.end() && it->second.size() == 1)
         tag->setArtist(it->second.front());
-    it = propMap.find("ALBUM");
+    it = propMap.find(interned_key(KEY_ALBUM));
     if (it != propMap.end() && it->second.size() == 1)
         tag->setAlbum(it->second.front());
-    it = propMap.find("COMMENT");
+    it = propMap.find(interned_key(KEY_COMMENT));
     if (it != propMap.end() && it->second.size() == 1)
         tag->setComment(it->second.front());
-    it = propMap.find("GENRE");
+    it = propMap.find(interned_key(KEY_GENRE));
     if (it != propMap.end() && it->second.size() == 1)
         tag->setGenre(it->second.front());
-    it = propMap.find("DATE");
-    if (it != propMap.end() && !it->second.isEmpty())
+    // setProperties() already wrote a full date ("2020-05-01"), which
+    // setYear() would cut down to the year.
+    it = propMap.find(interned_key(KEY_DATE));
+    if (it != propMap.end() && !it->second.isEmpty() &&
+        TagLib::String::number(it->second.front().toInt()) == it->second.front())
         tag->setYear(it->second.front().toInt());
-    it = propMap.find("TRACKNUMBER");
+    it = propMap.find(interned_key(KEY_TRACKNUMBER));
     if (it != propMap.end() && !it->second.isEmpty())
         tag->setTrack(it->second.front().toInt());
 }
 
+// Set by the last taglib_write_shim() or taglib_update_shim() call when
+// the edit left the file's tags as they were and the save was skipped.
+static bool g_write_skipped = false;
+
+using MsgpackBuffer = std::unique_ptr<uint8_t, decltype(&free)>;
+
+// How an edit opens and inspects the file. Edits that return nothing but
+// the saved file skip the audio properties scan, and leave the pictures
+// and lyrics they do not touch out of the change check: TagLib writes the
+// picture frames and blocks back as it read them, and a write-only
+// Matroska open does not read the attachments both are looked up in.
+struct EditMode {
+    bool read_properties;
+    bool with_pictures;
+    bool with_lyrics;
+};
+
+static EditMode edit_mode(bool returns_tags, bool touches_pictures, bool touches_lyrics) {
+    return EditMode{returns_tags, returns_tags || touches_pictures,
+                    returns_tags || touches_lyrics};
+}
+
+static MsgpackBuffer encode_tag_state(TagLib::File* file, size_t* size, const EditMode& mode) {
+    uint8_t* data = nullptr;
+    *size = 0;
+    if (encode_file_to_msgpack(file, &data, size, mode.with_pictures, mode.with_lyrics) !=
+        TL_SUCCESS) {
+        data = nullptr;
+    }
+    return MsgpackBuffer(data, free);
+}
+
+static bool msgpack_map_has_key(const uint8_t* data, size_t len, const char* wanted) {
+    mpack_reader_t reader;
+    mpack_reader_init_data(&reader, reinterpret_cast<const char*>(data), len);
+    uint32_t count = mpack_expect_map(&reader);
+    size_t wanted_len = strlen(wanted);
+    bool found = false;
+    for (uint32_t i = 0; i < count && !found && mpack_reader_error(&reader) == mpack_ok; i++) {
+        uint32_t klen = mpack_expect_str(&reader);
+        if (mpack_reader_error(&reader) != mpack_ok) break;
+        const char* key = mpack_read_bytes_inplace(&reader, klen);
+        mpack_done_str(&reader);
+        found = key && klen == wanted_len && memcmp(key, wanted, klen) == 0;
+        mpack_discard(&reader);
+    }
+    mpack_reader_destroy(&reader);
+    return found;
+}
+
+// What an edit can change, as the file holds it: the property map before
+// any tl_read_tags conversion (DATE "2020-05-01" is not the year 2020,
+// "1/12" not track 1), and the ratings, chapters and, when the edit mode
+// includes them, pictures and lyrics in their msgpack encoding, which
+// keeps rating values, counters, times and picture bytes exact.
+struct TagState {
+    TagLib::PropertyMap properties;
+    MsgpackBuffer extras{nullptr, free};
+    size_t extras_size = 0;
+
+    bool operator==(const TagState& other) const {
+        return extras && other.extras && extras_size == other.extras_size &&
+               memcmp(extras.get(), other.extras.get(), extras_size) == 0 &&
+               properties == other.properties;
+    }
+};
+
+static TagState capture_tag_state(TagLib::File* file, const EditMode& mode) {
+    TagState state;
+    state.properties = file->properties();
+
+    uint32_t count = 0;
+    if (count_ratings(file) > 0) count++;
+    if (count_chapters(file) > 0) count++;
+    if (mode.with_pictures && count_pictures(file) > 0) count++;
+    if (mode.with_lyrics && count_lyrics(file) > 0) count++;
+
+    mpack_writer_t writer;
+    char* data = nullptr;
+    size_t size = 0;
+    mpack_writer_init_growable(&writer, &data, &size);
+    mpack_start_map(&writer, count);
+    encode_ratings(&writer, file);
+    encode_chapters(&writer, file);
+    if (mode.with_pictures) encode_pictures(&writer, file);
+    if (mode.with_lyrics) encode_lyrics(&writer, file);
+    mpack_finish_map(&writer);
+    if (mpack_writer_destroy(&writer) == mpack_ok) {
+        state.extras.reset(reinterpret_cast<uint8_t*>(data));
+        state.extras_size = size;
+    }
+    return state;
+}
+
+// Runs edit(file) and returns whether it changed anything. Values that
+// set what the file already holds (a re-sent album, 3 for "3") count as
+// unchanged; a state that could not be captured counts as changed.
+// *after, when given, receives the msgpack of the edited file.
+template <typename Edit>
+static bool apply_tracked(TagLib::File* file, Edit& edit, EditMode mode,
+                          MsgpackBuffer* after, size_t* after_size) {
+    const TagState before = capture_tag_state(file, mode);
+
+    edit(file);
+
+    bool changed = !(capture_tag_state(file, mode) == before);
+    if (after) {
+        *after = encode_tag_state(file, after_size, mode);
+    }
+    return changed;
+}
+
+// tl_write_tags semantics: the properties in the map replace the file's,
+// pictures/ratings/lyrics/chapters are replaced when present.
+static void apply_write(TagLib::File* file, TagLib::PropertyMap propMap,
+                        const uint8_t* tags_msgpack, size_t tags_msgpack_len) {
+    if (uses_intpair_format(file)) {
+        merge_intpair_properties(propMap);
+    }
+    apply_propmap(file, propMap);
+    apply_pictures_from_msgpack(file, tags_msgpack, tags_msgpack_len);
+    apply_ratings_from_msgpack(file, tags_msgpack, tags_msgpack_len);
+    apply_lyrics_from_msgpack(file, tags_msgpack, tags_msgpack_len);
+    apply_chapters_from_msgpack(file, tags_msgpack, tags_msgpack_len);
+}
+
+// Opens a file on a stream: by the format detected from buf when the
+// caller has the whole file in memory, else through FileRef's detection
+// (extension of the stream name, then content).
+static TagLib::File* open_on_stream(TagLib::IOStream* stream,
+                                    const uint8_t* buf, size_t len, EditMode mode,
+                                    std::unique_ptr<TagLib::File>& file,
+                                    TagLib::FileRef& ref_fallback) {
+    if (buf) {
+        file.reset(create_file_for_format(tl_detect_format(buf, len), stream,
+                                          mode.read_properties));
+        if (file && file->isValid() && file->tag()) return file.get();
+    }
+
+    file.reset();
+    ref_fallback = TagLib::FileRef(stream, mode.read_properties);
+    if (ref_fallback.isNull() || !ref_fallback.tag()) return nullptr;
+    return ref_fallback.file();
+}
+
+static tl_error_code hand_over_tags(MsgpackBuffer& tags, size_t size,
+                                    uint8_t** out_tags, size_t* out_tags_size) {
+    if (!out_tags) return TL_SUCCESS;
+    if (!tags) return TL_ERROR_SERIALIZE_FAILED;
+    *out_tags = tags.release();
+    *out_tags_size = size;
+    return TL_SUCCESS;
+}
+
+// Renders the save into an overlay of the file, then applies it: when the
+// tags still fit their old bytes (a play count, a rating, a text fix of the
+// same length, anything padding absorbs) only the bytes that changed are
+// overwritten, otherwise the overlay is written from the changed region on.
+// Either way the file is parsed once. Sets *done when the edit is finished,
+// skipped included; otherwise the overlay could not open the file and the
+// caller tries FileRef's own detection.
+template <typename Edit>
+static tl_error_code save_path_via_overlay(const char* path, Edit& edit, EditMode mode,
+                                           uint8_t** out_tags, size_t* out_tags_size,
+                                           bool* done) {
+    *done = false;
+    TagLib::FileStream base(path, true);
+    if (!base.isOpen()) return TL_SUCCESS;
+
+    OverlayStream overlay(&base);
+    std::unique_ptr<TagLib::File> file;
+    TagLib::FileRef ref_fallback;
+    TagLib::File* f = open_on_stream(&overlay, nullptr, 0, mode, file, ref_fallback);
+    if (!f) return TL_SUCCESS;
+
+    *done = true;
+    MsgpackBuffer tags(nullptr, free);
+    size_t tags_size = 0;
+    if (!apply_tracked(f, edit, mode, out_tags ? &tags : nullptr, &tags_size)) {
+        // Nothing to write: leave the file, and its mtime, alone
+        g_write_skipped = true;
+        return hand_over_tags(tags, tags_size, out_tags, out_tags_size);
+    }
+    if (!f->save()) return TL_ERROR_IO_WRITE;
+
+    TagLib::FileStream target(path, false);
+    if (!target.isOpen() || target.readOnly()) return TL_ERROR_IO_WRITE;
+    if (overlay.inPlace()) overlay.patch(&target);
+    else overlay.writeTo(&target);
+    return hand_over_tags(tags, tags_size, out_tags, out_tags_size);
+}
+
+// Applies edit to the file at path and saves it. out_tags, when given,
+// receives the edited tags as tl_read_tags would encode them.
+template <typename Edit>
+static tl_error_code edit_path(const char* path, Edit& edit, EditMode mode,
+                               uint8_t** out_tags, size_t* out_tags_size) {
+    bool done;
+    tl_error_code rc = save_path_via_overlay(path, edit, mode, out_tags, out_tags_size, &done);
+    if (rc != TL_SUCCESS || done) return rc;
+
+    TagLib::FileRef ref(path, mode.read_properties);
+    if (ref.isNull() || !ref.tag()) return TL_ERROR_IO_WRITE;
+
+    MsgpackBuffer tags(nullptr, free);
+    size_t tags_size = 0;
+    if (!apply_tracked(ref.file(), edit, mode, out_tags ? &tags : nullptr, &tags_size)) {
+        // Nothing to write, as in the overlay path
+        g_write_skipped = true;
+        return hand_over_tags(tags, tags_size, out_tags, out_tags_size);
+    }
+    if (!ref.save()) return TL_ERROR_IO_WRITE;
+    return hand_over_tags(tags, tags_size, out_tags, out_tags_size);
+}
+
+// Applies edit to a copy of buf and returns the saved copy in out_buf.
+template <typename Edit>
+static tl_error_code edit_buffer(const uint8_t* buf, size_t len, Edit& edit, EditMode mode,
+                                 uint8_t** out_buf, size_t* out_size,
+                                 uint8_t** out_tags, size_t* out_tags_size) {
+    TagLib::ByteVectorStream stream(
+        TagLib::ByteVector(reinterpret_cast<const char*>(buf),
+                           static_cast<unsigned int>(len)));
+
+    std::unique_ptr<TagLib::File> file;
+    TagLib::FileRef ref_fallback;
+    TagLib::File* f = open_on_stream(&stream, buf, len, mode, file, ref_fallback);
+    if (!f) return TL_ERROR_PARSE_FAILED;
+
+    MsgpackBuffer tags(nullptr, free);
+    size_t tags_size = 0;
+    if (!apply_tracked(f, edit, mode, out_tags ? &tags : nullptr, &tags_size)) {
+        // Nothing to write: hand back the input as is
+        g_write_skipped = true;
+        *out_buf = (uint8_t*)malloc(len);
+        if (!*out_buf) return TL_ERROR_MEMORY_ALLOCATION;
+        memcpy(*out_buf, buf, len);
+        *out_size = len;
+        return hand_over_tags(tags, tags_size, out_tags, out_tags_size);
+    }
+
+    if (!f->save()) return TL_ERROR_IO_WRITE;
+
+    const TagLib::ByteVector* result = stream.data();
+    *out_size = result->size();
+    *out_buf = (uint8_t*)malloc(result->size());
+    if (!*out_buf) return TL_ERROR_MEMORY_ALLOCATION;
+    memcpy(*out_buf, result->data(), result->size());
+    return hand_over_tags(tags, tags_size, out_tags, out_tags_size);
+}
+
 static tl_error_code write_to_path(const char* path,
                                    const uint8_t* tags_msgpack, size_t tags_msgpack_len) {
-    try {
+    TL_TRY {
         TagLib::PropertyMap propMap;
         tl_error_code rc = decode_msgpack_to_propmap(tags_msgpack, tags_msgpack_len, propMap);
         if (rc != TL_SUCCESS) return rc;
 
-        TagLib::FileRef ref(path);
-        if (ref.isNull() || !ref.tag()) return TL_ERROR_IO_WRITE;
-
-        if (uses_intpair_format(ref.file())) {
-            merge_intpair_properties(propMap);
-        }
-        apply_propmap(ref.file(), propMap);
-        apply_pictures_from_msgpack(ref.file(), tags_msgpack, tags_msgpack_len);
-        apply_ratings_from_msgpack(ref.file(), tags_msgpack, tags_msgpack_len);
-        apply_lyrics_from_msgpack(ref.file(), tags_msgpack, tags_msgpack_len);
-        apply_chapters_from_msgpack(ref.file(), tags_msgpack, tags_msgpack_len);
-
-        if (!ref.save()) return TL_ERROR_IO_WRITE;
-        return TL_SUCCESS;
-    } catch (...) {
+        auto edit = [&](TagLib::File* f) {
+            apply_write(f, propMap, tags_msgpack, tags_msgpack_len);
+        };
+        EditMode mode = edit_mode(false,
+            msgpack_map_has_key(tags_msgpack, tags_msgpack_len, "pictures"),
+            msgpack_map_has_key(tags_msgpack, tags_msgpack_len, "lyrics"));
+        return edit_path(path, edit, mode, nullptr, nullptr);
+    } TL_CATCH_ALL {
         return TL_ERROR_PARSE_FAILED;
     }
 }
@@ -568,51 +916,332 @@ static tl_error_code write_to_path(const char* path,
 static tl_error_code write_to_buffer(const uint8_t* buf, size_t len,
                                      const uint8_t* tags_msgpack, size_t tags_msgpack_len,
                                      uint8_t** out_buf, size_t* out_size) {
-    try {
+    TL_TRY {
         TagLib::PropertyMap propMap;
         tl_error_code rc = decode_msgpack_to_propmap(tags_msgpack, tags_msgpack_len, propMap);
         if (rc != TL_SUCCESS) return rc;
 
-        TagLib::ByteVectorStream stream(
-            TagLib::ByteVector(reinterpret_cast<const char*>(buf),
-                               static_cast<unsigned int>(len)));
+        auto edit = [&](TagLib::File* f) {
+            apply_write(f, propMap, tags_msgpack, tags_msgpack_len);
+        };
+        EditMode mode = edit_mode(false,
+            msgpack_map_has_key(tags_msgpack, tags_msgpack_len, "pictures"),
+            msgpack_map_has_key(tags_msgpack, tags_msgpack_len, "lyrics"));
+        return edit_buffer(buf, len, edit, mode, out_buf, out_size, nullptr, nullptr);
+    } TL_CATCH_ALL {
+        return TL_ERROR_PARSE_FAILED;
+    }
+}
 
-        tl_format format = tl_detect_format(buf, len);
-        std::unique_ptr<TagLib::File> file(create_file_for_format(format, &stream));
-        TagLib::FileRef ref_fallback;
-        TagLib::File* f = nullptr;
+// tl_update_tags patch: a map with optional "set" (a tl_write_tags map
+// whose keys replace the file's), "append" (same shape; property values
+// and pictures are added to the file's, "ratings", "lyrics" and
+// "chapters" are rejected) and "remove" (an array of keys; "pictures",
+// "ratings", "lyrics" and "chapters" clear those lists).
+struct UpdatePatch {
+    const uint8_t* set;
+    size_t set_len;
+    const uint8_t* append;
+    size_t append_len;
+    const uint8_t* remove;
+    size_t remove_len;
+};
 
-        if (file && file->isValid() && file->tag()) {
-            f = file.get();
-        } else {
-            file.reset();
-            ref_fallback = TagLib::FileRef(&stream);
-            if (ref_fallback.isNull() || !ref_fallback.tag()) return TL_ERROR_PARSE_FAILED;
-            f = ref_fallback.file();
+static tl_error_code decode_update_patch(const uint8_t* data, size_t len, UpdatePatch* patch) {
+    memset(patch, 0, sizeof(*patch));
+
+    mpack_reader_t reader;
+    mpack_reader_init_data(&reader, reinterpret_cast<const char*>(data), len);
+    uint32_t count = mpack_expect_map(&reader);
+    for (uint32_t i = 0; i < count && mpack_reader_error(&reader) == mpack_ok; i++) {
+        char key[16];
+        uint32_t klen = mpack_expect_str(&reader);
+        if (mpack_reader_error(&reader) != mpack_ok) break;
+        if (klen >= sizeof(key)) {
+            mpack_skip_bytes(&reader, klen);
+            mpack_done_str(&reader);
+            mpack_discard(&reader);
+            continue;
+        }
+        mpack_read_bytes(&reader, key, klen);
+        mpack_done_str(&reader);
+        key[klen] = '\0';
+
+        // Record where the value starts and ends without decoding it
+        const char* start;
+        size_t remaining = mpack_reader_remaining(&reader, &start);
+        mpack_discard(&reader);
+        size_t value_len = remaining - mpack_reader_remaining(&reader, nullptr);
+        const uint8_t* value = reinterpret_cast<const uint8_t*>(start);
+
+        if (strcmp(key, "set") == 0) {
+            patch->set = value;
+            patch->set_len = value_len;
+        } else if (strcmp(key, "append") == 0) {
+            patch->append = value;
+            patch->append_len = value_len;
+        } else if (strcmp(key, "remove") == 0) {
+            patch->remove = value;
+            patch->remove_len = value_len;
+        }
+    }
+    mpack_done_map(&reader);
+    return mpack_reader_destroy(&reader) == mpack_ok ? TL_SUCCESS : TL_ERROR_PARSE_FAILED;
+}
+
+// Clears one of the list-valued fields by applying an empty list.
+static void clear_list_field(TagLib::File* file, const char* key) {
+    char data[32];
+    mpack_writer_t writer;
+    mpack_writer_init(&writer, data, sizeof(data));
+    mpack_start_map(&writer, 1);
+    mpack_write_cstr(&writer, key);
+    mpack_start_array(&writer, 0);
+    mpack_finish_array(&writer);
+    mpack_finish_map(&writer);
+    size_t size = mpack_writer_buffer_used(&writer);
+    if (mpack_writer_destroy(&writer) != mpack_ok) return;
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    if (strcmp(key, "pictures") == 0) apply_pictures_from_msgpack(file, bytes, size);
+    else if (strcmp(key, "ratings") == 0) apply_ratings_from_msgpack(file, bytes, size);
+    else if (strcmp(key, "lyrics") == 0) apply_lyrics_from_msgpack(file, bytes, size);
+    else if (strcmp(key, "chapters") == 0) apply_chapters_from_msgpack(file, bytes, size);
+}
+
+struct DecodedUpdate {
+    TagLib::PropertyMap set;
+    TagLib::PropertyMap append;
+    bool append_pictures;
+    TagLib::StringList remove_props;
+    std::vector<std::string> remove_lists;
+};
+
+static tl_error_code decode_update(const UpdatePatch& patch, DecodedUpdate& update) {
+    tl_error_code rc;
+    if (patch.set) {
+        rc = decode_msgpack_to_propmap(patch.set, patch.set_len, update.set);
+        if (rc != TL_SUCCESS) return rc;
+    }
+    update.append_pictures = false;
+    if (patch.append) {
+        // Appending would need per-format merge rules (one POPM frame per
+        // email, chapter IDs); rather than drop them, refuse
+        for (const char* key : {"ratings", "lyrics", "chapters"}) {
+            if (msgpack_map_has_key(patch.append, patch.append_len, key)) {
+                return TL_ERROR_INVALID_INPUT;
+            }
+        }
+        rc = decode_msgpack_to_propmap(patch.append, patch.append_len, update.append);
+        if (rc != TL_SUCCESS) return rc;
+        update.append_pictures = msgpack_map_has_key(patch.append, patch.append_len, "pictures");
+    }
+    if (!patch.remove) return TL_SUCCESS;
+
+    mpack_reader_t reader;
+    mpack_reader_init_data(&reader, reinterpret_cast<const char*>(patch.remove), patch.remove_len);
+    uint32_t count = mpack_expect_array(&reader);
+    for (uint32_t i = 0; i < count && mpack_reader_error(&reader) == mpack_ok; i++) {
+        char key[256];
+        uint32_t klen = mpack_expect_str(&reader);
+        if (mpack_reader_error(&reader) != mpack_ok) break;
+        if (klen >= sizeof(key)) { mpack_reader_destroy(&reader); return TL_ERROR_PARSE_FAILED; }
+        mpack_read_bytes(&reader, key, klen);
+        mpack_done_str(&reader);
+        key[klen] = '\0';
+
+        if (strcmp(key, "pictures") == 0 || strcmp(key, "ratings") == 0 ||
+            strcmp(key, "lyrics") == 0 || strcmp(key, "chapters") == 0) {
+            update.remove_lists.push_back(key);
+        } else if (const TagLib::String* mapped = map_camel_to_prop(key)) {
+            update.remove_props.append(*mapped);
+        } else if (is_uppercase_key(key)) {
+            update.remove_props.append(TagLib::String(key, TagLib::String::UTF8));
         }
+    }
+    mpack_done_array(&reader);
+    return mpack_reader_destroy(&reader) == mpack_ok ? TL_SUCCESS : TL_ERROR_PARSE_FAILED;
+}
 
-        if (uses_intpair_format(f)) {
-            merge_intpair_properties(propMap);
+// Properties are edited in the split form tl_read_tags reports
+// (TRACKNUMBER and TRACKTOTAL apart) and merged back for intpair formats.
+static void apply_update(TagLib::File* file, const DecodedUpdate& update,
+                         const UpdatePatch& patch) {
+    TagLib::PropertyMap props = file->properties();
+    bool intpair = uses_intpair_format(file);
+    if (intpair) split_intpair_properties(props);
+
+    for (const auto& key : update.remove_props) props.erase(key);
+    for (auto it = update.set.begin(); it != update.set.end(); ++it) {
+        props[it->first] = it->second;
+    }
+    for (auto it = update.append.begin(); it != update.append.end(); ++it) {
+        props[it->first].append(it->second);
+    }
+
+    if (intpair) merge_intpair_properties(props);
+    apply_propmap(file, props);
+
+    for (const auto& key : update.remove_lists) clear_list_field(file, key.c_str());
+    if (patch.set) {
+        apply_pictures_from_msgpack(file, patch.set, patch.set_len);
+        apply_ratings_from_msgpack(file, patch.set, patch.set_len);
+        apply_lyrics_from_msgpack(file, patch.set, patch.set_len);
+        apply_chapters_from_msgpack(file, patch.set, patch.set_len);
+    }
+    if (update.append_pictures) {
+        // Decoding replaces the list; put the existing pictures back in front
+        TagLib::List<TagLib::VariantMap> existing = file->complexProperties("PICTURE");
+        apply_pictures_from_msgpack(file, patch.append, patch.append_len);
+        if (!existing.isEmpty()) {
+            existing.append(file->complexProperties("PICTURE"));
+            file->setComplexProperties("PICTURE", existing);
         }
-        apply_propmap(f, propMap);
-        apply_pictures_from_msgpack(f, tags_msgpack, tags_msgpack_len);
-        apply_ratings_from_msgpack(f, tags_msgpack, tags_msgpack_len);
-        apply_lyrics_from_msgpack(f, tags_msgpack, tags_msgpack_len);
-        apply_chapters_from_msgpack(f, tags_msgpack, tags_msgpack_len);
+    }
+}
+
+static tl_error_code update_file(const char* path, const uint8_t* buf, size_t len,
+                                 const uint8_t* patch_msgpack, size_t patch_msgpack_len,
+                                 uint8_t** out_buf, size_t* out_size,
+                                 uint8_t** out_tags, size_t* out_tags_size) {
+    TL_TRY {
+        UpdatePatch patch;
+        tl_error_code rc = decode_update_patch(patch_msgpack, patch_msgpack_len, &patch);
+        if (rc != TL_SUCCESS) return rc;
+        DecodedUpdate update;
+        rc = decode_update(patch, update);
+        if (rc != TL_SUCCESS) return rc;
 
+        auto edit = [&](TagLib::File* f) { apply_update(f, update, patch); };
+        auto touches = [&](const char* key) {
+            return (patch.set && msgpack_map_has_key(patch.set, patch.set_len, key)) ||
+                   std::find(update.remove_lists.begin(), update.remove_lists.end(),
+                             key) != update.remove_lists.end();
+        };
+        EditMode mode = edit_mode(out_tags != nullptr,
+                                  update.append_pictures || touches("pictures"),
+                                  touches("lyrics"));
+        if (path) return edit_path(path, edit, mode, out_tags, out_tags_size);
+        return edit_buffer(buf, len, edit, mode, out_buf, out_size, out_tags, out_tags_size);
+    } TL_CATCH_ALL {
+        return TL_ERROR_PARSE_FAILED;
+    }
+}
+
+// Runs the write against an overlay of the file or buffer, which absorbs
+// the save, and reports what the save would have cost.
+static tl_error_code estimate_write(TagLib::IOStream* base,
+                                    const uint8_t* buf, size_t len,
+                                    const uint8_t* tags_msgpack, size_t tags_msgpack_len,
+                                    tl_write_estimate* out) {
+    TL_TRY {
+        TagLib::PropertyMap propMap;
+        tl_error_code rc = decode_msgpack_to_propmap(tags_msgpack, tags_msgpack_len, propMap);
+        if (rc != TL_SUCCESS) return rc;
+
+        EditMode mode = edit_mode(false,
+            msgpack_map_has_key(tags_msgpack, tags_msgpack_len, "pictures"),
+            msgpack_map_has_key(tags_msgpack, tags_msgpack_len, "lyrics"));
+        OverlayStream stream(base);
+        std::unique_ptr<TagLib::File> file;
+        TagLib::FileRef ref_fallback;
+        TagLib::File* f = open_on_stream(&stream, buf, len, mode, file, ref_fallback);
+        if (!f) return TL_ERROR_PARSE_FAILED;
+
+        memset(out, 0, sizeof(*out));
+        out->file_size = static_cast<uint64_t>(stream.baseLength());
+        auto edit = [&](TagLib::File* edited) {
+            apply_write(edited, propMap, tags_msgpack, tags_msgpack_len);
+        };
+        if (!apply_tracked(f, edit, mode, nullptr, nullptr)) {
+            out->new_file_size = out->file_size;
+            out->fits_in_place = 1;
+            out->unchanged = 1;
+            return TL_SUCCESS;
+        }
         if (!f->save()) return TL_ERROR_IO_WRITE;
 
-        const TagLib::ByteVector* result = stream.data();
-        *out_size = result->size();
-        *out_buf = (uint8_t*)malloc(result->size());
-        if (!*out_buf) return TL_ERROR_MEMORY_ALLOCATION;
-        memcpy(*out_buf, result->data(), result->size());
+        TagLib::offset_t offset, old_size, new_size;
+        stream.changedRegion(&offset, &old_size, &new_size);
+        const OverlayStream::Cost& cost = stream.cost();
+        out->new_file_size = static_cast<uint64_t>(stream.length());
+        out->region_offset = static_cast<uint64_t>(offset);
+        out->region_size = static_cast<uint64_t>(old_size);
+        out->new_region_size = static_cast<uint64_t>(new_size);
+        out->bytes_moved = static_cast<uint64_t>(cost.bytes_moved);
+        out->bytes_read = static_cast<uint64_t>(cost.bytes_read);
+        out->bytes_written = static_cast<uint64_t>(cost.bytes_written);
+        out->fits_in_place = cost.bytes_moved == 0 ? 1 : 0;
+        if (stream.inPlace()) {
+            // Path writes take the same-size fast path
+            out->bytes_written = static_cast<uint64_t>(stream.patch(nullptr));
+        }
         return TL_SUCCESS;
-    } catch (...) {
+    } TL_CATCH_ALL {
+        return TL_ERROR_PARSE_FAILED;
+    }
+}
+
+static tl_error_code snapshot_path(const char* path, uint8_t** out_buf, size_t* out_size) {
+    TL_TRY {
+        TagLib::FileStream base(path, true);
+        if (!base.isOpen()) return TL_ERROR_IO_READ;
+
+        // Same detection as read_from_path, without the audio scan
+        const FormatHandler* handler = nullptr;
+        {
+            TagLib::FileRef ref(&base, false);
+            if (ref.isNull()) return TL_ERROR_PARSE_FAILED;
+            handler = find_format_handler(ref.file());
+        }
+        if (!handler) return TL_ERROR_UNSUPPORTED_FORMAT;
+
+        StructureSnapshot snapshot = make_structure_snapshot(handler->format, &base);
+        if (!handler->walkStructure || !handler->walkStructure(&base, &snapshot)) {
+            snapshot = make_structure_snapshot(handler->format, &base);
+            if (!walk_generic_structure(&base, &snapshot)) return TL_ERROR_IO_READ;
+        }
+        return encode_structure_snapshot(snapshot, out_buf, out_size);
+    } TL_CATCH_ALL {
         return TL_ERROR_PARSE_FAILED;
     }
 }
 
+static tl_error_code read_with_snapshot(const char* path,
+                                        const uint8_t* snapshot_data, size_t snapshot_len,
+                                        uint8_t** out_buf, size_t* out_size, bool* used) {
+    auto encode = [&](TagLib::File* file) {
+        return encode_file_to_msgpack(file, out_buf, out_size);
+    };
+    TL_TRY {
+        StructureSnapshot snapshot;
+        tl_error_code rc = decode_structure_snapshot(snapshot_data, snapshot_len, &snapshot);
+        if (rc != TL_SUCCESS) return rc;
+
+        TagLib::FileStream base(path, true);
+        if (!base.isOpen()) return TL_ERROR_IO_READ;
+
+        // Only the recorded headers are read and checked here, the payloads
+        // are read as the file is opened
+        ReplayStream replay(&base);
+        const FormatHandler* handler = find_format_handler(snapshot.format);
+        if (handler && replay.load(snapshot)) {
+            std::unique_ptr<TagLib::File> file;
+            if (handler->openStructure) file.reset(handler->openStructure(&replay, snapshot));
+            if (!file) file.reset(handler->create(&replay, true));
+            if (file && file->isValid()) {
+                *used = true;
+                return encode(file.get());
+            }
+        }
+    } TL_CATCH_ALL {
+        return TL_ERROR_PARSE_FAILED;
+    }
+
+    // Stale snapshot: the file changed, or TagLib did
+    return read_from_path(path, encode);
+}
+
 extern "C" {
 
 tl_error_code taglib_read_shim(const char* path, const uint8_t* buf, size_t len,
@@ -624,18 +1253,67 @@ tl_error_code taglib_read_shim(const char* path, const uint8_t* buf, size_t len,
     *out_buf = nullptr;
     *out_size = 0;
 
+    auto encode = [&](TagLib::File* file) {
+        return encode_file_to_msgpack(file, out_buf, out_size);
+    };
     if (path && path[0] != '\0') {
-        return read_from_path(path, out_buf, out_size);
+        return read_from_path(path, encode);
     } else if (buf && len > 0) {
-        return read_from_buffer(buf, len, format, out_buf, out_size);
+        return read_from_buffer(buf, len, format, encode);
     } else {
         return TL_ERROR_INVALID_INPUT;
     }
 }
 
+tl_error_code taglib_read_chunked_shim(const char* path, const uint8_t* buf, size_t len,
+                                       tl_format format, size_t chunk_size,
+                                       mp_write_fn write, void* ctx) {
+    if (!write || chunk_size < MP_CHUNK_MIN_SIZE) {
+        return TL_ERROR_INVALID_INPUT;
+    }
+
+    auto encode = [&](TagLib::File* file) {
+        return encode_file_to_chunks(file, chunk_size, write, ctx);
+    };
+    if (path && path[0] != '\0') {
+        return read_from_path(path, encode);
+    } else if (buf && len > 0) {
+        return read_from_buffer(buf, len, format, encode);
+    } else {
+        return TL_ERROR_INVALID_INPUT;
+    }
+}
+
+tl_error_code taglib_snapshot_shim(const char* path, uint8_t** out_buf, size_t* out_size) {
+    if (!path || path[0] == '\0' || !out_buf || !out_size) {
+        return TL_ERROR_INVALID_INPUT;
+    }
+    *out_buf = nullptr;
+    *out_size = 0;
+    return snapshot_path(path, out_buf, out_size);
+}
+
+tl_error_code taglib_read_snapshot_shim(const char* path,
+                                        const uint8_t* snapshot, size_t snapshot_len,
+                                        uint8_t** out_buf, size_t* out_size,
+                                        int* out_snapshot_used) {
+    if (!path || path[0] == '\0' || !snapshot || snapshot_len == 0 ||
+        !out_buf || !out_size) {
+        return TL_ERROR_INVALID_INPUT;
+    }
+    *out_buf = nullptr;
+    *out_size = 0;
+
+    bool used = false;
+    tl_error_code rc = read_with_snapshot(path, snapshot, snapshot_len, out_buf, out_size, &used);
+    if (out_snapshot_used) *out_snapshot_used = used ? 1 : 0;
+    return rc;
+}
+
 tl_error_code taglib_write_shim(const char* path, const uint8_t* buf, size_t len,
                                 const uint8_t* tags_msgpack, size_t tags_msgpack_len,
                                 uint8_t** out_buf, size_t* out_size) {
+    g_write_skipped = false;
     if (!tags_msgpack || tags_msgpack_len == 0) {
         return TL_ERROR_INVALID_INPUT;
     }
@@ -652,4 +1330,71 @@ tl_error_code taglib_write_shim(const char* path, const uint8_t* buf, size_t len
     }
 }
 
+tl_error_code taglib_update_shim(const char* path, const uint8_t* buf, size_t len,
+                                 const uint8_t* patch_msgpack, size_t patch_msgpack_len,
+                                 uint8_t** out_buf, size_t* out_size,
+                                 uint8_t** out_tags, size_t* out_tags_size) {
+    g_write_skipped = false;
+    if (!patch_msgpack || patch_msgpack_len == 0) {
+        return TL_ERROR_INVALID_INPUT;
+    }
+    if (out_tags) {
+        if (!out_tags_size) return TL_ERROR_INVALID_INPUT;
+        *out_tags = nullptr;
+        *out_tags_size = 0;
+    }
+
+    if (path && path[0] != '\0') {
+        return update_file(path, nullptr, 0, patch_msgpack, patch_msgpack_len,
+                           nullptr, nullptr, out_tags, out_tags_size);
+    } else if (buf && len > 0) {
+        if (!out_buf || !out_size) return TL_ERROR_INVALID_INPUT;
+        *out_buf = nullptr;
+        *out_size = 0;
+        return update_file(nullptr, buf, len, patch_msgpack, patch_msgpack_len,
+                           out_buf, out_size, out_tags, out_tags_size);
+    } else {
+        return TL_ERROR_INVALID_INPUT;
+    }
+}
+
+tl_error_code taglib_estimate_shim(const char* path, const uint8_t* buf, size_t len,
+                                   const uint8_t* tags_msgpack, size_t tags_msgpack_len,
+                                   tl_write_estimate* out) {
+    if (!tags_msgpack || tags_msgpack_len == 0 || !out) {
+        return TL_ERROR_INVALID_INPUT;
+    }
+
+    TL_TRY {
+        if (path && path[0] != '\0') {
+            // Read-only: the overlay takes every write
+            TagLib::FileStream base(path, true);
+            if (!base.isOpen()) return TL_ERROR_IO_READ;
+            return estimate_write(&base, nullptr, 0, tags_msgpack, tags_msgpack_len, out);
+        } else if (buf && len > 0) {
+            TagLib::ByteVectorStream base(
+                TagLib::ByteVector(reinterpret_cast<const char*>(buf),
+                                   static_cast<unsigned int>(len)));
+            return estimate_write(&base, buf, len, tags_msgpack, tags_msgpack_len, out);
+        } else {
+            return TL_ERROR_INVALID_INPUT;
+        }
+    } TL_CATCH_ALL {
+        return TL_ERROR_PARSE_FAILED;
+    }
+}
+
+int taglib_write_skipped_shim(void) {
+    return g_write_skipped ? 1 : 0;
+}
+
+void taglib_preinit_shim(void) {
+    TL_TRY {
+        key_table();  // also builds the interned keys
+        preinit_format_groups();
+    } TL_CATCH_ALL {
+        // Tables that failed to build are built again on first use
+    }
+}
+
 } // extern "C"
@@ -28,6 +28,48 @@ extern "C" {
 tl_error_code taglib_read_shim(const char* path, const uint8_t* buf, size_t len,
                                tl_format format, uint8_t** out_buf, size_t* out_size);
 
+/**
+ * Read tags through C++ shim, streaming the msgpack result in chunks
+ * @param path File path (NULL for buffer mode)
+ * @param buf Buffer data (NULL for file mode)
+ * @param len Buffer length
+ * @param format Format hint
+ * @param chunk_size Largest piece handed to write (at least MP_CHUNK_MIN_SIZE)
+ * @param write Receives the chunks in order; a short count aborts
+ * @param ctx Passed to write
+ * @return Error code
+ */
+tl_error_code taglib_read_chunked_shim(const char* path, const uint8_t* buf, size_t len,
+                                       tl_format format, size_t chunk_size,
+                                       mp_write_fn write, void* ctx);
+
+/**
+ * Record the structural snapshot of a file: the headers of its atoms,
+ * pages, metadata blocks, chunks or top level elements, its format and a
+ * digest of the header bytes
+ * @param path File path
+ * @param out_buf Snapshot msgpack (caller must free)
+ * @param out_size Snapshot size
+ * @return Error code
+ */
+tl_error_code taglib_snapshot_shim(const char* path, uint8_t** out_buf, size_t* out_size);
+
+/**
+ * Read tags, reopening the file from a structural snapshot when it still
+ * matches and the regular way when it is stale
+ * @param path File path
+ * @param snapshot Snapshot from taglib_snapshot_shim()
+ * @param snapshot_len Snapshot size
+ * @param out_buf Output buffer (caller must free)
+ * @param out_size Output buffer size
+ * @param out_snapshot_used Set to 1 if the snapshot was used (may be NULL)
+ * @return Error code
+ */
+tl_error_code taglib_read_snapshot_shim(const char* path,
+                                        const uint8_t* snapshot, size_t snapshot_len,
+                                        uint8_t** out_buf, size_t* out_size,
+                                        int* out_snapshot_used);
+
 /**
  * Write tags through C++ shim with exception handling
  * @param path File path (NULL for buffer mode)
@@ -43,6 +85,52 @@ tl_error_code taglib_write_shim(const char* path, const uint8_t* buf, size_t len
                                 const uint8_t* tags_msgpack, size_t tags_msgpack_len,
                                 uint8_t** out_buf, size_t* out_size);
 
+/**
+ * Update tags through C++ shim with exception handling
+ * @param path File path (NULL for buffer mode)
+ * @param buf Buffer data (NULL for file mode)
+ * @param len Buffer length
+ * @param patch_msgpack Raw msgpack bytes: {set?, append?, remove?}
+ * @param patch_msgpack_len Length of msgpack bytes
+ * @param out_buf Output buffer for buffer mode (caller must free)
+ * @param out_size Output buffer size
+ * @param out_tags Tags after the update, as read tags (NULL to skip; caller must free)
+ * @param out_tags_size Tags size
+ * @return Error code
+ */
+tl_error_code taglib_update_shim(const char* path, const uint8_t* buf, size_t len,
+                                 const uint8_t* patch_msgpack, size_t patch_msgpack_len,
+                                 uint8_t** out_buf, size_t* out_size,
+                                 uint8_t** out_tags, size_t* out_tags_size);
+
+/**
+ * Run a write without persisting it and report its cost
+ * @param path File path (NULL for buffer mode), opened read-only
+ * @param buf Buffer data (NULL for file mode)
+ * @param len Buffer length
+ * @param tags_msgpack Raw msgpack bytes encoding tag data
+ * @param tags_msgpack_len Length of msgpack bytes
+ * @param out Receives the estimate
+ * @return Error code
+ */
+tl_error_code taglib_estimate_shim(const char* path, const uint8_t* buf, size_t len,
+                                   const uint8_t* tags_msgpack, size_t tags_msgpack_len,
+                                   tl_write_estimate* out);
+
+/**
+ * Whether the last taglib_write_shim() or taglib_update_shim() call
+ * succeeded without saving because the tags already matched the request
+ * @return 1 if the save was skipped, 0 otherwise
+ */
+int taglib_write_skipped_shim(void);
+
+/**
+ * Build the tables TagLib and the shim otherwise construct on first use
+ * (interned property keys, key lookup table, per-format maps). Called by
+ * tl_preinitialize() before the module is snapshotted.
+ */
+void taglib_preinit_shim(void);
+
 #ifdef __cplusplus
 }
 #endif
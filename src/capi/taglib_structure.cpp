@@ -0,0 +1,273 @@
+#include "taglib_structure.h"
+
+#include <taglib.h>
+#include <mpack/mpack.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using TagLib::ByteVector;
+using TagLib::offset_t;
+
+static const uint32_t SNAPSHOT_VERSION = 2;
+
+static uint64_t fnv1a64(uint64_t h, const ByteVector& data) {
+    for (unsigned int i = 0; i < data.size(); i++) {
+        h = (h ^ static_cast<uint8_t>(data[i])) * 1099511628211ull;
+    }
+    return h;
+}
+
+static const uint64_t FNV64_OFFSET = 14695981039346656037ull;
+
+static uint32_t taglib_version() {
+    return TAGLIB_MAJOR_VERSION * 10000 + TAGLIB_MINOR_VERSION * 100 + TAGLIB_PATCH_VERSION;
+}
+
+// Upper bound of recorded headers; walks that need more fall back to the
+// generic snapshot
+static const size_t MAX_ENTRIES = 4096;
+
+// Gap between headers that one read on load spans, so that a run of small
+// neighbouring headers (a FLAC block chain, an atom path) costs one read
+static const offset_t MAX_GAP = 256;
+
+// Bytes the generic snapshot records at either end of the file
+static const size_t GENERIC_HEAD_SIZE = 64;
+static const size_t GENERIC_TAIL_SIZE = 128;
+
+// --- Snapshot building ---
+
+StructureSnapshot make_structure_snapshot(tl_format format, TagLib::IOStream* stream) {
+    return StructureSnapshot{taglib_version(), format,
+                             static_cast<uint64_t>(stream->length()), FNV64_OFFSET, {}};
+}
+
+ByteVector read_structure_bytes(TagLib::IOStream* stream, offset_t offset, size_t size) {
+    if (offset < 0 || offset >= stream->length()) return ByteVector();
+    stream->seek(offset);
+    return stream->readBlock(size);
+}
+
+bool add_structure_entry(StructureSnapshot* snapshot, uint32_t id,
+                         offset_t offset, const ByteVector& header) {
+    if (header.isEmpty() || snapshot->entries.size() >= MAX_ENTRIES) return false;
+    if (!snapshot->entries.empty()) {
+        const StructureEntry& last = snapshot->entries.back();
+        if (offset < last.offset + last.header_size) return false;
+    }
+    snapshot->entries.push_back(StructureEntry{id, offset, header.size()});
+    snapshot->digest = fnv1a64(snapshot->digest, header);
+    return true;
+}
+
+bool walk_generic_structure(TagLib::IOStream* stream, StructureSnapshot* snapshot) {
+    const offset_t length = stream->length();
+    if (!add_structure_entry(snapshot, 0, 0,
+                             read_structure_bytes(stream, 0, GENERIC_HEAD_SIZE))) {
+        return false;
+    }
+    const offset_t tail = length - static_cast<offset_t>(GENERIC_TAIL_SIZE);
+    if (tail >= static_cast<offset_t>(GENERIC_HEAD_SIZE)) {
+        return add_structure_entry(snapshot, 0, tail,
+                                   read_structure_bytes(stream, tail, GENERIC_TAIL_SIZE));
+    }
+    return true;
+}
+
+// --- ReplayStream ---
+
+ReplayStream::ReplayStream(TagLib::IOStream* base)
+    : base_(base), length_(base->length()), position_(0), misses_(0) {}
+
+bool ReplayStream::load(const StructureSnapshot& snapshot) {
+    if (snapshot.taglib_version != taglib_version()) return false;
+    if (static_cast<uint64_t>(length_) != snapshot.file_size) return false;
+    if (snapshot.entries.empty() || snapshot.entries.size() > MAX_ENTRIES) return false;
+
+    // Group the headers into runs, each fetched with one read
+    std::vector<std::pair<offset_t, offset_t>> runs;
+    offset_t end = 0;
+    for (const StructureEntry& e : snapshot.entries) {
+        // Entries are sorted and disjoint, which readBlock's lookup relies on
+        if (e.offset < end || e.header_size == 0 ||
+            e.offset + e.header_size > length_) {
+            return false;
+        }
+        end = e.offset + e.header_size;
+        if (!runs.empty() && e.offset <= runs.back().second + MAX_GAP) {
+            runs.back().second = end;
+        } else {
+            runs.emplace_back(e.offset, end);
+        }
+    }
+
+    std::vector<offset_t> offsets;
+    std::vector<ByteVector> data;
+    offsets.reserve(runs.size());
+    data.reserve(runs.size());
+    for (const auto& [run_offset, run_end] : runs) {
+        base_->seek(run_offset);
+        data.push_back(base_->readBlock(static_cast<size_t>(run_end - run_offset)));
+        if (static_cast<offset_t>(data.back().size()) != run_end - run_offset) return false;
+        offsets.push_back(run_offset);
+    }
+
+    // Only the header bytes count, the gaps a run spans may be payload
+    uint64_t digest = FNV64_OFFSET;
+    size_t run = 0;
+    for (const StructureEntry& e : snapshot.entries) {
+        while (e.offset >= offsets[run] + static_cast<offset_t>(data[run].size())) run++;
+        digest = fnv1a64(digest, data[run].mid(static_cast<unsigned int>(e.offset - offsets[run]),
+                                               e.header_size));
+    }
+    if (digest != snapshot.digest) return false;
+
+    offsets_.swap(offsets);
+    data_.swap(data);
+    return true;
+}
+
+TagLib::FileName ReplayStream::name() const {
+    return base_->name();
+}
+
+ByteVector ReplayStream::readBlock(size_t length) {
+    offset_t end = std::min(position_ + static_cast<offset_t>(length), length_);
+    if (end <= position_) return ByteVector();
+
+    auto it = std::upper_bound(offsets_.begin(), offsets_.end(), position_);
+    if (it != offsets_.begin()) {
+        size_t i = static_cast<size_t>(it - offsets_.begin()) - 1;
+        if (end <= offsets_[i] + static_cast<offset_t>(data_[i].size())) {
+            ByteVector out = data_[i].mid(static_cast<unsigned int>(position_ - offsets_[i]),
+                                          static_cast<unsigned int>(end - position_));
+            position_ = end;
+            return out;
+        }
+    }
+
+    misses_++;
+    base_->seek(position_);
+    ByteVector out = base_->readBlock(length);
+    position_ += out.size();
+    return out;
+}
+
+void ReplayStream::writeBlock(const ByteVector&) {}
+
+void ReplayStream::insert(const ByteVector&, offset_t, size_t) {}
+
+void ReplayStream::removeBlock(offset_t, size_t) {}
+
+bool ReplayStream::readOnly() const {
+    return true;
+}
+
+bool ReplayStream::isOpen() const {
+    return base_->isOpen();
+}
+
+void ReplayStream::seek(offset_t offset, Position p) {
+    switch (p) {
+        case Beginning: position_ = offset; break;
+        case Current: position_ += offset; break;
+        case End: position_ = length_ + offset; break;
+    }
+    if (position_ < 0) position_ = 0;
+}
+
+void ReplayStream::clear() {
+    base_->clear();
+}
+
+offset_t ReplayStream::tell() const {
+    return position_;
+}
+
+offset_t ReplayStream::length() {
+    return length_;
+}
+
+void ReplayStream::truncate(offset_t) {}
+
+// --- Wire format ---
+
+tl_error_code encode_structure_snapshot(const StructureSnapshot& snapshot,
+                                        uint8_t** out_buf, size_t* out_size) {
+    mpack_writer_t writer;
+    char* data = nullptr;
+    size_t size = 0;
+    mpack_writer_init_growable(&writer, &data, &size);
+
+    mpack_start_map(&writer, 6);
+    mpack_write_cstr(&writer, "v");
+    mpack_write_uint(&writer, SNAPSHOT_VERSION);
+    mpack_write_cstr(&writer, "taglib");
+    mpack_write_uint(&writer, snapshot.taglib_version);
+    mpack_write_cstr(&writer, "format");
+    mpack_write_uint(&writer, static_cast<uint32_t>(snapshot.format));
+    mpack_write_cstr(&writer, "size");
+    mpack_write_uint(&writer, snapshot.file_size);
+    mpack_write_cstr(&writer, "digest");
+    mpack_write_uint(&writer, snapshot.digest);
+    mpack_write_cstr(&writer, "entries");
+    mpack_start_array(&writer, static_cast<uint32_t>(snapshot.entries.size() * 3));
+    for (const StructureEntry& e : snapshot.entries) {
+        mpack_write_uint(&writer, e.id);
+        mpack_write_uint(&writer, static_cast<uint64_t>(e.offset));
+        mpack_write_uint(&writer, e.header_size);
+    }
+    mpack_finish_array(&writer);
+    mpack_finish_map(&writer);
+
+    if (mpack_writer_destroy(&writer) != mpack_ok) return TL_ERROR_SERIALIZE_FAILED;
+    *out_buf = reinterpret_cast<uint8_t*>(data);
+    *out_size = size;
+    return TL_SUCCESS;
+}
+
+tl_error_code decode_structure_snapshot(const uint8_t* data, size_t len,
+                                        StructureSnapshot* snapshot) {
+    mpack_reader_t reader;
+    mpack_reader_init_data(&reader, reinterpret_cast<const char*>(data), len);
+
+    uint64_t version = 0;
+    *snapshot = StructureSnapshot{0, TL_FORMAT_AUTO, 0, 0, {}};
+    uint32_t count = mpack_expect_map(&reader);
+    for (uint32_t i = 0; i < count && mpack_reader_error(&reader) == mpack_ok; i++) {
+        char key[16];
+        mpack_expect_cstr(&reader, key, sizeof(key));
+        if (mpack_reader_error(&reader) != mpack_ok) break;
+
+        if (strcmp(key, "v") == 0) {
+            version = mpack_expect_u64(&reader);
+        } else if (strcmp(key, "taglib") == 0) {
+            snapshot->taglib_version = mpack_expect_u32(&reader);
+        } else if (strcmp(key, "format") == 0) {
+            snapshot->format = static_cast<tl_format>(mpack_expect_u32(&reader));
+        } else if (strcmp(key, "size") == 0) {
+            snapshot->file_size = mpack_expect_u64(&reader);
+        } else if (strcmp(key, "digest") == 0) {
+            snapshot->digest = mpack_expect_u64(&reader);
+        } else if (strcmp(key, "entries") == 0) {
+            uint32_t n = mpack_expect_array(&reader);
+            if (n % 3 != 0 || n / 3 > MAX_ENTRIES) mpack_reader_flag_error(&reader, mpack_error_data);
+            for (uint32_t j = 0; j + 2 < n && mpack_reader_error(&reader) == mpack_ok; j += 3) {
+                uint32_t id = mpack_expect_u32(&reader);
+                offset_t offset = static_cast<offset_t>(mpack_expect_u64(&reader));
+                uint32_t header_size = mpack_expect_u32(&reader);
+                snapshot->entries.push_back(StructureEntry{id, offset, header_size});
+            }
+            mpack_done_array(&reader);
+        } else {
+            mpack_discard(&reader);
+        }
+    }
+    mpack_done_map(&reader);
+
+    bool ok = mpack_reader_destroy(&reader) == mpack_ok;
+    if (!ok || version != SNAPSHOT_VERSION) return TL_ERROR_INVALID_INPUT;
+    return TL_SUCCESS;
+}
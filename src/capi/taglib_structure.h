@@ -0,0 +1,98 @@
+#ifndef TAGLIB_STRUCTURE_H
+#define TAGLIB_STRUCTURE_H
+
+#include "core/taglib_core.h"
+
+#ifdef __cplusplus
+
+#include <tiostream.h>
+#include <tbytevector.h>
+
+#include <vector>
+
+// Structural snapshot of a file: the headers of the structure TagLib
+// walks to open it (MP4 atom tree, Ogg page table, FLAC metadata block
+// chain, DSDIFF chunk table, Matroska top level elements), the format it
+// was opened as, and a digest of the header bytes. Checking a snapshot
+// reads the headers only, never payloads such as cover art or audio.
+// Reopening with a valid snapshot skips format detection and serves the
+// header reads from memory; formats whose File accepts the recorded
+// structure (Matroska) also skip the scan for it.
+struct StructureEntry {
+    uint32_t id;              // atom type, EBML ID, chunk ID, block type or page sequence
+    TagLib::offset_t offset;
+    uint32_t header_size;
+};
+
+struct StructureSnapshot {
+    uint32_t taglib_version;  // layout discovery may change between releases
+    tl_format format;
+    uint64_t file_size;
+    uint64_t digest;          // FNV-1a 64 over the header bytes, in order
+    std::vector<StructureEntry> entries;  // in file order, disjoint
+};
+
+// An empty snapshot of stream, opened as format.
+StructureSnapshot make_structure_snapshot(tl_format format, TagLib::IOStream* stream);
+
+// Reads size bytes at offset; shorter if the file ends before.
+TagLib::ByteVector read_structure_bytes(TagLib::IOStream* stream,
+                                        TagLib::offset_t offset, size_t size);
+
+// Appends the header at offset and adds its bytes to the digest. False if
+// it overlaps the previous entry or the snapshot is full.
+bool add_structure_entry(StructureSnapshot* snapshot, uint32_t id,
+                         TagLib::offset_t offset, const TagLib::ByteVector& header);
+
+// Records the first and last bytes of the file, for formats without a
+// structure walker or whose walk failed.
+bool walk_generic_structure(TagLib::IOStream* stream, StructureSnapshot* snapshot);
+
+// Read-only stream that serves reads from a snapshot's headers, loaded
+// up front, and falls back to the base stream for anything else.
+class ReplayStream : public TagLib::IOStream {
+public:
+    explicit ReplayStream(TagLib::IOStream* base);
+
+    // Reads the snapshot's headers from the base, neighbouring ones in one
+    // read, and checks the file size and digest. False means the snapshot
+    // is stale.
+    bool load(const StructureSnapshot& snapshot);
+
+    TagLib::FileName name() const override;
+    TagLib::ByteVector readBlock(size_t length) override;
+    void writeBlock(const TagLib::ByteVector& data) override;
+    void insert(const TagLib::ByteVector& data,
+                TagLib::offset_t start = 0, size_t replace = 0) override;
+    void removeBlock(TagLib::offset_t start = 0, size_t length = 0) override;
+    bool readOnly() const override;
+    bool isOpen() const override;
+    void seek(TagLib::offset_t offset, Position p = Beginning) override;
+    void clear() override;
+    TagLib::offset_t tell() const override;
+    TagLib::offset_t length() override;
+    void truncate(TagLib::offset_t length) override;
+
+    // Reads the loaded headers did not cover
+    size_t misses() const { return misses_; }
+
+private:
+    TagLib::IOStream* base_;
+    // Runs of neighbouring headers, with the bytes between them
+    std::vector<TagLib::offset_t> offsets_;
+    std::vector<TagLib::ByteVector> data_;
+    TagLib::offset_t length_;
+    TagLib::offset_t position_;
+    size_t misses_;
+};
+
+// Snapshot wire format: msgpack map {"v", "taglib", "format", "size",
+// "digest", "entries": [id, offset, header_size, ...]}.
+tl_error_code encode_structure_snapshot(const StructureSnapshot& snapshot,
+                                        uint8_t** out_buf, size_t* out_size);
+tl_error_code decode_structure_snapshot(const uint8_t* data, size_t len,
+                                        StructureSnapshot* snapshot);
+
+#endif
+
+#endif // TAGLIB_STRUCTURE_H
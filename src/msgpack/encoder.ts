@@ -7,6 +7,7 @@ import type {
   ExtendedTag,
   Picture,
   PropertyMap,
+  TagPatch,
 } from "../types.ts";
 import { toTagLibKey } from "../constants/properties.ts";
 
@@ -21,17 +22,21 @@ const MSGPACK_ENCODE_OPTIONS: EncoderOptions = {
   extensionCodec: undefined,
 };
 
+function remapTagKeys(tagData: ExtendedTag): Record<string, unknown> {
+  const remapped: Record<string, unknown> = {};
+  for (const [key, value] of Object.entries(tagData)) {
+    if (PASSTHROUGH_KEYS.has(key)) {
+      remapped[key] = value;
+    } else {
+      remapped[toTagLibKey(key)] = value;
+    }
+  }
+  return remapped;
+}
+
 export function encodeTagData(tagData: ExtendedTag): Uint8Array {
   try {
-    const remapped: Record<string, unknown> = {};
-    for (const [key, value] of Object.entries(tagData)) {
-      if (PASSTHROUGH_KEYS.has(key)) {
-        remapped[key] = value;
-      } else {
-        remapped[toTagLibKey(key)] = value;
-      }
-    }
-    return encode(cleanObject(remapped), MSGPACK_ENCODE_OPTIONS);
+    return encode(cleanObject(remapTagKeys(tagData)), MSGPACK_ENCODE_OPTIONS);
   } catch (error) {
     throw new MetadataError(
       "write",
@@ -40,6 +45,25 @@ export function encodeTagData(tagData: ExtendedTag): Uint8Array {
   }
 }
 
+export function encodeTagPatch(patch: TagPatch): Uint8Array {
+  try {
+    const wire: Record<string, unknown> = {};
+    if (patch.set) wire.set = cleanObject(remapTagKeys(patch.set));
+    if (patch.append) wire.append = cleanObject(remapTagKeys(patch.append));
+    if (patch.remove) {
+      wire.remove = patch.remove.map((key) =>
+        PASSTHROUGH_KEYS.has(key) ? key : toTagLibKey(key)
+      );
+    }
+    return encode(wire, MSGPACK_ENCODE_OPTIONS);
+  } catch (error) {
+    throw new MetadataError(
+      "write",
+      `Failed to encode tag patch: ${errorMessage(error)}`,
+    );
+  }
+}
+
 export function encodeAudioProperties(audioProps: AudioProperties): Uint8Array {
   try {
     return encode(cleanObject(audioProps), MSGPACK_ENCODE_OPTIONS);
@@ -188,6 +188,30 @@ export function supportsExnref(): boolean {
   }
 }
 
+// deno-fmt-ignore
+const SIMD_PROBE = new Uint8Array([
+  0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, // Wasm header
+  0x06, 0x16,                                       // Global section, 22 bytes
+  0x01,                                             // 1 global
+  0x7b, 0x00,                                       // v128, const
+  0xfd, 0x0c,                                       // v128.const
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x0b,                                             // end
+]);
+
+/**
+ * Detect whether the runtime supports Wasm fixed-width SIMD (simd128).
+ * Uses the same validation approach as `supportsExnref()`.
+ */
+export function supportsSimd(): boolean {
+  try {
+    return WebAssembly.validate(SIMD_PROBE);
+  } catch {
+    return false;
+  }
+}
+
 export function getEnvironmentDescription(env: RuntimeEnvironment): string {
   switch (env) {
     case "deno-wasi":
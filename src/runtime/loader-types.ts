@@ -32,4 +32,11 @@ export interface LoadTagLibOptions {
    * @default false
    */
   disableOptimizations?: boolean;
+
+  /**
+   * Prefer the SIMD build of the WASI module when the runtime supports
+   * Wasm SIMD and the binary is available. Ignored when `wasmUrl` is set.
+   * @default true
+   */
+  simd?: boolean;
 }
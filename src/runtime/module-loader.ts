@@ -41,6 +41,9 @@ import { checkNodeVersion } from "./detector.ts";
  * // Force WASI mode (Deno/Node.js only)
  * const module = await loadTagLibModule({ forceWasmType: "wasi" });
  *
+ * // Use the portable WASI binary even where Wasm SIMD is supported
+ * const module = await loadTagLibModule({ simd: false });
+ *
  * // With custom WASM binary
  * const wasmData = await fetch("taglib.wasm").then(r => r.arrayBuffer());
  * const module = await loadTagLibModule({ wasmBinary: wasmData });
@@ -91,6 +94,7 @@ export async function loadTagLibModule(
       wasmBinary: options?.wasmBinary,
       wasmUrl: options?.wasmUrl,
       forceWasmType: options?.forceWasmType,
+      simd: options?.simd,
       debug: false,
     });
   } catch (error) {
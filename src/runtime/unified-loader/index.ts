@@ -2,3 +2,12 @@ export { ModuleLoadError, UnifiedLoaderError } from "./types.ts";
 export type { UnifiedLoaderOptions, UnifiedTagLibModule } from "./types.ts";
 export { getRecommendedConfig, isWasiAvailable } from "./module-selection.ts";
 export { loadUnifiedTagLibModule } from "./loader.ts";
+export {
+  createRecyclingWasiModule,
+  readHeapReport,
+} from "./instance-recycling.ts";
+export type {
+  HeapReport,
+  InstanceRecyclingOptions,
+  RecyclingWasiModule,
+} from "./instance-recycling.ts";
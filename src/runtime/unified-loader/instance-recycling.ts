@@ -0,0 +1,263 @@
+/**
+ * @fileoverview Instance recycling for long-lived WASI modules
+ *
+ * Wasm linear memory never shrinks: after one large buffer-mode file an
+ * instance keeps that heap for the rest of its life. The recycling module
+ * forwards every call to a current instance and, when that instance's
+ * memory exceeds `maxHeapBytes`, retires it and instantiates a fresh one
+ * from the already compiled module (a pre-initialized snapshot when the
+ * build ran Wizer, so the swap costs one instantiation).
+ *
+ * Instances hold no state between operations (file handles keep their
+ * data on the JS side), so a swap is safe whenever the host owns no
+ * pointer into the old instance. The module therefore tracks pointers it
+ * handed out (malloc results, tl_read_tags results, tl_write_tags output
+ * buffers) and only swaps at the start of an operation, once all of them
+ * have been freed.
+ */
+
+import type { WasiModule } from "../wasmer-sdk-loader/types.ts";
+import type { WasiHostFactory } from "../wasi-host-loader.ts";
+
+export interface HeapReport {
+  /** Linear memory size */
+  memoryBytes: number;
+  /** Start of the malloc heap */
+  heapBase: number;
+  /** Linear memory above heapBase */
+  heapBytes: number;
+  /** Bytes in live allocations, 0 if the build has no allocation stats */
+  liveBytes: number;
+  /** High-water mark of liveBytes (sampled per report with mallinfo) */
+  peakLiveBytes: number;
+  /** Share of heapBytes not in live allocations, 0-1 (0 if unknown) */
+  fragmentation: number;
+}
+
+export interface InstanceRecyclingOptions {
+  /** Retire the instance once its linear memory exceeds this many bytes */
+  maxHeapBytes: number;
+  /** Log each recycle */
+  debug?: boolean;
+}
+
+export interface RecyclingWasiModule extends WasiModule, Disposable {
+  /** Number of instances retired so far */
+  readonly recycleCount: number;
+  /** Heap report of the current instance, if the module exports one */
+  heapReport(): HeapReport | undefined;
+}
+
+const HEAP_STATS_SIZE = 6 * 4;
+
+/**
+ * Read tl_heap_report() of a WASI module. Returns undefined for modules
+ * built before the export existed.
+ */
+export function readHeapReport(wasi: WasiModule): HeapReport | undefined {
+  if (!wasi.tl_heap_report) return undefined;
+  const ptr = wasi.malloc(HEAP_STATS_SIZE);
+  if (!ptr) return undefined;
+  try {
+    if (wasi.tl_heap_report(ptr) !== 0) return undefined;
+    const view = new DataView(wasi.memory.buffer, ptr, HEAP_STATS_SIZE);
+    const field = (index: number) => view.getUint32(index * 4, true);
+    return {
+      memoryBytes: field(0),
+      heapBase: field(1),
+      heapBytes: field(2),
+      liveBytes: field(3),
+      peakLiveBytes: field(4),
+      fragmentation: field(5) / 1000,
+    };
+  } finally {
+    wasi.free(ptr);
+  }
+}
+
+export function createRecyclingWasiModule(
+  factory: WasiHostFactory,
+  options: InstanceRecyclingOptions,
+): RecyclingWasiModule {
+  let current = factory.instantiate();
+  let recycleCount = 0;
+  // Pointers into the current instance the host has not freed yet
+  const outstanding = new Set<number>();
+  // Chunk sinks are registered before the read that may recycle, so they
+  // are kept here and handed to each new instance
+  const chunkSinks = new Map<number, (chunk: Uint8Array) => boolean>();
+
+  // Called at the start of every operation, never between a call and the
+  // reads or frees that follow it.
+  function maybeRecycle(): void {
+    if (outstanding.size > 0) return;
+    const memoryBytes = current.memory.buffer.byteLength;
+    if (memoryBytes <= options.maxHeapBytes) return;
+    if (options.debug) {
+      const report = readHeapReport(current);
+      const live = report ? `, ${report.liveBytes} bytes live` : "";
+      console.log(
+        `[UnifiedLoader] Recycling WASI instance: ${memoryBytes} bytes of memory${live}`,
+      );
+    }
+    current[Symbol.dispose]();
+    current = factory.instantiate();
+    for (const [streamId, sink] of chunkSinks) {
+      current.setChunkSink?.(streamId, sink);
+    }
+    recycleCount++;
+  }
+
+  function track(ptr: number): number {
+    if (ptr) outstanding.add(ptr);
+    return ptr;
+  }
+
+  return {
+    get recycleCount() {
+      return recycleCount;
+    },
+    get memory() {
+      return current.memory;
+    },
+    heapReport: () => readHeapReport(current),
+    tl_version: () => current.tl_version(),
+    tl_api_version: () => current.tl_api_version(),
+    malloc: (size) => {
+      maybeRecycle();
+      return track(current.malloc(size));
+    },
+    free: (ptr) => {
+      outstanding.delete(ptr);
+      current.free(ptr);
+    },
+    tl_read_tags: (pathPtr, bufPtr, len, outSizePtr) => {
+      maybeRecycle();
+      return track(current.tl_read_tags(pathPtr, bufPtr, len, outSizePtr));
+    },
+    tl_read_tags_chunked: (
+      pathPtr,
+      bufPtr,
+      len,
+      format,
+      chunkSize,
+      streamId,
+    ) => {
+      maybeRecycle();
+      return current.tl_read_tags_chunked?.(
+        pathPtr,
+        bufPtr,
+        len,
+        format,
+        chunkSize,
+        streamId,
+      ) ?? -99;
+    },
+    tl_snapshot_structure: (pathPtr, outBufPtr, outSizePtr) => {
+      maybeRecycle();
+      const result = current.tl_snapshot_structure?.(
+        pathPtr,
+        outBufPtr,
+        outSizePtr,
+      ) ?? -99;
+      if (result === 0 && outBufPtr) {
+        track(new DataView(current.memory.buffer).getUint32(outBufPtr, true));
+      }
+      return result;
+    },
+    tl_read_tags_snapshot: (
+      pathPtr,
+      snapshotPtr,
+      snapshotSize,
+      outSizePtr,
+      outUsedPtr,
+    ) => {
+      maybeRecycle();
+      return track(
+        current.tl_read_tags_snapshot?.(
+          pathPtr,
+          snapshotPtr,
+          snapshotSize,
+          outSizePtr,
+          outUsedPtr,
+        ) ?? 0,
+      );
+    },
+    setChunkSink: (streamId, sink) => {
+      if (sink) chunkSinks.set(streamId, sink);
+      else chunkSinks.delete(streamId);
+      current.setChunkSink?.(streamId, sink);
+    },
+    tl_write_tags: (
+      pathPtr,
+      bufPtr,
+      len,
+      tagsPtr,
+      tagsSize,
+      outBufPtr,
+      outSizePtr,
+    ) => {
+      maybeRecycle();
+      const result = current.tl_write_tags(
+        pathPtr,
+        bufPtr,
+        len,
+        tagsPtr,
+        tagsSize,
+        outBufPtr,
+        outSizePtr,
+      );
+      if (result === 0 && outBufPtr) {
+        track(new DataView(current.memory.buffer).getUint32(outBufPtr, true));
+      }
+      return result;
+    },
+    tl_update_tags: (
+      pathPtr,
+      bufPtr,
+      len,
+      patchPtr,
+      patchSize,
+      outBufPtr,
+      outSizePtr,
+      outTagsPtr,
+      outTagsSizePtr,
+    ) => {
+      maybeRecycle();
+      const result = current.tl_update_tags?.(
+        pathPtr,
+        bufPtr,
+        len,
+        patchPtr,
+        patchSize,
+        outBufPtr,
+        outSizePtr,
+        outTagsPtr,
+        outTagsSizePtr,
+      ) ?? -99;
+      if (result === 0) {
+        const view = new DataView(current.memory.buffer);
+        if (outBufPtr) track(view.getUint32(outBufPtr, true));
+        if (outTagsPtr) track(view.getUint32(outTagsPtr, true));
+      }
+      return result;
+    },
+    tl_write_skipped: () => current.tl_write_skipped?.() ?? 0,
+    tl_estimate_write: (pathPtr, bufPtr, len, tagsPtr, tagsSize, outPtr) => {
+      maybeRecycle();
+      return current.tl_estimate_write?.(
+        pathPtr,
+        bufPtr,
+        len,
+        tagsPtr,
+        tagsSize,
+        outPtr,
+      ) ?? -99;
+    },
+    tl_get_last_error: () => current.tl_get_last_error(),
+    tl_get_last_error_code: () => current.tl_get_last_error_code(),
+    tl_clear_error: () => current.tl_clear_error(),
+    tl_heap_report: (statsPtr) => current.tl_heap_report?.(statsPtr) ?? -1,
+    [Symbol.dispose]: () => current[Symbol.dispose](),
+  };
+}
@@ -4,6 +4,10 @@ import type { TagLibModule } from "../../wasm.ts";
 import type { UnifiedLoaderOptions, UnifiedTagLibModule } from "./types.ts";
 import { selectWasmType } from "./module-selection.ts";
 import { loadModule } from "./module-loading.ts";
+import {
+  readHeapReport,
+  type RecyclingWasiModule,
+} from "./instance-recycling.ts";
 
 export async function loadUnifiedTagLibModule(
   options: UnifiedLoaderOptions = {},
@@ -65,6 +69,10 @@ async function createUnifiedModule(
         wasmType: "wasi" as const,
         environment: runtime.environment,
         memoryUsage: wasiModule.memory.buffer.byteLength,
+        instanceRecycles: "recycleCount" in wasiModule
+          ? (wasiModule as RecyclingWasiModule).recycleCount
+          : undefined,
+        heap: readHeapReport(wasiModule),
       }),
     }) as UnifiedTagLibModule;
   } else {
@@ -1,6 +1,7 @@
 import type { RuntimeDetectionResult } from "../detector.ts";
-import { supportsExnref } from "../detector.ts";
+import { supportsExnref, supportsSimd } from "../detector.ts";
 import type { TagLibModule } from "../../wasm.ts";
+import type { WasiModule } from "../wasmer-sdk-loader/types.ts";
 import type { LoadModuleResult, UnifiedLoaderOptions } from "./types.ts";
 import { ModuleLoadError } from "./types.ts";
 import { errorMessage } from "../../errors/classes.ts";
@@ -43,6 +44,40 @@ function resolveWasmPath(relativePath: string): string {
   return url.protocol === "file:" ? fileUrlToPath(url) : url.href;
 }
 
+/**
+ * WASI binaries to try, in order. The SIMD build comes first when the
+ * runtime validates SIMD code; the portable build is always the fallback,
+ * so a missing SIMD binary only costs one failed read.
+ */
+export function wasiBinaryCandidates(
+  options: UnifiedLoaderOptions,
+  simdSupported = supportsSimd(),
+): string[] {
+  if (options.wasmUrl) return [options.wasmUrl];
+  const portable = resolveWasmPath("../../../build/taglib_wasi.wasm");
+  if (options.simd === false || !simdSupported) return [portable];
+  return [resolveWasmPath("../../../build/taglib_wasi_simd.wasm"), portable];
+}
+
+async function loadWasiInstance(
+  wasmPath: string,
+  options: UnifiedLoaderOptions,
+): Promise<WasiModule> {
+  const config = { wasmPath, preopens: getPreopens() };
+  if (options.maxHeapBytes === undefined) {
+    const { loadWasiHost } = await import("../wasi-host-loader.ts");
+    return await loadWasiHost(config);
+  }
+  const { createWasiHostFactory } = await import("../wasi-host-loader.ts");
+  const { createRecyclingWasiModule } = await import(
+    "./instance-recycling.ts"
+  );
+  return createRecyclingWasiModule(await createWasiHostFactory(config), {
+    maxHeapBytes: options.maxHeapBytes,
+    debug: options.debug,
+  });
+}
+
 export async function loadModule(
   wasmType: "wasi" | "emscripten",
   runtime: RuntimeDetectionResult,
@@ -62,29 +97,34 @@ async function loadWasiModuleWithFallback(
   runtime: RuntimeDetectionResult,
   options: UnifiedLoaderOptions,
 ): Promise<LoadModuleResult> {
-  const defaultWasmPath = resolveWasmPath("../../../build/taglib_wasi.wasm");
-
   // Strategy 1: In-process WASI host (Deno, Node, Bun — no external deps)
-  try {
-    const { loadWasiHost } = await import("../wasi-host-loader.ts");
-    const wasiModule = await loadWasiHost({
-      wasmPath: options.wasmUrl || defaultWasmPath,
-      preopens: getPreopens(),
-    });
-    return { module: wasiModule, actualWasmType: "wasi" };
-  } catch (hostError) {
-    if (runtime.environment === "node-wasi" && !supportsExnref()) {
-      const g = globalThis as Record<string, unknown>;
-      const nodeVersion = ((g.process as any)?.versions?.node ?? "") as string;
-      console.warn(
-        `[taglib-wasm] WASI unavailable: Node.js ${nodeVersion} requires --experimental-wasm-exnref. ` +
-          `Falling back to Emscripten. Run with: node --experimental-wasm-exnref your-script.js`,
-      );
-    } else if (options.debug) {
-      console.warn(`[UnifiedLoader] WASI host failed:`, hostError);
+  let hostError: unknown;
+  for (const wasmPath of wasiBinaryCandidates(options)) {
+    try {
+      const wasiModule = await loadWasiInstance(wasmPath, options);
+      if (options.debug) {
+        console.log(`[UnifiedLoader] Loaded WASI binary ${wasmPath}`);
+      }
+      return { module: wasiModule, actualWasmType: "wasi" };
+    } catch (error) {
+      hostError = error;
+      if (options.debug) {
+        console.warn(`[UnifiedLoader] Could not load ${wasmPath}:`, error);
+      }
     }
   }
 
+  if (runtime.environment === "node-wasi" && !supportsExnref()) {
+    const g = globalThis as Record<string, unknown>;
+    const nodeVersion = ((g.process as any)?.versions?.node ?? "") as string;
+    console.warn(
+      `[taglib-wasm] WASI unavailable: Node.js ${nodeVersion} requires --experimental-wasm-exnref. ` +
+        `Falling back to Emscripten. Run with: node --experimental-wasm-exnref your-script.js`,
+    );
+  } else if (options.debug) {
+    console.warn(`[UnifiedLoader] WASI host failed:`, hostError);
+  }
+
   // Strategy 2: Emscripten fallback
   if (options.debug) {
     console.warn(`[UnifiedLoader] WASI loader failed, using Emscripten`);
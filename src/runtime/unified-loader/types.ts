@@ -1,6 +1,7 @@
 import type { RuntimeDetectionResult } from "../detector.ts";
 import type { WasiModule } from "../wasmer-sdk-loader/types.ts";
 import type { TagLibModule } from "../../wasm.ts";
+import type { HeapReport } from "./instance-recycling.ts";
 import { TagLibError } from "../../errors/base.ts";
 
 export class UnifiedLoaderError extends TagLibError {
@@ -36,6 +37,14 @@ export interface UnifiedLoaderOptions {
   wasmUrl?: string;
   /** Enable debug output */
   debug?: boolean;
+  /** Prefer the SIMD WASI binary when supported (default: true) */
+  simd?: boolean;
+  /**
+   * Retire the WASI instance and start a fresh one when its linear memory
+   * exceeds this many bytes between calls (default: never). Wasm memory
+   * never shrinks, so this bounds the footprint of long-running scanners.
+   */
+  maxHeapBytes?: number;
 }
 
 export interface UnifiedTagLibModule extends TagLibModule {
@@ -54,6 +63,10 @@ export interface PerformanceMetrics {
   wasmType: "wasi" | "emscripten";
   environment: string;
   memoryUsage?: number;
+  /** WASI instances retired because of maxHeapBytes */
+  instanceRecycles?: number;
+  /** Heap report of the current WASI instance */
+  heap?: HeapReport;
 }
 
 export interface LoadModuleResult {
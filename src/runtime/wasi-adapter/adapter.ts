@@ -13,11 +13,15 @@ import { WasiFileHandle } from "./file-handle.ts";
 
 export class WasiToTagLibAdapter implements TagLibModule {
   private readonly wasi: WasiModule;
-  private readonly heap: Uint8Array;
 
   constructor(wasiModule: WasiModule) {
     this.wasi = wasiModule;
-    this.heap = new Uint8Array(wasiModule.memory.buffer);
+  }
+
+  // Fresh view on every access: memory grows, and a recycling module
+  // swaps the instance behind it
+  private get heap(): Uint8Array {
+    return new Uint8Array(this.wasi.memory.buffer);
   }
 
   FileHandle = class {
@@ -14,6 +14,7 @@ import { WasmerExecutionError } from "../wasmer-sdk-loader/types.ts";
 import { decodeTagData } from "../../msgpack/decoder.ts";
 import { fromTagLibKey, toTagLibKey } from "../../constants/properties.ts";
 import {
+  lastWriteSkipped,
   readTagsFromWasm,
   readTagsFromWasmPath,
   writeTagsToWasm,
@@ -68,6 +69,7 @@ export class WasiFileHandle implements FileHandle {
   private filePath: string | null = null;
   private tagData: Record<string, unknown> | null = null;
   private destroyed = false;
+  private lastSaveSkipped = false;
 
   constructor(wasiModule: WasiModule) {
     this.wasi = wasiModule;
@@ -111,25 +113,34 @@ export class WasiFileHandle implements FileHandle {
 
   save(): boolean {
     this.checkNotDestroyed();
+    this.lastSaveSkipped = false;
     if (!this.tagData) return false;
 
     if (this.filePath) {
-      return writeTagsToWasmPath(
+      writeTagsToWasmPath(
         this.wasi,
         this.filePath,
         this.tagData as import("../../types.ts").ExtendedTag,
       );
+      this.lastSaveSkipped = lastWriteSkipped(this.wasi);
+      return true;
     }
 
     if (!this.fileData) return false;
     const result = writeTagsToWasm(this.wasi, this.fileData, this.tagData);
     if (result) {
+      this.lastSaveSkipped = lastWriteSkipped(this.wasi);
       this.fileData = result;
       return true;
     }
     return false;
   }
 
+  saveSkipped(): boolean {
+    this.checkNotDestroyed();
+    return this.lastSaveSkipped;
+  }
+
   getTagData(): BasicTagData {
     this.checkNotDestroyed();
     const d = this.tagData ?? {};
@@ -12,12 +12,40 @@ import {
   WasmMemoryError,
 } from "../wasi-memory.ts";
 import { InvalidFormatError } from "../../errors/classes.ts";
-import { encodeTagData } from "../../msgpack/encoder.ts";
-import type { ExtendedTag } from "../../types.ts";
+import { encodeTagData, encodeTagPatch } from "../../msgpack/encoder.ts";
+import type { ExtendedTag, TagPatch } from "../../types.ts";
 
 const TL_ERROR_UNSUPPORTED_FORMAT = -2;
 const TL_ERROR_PARSE_FAILED = -6;
 
+/** What a write would cost, as reported by tl_estimate_write */
+export interface WriteEstimate {
+  fileSize: number;
+  newFileSize: number;
+  /** Span of the file the save rewrites: tags plus padding/headers */
+  regionOffset: number;
+  regionSize: number;
+  newRegionSize: number;
+  /** Payload shifted because the region changed size */
+  bytesMoved: number;
+  /** Bytes read and written while saving, moved payload included */
+  bytesRead: number;
+  bytesWritten: number;
+  /** No payload moves: the tags fit in place */
+  fitsInPlace: boolean;
+  /** The tags already match; tl_write_tags would skip the save */
+  unchanged: boolean;
+}
+
+const WRITE_ESTIMATE_SIZE = 8 * 8 + 2 * 4;
+
+/** Default piece size for chunked reads */
+export const READ_CHUNK_SIZE = 64 * 1024;
+
+const TL_FORMAT_AUTO = 0;
+
+let nextStreamId = 1;
+
 export function readTagsFromWasm(
   wasi: WasiModule,
   buffer: Uint8Array,
@@ -94,6 +122,210 @@ export function readTagsFromWasmPath(
   return result;
 }
 
+function readTagsChunked(
+  wasi: WasiModule,
+  pathPtr: number,
+  bufPtr: number,
+  len: number,
+  onChunk: (chunk: Uint8Array) => void,
+  chunkSize: number,
+  what: string,
+): boolean {
+  if (!wasi.tl_read_tags_chunked || !wasi.setChunkSink) return false;
+
+  const streamId = nextStreamId++;
+  let sinkError: unknown;
+  let failed = false;
+  wasi.setChunkSink(streamId, (chunk) => {
+    try {
+      onChunk(chunk);
+      return true;
+    } catch (error) {
+      sinkError = error;
+      failed = true;
+      return false;
+    }
+  });
+
+  let result: number;
+  try {
+    result = wasi.tl_read_tags_chunked(
+      pathPtr,
+      bufPtr,
+      len,
+      TL_FORMAT_AUTO,
+      chunkSize,
+      streamId,
+    );
+  } finally {
+    wasi.setChunkSink(streamId, undefined);
+  }
+  if (failed) throw sinkError;
+
+  if (result !== 0) {
+    const errorCode = wasi.tl_get_last_error_code();
+    if (
+      errorCode === TL_ERROR_UNSUPPORTED_FORMAT ||
+      errorCode === TL_ERROR_PARSE_FAILED
+    ) {
+      throw new InvalidFormatError(
+        `File may be corrupted or in an unsupported format. ${what}`,
+      );
+    }
+    throw new WasmMemoryError(
+      `error code ${errorCode}. ${what}`,
+      "read tags chunked",
+      errorCode,
+    );
+  }
+  return true;
+}
+
+/**
+ * Reads the tags of the file at path and hands the msgpack result to
+ * onChunk in order, at most chunkSize bytes per call, so the result is
+ * never held whole in wasm memory. Returns false without reading for
+ * modules built before tl_read_tags_chunked; use readTagsFromWasmPath
+ * then. An error thrown by onChunk aborts the read and is rethrown.
+ */
+export function readTagsFromWasmPathChunked(
+  wasi: WasiModule,
+  path: string,
+  onChunk: (chunk: Uint8Array) => void,
+  chunkSize = READ_CHUNK_SIZE,
+): boolean {
+  using arena = new WasmArena(wasi as WasmExports);
+  const pathAlloc = arena.allocString(path);
+  return readTagsChunked(
+    wasi,
+    pathAlloc.ptr,
+    0,
+    0,
+    onChunk,
+    chunkSize,
+    `Path: ${path}`,
+  );
+}
+
+/** Buffer variant of readTagsFromWasmPathChunked. */
+export function readTagsFromWasmChunked(
+  wasi: WasiModule,
+  buffer: Uint8Array,
+  onChunk: (chunk: Uint8Array) => void,
+  chunkSize = READ_CHUNK_SIZE,
+): boolean {
+  using arena = new WasmArena(wasi as WasmExports);
+  const inputBuf = arena.allocBuffer(buffer);
+  return readTagsChunked(
+    wasi,
+    0,
+    inputBuf.ptr,
+    inputBuf.size,
+    onChunk,
+    chunkSize,
+    `Buffer size: ${buffer.length} bytes`,
+  );
+}
+
+/**
+ * Records the structural snapshot of the file at path for
+ * readTagsFromWasmPathWithSnapshot: the headers of the structure TagLib
+ * walks to open it, its format, size and a digest of the headers. Returns
+ * undefined for modules built before snapshots existed.
+ */
+export function snapshotStructureFromWasmPath(
+  wasi: WasiModule,
+  path: string,
+): Uint8Array | undefined {
+  if (!wasi.tl_snapshot_structure) return undefined;
+  using arena = new WasmArena(wasi as WasmExports);
+
+  const pathAlloc = arena.allocString(path);
+  const outBufPtr = arena.allocUint32();
+  const outSizePtr = arena.allocUint32();
+
+  const result = wasi.tl_snapshot_structure(
+    pathAlloc.ptr,
+    outBufPtr.ptr,
+    outSizePtr.ptr,
+  );
+  if (result !== 0) {
+    const errorCode = wasi.tl_get_last_error_code();
+    if (
+      errorCode === TL_ERROR_UNSUPPORTED_FORMAT ||
+      errorCode === TL_ERROR_PARSE_FAILED
+    ) {
+      throw new InvalidFormatError(
+        `File may be corrupted or in an unsupported format. Path: ${path}`,
+      );
+    }
+    throw new WasmMemoryError(
+      `error code ${errorCode}. Path: ${path}`,
+      "snapshot structure",
+      errorCode,
+    );
+  }
+
+  const ptr = outBufPtr.readUint32();
+  const size = outSizePtr.readUint32();
+  const u8 = new Uint8Array(wasi.memory.buffer);
+  const snapshot = new Uint8Array(u8.slice(ptr, ptr + size));
+  wasi.free(ptr);
+  return snapshot;
+}
+
+/**
+ * readTagsFromWasmPath that reopens the file from a snapshot taken by
+ * snapshotStructureFromWasmPath. A stale snapshot (the file changed) falls
+ * back to a regular read; snapshotUsed tells which happened, so callers
+ * know when to take a new one.
+ */
+export function readTagsFromWasmPathWithSnapshot(
+  wasi: WasiModule,
+  path: string,
+  snapshot: Uint8Array,
+): { tags: Uint8Array; snapshotUsed: boolean } {
+  if (!wasi.tl_read_tags_snapshot) {
+    return { tags: readTagsFromWasmPath(wasi, path), snapshotUsed: false };
+  }
+  using arena = new WasmArena(wasi as WasmExports);
+
+  const pathAlloc = arena.allocString(path);
+  const snapshotBuf = arena.allocBuffer(snapshot);
+  const outSizePtr = arena.allocUint32();
+  const usedPtr = arena.allocUint32();
+
+  const resultPtr = wasi.tl_read_tags_snapshot(
+    pathAlloc.ptr,
+    snapshotBuf.ptr,
+    snapshotBuf.size,
+    outSizePtr.ptr,
+    usedPtr.ptr,
+  );
+  if (resultPtr === 0) {
+    const errorCode = wasi.tl_get_last_error_code();
+    if (
+      errorCode === TL_ERROR_UNSUPPORTED_FORMAT ||
+      errorCode === TL_ERROR_PARSE_FAILED
+    ) {
+      throw new InvalidFormatError(
+        `File may be corrupted or in an unsupported format. Path: ${path}`,
+      );
+    }
+    throw new WasmMemoryError(
+      `error code ${errorCode}. Path: ${path}`,
+      "read tags with snapshot",
+      errorCode,
+    );
+  }
+
+  const outSize = outSizePtr.readUint32();
+  const u8 = new Uint8Array(wasi.memory.buffer);
+  const tags = new Uint8Array(u8.slice(resultPtr, resultPtr + outSize));
+  wasi.free(resultPtr);
+  return { tags, snapshotUsed: usedPtr.readUint32() === 1 };
+}
+
 export function writeTagsToWasmPath(
   wasi: WasiModule,
   path: string,
@@ -127,6 +359,208 @@ export function writeTagsToWasmPath(
   return true;
 }
 
+function estimateWrite(
+  wasi: WasiModule,
+  arena: WasmArena,
+  pathPtr: number,
+  bufPtr: number,
+  len: number,
+  tagData: ExtendedTag,
+  what: string,
+): WriteEstimate | undefined {
+  if (!wasi.tl_estimate_write) return undefined;
+
+  const tagBuf = arena.allocBuffer(encodeTagData(tagData));
+  const out = arena.alloc(WRITE_ESTIMATE_SIZE);
+  const result = wasi.tl_estimate_write(
+    pathPtr,
+    bufPtr,
+    len,
+    tagBuf.ptr,
+    tagBuf.size,
+    out.ptr,
+  );
+  if (result !== 0) {
+    const errorCode = wasi.tl_get_last_error_code();
+    throw new WasmMemoryError(
+      `error code ${errorCode}. ${what}`,
+      "estimate write",
+      errorCode,
+    );
+  }
+
+  const view = new DataView(wasi.memory.buffer, out.ptr, WRITE_ESTIMATE_SIZE);
+  const u64 = (index: number) => Number(view.getBigUint64(index * 8, true));
+  const u32 = (index: number) => view.getUint32(64 + index * 4, true);
+  return {
+    fileSize: u64(0),
+    newFileSize: u64(1),
+    regionOffset: u64(2),
+    regionSize: u64(3),
+    newRegionSize: u64(4),
+    bytesMoved: u64(5),
+    bytesRead: u64(6),
+    bytesWritten: u64(7),
+    fitsInPlace: u32(0) === 1,
+    unchanged: u32(1) === 1,
+  };
+}
+
+/**
+ * Dry run of writeTagsToWasmPath: reports what writing tagData to path
+ * would cost without touching the file. Undefined for modules built
+ * without tl_estimate_write.
+ */
+export function estimateWriteToWasmPath(
+  wasi: WasiModule,
+  path: string,
+  tagData: ExtendedTag,
+): WriteEstimate | undefined {
+  using arena = new WasmArena(wasi as WasmExports);
+  const pathAlloc = arena.allocString(path);
+  return estimateWrite(
+    wasi,
+    arena,
+    pathAlloc.ptr,
+    0,
+    0,
+    tagData,
+    `Path: ${path}`,
+  );
+}
+
+/** Dry run of writeTagsToWasm, see estimateWriteToWasmPath. */
+export function estimateWriteToWasm(
+  wasi: WasiModule,
+  fileData: Uint8Array,
+  tagData: ExtendedTag,
+): WriteEstimate | undefined {
+  using arena = new WasmArena(wasi as WasmExports);
+  const inputBuf = arena.allocBuffer(fileData);
+  return estimateWrite(
+    wasi,
+    arena,
+    0,
+    inputBuf.ptr,
+    inputBuf.size,
+    tagData,
+    `Buffer size: ${fileData.length} bytes`,
+  );
+}
+
+function updateTags(
+  wasi: WasiModule,
+  arena: WasmArena,
+  pathPtr: number,
+  bufPtr: number,
+  len: number,
+  patch: TagPatch,
+  returnTags: boolean,
+  what: string,
+): { buffer: Uint8Array | null; tags: Uint8Array | null } {
+  if (!wasi.tl_update_tags) {
+    throw new WasmMemoryError(
+      `module does not export tl_update_tags. ${what}`,
+      "update tags",
+    );
+  }
+
+  const patchBuf = arena.allocBuffer(encodeTagPatch(patch));
+  const outBufPtr = arena.allocUint32();
+  const outSizePtr = arena.allocUint32();
+  const outTagsPtr = arena.allocUint32();
+  const outTagsSizePtr = arena.allocUint32();
+
+  const result = wasi.tl_update_tags(
+    pathPtr,
+    bufPtr,
+    len,
+    patchBuf.ptr,
+    patchBuf.size,
+    outBufPtr.ptr,
+    outSizePtr.ptr,
+    returnTags ? outTagsPtr.ptr : 0,
+    returnTags ? outTagsSizePtr.ptr : 0,
+  );
+  if (result !== 0) {
+    const errorCode = wasi.tl_get_last_error_code();
+    throw new WasmMemoryError(
+      `error code ${errorCode}. ${what}`,
+      "update tags",
+      errorCode,
+    );
+  }
+
+  const take = (ptr: number, size: number): Uint8Array | null => {
+    if (!ptr) return null;
+    const u8 = new Uint8Array(wasi.memory.buffer);
+    const copy = new Uint8Array(u8.slice(ptr, ptr + size));
+    wasi.free(ptr);
+    return copy;
+  };
+  return {
+    buffer: take(outBufPtr.readUint32(), outSizePtr.readUint32()),
+    tags: returnTags
+      ? take(outTagsPtr.readUint32(), outTagsSizePtr.readUint32())
+      : null,
+  };
+}
+
+/**
+ * Applies a set/append/remove patch to the file at path on a single parse.
+ * With returnTags, returns the updated tags (msgpack, as
+ * readTagsFromWasmPath) from that same parse; otherwise null.
+ */
+export function updateTagsInWasmPath(
+  wasi: WasiModule,
+  path: string,
+  patch: TagPatch,
+  returnTags = false,
+): Uint8Array | null {
+  using arena = new WasmArena(wasi as WasmExports);
+  const pathAlloc = arena.allocString(path);
+  return updateTags(
+    wasi,
+    arena,
+    pathAlloc.ptr,
+    0,
+    0,
+    patch,
+    returnTags,
+    `Path: ${path}`,
+  ).tags;
+}
+
+/** Buffer variant of updateTagsInWasmPath; returns the updated file too. */
+export function updateTagsInWasm(
+  wasi: WasiModule,
+  fileData: Uint8Array,
+  patch: TagPatch,
+  returnTags = false,
+): { buffer: Uint8Array; tags: Uint8Array | null } {
+  using arena = new WasmArena(wasi as WasmExports);
+  const inputBuf = arena.allocBuffer(fileData);
+  const { buffer, tags } = updateTags(
+    wasi,
+    arena,
+    0,
+    inputBuf.ptr,
+    inputBuf.size,
+    patch,
+    returnTags,
+    `Buffer size: ${fileData.length} bytes`,
+  );
+  return { buffer: buffer ?? fileData, tags };
+}
+
+/**
+ * Whether the last write found the tags already as requested and skipped
+ * the save, leaving the file (or buffer) untouched.
+ */
+export function lastWriteSkipped(wasi: WasiModule): boolean {
+  return wasi.tl_write_skipped?.() === 1;
+}
+
 export function writeTagsToWasm(
   wasi: WasiModule,
   fileData: Uint8Array,
@@ -42,9 +42,38 @@ async function resolveFs(
   return createNodeFsProvider();
 }
 
+/**
+ * A compiled WASI module that can be instantiated again synchronously,
+ * e.g. to replace an instance whose memory has grown too large. Each
+ * instance gets its own memory and WASI state.
+ */
+export interface WasiHostFactory {
+  instantiate(): WasiModule & Disposable;
+}
+
+export async function createWasiHostFactory(
+  config: WasiHostLoaderConfig,
+): Promise<WasiHostFactory> {
+  const { wasmModule, preopens, fs } = await compileWasiHost(config);
+  return {
+    instantiate: () => {
+      const host = createHostImports(preopens, fs);
+      const instance = new WebAssembly.Instance(wasmModule, host.importObject);
+      return initializeInstance(instance, host);
+    },
+  };
+}
+
 export async function loadWasiHost(
   config: WasiHostLoaderConfig,
 ): Promise<WasiModule & Disposable> {
+  const { wasmModule, preopens, fs } = await compileWasiHost(config);
+  const host = createHostImports(preopens, fs);
+  const instance = await WebAssembly.instantiate(wasmModule, host.importObject);
+  return initializeInstance(instance, host);
+}
+
+async function compileWasiHost(config: WasiHostLoaderConfig) {
   const defaultPath = (() => {
     const url = new URL("../../build/taglib_wasi.wasm", import.meta.url);
     return url.protocol === "file:" ? fileUrlToPath(url) : url.href;
@@ -55,7 +84,22 @@ export async function loadWasiHost(
 
   const wasmBytes = await loadWasmBinary(wasmPath, fs);
   const wasmModule = await WebAssembly.compile(wasmBytes as BufferSource);
+  return { wasmModule, preopens, fs };
+}
+
+type ChunkSink = (chunk: Uint8Array) => boolean;
+
+interface HostImports {
+  memoryProxy: { buffer: ArrayBuffer };
+  wasiImports: WasiImportDisposable;
+  chunkSinks: Map<number, ChunkSink>;
+  importObject: WebAssembly.Imports;
+}
 
+function createHostImports(
+  preopens: Record<string, string>,
+  fs: FileSystemProvider,
+): HostImports {
   // We need a Memory object before creating imports, but Wasm defines its own.
   // Create a placeholder that will be updated after instantiation.
   const memoryProxy = { buffer: new ArrayBuffer(0) };
@@ -71,16 +115,32 @@ export async function loadWasiHost(
 
   const wasiImports = createWasiImports(memoryProxy, hostConfig);
 
+  // tl_read_tags_chunked output; an unknown stream aborts the read
+  const chunkSinks = new Map<number, ChunkSink>();
+  const tl_host_chunk = (streamId: number, ptr: number, len: number) => {
+    const sink = chunkSinks.get(streamId);
+    if (!sink) return 1;
+    return sink(new Uint8Array(memoryProxy.buffer.slice(ptr, ptr + len)))
+      ? 0
+      : 1;
+  };
+
   const importObject = {
     wasi_snapshot_preview1: wasiImports,
-    env: {},
+    env: { tl_host_chunk },
   };
 
-  const instance = await WebAssembly.instantiate(wasmModule, importObject);
+  return { memoryProxy, wasiImports, chunkSinks, importObject };
+}
+
+function initializeInstance(
+  instance: WebAssembly.Instance,
+  host: HostImports,
+): WasiModule & Disposable {
   const memory = instance.exports.memory as WebAssembly.Memory;
 
   // Patch the memory proxy to point at real memory
-  Object.defineProperty(memoryProxy, "buffer", {
+  Object.defineProperty(host.memoryProxy, "buffer", {
     get: () => memory.buffer,
   });
 
@@ -88,7 +148,7 @@ export async function loadWasiHost(
     (instance.exports._initialize as () => void)();
   }
 
-  return createWasiModuleFromInstance(instance, memory, wasiImports);
+  return createWasiModuleFromInstance(instance, memory, host);
 }
 
 async function loadWasmBinary(
@@ -117,9 +177,10 @@ async function loadWasmBinary(
 function createWasiModuleFromInstance(
   instance: WebAssembly.Instance,
   memory: WebAssembly.Memory,
-  wasiImports: WasiImportDisposable,
+  host: HostImports,
 ): WasiModule & Disposable {
   const exports = instance.exports;
+  const { wasiImports, chunkSinks } = host;
 
   function readCString(ptr: number): string {
     if (!ptr) return "";
@@ -146,6 +207,56 @@ function createWasiModuleFromInstance(
         l: number,
         o: number,
       ) => number)(pathPtr, bufPtr, len, outSizePtr),
+    ...(exports.tl_read_tags_chunked && {
+      tl_read_tags_chunked: (
+        pathPtr: number,
+        bufPtr: number,
+        len: number,
+        format: number,
+        chunkSize: number,
+        streamId: number,
+      ) =>
+        (exports.tl_read_tags_chunked as (...args: number[]) => number)(
+          pathPtr,
+          bufPtr,
+          len,
+          format,
+          chunkSize,
+          streamId,
+        ),
+      setChunkSink: (streamId: number, sink: ChunkSink | undefined) => {
+        if (sink) chunkSinks.set(streamId, sink);
+        else chunkSinks.delete(streamId);
+      },
+    }),
+    ...(exports.tl_snapshot_structure && {
+      tl_snapshot_structure: (
+        pathPtr: number,
+        outPtr: number,
+        outSzPtr: number,
+      ) =>
+        (exports.tl_snapshot_structure as (
+          p: number,
+          o: number,
+          os: number,
+        ) => number)(pathPtr, outPtr, outSzPtr),
+    }),
+    ...(exports.tl_read_tags_snapshot && {
+      tl_read_tags_snapshot: (
+        pathPtr: number,
+        snapshotPtr: number,
+        snapshotSz: number,
+        outSzPtr: number,
+        usedPtr: number,
+      ) =>
+        (exports.tl_read_tags_snapshot as (...args: number[]) => number)(
+          pathPtr,
+          snapshotPtr,
+          snapshotSz,
+          outSzPtr,
+          usedPtr,
+        ),
+    }),
     tl_write_tags: (pathPtr, bufPtr, len, tagsPtr, tagsSz, outPtr, outSzPtr) =>
       (exports.tl_write_tags as (
         p: number,
@@ -156,10 +267,63 @@ function createWasiModuleFromInstance(
         o: number,
         os: number,
       ) => number)(pathPtr, bufPtr, len, tagsPtr, tagsSz, outPtr, outSzPtr),
+    ...(exports.tl_update_tags && {
+      tl_update_tags: (
+        pathPtr: number,
+        bufPtr: number,
+        len: number,
+        patchPtr: number,
+        patchSz: number,
+        outPtr: number,
+        outSzPtr: number,
+        tagsPtr: number,
+        tagsSzPtr: number,
+      ) =>
+        (exports.tl_update_tags as (...args: number[]) => number)(
+          pathPtr,
+          bufPtr,
+          len,
+          patchPtr,
+          patchSz,
+          outPtr,
+          outSzPtr,
+          tagsPtr,
+          tagsSzPtr,
+        ),
+    }),
+    ...(exports.tl_write_skipped && {
+      tl_write_skipped: () => (exports.tl_write_skipped as () => number)(),
+    }),
+    ...(exports.tl_estimate_write && {
+      tl_estimate_write: (
+        pathPtr: number,
+        bufPtr: number,
+        len: number,
+        tagsPtr: number,
+        tagsSz: number,
+        outPtr: number,
+      ) =>
+        (exports.tl_estimate_write as (
+          p: number,
+          b: number,
+          l: number,
+          t: number,
+          ts: number,
+          o: number,
+        ) => number)(pathPtr, bufPtr, len, tagsPtr, tagsSz, outPtr),
+    }),
     tl_get_last_error: () => (exports.tl_get_last_error as () => number)(),
     tl_get_last_error_code: () =>
       (exports.tl_get_last_error_code as () => number)(),
     tl_clear_error: () => (exports.tl_clear_error as () => void)(),
+    ...(exports.tl_heap_report && {
+      tl_heap_report: (statsPtr: number) =>
+        (exports.tl_heap_report as (p: number) => number)(statsPtr),
+    }),
+    ...(exports.tl_pgo_write_profile && {
+      tl_pgo_write_profile: (pathPtr: number) =>
+        (exports.tl_pgo_write_profile as (p: number) => number)(pathPtr),
+    }),
     memory,
     [Symbol.dispose]: () => wasiImports[Symbol.dispose](),
   };
@@ -32,6 +32,37 @@ export interface WasiModule {
     len: number,
     outSizePtr: number,
   ): number;
+  // Read that streams the msgpack result through the env.tl_host_chunk
+  // import to the sink registered for streamId
+  tl_read_tags_chunked?(
+    pathPtr: number,
+    bufPtr: number,
+    len: number,
+    format: number,
+    chunkSize: number,
+    streamId: number,
+  ): number;
+  // Registers (or with undefined, removes) the receiver of
+  // tl_read_tags_chunked output for streamId. The sink gets its own copy
+  // of each chunk and returns false to abort the read.
+  setChunkSink?(
+    streamId: number,
+    sink: ((chunk: Uint8Array) => boolean) | undefined,
+  ): void;
+  // Structural snapshot of a file (opaque msgpack) and the read that
+  // reopens from it; missing in modules built before snapshots existed
+  tl_snapshot_structure?(
+    pathPtr: number,
+    outBufPtr: number,
+    outSizePtr: number,
+  ): number;
+  tl_read_tags_snapshot?(
+    pathPtr: number,
+    snapshotPtr: number,
+    snapshotSize: number,
+    outSizePtr: number,
+    outUsedPtr: number,
+  ): number;
   tl_write_tags(
     pathPtr: number,
     bufPtr: number,
@@ -41,12 +72,44 @@ export interface WasiModule {
     outBufPtr: number,
     outSizePtr: number,
   ): number;
+  // Patch-semantics write (set/append/remove) on a single parse; missing in
+  // modules built before it existed
+  tl_update_tags?(
+    pathPtr: number,
+    bufPtr: number,
+    len: number,
+    patchPtr: number,
+    patchSize: number,
+    outBufPtr: number,
+    outSizePtr: number,
+    outTagsPtr: number,
+    outTagsSizePtr: number,
+  ): number;
+  // 1 if the last tl_write_tags call found nothing to change and skipped
+  // the save; missing in modules built before no-op writes were elided
+  tl_write_skipped?(): number;
+  // Write dry run filling a tl_write_estimate (eight u64, two u32), see
+  // src/capi/core/taglib_core.h
+  tl_estimate_write?(
+    pathPtr: number,
+    bufPtr: number,
+    len: number,
+    tagsPtr: number,
+    tagsSize: number,
+    outPtr: number,
+  ): number;
 
   // Error handling (returns pointer to error string)
   tl_get_last_error(): number;
   tl_get_last_error_code(): number;
   tl_clear_error(): void;
 
+  // Fills a tl_heap_stats (six u32 fields), see src/capi/core/taglib_heap.h
+  tl_heap_report?(statsPtr: number): number;
+
+  // Profile dump, only exported by TAGLIB_WASI_PGO=generate builds
+  tl_pgo_write_profile?(pathPtr: number): number;
+
   // Memory access
   memory: WebAssembly.Memory;
 }
@@ -226,6 +226,28 @@ export interface ExtendedTag extends Tag {
   }>;
 }
 
+/**
+ * Per-key edit applied on a single parse by the WASI update call.
+ * `set` replaces only the listed fields, `append` adds values (and
+ * pictures) to the existing ones, `remove` deletes fields; "pictures",
+ * "ratings", "lyrics" and "chapters" clear those lists. Ratings, lyrics
+ * and chapters cannot be appended: set the full list instead.
+ *
+ * @example
+ * ```typescript
+ * const patch: TagPatch = {
+ *   set: { title: ["New Title"] },
+ *   append: { genre: ["Funk"] },
+ *   remove: ["comment"],
+ * };
+ * ```
+ */
+export interface TagPatch {
+  readonly set?: ExtendedTag;
+  readonly append?: Omit<ExtendedTag, "ratings" | "lyrics" | "chapters">;
+  readonly remove?: readonly string[];
+}
+
 /**
  * Extended metadata properties map with known-key autocomplete.
  * Known keys (from PROPERTIES) are optional and provide IDE autocomplete.
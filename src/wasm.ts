@@ -65,6 +65,8 @@ export interface FileHandle {
   loadFromPath?(path: string): boolean;
   isValid(): boolean;
   save(): boolean;
+  /** Whether the last save() succeeded without writing because nothing changed */
+  saveSkipped?(): boolean;
   getFormat(): string;
   getProperties(): Record<string, string[]>;
   setProperties(props: Record<string, string[]>): void;
@@ -25,6 +25,7 @@
 
 #include "dsdifffile.h"
 
+#include <algorithm>
 #include <array>
 #include <memory>
 
@@ -32,6 +33,7 @@
 #include "tstringlist.h"
 #include "tpropertymap.h"
 #include "tdebug.h"
+#include "tfile.h"
 #include "id3v2tag.h"
 #include "tagutils.h"
 #include "tagunion.h"
@@ -69,6 +71,91 @@ namespace
                         [](unsigned char c) { return c < 32 || c > 126; });
   }
 
+  // Serves the small header and value reads of the chunk scan from large
+  // buffered blocks. A refill only happens when a read falls outside of the
+  // current block, i.e. about once per region of chunk headers, which avoids
+  // a round trip per header on slow (e.g. network) storage.
+  class ChunkReader
+  {
+  public:
+    ChunkReader(TagLib::File &file, offset_t fileLength) :
+      file(file), fileLength(fileLength)
+    {
+    }
+
+    ByteVector read(offset_t offset, unsigned int length)
+    {
+      if(offset < 0 || offset >= fileLength)
+        return ByteVector();
+
+      const offset_t bufferEnd = bufferOffset + buffer.size();
+      if(offset < bufferOffset || offset >= bufferEnd ||
+         (offset + length > bufferEnd && bufferEnd < fileLength)) {
+        file.seek(offset);
+        buffer = file.readBlock(std::max<size_t>(length, blockSize));
+        bufferOffset = offset;
+      }
+      return buffer.mid(static_cast<unsigned int>(offset - bufferOffset), length);
+    }
+
+  private:
+    static constexpr size_t blockSize = 64 * 1024;
+
+    TagLib::File &file;
+    const offset_t fileLength;
+    ByteVector buffer;
+    offset_t bufferOffset { 0 };
+  };
+
+  // Scans the chunk headers in [begin, end) and passes each chunk to
+  // onChunk, which returns false to stop the scan. Returns false if a
+  // malformed chunk is found.
+  template <typename ChunkHandler>
+  bool readChunkList(ChunkReader &reader, offset_t begin, offset_t end, bool bigEndian,
+                     const ByteVector &container, const ByteVector &limit,
+                     const ChunkHandler &onChunk)
+  {
+    offset_t pos = begin;
+    while(pos + 12 <= end) {
+      const ByteVector header = reader.read(pos, 12);
+      const ByteVector chunkName = header.mid(0, 4);
+      const auto chunkSize = static_cast<unsigned long long>(header.toLongLong(4, bigEndian));
+
+      if(!isValidChunkID(chunkName)) {
+        debug("DSDIFF::File::read() -- " + container + "Chunk '" + chunkName + "' has invalid ID");
+        return false;
+      }
+
+      if(static_cast<unsigned long long>(pos + 12) + chunkSize >
+         static_cast<unsigned long long>(end)) {
+        debug("DSDIFF::File::read() -- " + container + "Chunk '" + chunkName
+              + "' has invalid size (larger than the " + limit + ")");
+        return false;
+      }
+
+      Chunk64 chunk;
+      chunk.name = chunkName;
+      chunk.size = chunkSize;
+      chunk.offset = pos + 12;
+      pos = static_cast<offset_t>(chunk.offset + chunk.size);
+
+      // Check padding, a chunk which is not well formed has none
+
+      chunk.padding = 0;
+      if((pos & 0x01) != 0) {
+        if(const ByteVector iByte = reader.read(pos, 1);
+           iByte.size() == 1 && iByte[0] == 0) {
+          chunk.padding = 1;
+          ++pos;
+        }
+      }
+
+      if(!onChunk(chunk))
+        break;
+    }
+    return true;
+  }
+
   enum {
     ID3v2Index = 0,
     DIINIndex = 1
@@ -77,6 +164,121 @@ namespace
     PROPChunk = 0,
     DIINChunk = 1
   };
+
+  // Chunks which are no longer used but cannot be removed without moving the
+  // sound data are renamed to this ID. Like all unknown local chunks, they
+  // are skipped by DSDIFF readers.
+  const ByteVector freeChunkID("FREE");
+
+  unsigned long long paddedSize(unsigned long long size)
+  {
+    return (size + 1) & ~1ULL;
+  }
+
+  int soundDataChunkIndex(const ChunkList &chunks)
+  {
+    for(size_t i = 0; i < chunks.size(); i++) {
+      if(chunks[i].name == "DSD " || chunks[i].name == "DST ")
+        return static_cast<int>(i);
+    }
+    return -1;
+  }
+
+  // True if a size change of the root chunk i would move the sound data.
+  bool precedesSoundData(const ChunkList &chunks, int i)
+  {
+    const int soundIndex = soundDataChunkIndex(chunks);
+    return i >= 0 && soundIndex >= 0 && i < soundIndex;
+  }
+
+  // Chunks whose content may be followed by zero bytes without changing
+  // its meaning: the ID3v2 header carries the tag size and the DIIN strings
+  // are prefixed with their length.
+  bool canPadChunk(const Chunk64 &chunk)
+  {
+    return (chunk.name == "ID3 " || chunk.name == "id3 " ||
+            chunk.name == "DITI" || chunk.name == "DIAR") &&
+           chunk.padding == static_cast<char>(chunk.size & 1);
+  }
+
+  enum class ChunkUpdate {
+    // Same size, overwritten in place
+    Overwrite,
+    // Smaller data, zero padded to the old size and overwritten in place
+    Pad,
+    // Removed by renaming it to a FREE chunk in place
+    Free,
+    // Freed and its data written after the last chunk
+    Relocate,
+    // Rewritten with a different size, all following bytes move
+    Resize,
+    // Removed, all following bytes move
+    Remove
+  };
+
+  // Decides how an existing chunk is updated with dataSize bytes. Chunks
+  // in front of the sound data are never resized, so that the (multi-GB)
+  // sound data is not moved when tags are edited.
+  ChunkUpdate planChunkUpdate(const Chunk64 &chunk, unsigned long long dataSize,
+                              bool beforeSoundData)
+  {
+    if(dataSize == 0)
+      return beforeSoundData ? ChunkUpdate::Free : ChunkUpdate::Remove;
+    if(paddedSize(dataSize) == chunk.size + chunk.padding)
+      return ChunkUpdate::Overwrite;
+    if(!beforeSoundData)
+      return ChunkUpdate::Resize;
+    if(dataSize <= chunk.size && canPadChunk(chunk))
+      return ChunkUpdate::Pad;
+    return ChunkUpdate::Relocate;
+  }
+
+  // Copies the root chunk i behind the last chunk and turns the old one into
+  // a FREE chunk, so that it can grow without moving any other chunk. The
+  // offsets of its child chunks are updated. Returns the index of the copy.
+  unsigned int relocateRootChunk(TagLib::File &file, ChunkList &chunks, unsigned int i,
+                                 ChunkList &childChunks, unsigned long long &formSize,
+                                 bool bigEndian)
+  {
+    const Chunk64 chunk = chunks[i];
+    file.seek(chunk.offset);
+    const ByteVector content = file.readBlock(chunk.size);
+
+    Chunk64 &last = chunks.back();
+    unsigned long long offset = last.offset + last.size + last.padding;
+    ByteVector block;
+    if(offset & 1) {
+      // The previous chunk was not padded, complete it.
+      block.append('\x00');
+      last.padding = 1;
+      ++offset;
+    }
+    block.append(chunk.name);
+    block.append(ByteVector::fromLongLong(content.size(), bigEndian));
+    block.append(content);
+    if(content.size() & 1)
+      block.append('\x00');
+
+    formSize += block.size();
+    file.insert(ByteVector::fromLongLong(formSize, bigEndian), 4, 8);
+
+    const auto fileLength = static_cast<unsigned long long>(file.length());
+    file.insert(block, offset, static_cast<size_t>(fileLength > offset ? fileLength - offset : 0));
+    file.insert(freeChunkID, chunk.offset - 12, 4);
+    chunks[i].name = freeChunkID;
+
+    Chunk64 copy;
+    copy.name = chunk.name;
+    copy.size = content.size();
+    copy.offset = offset + 12;
+    copy.padding = (content.size() & 1) ? 1 : 0;
+    chunks.push_back(copy);
+
+    for(auto &child : childChunks)
+      child.offset = child.offset - chunk.offset + copy.offset;
+
+    return static_cast<unsigned int>(chunks.size() - 1);
+  }
 } // namespace
 
 class DSDIFF::File::FilePrivate
@@ -224,13 +426,29 @@ bool DSDIFF::File::save(int tags, StripTags strip, ID3v2::Version version)
 
   if(const ID3v2::Tag *id3v2Tag = ID3v2Tag(); (tags & ID3v2) && id3v2Tag) {
     if(d->isID3InPropChunk) {
+      const int i = chunkIndex(d->childChunks[PROPChunk], d->id3v2TagChunkID);
       if(!id3v2Tag->isEmpty()) {
-        setChildChunkData(d->id3v2TagChunkID, id3v2Tag->render(version), PROPChunk);
+        const ByteVector data = id3v2Tag->render(version);
+        if(i >= 0) {
+          // Moves the tag to the root level behind the sound data if the
+          // PROP chunk would have to grow
+          setChildChunkData(i, data, PROPChunk);
+        }
+        else if(!precedesSoundData(d->chunks, d->childChunkIndex[PROPChunk])) {
+          setChildChunkData(d->id3v2TagChunkID, data, PROPChunk);
+        }
+        else {
+          // A new child would grow the PROP chunk
+          d->isID3InPropChunk = false;
+          setRootChunkData(d->id3v2TagChunkID, data);
+        }
         d->hasID3v2 = true;
       }
       else {
-        // Empty tag: remove it
-        setChildChunkData(d->id3v2TagChunkID, ByteVector(), PROPChunk);
+        // Empty tag: remove it, a later tag is added at the root level
+        if(i >= 0)
+          setChildChunkData(i, ByteVector(), PROPChunk);
+        d->isID3InPropChunk = false;
         d->hasID3v2 = false;
       }
     }
@@ -294,8 +512,12 @@ void DSDIFF::File::strip(int tags)
   if(tags & DIIN) {
     removeChildChunk("DITI", DIINChunk);
     removeChildChunk("DIAR", DIINChunk);
-    if(d->childChunks[DIINIndex].empty()) {
+    // Children in front of the sound data were only renamed to FREE
+    if(std::all_of(d->childChunks[DIINChunk].cbegin(), d->childChunks[DIINChunk].cend(),
+                   [](const Chunk64 &chunk) { return chunk.name == freeChunkID; })) {
       removeRootChunk("DIIN");
+      d->childChunks[DIINChunk].clear();
+      d->childChunkIndex[DIINChunk] = -1;
     }
 
     d->hasDiin = false;
@@ -309,6 +531,15 @@ void DSDIFF::File::strip(int tags)
 
 void DSDIFF::File::removeRootChunk(unsigned int i)
 {
+    if(precedesSoundData(d->chunks, i)) {
+      // Keep the sound data in place, only rename the chunk
+      insert(freeChunkID, d->chunks[i].offset - 12, 4);
+      d->chunks[i].name = freeChunkID;
+      if(d->childChunkIndex[DIINChunk] == static_cast<int>(i))
+        d->childChunkIndex[DIINChunk] = -1;
+      return;
+    }
+
     unsigned long long chunkSize = d->chunks[i].size + d->chunks[i].padding + 12;
 
     d->size -= chunkSize;
@@ -337,9 +568,26 @@ void DSDIFF::File::removeRootChunk(const ByteVector &id)
 
 void DSDIFF::File::setRootChunkData(unsigned int i, const ByteVector &data)
 {
-  if(data.isEmpty()) {
+  switch(planChunkUpdate(d->chunks[i], data.size(), precedesSoundData(d->chunks, i))) {
+  case ChunkUpdate::Free:
+  case ChunkUpdate::Remove:
     removeRootChunk(i);
     return;
+  case ChunkUpdate::Pad:
+    writeChunk(d->chunks[i].name,
+               data + ByteVector(static_cast<unsigned int>(d->chunks[i].size - data.size()), '\x00'),
+               d->chunks[i].offset - 12,
+               static_cast<unsigned long>(d->chunks[i].size + d->chunks[i].padding + 12));
+    return;
+  case ChunkUpdate::Relocate: {
+    const ByteVector name = d->chunks[i].name;
+    removeRootChunk(i);
+    setRootChunkData(name, data);
+    return;
+  }
+  case ChunkUpdate::Overwrite:
+  case ChunkUpdate::Resize:
+    break;
   }
 
   // Non null data: update chunk
@@ -406,6 +654,13 @@ void DSDIFF::File::removeChildChunk(unsigned int i, unsigned int childChunkNum)
 {
     ChunkList &childChunks = d->childChunks[childChunkNum];
 
+    if(precedesSoundData(d->chunks, d->childChunkIndex[childChunkNum])) {
+      // Keep the sound data in place, only rename the chunk
+      insert(freeChunkID, childChunks[i].offset - 12, 4);
+      childChunks[i].name = freeChunkID;
+      return;
+    }
+
     // Update global size
 
     unsigned long long removedChunkTotalSize = childChunks[i].size + childChunks[i].padding + 12;
@@ -452,9 +707,37 @@ void DSDIFF::File::setChildChunkData(unsigned int i,
 {
   ChunkList &childChunks = d->childChunks[childChunkNum];
 
-  if(data.isEmpty()) {
+  switch(planChunkUpdate(childChunks[i], data.size(),
+                         precedesSoundData(d->chunks, d->childChunkIndex[childChunkNum]))) {
+  case ChunkUpdate::Free:
+  case ChunkUpdate::Remove:
     removeChildChunk(i, childChunkNum);
     return;
+  case ChunkUpdate::Pad:
+    writeChunk(childChunks[i].name,
+               data + ByteVector(static_cast<unsigned int>(childChunks[i].size - data.size()), '\x00'),
+               childChunks[i].offset - 12,
+               static_cast<unsigned long>(childChunks[i].size + childChunks[i].padding + 12));
+    return;
+  case ChunkUpdate::Relocate:
+    if(childChunkNum == PROPChunk) {
+      // The PROP chunk has to stay in front of the sound data, so the child
+      // is freed and written at the root level behind it instead.
+      const ByteVector name = childChunks[i].name;
+      removeChildChunk(i, PROPChunk);
+      if(name == d->id3v2TagChunkID)
+        d->isID3InPropChunk = false;
+      setRootChunkData(name, data);
+      return;
+    }
+    // The DIIN chunk is moved behind the sound data and resized there.
+    d->childChunkIndex[DIINChunk] = relocateRootChunk(
+      *this, d->chunks, d->childChunkIndex[DIINChunk], childChunks, d->size,
+      d->endianness == BigEndian);
+    break;
+  case ChunkUpdate::Overwrite:
+  case ChunkUpdate::Resize:
+    break;
   }
 
   // Non null data: update chunk
@@ -510,6 +793,14 @@ void DSDIFF::File::setChildChunkData(const ByteVector &name,
 
   // Couldn't find an existing chunk, so let's create a new one.
 
+  if(childChunkNum == DIINChunk &&
+     precedesSoundData(d->chunks, d->childChunkIndex[DIINChunk])) {
+    // Move the DIIN chunk behind the sound data before it grows.
+    d->childChunkIndex[DIINChunk] = relocateRootChunk(
+      *this, d->chunks, d->childChunkIndex[DIINChunk], childChunks, d->size,
+      d->endianness == BigEndian);
+  }
+
   unsigned long long offset = 0;
   if(!childChunks.empty()) {
     size_t i = childChunks.size() - 1;
@@ -605,50 +896,13 @@ void DSDIFF::File::read(bool readProperties, Properties::ReadStyle propertiesSty
 {
   bool bigEndian = d->endianness == BigEndian;
 
-  d->type = readBlock(4);
-  d->size = readBlock(8).toLongLong(bigEndian);
-  d->format = readBlock(4);
-
-  // + 12: chunk header at least, fix for additional junk bytes
-
-  while(tell() + 12 <= length()) {
-    ByteVector chunkName = readBlock(4);
-    unsigned long long chunkSize = readBlock(8).toLongLong(bigEndian);
-
-    if(!isValidChunkID(chunkName)) {
-      debug("DSDIFF::File::read() -- Chunk '" + chunkName + "' has invalid ID");
-      setValid(false);
-      break;
-    }
-
-    if(static_cast<unsigned long long>(tell()) + chunkSize >
-       static_cast<unsigned long long>(length())) {
-      debug("DSDIFF::File::read() -- Chunk '" + chunkName
-            + "' has invalid size (larger than the file size)");
-      setValid(false);
-      break;
-    }
-
-    Chunk64 chunk;
-    chunk.name = chunkName;
-    chunk.size = chunkSize;
-    chunk.offset = tell();
-
-    seek(chunk.size, Current);
+  const offset_t fileLength = length();
+  ChunkReader reader(*this, fileLength);
 
-    // Check padding
-
-    chunk.padding = 0;
-    if(offset_t uPosNotPadded = tell(); (uPosNotPadded & 0x01) != 0) {
-      if(ByteVector iByte = readBlock(1);
-         iByte.size() != 1 || iByte[0] != 0)
-        // Not well formed, re-seek
-        seek(uPosNotPadded, Beginning);
-      else
-        chunk.padding = 1;
-    }
-    d->chunks.push_back(chunk);
-  }
+  const ByteVector header = reader.read(0, 16);
+  d->type = header.mid(0, 4);
+  d->size = header.toLongLong(4, bigEndian);
+  d->format = header.mid(12, 4);
 
   // For DSD uncompressed
   unsigned long long lengthDSDSamplesTimeChannels = 0;
@@ -659,168 +913,114 @@ void DSDIFF::File::read(bool readProperties, Properties::ReadStyle propertiesSty
   // For DST compressed frames
   unsigned short dstFrameRate = 0;
 
-  for(unsigned int i = 0; i < d->chunks.size(); i++) {
-    if(d->chunks[i].name == "DSD ") {
-      lengthDSDSamplesTimeChannels = d->chunks[i].size * 8;
-      audioDataSizeinBytes = d->chunks[i].size;
+  unsigned int sampleRate = 0;
+  unsigned short channels = 0;
+  ByteVector diinTitle;
+  ByteVector diinArtist;
+  bool hasDiinTitle = false;
+  bool hasDiinArtist = false;
+
+  // Index the root chunks in a single forward pass. The child chunks of PROP,
+  // DIIN and DST and the few values needed from them are read while they are
+  // still buffered, so the file is not revisited afterwards.
+  bool valid = true;
+
+  const auto readPropChunk = [&](const Chunk64 &chunk) {
+    if(chunk.name == "FS  ") {
+      // Sample rate
+      sampleRate = reader.read(chunk.offset, 4).toUInt(0, 4, bigEndian);
     }
-    else if(d->chunks[i].name == "DST ") {
-      // Now decode the chunks inside the DST chunk to read the DST Frame Information one
-      long long dstChunkEnd = d->chunks[i].offset + d->chunks[i].size;
-      seek(d->chunks[i].offset);
-
-      audioDataSizeinBytes = d->chunks[i].size;
-
-      while(tell() + 12 <= dstChunkEnd) {
-        ByteVector dstChunkName = readBlock(4);
-        long long dstChunkSize = readBlock(8).toLongLong(bigEndian);
+    else if(chunk.name == "CHNL") {
+      // Channels
+      channels = reader.read(chunk.offset, 2).toShort(0, bigEndian);
+    }
+    d->childChunks[PROPChunk].push_back(chunk);
+    return true;
+  };
 
-        if(!isValidChunkID(dstChunkName)) {
-          debug("DSDIFF::File::read() -- DST Chunk '" + dstChunkName + "' has invalid ID");
-          setValid(false);
-          break;
-        }
+  const auto readDiinString = [&](const Chunk64 &chunk, ByteVector &value) {
+    if(unsigned int strLength = reader.read(chunk.offset, 4).toUInt(0, 4, bigEndian);
+       strLength <= chunk.size) {
+      value = reader.read(chunk.offset + 4, strLength);
+      return true;
+    }
+    return false;
+  };
 
-        if(static_cast<long long>(tell()) + dstChunkSize > dstChunkEnd) {
-          debug("DSDIFF::File::read() -- DST Chunk '" + dstChunkName
-                + "' has invalid size (larger than the DST chunk)");
-          setValid(false);
-          break;
-        }
+  const auto readDiinChunk = [&](const Chunk64 &chunk) {
+    if(chunk.name == "DITI")
+      hasDiinTitle = readDiinString(chunk, diinTitle) || hasDiinTitle;
+    else if(chunk.name == "DIAR")
+      hasDiinArtist = readDiinString(chunk, diinArtist) || hasDiinArtist;
+    d->childChunks[DIINChunk].push_back(chunk);
+    return true;
+  };
 
-        if(dstChunkName == "FRTE") {
-          // Found the DST frame information chunk
-          dstNumFrames = readBlock(4).toUInt(bigEndian);
-          dstFrameRate = readBlock(2).toUShort(bigEndian);
-          // Found the wanted one, no need to look at the others
-          break;
-        }
+  const auto readDstChunk = [&](const Chunk64 &chunk) {
+    if(chunk.name == "FRTE") {
+      // Found the DST frame information chunk
+      const ByteVector frameInfo = reader.read(chunk.offset, 6);
+      dstNumFrames = frameInfo.toUInt(0, 4, bigEndian);
+      dstFrameRate = frameInfo.toUShort(4, bigEndian);
+      // Found the wanted one, no need to look at the others
+      return false;
+    }
+    return true;
+  };
 
-        seek(dstChunkSize, Current);
+  const auto readRootChunk = [&](const Chunk64 &chunk) {
+    const auto i = static_cast<unsigned int>(d->chunks.size());
+    d->chunks.push_back(chunk);
+    const offset_t chunkEnd = chunk.offset + chunk.size;
 
-        // Check padding
-        if(offset_t uPosNotPadded = tell(); (uPosNotPadded & 0x01) != 0) {
-          if(ByteVector iByte = readBlock(1);
-             iByte.size() != 1 || iByte[0] != 0)
-            // Not well formed, re-seek
-            seek(uPosNotPadded, Beginning);
-        }
-      }
+    if(chunk.name == "DSD ") {
+      lengthDSDSamplesTimeChannels = chunk.size * 8;
+      audioDataSizeinBytes = chunk.size;
     }
-    else if(d->chunks[i].name == "PROP") {
+    else if(chunk.name == "DST ") {
+      audioDataSizeinBytes = chunk.size;
+      // Decode the chunks inside the DST chunk to read the DST Frame Information one
+      valid = readChunkList(reader, chunk.offset, chunkEnd, bigEndian,
+                            "DST ", "DST chunk", readDstChunk);
+    }
+    else if(chunk.name == "PROP") {
       d->childChunkIndex[PROPChunk] = i;
-      // Now decodes the chunks inside the PROP chunk
-      long long propChunkEnd = d->chunks[i].offset + d->chunks[i].size;
       // +4 to remove the 'SND ' marker at beginning of 'PROP' chunk
-      seek(d->chunks[i].offset + 4);
-      while(tell() + 12 <= propChunkEnd) {
-        ByteVector propChunkName = readBlock(4);
-        long long propChunkSize = readBlock(8).toLongLong(bigEndian);
-
-        if(!isValidChunkID(propChunkName)) {
-          debug("DSDIFF::File::read() -- PROP Chunk '" + propChunkName + "' has invalid ID");
-          setValid(false);
-          break;
-        }
-
-        if(static_cast<long long>(tell()) + propChunkSize > propChunkEnd) {
-          debug("DSDIFF::File::read() -- PROP Chunk '" + propChunkName
-                + "' has invalid size (larger than the PROP chunk)");
-          setValid(false);
-          break;
-        }
-
-        Chunk64 chunk;
-        chunk.name = propChunkName;
-        chunk.size = propChunkSize;
-        chunk.offset = tell();
-
-        seek(chunk.size, Current);
-
-        // Check padding
-        chunk.padding = 0;
-        if(offset_t uPosNotPadded = tell(); (uPosNotPadded & 0x01) != 0) {
-          if(ByteVector iByte = readBlock(1);
-             iByte.size() != 1 || iByte[0] != 0)
-            // Not well formed, re-seek
-            seek(uPosNotPadded, Beginning);
-          else
-            chunk.padding = 1;
-        }
-        d->childChunks[PROPChunk].push_back(chunk);
-      }
+      valid = readChunkList(reader, chunk.offset + 4, chunkEnd, bigEndian,
+                            "PROP ", "PROP chunk", readPropChunk);
     }
-    else if(d->chunks[i].name == "DIIN") {
+    else if(chunk.name == "DIIN") {
       d->childChunkIndex[DIINChunk] = i;
       d->hasDiin = true;
+      valid = readChunkList(reader, chunk.offset, chunkEnd, bigEndian,
+                            "DIIN ", "DIIN chunk", readDiinChunk);
+    }
+    return valid;
+  };
 
-      // Now decode the chunks inside the DIIN chunk
-
-      long long diinChunkEnd = d->chunks[i].offset + d->chunks[i].size;
-      seek(d->chunks[i].offset);
-
-      while(tell() + 12 <= diinChunkEnd) {
-        ByteVector diinChunkName = readBlock(4);
-        long long diinChunkSize = readBlock(8).toLongLong(bigEndian);
-
-        if(!isValidChunkID(diinChunkName)) {
-          debug("DSDIFF::File::read() -- DIIN Chunk '" + diinChunkName + "' has invalid ID");
-          setValid(false);
-          break;
-        }
-
-        if(static_cast<long long>(tell()) + diinChunkSize > diinChunkEnd) {
-          debug("DSDIFF::File::read() -- DIIN Chunk '" + diinChunkName
-                + "' has invalid size (larger than the DIIN chunk)");
-          setValid(false);
-          break;
-        }
-
-        Chunk64 chunk;
-        chunk.name = diinChunkName;
-        chunk.size = diinChunkSize;
-        chunk.offset = tell();
-
-        seek(chunk.size, Current);
-
-        // Check padding
-
-        chunk.padding = 0;
+  // + 12: chunk header at least, fix for additional junk bytes
+  if(!readChunkList(reader, 16, fileLength, bigEndian, "", "file size", readRootChunk) ||
+     !valid) {
+    setValid(false);
+    return;
+  }
 
-        if(offset_t uPosNotPadded = tell(); (uPosNotPadded & 0x01) != 0) {
-          if(ByteVector iByte = readBlock(1);
-             iByte.size() != 1 || iByte[0] != 0)
-            // Not well formed, re-seek
-            seek(uPosNotPadded, Beginning);
-          else
-            chunk.padding = 1;
-        }
-        d->childChunks[DIINChunk].push_back(chunk);
-      }
-    }
-    else if(d->chunks[i].name == "ID3 " || d->chunks[i].name == "id3 ") {
-      d->id3v2TagChunkID = d->chunks[i].name;
-      d->tag.set(ID3v2Index, new ID3v2::Tag(this, d->chunks[i].offset,
+  for(const auto &chunk : d->chunks) {
+    if(chunk.name == "ID3 " || chunk.name == "id3 ") {
+      d->id3v2TagChunkID = chunk.name;
+      d->tag.set(ID3v2Index, new ID3v2::Tag(this, chunk.offset,
                                             d->ID3v2FrameFactory));
       d->isID3InPropChunk = false;
       d->hasID3v2 = true;
     }
   }
 
-  if(!isValid())
-    return;
-
   if(d->childChunkIndex[PROPChunk] < 0) {
     debug("DSDIFF::File::read() -- no PROP chunk found");
     setValid(false);
     return;
   }
 
-  // Read properties
-
-  unsigned int sampleRate = 0;
-  unsigned short channels = 0;
-
   for(unsigned int i = 0; i < d->childChunks[PROPChunk].size(); i++) {
     if(d->childChunks[PROPChunk][i].name == "ID3 " ||
        d->childChunks[PROPChunk][i].name == "id3 ") {
@@ -835,41 +1035,17 @@ void DSDIFF::File::read(bool readProperties, Properties::ReadStyle propertiesSty
       d->isID3InPropChunk = true;
       d->hasID3v2 = true;
     }
-    else if(d->childChunks[PROPChunk][i].name == "FS  ") {
-      // Sample rate
-      seek(d->childChunks[PROPChunk][i].offset);
-      sampleRate = readBlock(4).toUInt(0, 4, bigEndian);
-    }
-    else if(d->childChunks[PROPChunk][i].name == "CHNL") {
-      // Channels
-      seek(d->childChunks[PROPChunk][i].offset);
-      channels = readBlock(2).toShort(0, bigEndian);
-    }
   }
 
-  // Read title & artist from DIIN chunk
+  // Title & artist from DIIN chunk
 
   d->tag.access<DSDIFF::DIIN::Tag>(DIINIndex, true);
 
   if(d->hasDiin) {
-    for(unsigned int i = 0; i < d->childChunks[DIINChunk].size(); i++) {
-      if(d->childChunks[DIINChunk][i].name == "DITI") {
-        seek(d->childChunks[DIINChunk][i].offset);
-        if(unsigned int titleStrLength = readBlock(4).toUInt(0, 4, bigEndian);
-           titleStrLength <= d->childChunks[DIINChunk][i].size) {
-          ByteVector titleStr = readBlock(titleStrLength);
-          d->tag.access<DSDIFF::DIIN::Tag>(DIINIndex, false)->setTitle(titleStr);
-        }
-      }
-      else if(d->childChunks[DIINChunk][i].name == "DIAR") {
-        seek(d->childChunks[DIINChunk][i].offset);
-        if(unsigned int artistStrLength = readBlock(4).toUInt(0, 4, bigEndian);
-           artistStrLength <= d->childChunks[DIINChunk][i].size) {
-          ByteVector artistStr = readBlock(artistStrLength);
-          d->tag.access<DSDIFF::DIIN::Tag>(DIINIndex, false)->setArtist(artistStr);
-        }
-      }
-    }
+    if(hasDiinTitle)
+      d->tag.access<DSDIFF::DIIN::Tag>(DIINIndex, false)->setTitle(diinTitle);
+    if(hasDiinArtist)
+      d->tag.access<DSDIFF::DIIN::Tag>(DIINIndex, false)->setArtist(diinArtist);
   }
 
   if(readProperties) {
@@ -38,8 +38,8 @@
 
 using namespace TagLib;
 
-#define RETURN_ELEMENT_FOR_CASE(eid) \
-  case (eid): return make_unique_element<eid>(id, sizeLength, dataSize, offset)
+#define CREATE_ELEMENT_FOR_CASE(eid) \
+  case (eid): element = make_unique_element<eid>(id, sizeLength, dataSize, offset); break
 
 std::unique_ptr<EBML::Element> EBML::Element::factory(File &file)
 {
@@ -56,80 +56,87 @@ std::unique_ptr<EBML::Element> EBML::Element::factory(File &file)
   if(!sizeLength)
     return nullptr;
 
-  // Return the subclass
+  // Create the subclass
   // The enum switch without default will give us a warning if an ID is missing
   auto id = static_cast<Id>(uintId);
+  std::unique_ptr<Element> element;
   switch(id) {
-    RETURN_ELEMENT_FOR_CASE(Id::EBMLHeader);
-    RETURN_ELEMENT_FOR_CASE(Id::DocType);
-    RETURN_ELEMENT_FOR_CASE(Id::DocTypeVersion);
-    RETURN_ELEMENT_FOR_CASE(Id::MkSegment);
-    RETURN_ELEMENT_FOR_CASE(Id::MkInfo);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTracks);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTags);
-    RETURN_ELEMENT_FOR_CASE(Id::MkAttachments);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTag);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagTargets);
-    RETURN_ELEMENT_FOR_CASE(Id::MkSimpleTag);
-    RETURN_ELEMENT_FOR_CASE(Id::MkAttachedFile);
-    RETURN_ELEMENT_FOR_CASE(Id::MkSeek);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTrackEntry);
-    RETURN_ELEMENT_FOR_CASE(Id::MkAudio);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagName);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagString);
-    RETURN_ELEMENT_FOR_CASE(Id::MkAttachedFileName);
-    RETURN_ELEMENT_FOR_CASE(Id::MkAttachedFileDescription);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagLanguage);
-    RETURN_ELEMENT_FOR_CASE(Id::MkAttachedFileMediaType);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCodecID);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagTargetTypeValue);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagTrackUID);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagEditionUID);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagChapterUID);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagAttachmentUID);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagsLanguageDefault);
-    RETURN_ELEMENT_FOR_CASE(Id::MkAttachedFileUID);
-    RETURN_ELEMENT_FOR_CASE(Id::MkSeekPosition);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTimestampScale);
-    RETURN_ELEMENT_FOR_CASE(Id::MkBitDepth);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChannels);
-    RETURN_ELEMENT_FOR_CASE(Id::MkAttachedFileData);
-    RETURN_ELEMENT_FOR_CASE(Id::MkSeekID);
-    RETURN_ELEMENT_FOR_CASE(Id::MkDuration);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTitle);
-    RETURN_ELEMENT_FOR_CASE(Id::MkSamplingFrequency);
-    RETURN_ELEMENT_FOR_CASE(Id::MkSeekHead);
-    RETURN_ELEMENT_FOR_CASE(Id::VoidElement);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCluster);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCodecState);
-    RETURN_ELEMENT_FOR_CASE(Id::MkTagBinary);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCues);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCuePoint);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueTime);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueTrackPositions);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueTrack);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueClusterPosition);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueRelativePosition);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueDuration);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueBlockNumber);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueCodecState);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueReference);
-    RETURN_ELEMENT_FOR_CASE(Id::MkCueRefTime);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChapters);
-    RETURN_ELEMENT_FOR_CASE(Id::MkEditionEntry);
-    RETURN_ELEMENT_FOR_CASE(Id::MkEditionUID);
-    RETURN_ELEMENT_FOR_CASE(Id::MkEditionFlagDefault);
-    RETURN_ELEMENT_FOR_CASE(Id::MkEditionFlagOrdered);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChapterAtom);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChapterUID);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChapterTimeStart);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChapterTimeEnd);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChapterFlagHidden);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChapterDisplay);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChapString);
-    RETURN_ELEMENT_FOR_CASE(Id::MkChapLanguage);
+    CREATE_ELEMENT_FOR_CASE(Id::EBMLHeader);
+    CREATE_ELEMENT_FOR_CASE(Id::DocType);
+    CREATE_ELEMENT_FOR_CASE(Id::DocTypeVersion);
+    CREATE_ELEMENT_FOR_CASE(Id::MkSegment);
+    CREATE_ELEMENT_FOR_CASE(Id::MkInfo);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTracks);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTags);
+    CREATE_ELEMENT_FOR_CASE(Id::MkAttachments);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTag);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagTargets);
+    CREATE_ELEMENT_FOR_CASE(Id::MkSimpleTag);
+    CREATE_ELEMENT_FOR_CASE(Id::MkAttachedFile);
+    CREATE_ELEMENT_FOR_CASE(Id::MkSeek);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTrackEntry);
+    CREATE_ELEMENT_FOR_CASE(Id::MkAudio);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagName);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagString);
+    CREATE_ELEMENT_FOR_CASE(Id::MkAttachedFileName);
+    CREATE_ELEMENT_FOR_CASE(Id::MkAttachedFileDescription);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagLanguage);
+    CREATE_ELEMENT_FOR_CASE(Id::MkAttachedFileMediaType);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCodecID);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagTargetTypeValue);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagTrackUID);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagEditionUID);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagChapterUID);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagAttachmentUID);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagsLanguageDefault);
+    CREATE_ELEMENT_FOR_CASE(Id::MkAttachedFileUID);
+    CREATE_ELEMENT_FOR_CASE(Id::MkSeekPosition);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTimestampScale);
+    CREATE_ELEMENT_FOR_CASE(Id::MkBitDepth);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChannels);
+    CREATE_ELEMENT_FOR_CASE(Id::MkAttachedFileData);
+    CREATE_ELEMENT_FOR_CASE(Id::MkSeekID);
+    CREATE_ELEMENT_FOR_CASE(Id::MkDuration);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTitle);
+    CREATE_ELEMENT_FOR_CASE(Id::MkSamplingFrequency);
+    CREATE_ELEMENT_FOR_CASE(Id::MkSeekHead);
+    CREATE_ELEMENT_FOR_CASE(Id::VoidElement);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCluster);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCodecState);
+    CREATE_ELEMENT_FOR_CASE(Id::MkTagBinary);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCues);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCuePoint);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueTime);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueTrackPositions);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueTrack);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueClusterPosition);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueRelativePosition);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueDuration);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueBlockNumber);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueCodecState);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueReference);
+    CREATE_ELEMENT_FOR_CASE(Id::MkCueRefTime);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChapters);
+    CREATE_ELEMENT_FOR_CASE(Id::MkEditionEntry);
+    CREATE_ELEMENT_FOR_CASE(Id::MkEditionUID);
+    CREATE_ELEMENT_FOR_CASE(Id::MkEditionFlagDefault);
+    CREATE_ELEMENT_FOR_CASE(Id::MkEditionFlagOrdered);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChapterAtom);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChapterUID);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChapterTimeStart);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChapterTimeEnd);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChapterFlagHidden);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChapterDisplay);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChapString);
+    CREATE_ELEMENT_FOR_CASE(Id::MkChapLanguage);
   }
-  return std::make_unique<Element>(id, sizeLength, dataSize);
+  if(!element)
+    element = std::make_unique<Element>(id, sizeLength, dataSize);
+
+  // Live recordings (e.g. from MediaRecorder) write Segments and Clusters
+  // with all size bits set because the size is not known while streaming.
+  element->unknownSize = dataSize == unknownSizeValue(sizeLength);
+  return element;
 }
 
 unsigned int EBML::Element::readId(File &file)
@@ -199,6 +206,11 @@ int64_t EBML::Element::getDataSize() const
   return dataSize;
 }
 
+bool EBML::Element::hasUnknownSize() const
+{
+  return unknownSize;
+}
+
 ByteVector EBML::Element::render()
 {
   ByteVector buffer = renderId();
@@ -120,6 +120,7 @@ namespace TagLib
       offset_t getSize() const;
       int getSizeLength() const;
       int64_t getDataSize() const;
+      bool hasUnknownSize() const;
       ByteVector renderId() const;
       virtual ByteVector render();
       static std::unique_ptr<Element> factory(File &file);
@@ -129,6 +130,7 @@ namespace TagLib
       Id id;
       int sizeLength;
       offset_t dataSize;
+      bool unknownSize = false;
     };
 
     // Template specializations to ensure that elements for the different IDs
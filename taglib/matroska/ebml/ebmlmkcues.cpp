@@ -45,7 +45,12 @@ std::unique_ptr<Matroska::Cues> EBML::MkCues::parse(offset_t segmentDataOffset)
   cues->setOffset(offset);
   cues->setSize(getSize());
   cues->setID(static_cast<Matroska::Element::ID>(id));
+  parseCuePoints(*cues);
+  return cues;
+}
 
+void EBML::MkCues::parseCuePoints(Matroska::Cues &cues) const
+{
   for(const auto &cuesChild : elements) {
     if(cuesChild->getId() != Id::MkCuePoint)
       continue;
@@ -83,7 +88,6 @@ std::unique_ptr<Matroska::Cues> EBML::MkCues::parse(offset_t segmentDataOffset)
         cuePoint->addCueTrack(std::move(cueTrack));
       }
     }
-    cues->addCuePoint(std::move(cuePoint));
+    cues.addCuePoint(std::move(cuePoint));
   }
-  return cues;
 }
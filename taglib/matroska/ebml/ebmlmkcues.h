@@ -39,6 +39,7 @@ namespace TagLib {
       MkCues();
 
       std::unique_ptr<Matroska::Cues> parse(offset_t segmentDataOffset) const;
+      void parseCuePoints(Matroska::Cues &cues) const;
     };
   }
 }
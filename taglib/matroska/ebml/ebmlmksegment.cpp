@@ -27,6 +27,7 @@
 #include "matroskacues.h"
 #include "matroskaseekhead.h"
 #include "matroskasegment.h"
+#include "tdebug.h"
 
 using namespace TagLib;
 
@@ -49,60 +50,107 @@ offset_t EBML::MkSegment::segmentDataOffset() const
 
 bool EBML::MkSegment::read(File &file)
 {
+  // A segment with unknown size extends to the end of the file.
+  if(unknownSize)
+    dataSize = file.length() - file.tell();
   const offset_t maxOffset = file.tell() + dataSize;
   std::unique_ptr<Element> element;
   int i = 0;
   int seekHeadIndex = -1;
   while((element = findNextElement(file, maxOffset))) {
-    if(const Id id = element->getId(); id == Id::MkSeekHead) {
-      seekHeadIndex = i;
-      seekHead = element_cast<Id::MkSeekHead>(std::move(element));
-      if(!seekHead->read(file))
-        return false;
-    }
-    else if(id == Id::MkCues) {
-      cues = element_cast<Id::MkCues>(std::move(element));
-      if(!cues->read(file))
-        return false;
-    }
-    else if(id == Id::MkInfo) {
-      info = element_cast<Id::MkInfo>(std::move(element));
-      if(!info->read(file))
-        return false;
-    }
-    else if(id == Id::MkTracks) {
-      tracks = element_cast<Id::MkTracks>(std::move(element));
-      if(!tracks->read(file))
-        return false;
-    }
-    else if(id == Id::MkTags) {
-      tags = element_cast<Id::MkTags>(std::move(element));
-      if(!tags->read(file))
-        return false;
-    }
-    else if(id == Id::MkAttachments) {
-      attachments = element_cast<Id::MkAttachments>(std::move(element));
-      if(!attachments->read(file))
-        return false;
-    }
-    else if(id == Id::MkChapters) {
-      chapters = element_cast<Id::MkChapters>(std::move(element));
-      if(!chapters->read(file))
-        return false;
-    }
-    else {
-      if(id == Id::VoidElement
-         && seekHead
-         && seekHeadIndex == i - 1)
-        seekHead->setPadding(element->getSize());
+    if(!readChild(file, std::move(element), maxOffset, i, seekHeadIndex))
+      return false;
+    i++;
+  }
+  return true;
+}
 
-      element->skipData(file);
+bool EBML::MkSegment::read(File &file, const List<offset_t> &elementOffsets)
+{
+  if(unknownSize)
+    dataSize = file.length() - file.tell();
+  const offset_t dataOffset = file.tell();
+  const offset_t maxOffset = dataOffset + dataSize;
+  int i = 0;
+  int seekHeadIndex = -1;
+  for(const auto elementOffset : elementOffsets) {
+    if(elementOffset < dataOffset || elementOffset >= maxOffset) {
+      debug("Element offset outside of segment");
+      return false;
     }
+    file.seek(elementOffset);
+    auto element = Element::factory(file);
+    if(!element || (!isTopLevelId(static_cast<unsigned int>(element->getId())) &&
+                    element->getId() != Id::VoidElement)) {
+      debug("No top level element found at offset");
+      return false;
+    }
+    if(!readChild(file, std::move(element), maxOffset, i, seekHeadIndex))
+      return false;
     i++;
   }
   return true;
 }
 
+bool EBML::MkSegment::readChild(File &file, std::unique_ptr<Element> &&element,
+                                offset_t maxOffset, int index, int &seekHeadIndex)
+{
+  if(const Id id = element->getId(); id == Id::MkSeekHead) {
+    seekHeadIndex = index;
+    seekHead = element_cast<Id::MkSeekHead>(std::move(element));
+    if(!seekHead->read(file))
+      return false;
+  }
+  else if(id == Id::MkCues) {
+    cues = element_cast<Id::MkCues>(std::move(element));
+    if(deferReading)
+      cues->skipData(file);
+    else if(!cues->read(file))
+      return false;
+  }
+  else if(id == Id::MkInfo) {
+    info = element_cast<Id::MkInfo>(std::move(element));
+    if(!info->read(file))
+      return false;
+  }
+  else if(id == Id::MkTracks) {
+    tracks = element_cast<Id::MkTracks>(std::move(element));
+    if(!tracks->read(file))
+      return false;
+  }
+  else if(id == Id::MkTags) {
+    tags = element_cast<Id::MkTags>(std::move(element));
+    if(!tags->read(file))
+      return false;
+  }
+  else if(id == Id::MkAttachments) {
+    attachments = element_cast<Id::MkAttachments>(std::move(element));
+    if(deferReading)
+      attachments->skipData(file);
+    else if(!attachments->read(file))
+      return false;
+  }
+  else if(id == Id::MkChapters) {
+    chapters = element_cast<Id::MkChapters>(std::move(element));
+    if(deferReading)
+      chapters->skipData(file);
+    else if(!chapters->read(file))
+      return false;
+  }
+  else if(element->hasUnknownSize()) {
+    skipUnknownSizeData(file, maxOffset);
+  }
+  else {
+    if(id == Id::VoidElement
+       && seekHead
+       && seekHeadIndex == index - 1)
+      seekHead->setPadding(element->getSize());
+
+    element->skipData(file);
+  }
+  return true;
+}
+
 std::unique_ptr<Matroska::Tag> EBML::MkSegment::parseTag() const
 {
   return tags ? tags->parse() : nullptr;
@@ -110,12 +158,12 @@ std::unique_ptr<Matroska::Tag> EBML::MkSegment::parseTag() const
 
 std::unique_ptr<Matroska::Attachments> EBML::MkSegment::parseAttachments() const
 {
-  return attachments ? attachments->parse() : nullptr;
+  return attachments && !deferReading ? attachments->parse() : nullptr;
 }
 
 std::unique_ptr<Matroska::Chapters> EBML::MkSegment::parseChapters() const
 {
-  return chapters ? chapters->parse() : nullptr;
+  return chapters && !deferReading ? chapters->parse() : nullptr;
 }
 
 std::unique_ptr<Matroska::SeekHead> EBML::MkSegment::parseSeekHead() const
@@ -125,12 +173,31 @@ std::unique_ptr<Matroska::SeekHead> EBML::MkSegment::parseSeekHead() const
 
 std::unique_ptr<Matroska::Cues> EBML::MkSegment::parseCues() const
 {
-  return cues ? cues->parse(segmentDataOffset()) : nullptr;
+  return cues && !deferReading ? cues->parse(segmentDataOffset()) : nullptr;
+}
+
+void EBML::MkSegment::setDeferReading(bool defer)
+{
+  deferReading = defer;
+}
+
+const EBML::MasterElement *EBML::MkSegment::deferredElement(Id elementId) const
+{
+  if(!deferReading)
+    return nullptr;
+  if(elementId == Id::MkCues)
+    return cues.get();
+  if(elementId == Id::MkAttachments)
+    return attachments.get();
+  if(elementId == Id::MkChapters)
+    return chapters.get();
+  return nullptr;
 }
 
 std::unique_ptr<Matroska::Segment> EBML::MkSegment::parseSegment() const
 {
-  return std::make_unique<Matroska::Segment>(sizeLength, dataSize, offset + idSize(id));
+  return std::make_unique<Matroska::Segment>(sizeLength, dataSize, offset + idSize(id),
+                                             unknownSize);
 }
 
 void EBML::MkSegment::parseInfo(Matroska::Properties *properties) const
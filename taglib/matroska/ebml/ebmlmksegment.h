@@ -31,6 +31,7 @@
 #include "ebmlmkinfo.h"
 #include "ebmlmktracks.h"
 #include "taglib.h"
+#include "tlist.h"
 
 namespace TagLib {
   namespace Matroska {
@@ -51,6 +52,9 @@ namespace TagLib {
 
       offset_t segmentDataOffset() const;
       bool read(File &file) override;
+      // Reads only the top level elements at elementOffsets, which have to
+      // be in file order, instead of scanning the whole segment.
+      bool read(File &file, const List<offset_t> &elementOffsets);
       std::unique_ptr<Matroska::Tag> parseTag() const;
       std::unique_ptr<Matroska::Attachments> parseAttachments() const;
       std::unique_ptr<Matroska::Chapters> parseChapters() const;
@@ -60,7 +64,16 @@ namespace TagLib {
       void parseInfo(Matroska::Properties *properties) const;
       void parseTracks(Matroska::Properties *properties) const;
 
+      // When set before read(), Cues, Attachments and Chapters are only
+      // located and their data is skipped. They are not returned by the
+      // parse methods then, but by deferredElement() with offset and size.
+      void setDeferReading(bool defer);
+      const MasterElement *deferredElement(Id elementId) const;
+
     private:
+      bool readChild(File &file, std::unique_ptr<Element> &&element,
+                     offset_t maxOffset, int index, int &seekHeadIndex);
+
       std::unique_ptr<MkTags> tags;
       std::unique_ptr<MkAttachments> attachments;
       std::unique_ptr<MkChapters> chapters;
@@ -68,6 +81,7 @@ namespace TagLib {
       std::unique_ptr<MkCues> cues;
       std::unique_ptr<MkInfo> info;
       std::unique_ptr<MkTracks> tracks;
+      bool deferReading = false;
     };
   }
 }
@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include "ebmlutils.h"
+#include <algorithm>
 #include <random>
 #include "tbytevector.h"
 #include "matroskafile.h"
@@ -45,6 +46,109 @@ std::unique_ptr<EBML::Element> EBML::findNextElement(File &file, offset_t maxOff
   return file.tell() < maxOffset ? Element::factory(file) : nullptr;
 }
 
+bool EBML::isTopLevelId(unsigned int id)
+{
+  switch(static_cast<Element::Id>(id)) {
+  case Element::Id::EBMLHeader:
+  case Element::Id::MkSegment:
+  case Element::Id::MkSeekHead:
+  case Element::Id::MkInfo:
+  case Element::Id::MkTracks:
+  case Element::Id::MkCluster:
+  case Element::Id::MkCues:
+  case Element::Id::MkAttachments:
+  case Element::Id::MkChapters:
+  case Element::Id::MkTags:
+    return true;
+  default:
+    return false;
+  }
+}
+
+namespace {
+
+  // Scan forward for the ID of a top level element, reading at most
+  // UNKNOWN_SIZE_LOOKAHEAD bytes in large blocks. Returns the offset of the
+  // element or -1 if none is found.
+  offset_t scanForTopLevelId(File &file, offset_t maxOffset)
+  {
+    static const ByteVector topLevelIds[] = {
+      ByteVector("\x1F\x43\xB6\x75", 4), // Cluster
+      ByteVector("\x1C\x53\xBB\x6B", 4), // Cues
+      ByteVector("\x12\x54\xC3\x67", 4), // Tags
+      ByteVector("\x19\x41\xA4\x69", 4), // Attachments
+      ByteVector("\x10\x43\xA7\x70", 4), // Chapters
+      ByteVector("\x11\x4D\x9B\x74", 4), // SeekHead
+      ByteVector("\x15\x49\xA9\x66", 4), // Info
+      ByteVector("\x16\x54\xAE\x6B", 4), // Tracks
+      ByteVector("\x18\x53\x80\x67", 4), // Segment
+      ByteVector("\x1A\x45\xDF\xA3", 4)  // EBML header
+    };
+    constexpr offset_t blockSize = 64 * 1024;
+    constexpr unsigned int idLength = 4;
+
+    const offset_t startOffset = file.tell();
+    const offset_t endOffset = std::min(maxOffset, startOffset + EBML::UNKNOWN_SIZE_LOOKAHEAD);
+    offset_t blockOffset = startOffset;
+    while(blockOffset < endOffset) {
+      const auto length = static_cast<size_t>(std::min(blockSize, endOffset - blockOffset));
+      file.seek(blockOffset);
+      const ByteVector block = file.readBlock(length);
+      if(block.size() < idLength)
+        break;
+
+      int found = -1;
+      for(const auto &id : topLevelIds) {
+        if(const int pos = block.find(id); pos >= 0 && (found < 0 || pos < found))
+          found = pos;
+      }
+      if(found >= 0)
+        return blockOffset + found;
+
+      if(block.size() < length)
+        break;
+      // Overlap the blocks so that IDs crossing a block boundary are found.
+      blockOffset += block.size() - (idLength - 1);
+    }
+    return -1;
+  }
+
+}
+
+void EBML::skipUnknownSizeData(File &file, offset_t maxOffset)
+{
+  // An element with unknown size ends with the first element which is not
+  // a valid child, i.e. a top level element. The children are walked using
+  // only their headers, so this costs one small read per child.
+  while(file.tell() < maxOffset) {
+    const offset_t childOffset = file.tell();
+    const unsigned int childId = Element::readId(file);
+    if(childId && isTopLevelId(childId)) {
+      file.seek(childOffset);
+      return;
+    }
+    const auto &[sizeLength, dataSize] = childId
+      ? readVINT(file) : std::pair<unsigned int, uint64_t>(0, 0);
+    if(!sizeLength || dataSize == unknownSizeValue(sizeLength)) {
+      // The children cannot be parsed, resynchronize on the next top level
+      // element within a bounded window.
+      debug("Scanning for end of element with unknown size");
+      file.seek(childOffset + 1);
+      if(const offset_t nextOffset = scanForTopLevelId(file, maxOffset); nextOffset >= 0)
+        file.seek(nextOffset);
+      else
+        file.seek(maxOffset);
+      return;
+    }
+    if(static_cast<uint64_t>(maxOffset - file.tell()) < dataSize) {
+      // Last child of a truncated live recording
+      file.seek(maxOffset);
+      return;
+    }
+    file.seek(static_cast<offset_t>(dataSize), File::Position::Current);
+  }
+}
+
 template <int maxSizeLength>
 unsigned int EBML::VINTSizeLength(uint8_t firstByte)
 {
@@ -33,6 +33,12 @@ namespace TagLib {
   namespace EBML {
     std::unique_ptr<Element> findElement(File &file, Element::Id id, offset_t maxOffset);
     std::unique_ptr<Element> findNextElement(File &file, offset_t maxOffset);
+    void skipUnknownSizeData(File &file, offset_t maxOffset);
+    bool isTopLevelId(unsigned int id);
+
+    // Maximum number of bytes scanned for the next top level element when
+    // the children of an element with unknown size cannot be parsed.
+    inline constexpr offset_t UNKNOWN_SIZE_LOOKAHEAD = 1024 * 1024;
 
     template <int maxSizeLength>
     unsigned int VINTSizeLength(uint8_t firstByte);
@@ -60,6 +66,12 @@ namespace TagLib {
       return 0;
     }
 
+    constexpr uint64_t unknownSizeValue(unsigned int sizeLength)
+    {
+      return sizeLength >= 1 && sizeLength <= 8
+        ? (1ULL << (7 * sizeLength)) - 1 : 0;
+    }
+
     constexpr int idSize(Element::Id id)
     {
       const auto uintId = static_cast<unsigned int>(id);
@@ -125,6 +125,13 @@ bool Matroska::Cues::sizeChanged(Element &caller, offset_t delta)
     return false;
 
   const offset_t offset = caller.offset() - segmentDataOffset;
+  if(deferred) {
+    // The cluster positions are unknown, so the cues have to be read and
+    // rendered.
+    deferredOffsetChanges.append({offset, delta});
+    setNeedsRender(true);
+    return true;
+  }
   for(const auto &cuePoint : cuePoints) {
     if(cuePoint->adjustOffset(offset, delta)) {
       setNeedsRender(true);
@@ -133,6 +140,23 @@ bool Matroska::Cues::sizeChanged(Element &caller, offset_t delta)
   return true;
 }
 
+void Matroska::Cues::setDeferred(bool deferCuePoints)
+{
+  if(deferred && !deferCuePoints) {
+    for(const auto &[offset, delta] : deferredOffsetChanges) {
+      for(const auto &cuePoint : cuePoints)
+        cuePoint->adjustOffset(offset, delta);
+    }
+    deferredOffsetChanges.clear();
+  }
+  deferred = deferCuePoints;
+}
+
+bool Matroska::Cues::isDeferred() const
+{
+  return deferred;
+}
+
 bool Matroska::Cues::isValid(TagLib::File &file) const
 {
   for(const auto &cuePoint : cuePoints) {
@@ -23,6 +23,7 @@
 #ifndef DO_NOT_DOCUMENT
 
 #include <optional>
+#include <utility>
 
 #include "tlist.h"
 #include "matroskaelement.h"
@@ -50,12 +51,19 @@ namespace TagLib {
       bool sizeChanged(Element &caller, offset_t delta) override;
       void write(TagLib::File &file) override;
 
+      // Deferred cues have no cue points yet, the offset changes received
+      // until setDeferred(false) are applied to the cue points added then.
+      void setDeferred(bool deferred);
+      bool isDeferred() const;
+
     private:
       friend class EBML::MkCues;
       ByteVector renderInternal() override;
 
       CuePointList cuePoints;
       const offset_t segmentDataOffset;
+      bool deferred = false;
+      List<std::pair<offset_t, offset_t>> deferredOffsetChanges;
     };
 
     class CuePoint
@@ -41,6 +41,65 @@
 
 using namespace TagLib;
 
+namespace {
+
+  // Placeholder for an Attachments or Chapters element which was skipped
+  // when the file was opened without audio properties. It is a size listener
+  // in save() so that its offset follows relocations, but it is never
+  // rendered or written.
+  class DeferredElement : public Matroska::Element
+  {
+  public:
+    explicit DeferredElement(const EBML::MasterElement &element) :
+      Element(static_cast<ID>(element.getId()))
+    {
+      setOffset(element.getOffset());
+      setSize(element.getSize());
+      setNeedsRender(false);
+    }
+
+    void write(TagLib::File &) override
+    {
+    }
+
+    bool isRead() const
+    {
+      return read;
+    }
+
+    void setRead()
+    {
+      read = true;
+    }
+
+  private:
+    ByteVector renderInternal() override
+    {
+      return {};
+    }
+
+    bool read = false;
+  };
+
+  // The file position is restored, the const accessors read through here.
+  template <EBML::Element::Id ID>
+  std::unique_ptr<typename EBML::GetElementTypeById<ID>::type>
+  readDeferredElement(TagLib::File &file, offset_t offset)
+  {
+    const offset_t position = file.tell();
+    file.seek(offset);
+    auto element = EBML::Element::factory(file);
+    const bool ok = element && element->getId() == ID && element->read(file);
+    file.seek(position);
+    if(!ok) {
+      debug("Failed to read deferred Matroska element");
+      return nullptr;
+    }
+    return EBML::element_cast<ID>(std::move(element));
+  }
+
+}
+
 class Matroska::File::FilePrivate
 {
 public:
@@ -57,6 +116,15 @@ public:
   std::unique_ptr<Cues> cues;
   std::unique_ptr<Segment> segment;
   std::unique_ptr<Properties> properties;
+
+  // Elements skipped when opened without audio properties, they are read
+  // when they are accessed. The placeholders are kept after that because
+  // other elements may still have them as size listeners.
+  std::unique_ptr<DeferredElement> deferredAttachments;
+  std::unique_ptr<DeferredElement> deferredChapters;
+  // File offset of deferred cues, the cues are read in save() if a size
+  // change requires updating their cluster positions
+  offset_t deferredCuesOffset = 0;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -99,6 +167,19 @@ Matroska::File::File(IOStream *stream, bool readProperties,
   read(readProperties, readStyle);
 }
 
+Matroska::File::File(IOStream *stream, const List<offset_t> &elementOffsets,
+                     bool readProperties, Properties::ReadStyle readStyle) :
+  TagLib::File(stream),
+  d(std::make_unique<FilePrivate>())
+{
+  if(!isOpen()) {
+    debug("Failed to open matroska file");
+    setValid(false);
+    return;
+  }
+  read(readProperties, readStyle, elementOffsets);
+}
+
 Matroska::File::~File() = default;
 
 Matroska::Properties *Matroska::File::audioProperties() const
@@ -173,7 +254,7 @@ namespace {
 StringList Matroska::File::complexPropertyKeys() const
 {
   StringList keys = TagLib::File::complexPropertyKeys();
-  if(d->attachments) {
+  if(attachments()) {
     const auto &attachedFiles = d->attachments->attachedFileList();
     for(const auto &attachedFile : attachedFiles) {
       if(String key = keyForAttachedFile(attachedFile);
@@ -182,7 +263,7 @@ StringList Matroska::File::complexPropertyKeys() const
       }
     }
   }
-  if(d->chapters && !d->chapters->chapterEditionList().isEmpty()) {
+  if(chapters() && !d->chapters->chapterEditionList().isEmpty()) {
     keys.append("CHAPTERS");
   }
   return keys;
@@ -192,7 +273,7 @@ List<VariantMap> Matroska::File::complexProperties(const String &key) const
 {
   List<VariantMap> props = TagLib::File::complexProperties(key);
   if(key.upper() == "CHAPTERS") {
-    if(d->chapters) {
+    if(chapters()) {
       for(const auto &edition : d->chapters->chapterEditionList()) {
         VariantMap property;
         if(const auto uid = edition.uid()) {
@@ -240,7 +321,7 @@ List<VariantMap> Matroska::File::complexProperties(const String &key) const
       }
     }
   }
-  if(d->attachments) {
+  if(attachments()) {
     const auto &attachedFiles = d->attachments->attachedFileList();
     for(const auto &attachedFile : attachedFiles) {
       if(keyMatchesAttachedFile(key, attachedFile)) {
@@ -345,6 +426,12 @@ bool Matroska::File::setComplexProperties(const String &key, const List<VariantM
 
 Matroska::Attachments *Matroska::File::attachments(bool create) const
 {
+  if(d->deferredAttachments && !d->deferredAttachments->isRead()) {
+    d->deferredAttachments->setRead();
+    if(const auto element = readDeferredElement<EBML::Element::Id::MkAttachments>(
+         const_cast<File &>(*this), d->deferredAttachments->offset()))
+      d->attachments = element->parse();
+  }
   if(!d->attachments && create)
     d->attachments = std::make_unique<Attachments>();
   return d->attachments.get();
@@ -352,12 +439,19 @@ Matroska::Attachments *Matroska::File::attachments(bool create) const
 
 Matroska::Chapters *Matroska::File::chapters(bool create) const
 {
+  if(d->deferredChapters && !d->deferredChapters->isRead()) {
+    d->deferredChapters->setRead();
+    if(const auto element = readDeferredElement<EBML::Element::Id::MkChapters>(
+         const_cast<File &>(*this), d->deferredChapters->offset()))
+      d->chapters = element->parse();
+  }
   if(!d->chapters && create)
     d->chapters = std::make_unique<Chapters>();
   return d->chapters.get();
 }
 
-void Matroska::File::read(bool readProperties, Properties::ReadStyle readStyle)
+void Matroska::File::read(bool readProperties, Properties::ReadStyle readStyle,
+                          const List<offset_t> &elementOffsets)
 {
   const offset_t fileLength = length();
 
@@ -379,7 +473,7 @@ void Matroska::File::read(bool readProperties, Properties::ReadStyle readStyle)
   // Find the Matroska segment in the file
   const std::unique_ptr<EBML::MkSegment> segment(
     EBML::element_cast<EBML::Element::Id::MkSegment>(
-      EBML::findElement(*this, EBML::Element::Id::MkSegment, fileLength - tell())
+      EBML::findElement(*this, EBML::Element::Id::MkSegment, fileLength)
     )
   );
   if(!segment) {
@@ -388,8 +482,12 @@ void Matroska::File::read(bool readProperties, Properties::ReadStyle readStyle)
     return;
   }
 
-  // Read the segment into memory from file
-  if(!segment->read(*this)) {
+  // Read the segment into memory from file. When only tags are needed,
+  // e.g. to edit them, the potentially large Cues, Attachments and Chapters
+  // are skipped and read on demand.
+  segment->setDeferReading(!readProperties && readStyle != AudioProperties::Accurate);
+  if(!(elementOffsets.isEmpty() ? segment->read(*this)
+                                : segment->read(*this, elementOffsets))) {
     debug("Failed to read segment");
     setValid(false);
     return;
@@ -402,6 +500,19 @@ void Matroska::File::read(bool readProperties, Properties::ReadStyle readStyle)
   d->tag = segment->parseTag();
   d->attachments = segment->parseAttachments();
   d->chapters = segment->parseChapters();
+  if(const auto cues = segment->deferredElement(EBML::Element::Id::MkCues)) {
+    d->cues = std::make_unique<Cues>(segment->segmentDataOffset());
+    d->cues->setOffset(cues->getOffset());
+    d->cues->setSize(cues->getSize());
+    d->cues->setDeferred(true);
+    d->deferredCuesOffset = cues->getOffset();
+  }
+  if(const auto attachments = segment->deferredElement(EBML::Element::Id::MkAttachments)) {
+    d->deferredAttachments = std::make_unique<DeferredElement>(*attachments);
+  }
+  if(const auto chapters = segment->deferredElement(EBML::Element::Id::MkChapters)) {
+    d->deferredChapters = std::make_unique<DeferredElement>(*chapters);
+  }
 
   if(readProperties) {
     d->properties = std::make_unique<Properties>(this);
@@ -493,6 +604,13 @@ bool Matroska::File::save()
   if(renderList.isEmpty() && newElements.isEmpty())
     return true;
 
+  // Unread attachments and chapters are not written, but their offsets
+  // have to follow the size changes of the elements in front of them.
+  for(auto deferred : {d->deferredAttachments.get(), d->deferredChapters.get()}) {
+    if(deferred && !deferred->isRead())
+      renderList.append(deferred);
+  }
+
   auto sortAscending = [](const auto a, const auto b) { return a->offset() < b->offset(); };
   renderList.sort(sortAscending);
   renderList.append(newElements);
@@ -542,6 +660,17 @@ bool Matroska::File::save()
     for(const auto element : renderList) {
       if(element->needsRender()) {
         rendering = true;
+        // Deferred cues need rendering when clusters may have moved, they
+        // are read from the unchanged file before that.
+        if(element == d->cues.get() && d->cues->isDeferred()) {
+          const auto cues = readDeferredElement<EBML::Element::Id::MkCues>(
+            *this, d->deferredCuesOffset);
+          if(!cues) {
+            return false;
+          }
+          cues->parseCuePoints(*d->cues);
+          d->cues->setDeferred(false);
+        }
         if(!element->render()) {
           return false;
         }
@@ -555,5 +684,8 @@ bool Matroska::File::save()
   for(const auto element : renderList)
     element->write(*this);
 
+  if(d->cues && d->cues->isDeferred())
+    d->deferredCuesOffset = d->cues->offset();
+
   return true;
 }
@@ -23,6 +23,7 @@
 
 #include "taglib_export.h"
 #include "tfile.h"
+#include "tlist.h"
 #include "matroskaproperties.h"
 
 //! An implementation of Matroska metadata
@@ -44,7 +45,9 @@ namespace TagLib::Matroska {
      * file's audio properties will also be read.
      *
      * If \a readStyle is \c Accurate all seek head and cues segment positions
-     * are verified for the isValid() state of the file.
+     * are verified for the isValid() state of the file. Otherwise, if
+     * \a readProperties is \c false, cues, attachments and chapters are
+     * only read when they are accessed or when save() has to update them.
      */
     explicit File(FileName file, bool readProperties = true,
                   Properties::ReadStyle readStyle = Properties::Average);
@@ -54,11 +57,27 @@ namespace TagLib::Matroska {
      * file's audio properties will also be read.
      *
      * If \a readStyle is \c Accurate all seek head and cues segment positions
-     * are verified for the isValid() state of the file.
+     * are verified for the isValid() state of the file. Otherwise, if
+     * \a readProperties is \c false, cues, attachments and chapters are
+     * only read when they are accessed or when save() has to update them.
      */
     explicit File(IOStream *stream, bool readProperties = true,
                   Properties::ReadStyle readStyle = Properties::Average);
 
+    /*!
+     * Constructs a Matroska file from \a stream, reading only the top level
+     * elements of the segment at \a elementOffsets instead of scanning the
+     * segment for them, e.g. with the offsets recorded from an earlier open
+     * of the unchanged file. The offsets have to be in file order and cover
+     * the SeekHead, Info, Tracks, Tags, Attachments, Chapters and Cues
+     * elements of the file, and a Void element directly following the
+     * SeekHead. If an offset does not point to a top level element, the
+     * file is not valid.
+     */
+    File(IOStream *stream, const List<offset_t> &elementOffsets,
+         bool readProperties = true,
+         Properties::ReadStyle readStyle = Properties::Average);
+
     /*!
      * Destroys this instance of the File.
      */
@@ -175,7 +194,8 @@ namespace TagLib::Matroska {
     static bool isSupported(IOStream *stream);
 
   private:
-    void read(bool readProperties, Properties::ReadStyle readStyle);
+    void read(bool readProperties, Properties::ReadStyle readStyle,
+              const List<offset_t> &elementOffsets = List<offset_t>());
     class FilePrivate;
     friend class Properties;
     TAGLIB_MSVC_SUPPRESS_WARNING_NEEDS_TO_HAVE_DLL_INTERFACE
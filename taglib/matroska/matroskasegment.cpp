@@ -24,9 +24,10 @@
 
 using namespace TagLib;
 
-Matroska::Segment::Segment(offset_t sizeLength, offset_t dataSize, offset_t lengthOffset) :
+Matroska::Segment::Segment(offset_t sizeLength, offset_t dataSize, offset_t lengthOffset,
+                           bool unknownSize) :
   Element(static_cast<ID>(EBML::Element::Id::MkSegment)),
-  sizeLength(sizeLength), dataSize(dataSize)
+  sizeLength(sizeLength), dataSize(dataSize), unknownSize(unknownSize)
 {
   setOffset(lengthOffset);
   setSize(sizeLength);
@@ -36,6 +37,11 @@ Matroska::Segment::~Segment() = default;
 
 ByteVector Matroska::Segment::renderInternal()
 {
+  // New elements are only appended at the end of the file, so a segment with
+  // unknown size still covers them and its size does not have to be converted.
+  if(unknownSize)
+    return EBML::renderVINT(EBML::unknownSizeValue(static_cast<unsigned int>(sizeLength)),
+                            static_cast<int>(sizeLength));
   return EBML::renderVINT(dataSize, static_cast<int>(sizeLength));
 }
 
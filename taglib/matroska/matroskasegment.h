@@ -28,7 +28,8 @@ namespace TagLib::Matroska {
   class Segment : public Element
   {
   public:
-    Segment(offset_t sizeLength, offset_t dataSize, offset_t lengthOffset);
+    Segment(offset_t sizeLength, offset_t dataSize, offset_t lengthOffset,
+            bool unknownSize = false);
     ~Segment() override;
     bool render() override;
     bool sizeChanged(Element &caller, offset_t delta) override;
@@ -39,6 +40,7 @@ namespace TagLib::Matroska {
 
     offset_t sizeLength;
     offset_t dataSize;
+    bool unknownSize;
   };
 }
 
@@ -25,10 +25,13 @@
 
 #include "mp4tag.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <utility>
 
 #include "tdebug.h"
 #include "tpropertymap.h"
+#include "tsimd.h"
 #include "mp4itemfactory.h"
 #include "mp4atom.h"
 #include "mp4coverart.h"
@@ -36,6 +39,67 @@
 
 using namespace TagLib;
 
+namespace
+{
+  // Adds delta to the count big-endian 32-bit chunk offsets in table which
+  // are greater than threshold.  The result wraps like the 32-bit field.
+  void adjustChunkOffsets32(char *table, size_t count, offset_t threshold, offset_t delta)
+  {
+    // Offsets are adjusted if they are at least lower.
+    const unsigned long long lower = threshold < 0 ? 0 : threshold + 1ULL;
+    if(lower > 0xffffffffULL)
+      return;
+
+    const auto lower32 = static_cast<uint32_t>(lower);
+    const auto delta32 = static_cast<uint32_t>(delta);
+
+    size_t i = 0;
+
+#ifdef TAGLIB_SIMD
+    using namespace Utils::Simd;
+    const Vector lowerVector = splat32(lower32);
+    const Vector deltaVector = splat32(delta32);
+    for(; i + 4 <= count; i += 4) {
+      char *p = table + i * 4;
+      const Vector offsets = byteSwap32(load(p));
+      const Vector unchanged = greater32(lowerVector, offsets);
+      store(p, byteSwap32(select(unchanged, offsets, add32(offsets, deltaVector))));
+    }
+#endif
+
+    for(; i < count; ++i) {
+      auto *p = reinterpret_cast<unsigned char *>(table + i * 4);
+      uint32_t o = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8)  |  static_cast<uint32_t>(p[3]);
+      if(o >= lower32) {
+        o += delta32;
+        p[0] = static_cast<unsigned char>(o >> 24);
+        p[1] = static_cast<unsigned char>(o >> 16);
+        p[2] = static_cast<unsigned char>(o >> 8);
+        p[3] = static_cast<unsigned char>(o);
+      }
+    }
+  }
+
+  // The 64-bit counterpart of adjustChunkOffsets32().
+  void adjustChunkOffsets64(char *table, size_t count, offset_t threshold, offset_t delta)
+  {
+    for(size_t i = 0; i < count; ++i) {
+      auto *p = reinterpret_cast<unsigned char *>(table + i * 8);
+      unsigned long long o = 0;
+      for(size_t j = 0; j < 8; ++j)
+        o = (o << 8) | p[j];
+      if(static_cast<long long>(o) > threshold) {
+        o += static_cast<unsigned long long>(delta);
+        for(size_t j = 8; j > 0; --j) {
+          p[j - 1] = static_cast<unsigned char>(o);
+          o >>= 8;
+        }
+      }
+    }
+  }
+}  // namespace
+
 class MP4::Tag::TagPrivate
 {
 public:
@@ -197,17 +261,12 @@ MP4::Tag::updateOffsets(offset_t delta, offset_t offset)
       }
       d->file->seek(atom->offset() + 12);
       ByteVector data = d->file->readBlock(atom->length() - 12);
-      unsigned int count = data.toUInt();
+      if(data.size() < 4)
+        continue;
+      const size_t count = std::min<size_t>(data.toUInt(), (data.size() - 4) / 4);
+      adjustChunkOffsets32(data.data() + 4, count, offset, delta);
       d->file->seek(atom->offset() + 16);
-      unsigned int pos = 4;
-      while(count--) {
-        auto o = static_cast<offset_t>(data.toUInt(pos));
-        if(o > offset) {
-          o += delta;
-        }
-        d->file->writeBlock(ByteVector::fromUInt(static_cast<unsigned int>(o)));
-        pos += 4;
-      }
+      d->file->writeBlock(data.mid(4, static_cast<unsigned int>(count * 4)));
     }
 
     const MP4::AtomList co64 = moov->findall("co64", true);
@@ -217,17 +276,12 @@ MP4::Tag::updateOffsets(offset_t delta, offset_t offset)
       }
       d->file->seek(atom->offset() + 12);
       ByteVector data = d->file->readBlock(atom->length() - 12);
-      unsigned int count = data.toUInt();
+      if(data.size() < 4)
+        continue;
+      const size_t count = std::min<size_t>(data.toUInt(), (data.size() - 4) / 8);
+      adjustChunkOffsets64(data.data() + 4, count, offset, delta);
       d->file->seek(atom->offset() + 16);
-      unsigned int pos = 4;
-      while(count--) {
-        long long o = data.toLongLong(pos);
-        if(o > offset) {
-          o += delta;
-        }
-        d->file->writeBlock(ByteVector::fromLongLong(o));
-        pos += 8;
-      }
+      d->file->writeBlock(data.mid(4, static_cast<unsigned int>(count * 8)));
     }
   }
 
@@ -29,6 +29,7 @@
 
 #include "tdebug.h"
 #include "tmap.h"
+#include "tsearch.h"
 #include "oggpage.h"
 #include "oggpageheader.h"
 
@@ -117,7 +118,7 @@ void Ogg::File::setPacket(unsigned int i, const ByteVector &p)
 const Ogg::PageHeader *Ogg::File::firstPageHeader()
 {
   if(!d->firstPageHeader) {
-    const offset_t firstPageHeaderOffset = find("OggS");
+    const offset_t firstPageHeaderOffset = Utils::findInFile(this, "OggS");
     if(firstPageHeaderOffset < 0)
       return nullptr;
 
@@ -130,7 +131,7 @@ const Ogg::PageHeader *Ogg::File::firstPageHeader()
 const Ogg::PageHeader *Ogg::File::lastPageHeader()
 {
   if(!d->lastPageHeader) {
-    const offset_t lastPageHeaderOffset = rfind("OggS");
+    const offset_t lastPageHeaderOffset = Utils::rfindInFile(this, "OggS");
     if(lastPageHeaderOffset < 0)
       return nullptr;
 
@@ -183,7 +184,7 @@ bool Ogg::File::readPages(unsigned int i)
 
     if(d->pages.isEmpty()) {
       packetIndex = 0;
-      offset = find("OggS");
+      offset = Utils::findInFile(this, "OggS");
       if(offset < 0)
         return false;
     }
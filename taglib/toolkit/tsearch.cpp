@@ -0,0 +1,221 @@
+/***************************************************************************
+ *   This library is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License version   *
+ *   2.1 as published by the Free Software Foundation.                     *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful, but   *
+ *   WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA         *
+ *   02110-1301  USA                                                       *
+ *                                                                         *
+ *   Alternatively, this file is available under the Mozilla Public        *
+ *   License Version 1.1.  You may obtain a copy of the License at         *
+ *   http://www.mozilla.org/MPL/                                           *
+ ***************************************************************************/
+
+#include "tsearch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tbytevector.h"
+#include "tfile.h"
+#include "tsimd.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace TagLib;
+
+namespace
+{
+  constexpr size_t blockSize = 16;
+
+  // Returns a bit mask of the positions i in [0, 16) of the block at
+  // data, where data[i] == first and data[i + patternLength - 1] == last.
+  inline unsigned int candidateMask(const char *data, size_t patternLength,
+                                    char first, char last)
+  {
+#ifdef TAGLIB_SIMD
+    using namespace Utils::Simd;
+    const Vector eq = bitAnd(equal8(load(data), splat8(first)),
+                             equal8(load(data + patternLength - 1), splat8(last)));
+    return highBits8(eq);
+#else
+    unsigned int mask = 0;
+    for(size_t i = 0; i < blockSize; ++i) {
+      if(data[i] == first && data[i + patternLength - 1] == last)
+        mask |= 1U << i;
+    }
+    return mask;
+#endif
+  }
+
+  inline unsigned int lowestBit(unsigned int mask)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+  }
+
+  inline unsigned int highestBit(unsigned int mask)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return index;
+#else
+    return 31 - static_cast<unsigned int>(__builtin_clz(mask));
+#endif
+  }
+
+  // The first and last bytes of a candidate already match.
+  inline bool matchesAt(const char *data, const char *pattern, size_t patternLength)
+  {
+    return patternLength <= 2 || ::memcmp(data + 1, pattern + 1, patternLength - 2) == 0;
+  }
+}  // namespace
+
+long long Utils::findBytes(const char *data, size_t length,
+                           const char *pattern, size_t patternLength)
+{
+  if(patternLength == 0 || patternLength > length)
+    return -1;
+
+  if(patternLength == 1) {
+    const void *p = ::memchr(data, pattern[0], length);
+    return p ? static_cast<const char *>(p) - data : -1;
+  }
+
+  const char first = pattern[0];
+  const char last = pattern[patternLength - 1];
+  const size_t candidates = length - patternLength + 1;
+
+  size_t i = 0;
+  for(; i + blockSize <= candidates; i += blockSize) {
+    for(unsigned int mask = candidateMask(data + i, patternLength, first, last);
+        mask != 0; mask &= mask - 1) {
+      const size_t pos = i + lowestBit(mask);
+      if(matchesAt(data + pos, pattern, patternLength))
+        return static_cast<long long>(pos);
+    }
+  }
+
+  for(; i < candidates; ++i) {
+    if(data[i] == first && data[i + patternLength - 1] == last &&
+       matchesAt(data + i, pattern, patternLength))
+      return static_cast<long long>(i);
+  }
+
+  return -1;
+}
+
+long long Utils::rfindBytes(const char *data, size_t length,
+                            const char *pattern, size_t patternLength)
+{
+  if(patternLength == 0 || patternLength > length)
+    return -1;
+
+  const char first = pattern[0];
+  const char last = pattern[patternLength - 1];
+  size_t candidates = length - patternLength + 1;
+
+  for(; candidates >= blockSize; candidates -= blockSize) {
+    const size_t i = candidates - blockSize;
+    for(unsigned int mask = candidateMask(data + i, patternLength, first, last);
+        mask != 0; mask &= ~(1U << highestBit(mask))) {
+      const size_t pos = i + highestBit(mask);
+      if(matchesAt(data + pos, pattern, patternLength))
+        return static_cast<long long>(pos);
+    }
+  }
+
+  while(candidates > 0) {
+    const size_t i = --candidates;
+    if(data[i] == first && data[i + patternLength - 1] == last &&
+       matchesAt(data + i, pattern, patternLength))
+      return static_cast<long long>(i);
+  }
+
+  return -1;
+}
+
+offset_t Utils::findInFile(File *file, const ByteVector &pattern,
+                           offset_t fromOffset, offset_t toOffset, size_t windowSize)
+{
+  const auto patternLength = static_cast<offset_t>(pattern.size());
+  if(!file || patternLength == 0)
+    return -1;
+
+  const offset_t originalPosition = file->tell();
+  const offset_t end = toOffset < 0 ? file->length() : std::min(toOffset, file->length());
+  const offset_t step = std::max<offset_t>(static_cast<offset_t>(windowSize), patternLength);
+
+  offset_t result = -1;
+
+  // Windows overlap by patternLength - 1 bytes, so that a match crossing a
+  // window boundary is found.
+  for(offset_t windowStart = std::max<offset_t>(fromOffset, 0);
+      end - windowStart >= patternLength;
+      windowStart += step - patternLength + 1) {
+    const offset_t windowLength = std::min(step, end - windowStart);
+    file->seek(windowStart);
+    const ByteVector window = file->readBlock(static_cast<size_t>(windowLength));
+
+    if(const long long pos = findBytes(window.data(), window.size(),
+                                       pattern.data(), pattern.size()); pos >= 0) {
+      result = windowStart + pos;
+      break;
+    }
+
+    if(static_cast<offset_t>(window.size()) < windowLength)
+      break;
+  }
+
+  file->seek(originalPosition);
+  return result;
+}
+
+offset_t Utils::rfindInFile(File *file, const ByteVector &pattern,
+                            offset_t fromOffset, offset_t toOffset, size_t windowSize)
+{
+  const auto patternLength = static_cast<offset_t>(pattern.size());
+  if(!file || patternLength == 0)
+    return -1;
+
+  const offset_t originalPosition = file->tell();
+  const offset_t begin = std::max<offset_t>(fromOffset, 0);
+  const offset_t step = std::max<offset_t>(static_cast<offset_t>(windowSize), patternLength);
+
+  offset_t result = -1;
+
+  for(offset_t windowEnd = toOffset < 0 ? file->length() : std::min(toOffset, file->length());
+      windowEnd - begin >= patternLength;
+      windowEnd -= step - patternLength + 1) {
+    const offset_t windowStart = std::max(begin, windowEnd - step);
+    file->seek(windowStart);
+    const ByteVector window = file->readBlock(static_cast<size_t>(windowEnd - windowStart));
+
+    if(const long long pos = rfindBytes(window.data(), window.size(),
+                                        pattern.data(), pattern.size()); pos >= 0) {
+      result = windowStart + pos;
+      break;
+    }
+
+    if(windowStart == begin)
+      break;
+  }
+
+  file->seek(originalPosition);
+  return result;
+}
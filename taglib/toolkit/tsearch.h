@@ -0,0 +1,87 @@
+/***************************************************************************
+ *   This library is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License version   *
+ *   2.1 as published by the Free Software Foundation.                     *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful, but   *
+ *   WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA         *
+ *   02110-1301  USA                                                       *
+ *                                                                         *
+ *   Alternatively, this file is available under the Mozilla Public        *
+ *   License Version 1.1.  You may obtain a copy of the License at         *
+ *   http://www.mozilla.org/MPL/                                           *
+ ***************************************************************************/
+
+#ifndef TAGLIB_SEARCH_H
+#define TAGLIB_SEARCH_H
+
+// THIS FILE IS NOT A PART OF THE TAGLIB API
+
+#ifndef DO_NOT_DOCUMENT  // tell Doxygen not to document this header
+
+#include <cstddef>
+
+#include "taglib.h"
+
+namespace TagLib
+{
+  class ByteVector;
+  class File;
+
+  namespace Utils
+  {
+    /*!
+     * Returns the offset of the first occurrence of \a pattern in \a data,
+     * or -1 if it is not found.
+     *
+     * Candidates are filtered by comparing the first and the last byte of the
+     * pattern 16 positions at a time (SSE2, wasm simd128 or NEON), only
+     * positions where both match are compared completely.
+     */
+    long long findBytes(const char *data, size_t length,
+                        const char *pattern, size_t patternLength);
+
+    /*!
+     * Returns the offset of the last occurrence of \a pattern in \a data,
+     * or -1 if it is not found.
+     */
+    long long rfindBytes(const char *data, size_t length,
+                         const char *pattern, size_t patternLength);
+
+    /*!
+     * Returns the offset of the first occurrence of \a pattern in \a file
+     * which starts at or after \a fromOffset and ends at or before
+     * \a toOffset, or -1 if it is not found.  A negative \a toOffset means
+     * the end of the file.
+     *
+     * The file is read in windows of \a windowSize bytes.  The file position
+     * is restored afterwards.
+     */
+    offset_t findInFile(File *file, const ByteVector &pattern,
+                        offset_t fromOffset = 0, offset_t toOffset = -1,
+                        size_t windowSize = 64 * 1024);
+
+    /*!
+     * Returns the offset of the last occurrence of \a pattern in \a file
+     * which starts at or after \a fromOffset and ends at or before
+     * \a toOffset, or -1 if it is not found.  A negative \a toOffset means
+     * the end of the file.
+     *
+     * The file is read backwards in windows of \a windowSize bytes.  The file
+     * position is restored afterwards.
+     */
+    offset_t rfindInFile(File *file, const ByteVector &pattern,
+                         offset_t fromOffset = 0, offset_t toOffset = -1,
+                         size_t windowSize = 64 * 1024);
+  }  // namespace Utils
+}  // namespace TagLib
+
+#endif
+
+#endif
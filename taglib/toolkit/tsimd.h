@@ -0,0 +1,166 @@
+/***************************************************************************
+ *   This library is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License version   *
+ *   2.1 as published by the Free Software Foundation.                     *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful, but   *
+ *   WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA         *
+ *   02110-1301  USA                                                       *
+ *                                                                         *
+ *   Alternatively, this file is available under the Mozilla Public        *
+ *   License Version 1.1.  You may obtain a copy of the License at         *
+ *   http://www.mozilla.org/MPL/                                           *
+ ***************************************************************************/
+
+#ifndef TAGLIB_SIMD_H
+#define TAGLIB_SIMD_H
+
+// THIS FILE IS NOT A PART OF THE TAGLIB API
+
+#ifndef DO_NOT_DOCUMENT  // tell Doxygen not to document this header
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TAGLIB_SIMD 1
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define TAGLIB_SIMD 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define TAGLIB_SIMD 1
+#endif
+
+#ifdef TAGLIB_SIMD
+
+namespace TagLib
+{
+  namespace Utils
+  {
+    namespace Simd
+    {
+      // A minimal 128-bit vector abstraction over SSE2, wasm simd128 and
+      // AArch64 NEON, only the operations used by TagLib's kernels.  Code
+      // using it must provide a scalar fallback for builds where
+      // TAGLIB_SIMD is not defined.
+
+      constexpr unsigned int width = 16;
+
+#if defined(__SSE2__)
+      using Vector = __m128i;
+
+      inline Vector load(const void *p)
+      {
+        return _mm_loadu_si128(static_cast<const __m128i *>(p));
+      }
+
+      inline void store(void *p, Vector v)
+      {
+        _mm_storeu_si128(static_cast<__m128i *>(p), v);
+      }
+
+      inline Vector splat8(char c) { return _mm_set1_epi8(c); }
+      inline Vector splat32(uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+      inline Vector equal8(Vector a, Vector b) { return _mm_cmpeq_epi8(a, b); }
+      inline Vector bitAnd(Vector a, Vector b) { return _mm_and_si128(a, b); }
+      inline Vector add32(Vector a, Vector b) { return _mm_add_epi32(a, b); }
+
+      // Unsigned a > b for each 32-bit lane.
+      inline Vector greater32(Vector a, Vector b)
+      {
+        const Vector bias = _mm_set1_epi32(static_cast<int>(0x80000000U));
+        return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+      }
+
+      // Lanes of mask are all ones or all zeros.
+      inline Vector select(Vector mask, Vector a, Vector b)
+      {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+      }
+
+      inline Vector byteSwap32(Vector v)
+      {
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      }
+
+      // Bit i is the most significant bit of byte i.
+      inline unsigned int highBits8(Vector v)
+      {
+        return static_cast<unsigned int>(_mm_movemask_epi8(v));
+      }
+
+#elif defined(__wasm_simd128__)
+      using Vector = v128_t;
+
+      inline Vector load(const void *p) { return wasm_v128_load(p); }
+      inline void store(void *p, Vector v) { wasm_v128_store(p, v); }
+      inline Vector splat8(char c) { return wasm_i8x16_splat(c); }
+      inline Vector splat32(uint32_t x) { return wasm_i32x4_splat(static_cast<int32_t>(x)); }
+      inline Vector equal8(Vector a, Vector b) { return wasm_i8x16_eq(a, b); }
+      inline Vector bitAnd(Vector a, Vector b) { return wasm_v128_and(a, b); }
+      inline Vector add32(Vector a, Vector b) { return wasm_i32x4_add(a, b); }
+      inline Vector greater32(Vector a, Vector b) { return wasm_u32x4_gt(a, b); }
+      inline Vector select(Vector mask, Vector a, Vector b) { return wasm_v128_bitselect(a, b, mask); }
+
+      inline Vector byteSwap32(Vector v)
+      {
+        return wasm_i8x16_shuffle(v, v, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+      }
+
+      inline unsigned int highBits8(Vector v)
+      {
+        return static_cast<unsigned int>(wasm_i8x16_bitmask(v));
+      }
+
+#else
+      using Vector = uint8x16_t;
+
+      inline Vector load(const void *p) { return vld1q_u8(static_cast<const uint8_t *>(p)); }
+      inline void store(void *p, Vector v) { vst1q_u8(static_cast<uint8_t *>(p), v); }
+      inline Vector splat8(char c) { return vdupq_n_u8(static_cast<uint8_t>(c)); }
+      inline Vector splat32(uint32_t x) { return vreinterpretq_u8_u32(vdupq_n_u32(x)); }
+      inline Vector equal8(Vector a, Vector b) { return vceqq_u8(a, b); }
+      inline Vector bitAnd(Vector a, Vector b) { return vandq_u8(a, b); }
+      inline Vector select(Vector mask, Vector a, Vector b) { return vbslq_u8(mask, a, b); }
+      inline Vector byteSwap32(Vector v) { return vrev32q_u8(v); }
+
+      inline Vector add32(Vector a, Vector b)
+      {
+        return vreinterpretq_u8_u32(vaddq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+      }
+
+      inline Vector greater32(Vector a, Vector b)
+      {
+        return vreinterpretq_u8_u32(vcgtq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+      }
+
+      inline unsigned int highBits8(Vector v)
+      {
+        // NEON has no movemask: spread the sign bits to whole bytes, weight
+        // them by position and add up each half.
+        static const uint8_t weights[16] = {
+          1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128
+        };
+        const uint8x16_t bits = vandq_u8(
+          vreinterpretq_u8_s8(vshrq_n_s8(vreinterpretq_s8_u8(v), 7)), vld1q_u8(weights));
+        return vaddv_u8(vget_low_u8(bits)) | (vaddv_u8(vget_high_u8(bits)) << 8);
+      }
+#endif
+    }  // namespace Simd
+  }  // namespace Utils
+}  // namespace TagLib
+
+#endif
+
+#endif
+
+#endif
@@ -25,12 +25,14 @@
 
 #include "tstring.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <climits>
+#include <cstring>
 #include <iostream>
-#include <utf8.h>
 
 #include "tdebug.h"
+#include "tsimd.h"
 #include "tstringlist.h"
 #include "tutils.h"
 
@@ -45,14 +47,223 @@ namespace
                                                            : String::UTF16BE;
   }
 
+  // Returns the number of leading ASCII characters in an 8-bit string.
+  size_t asciiPrefixLength(const char *s, size_t length)
+  {
+    size_t i = 0;
+
+#ifdef TAGLIB_SIMD
+    for(; i + Utils::Simd::width <= length; i += Utils::Simd::width) {
+      if(Utils::Simd::highBits8(Utils::Simd::load(s + i)) != 0)
+        break;
+    }
+#else
+    for(; i + 8 <= length; i += 8) {
+      unsigned long long word;
+      ::memcpy(&word, s + i, 8);
+      if(word & 0x8080808080808080ULL)
+        break;
+    }
+#endif
+
+    while(i < length && static_cast<unsigned char>(s[i]) < 0x80)
+      ++i;
+
+    return i;
+  }
+
+  // Returns the number of leading ASCII characters in the internal buffer.
+  // The characters are tested in blocks, so that the compiler can vectorize
+  // the inner loop.
+  size_t asciiPrefixLength(const wchar_t *s, size_t length)
+  {
+    size_t i = 0;
+
+    for(; i + 16 <= length; i += 16) {
+      unsigned int bits = 0;
+      for(size_t j = 0; j < 16; ++j)
+        bits |= static_cast<unsigned int>(s[i + j]);
+      if(bits >= 0x80)
+        break;
+    }
+
+    while(i < length && static_cast<unsigned int>(s[i]) < 0x80)
+      ++i;
+
+    return i;
+  }
+
+  // Widens 8-bit characters without conversion, used for Latin-1 and for
+  // the ASCII part of UTF-8.
+  void widenLatin1(wchar_t *dst, const char *s, size_t length)
+  {
+    for(size_t i = 0; i < length; ++i)
+      dst[i] = static_cast<unsigned char>(s[i]);
+  }
+
+  // Narrows characters known to fit in 8 bits, the counterpart of
+  // widenLatin1().
+  void narrowLatin1(char *dst, const wchar_t *s, size_t length)
+  {
+    for(size_t i = 0; i < length; ++i)
+      dst[i] = static_cast<char>(s[i]);
+  }
+
+  // Returns the length of a UTF-16 string encoded in UTF-8, or
+  // std::string::npos if it contains unpaired surrogates.
+  size_t utf8Length(const wchar_t *s, size_t length)
+  {
+    size_t i = asciiPrefixLength(s, length);
+    size_t bytes = i;
+
+    while(i < length) {
+      const unsigned int c = static_cast<unsigned int>(s[i++]) & 0xffff;
+      if(c < 0x80)
+        bytes += 1;
+      else if(c < 0x800)
+        bytes += 2;
+      else if(c >= 0xd800 && c <= 0xdbff) {
+        if(i == length)
+          return std::string::npos;
+        const unsigned int trail = static_cast<unsigned int>(s[i++]) & 0xffff;
+        if(trail < 0xdc00 || trail > 0xdfff)
+          return std::string::npos;
+        bytes += 4;
+      }
+      else if(c >= 0xdc00 && c <= 0xdfff)
+        return std::string::npos;
+      else
+        bytes += 3;
+    }
+
+    return bytes;
+  }
+
+  // Encodes a UTF-16 string into dst, which has room for size bytes, and
+  // checks it in the same pass.  Returns the number of bytes written, or
+  // std::string::npos if the string has unpaired surrogates or does not fit.
+  size_t encodeUTF8(char *dst, size_t size, const wchar_t *s, size_t length)
+  {
+    size_t i = asciiPrefixLength(s, length);
+    if(i > size)
+      return std::string::npos;
+    narrowLatin1(dst, s, i);
+    char *out = dst + i;
+    const char *const end = dst + size;
+
+    while(i < length) {
+      unsigned int c = static_cast<unsigned int>(s[i++]) & 0xffff;
+      if(c < 0x80) {
+        if(end - out < 1)
+          return std::string::npos;
+        *out++ = static_cast<char>(c);
+      }
+      else if(c < 0x800) {
+        if(end - out < 2)
+          return std::string::npos;
+        *out++ = static_cast<char>(0xc0 | (c >> 6));
+        *out++ = static_cast<char>(0x80 | (c & 0x3f));
+      }
+      else if(c >= 0xd800 && c <= 0xdbff) {
+        if(i == length || end - out < 4)
+          return std::string::npos;
+        const unsigned int trail = static_cast<unsigned int>(s[i++]) & 0xffff;
+        if(trail < 0xdc00 || trail > 0xdfff)
+          return std::string::npos;
+        c = 0x10000 + ((c - 0xd800) << 10) + (trail - 0xdc00);
+        *out++ = static_cast<char>(0xf0 | (c >> 18));
+        *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+        *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        *out++ = static_cast<char>(0x80 | (c & 0x3f));
+      }
+      else if(c >= 0xdc00 && c <= 0xdfff) {
+        return std::string::npos;
+      }
+      else {
+        if(end - out < 3)
+          return std::string::npos;
+        *out++ = static_cast<char>(0xe0 | (c >> 12));
+        *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        *out++ = static_cast<char>(0x80 | (c & 0x3f));
+      }
+    }
+
+    return static_cast<size_t>(out - dst);
+  }
+
   // Converts a Latin-1 string into UTF-16(without BOM/CPU byte order)
   // and copies it to the internal buffer.
   void copyFromLatin1(std::wstring &data, const char *s, size_t length)
   {
     data.resize(length);
+    widenLatin1(&data[0], s, length);
+  }
 
-    for(size_t i = 0; i < length; ++i)
-      data[i] = static_cast<unsigned char>(s[i]);
+  // Decodes a UTF-8 string into UTF-16 at dst, which has room for length
+  // characters.  Returns the number of characters written, or
+  // std::string::npos if the string is not valid UTF-8: truncated or
+  // overlong sequences, surrogates and code points above U+10FFFF are
+  // rejected.  Errors are returned rather than thrown, so that this also
+  // works in builds without exception support.
+  size_t decodeUTF8(wchar_t *dst, const char *s, size_t length)
+  {
+    const auto *p = reinterpret_cast<const unsigned char *>(s);
+    const unsigned char *const end = p + length;
+    wchar_t *const begin = dst;
+
+    while(p < end) {
+      const unsigned int lead = *p++;
+      if(lead < 0x80) {
+        *dst++ = static_cast<wchar_t>(lead);
+        continue;
+      }
+
+      unsigned int c;
+      size_t trailing;
+      unsigned int minimum;
+      if(lead >= 0xc2 && lead <= 0xdf) {
+        c = lead & 0x1f;
+        trailing = 1;
+        minimum = 0x80;
+      }
+      else if(lead >= 0xe0 && lead <= 0xef) {
+        c = lead & 0x0f;
+        trailing = 2;
+        minimum = 0x800;
+      }
+      else if(lead >= 0xf0 && lead <= 0xf4) {
+        c = lead & 0x07;
+        trailing = 3;
+        minimum = 0x10000;
+      }
+      else {
+        return std::string::npos;
+      }
+
+      if(static_cast<size_t>(end - p) < trailing)
+        return std::string::npos;
+
+      for(size_t i = 0; i < trailing; ++i) {
+        const unsigned int b = *p++;
+        if((b & 0xc0) != 0x80)
+          return std::string::npos;
+        c = (c << 6) | (b & 0x3f);
+      }
+
+      if(c < minimum || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff))
+        return std::string::npos;
+
+      if(c >= 0x10000) {
+        c -= 0x10000;
+        *dst++ = static_cast<wchar_t>(0xd800 + (c >> 10));
+        *dst++ = static_cast<wchar_t>(0xdc00 + (c & 0x3ff));
+      }
+      else {
+        *dst++ = static_cast<wchar_t>(c);
+      }
+    }
+
+    return static_cast<size_t>(dst - begin);
   }
 
   // Converts a UTF-8 string into UTF-16(without BOM/CPU byte order)
@@ -61,15 +272,20 @@ namespace
   {
     data.resize(length);
 
-    try {
-      const std::wstring::iterator dstEnd = utf8::utf8to16(s, s + length, data.begin());
-      data.resize(dstEnd - data.begin());
-    }
-    catch(const utf8::exception &e) {
-      const String message(e.what());
-      debug("String::copyFromUTF8() - UTF8-CPP error: " + message);
+    // Most tag text is ASCII, which maps to UTF-16 one to one.
+    const size_t ascii = asciiPrefixLength(s, length);
+    widenLatin1(&data[0], s, ascii);
+    if(ascii == length)
+      return;
+
+    const size_t decoded = decodeUTF8(&data[ascii], s + ascii, length - ascii);
+    if(decoded == std::string::npos) {
+      debug("String::copyFromUTF8() - Invalid UTF-8 string.");
       data.clear();
+      return;
     }
+
+    data.resize(ascii + decoded);
   }
 
   // Helper functions to read a UTF-16 character from an array.
@@ -85,13 +301,10 @@ namespace
   template <>
   unsigned short nextUTF16<char>(const char **p)
   {
-    union {
-      unsigned short w;
-      char c[2];
-    } u;
-    u.c[0] = *(*p)++;
-    u.c[1] = *(*p)++;
-    return u.w;
+    unsigned short w;
+    ::memcpy(&w, *p, 2);
+    *p += 2;
+    return w;
   }
 
   // Converts a UTF-16 (with BOM), UTF-16LE or UTF16-BE string into
@@ -121,13 +334,16 @@ namespace
       swap = t != wcharByteOrder();
     }
 
+    // Keep the byte order test out of the loops, so that they can be
+    // vectorized.
     data.resize(length);
-    for(size_t i = 0; i < length; ++i) {
-      const unsigned short c = nextUTF16(&s);
-      if(swap)
-        data[i] = Utils::byteSwap(c);
-      else
-        data[i] = c;
+    if(swap) {
+      for(size_t i = 0; i < length; ++i)
+        data[i] = Utils::byteSwap(nextUTF16(&s));
+    }
+    else {
+      for(size_t i = 0; i < length; ++i)
+        data[i] = nextUTF16(&s);
     }
   }
 }  // namespace
@@ -137,6 +353,18 @@ namespace TagLib {
   class String::StringPrivate
   {
   public:
+    /*!
+     * Returns the representation shared by all empty strings, so that they
+     * can be created without an allocation. It is never modified, detach()
+     * makes a private copy before any change.
+     */
+    static const std::shared_ptr<StringPrivate> &empty()
+    {
+      static const std::shared_ptr<StringPrivate> emptyPrivate =
+        std::make_shared<StringPrivate>();
+      return emptyPrivate;
+    }
+
     /*!
      * Stores string in UTF-16. The byte order depends on the CPU endian.
      */
@@ -153,7 +381,7 @@ namespace TagLib {
 ////////////////////////////////////////////////////////////////////////////////
 
 String::String() :
-  d(std::make_shared<StringPrivate>())
+  d(StringPrivate::empty())
 {
 }
 
@@ -242,7 +470,7 @@ String::String(char c, Type t) :
 }
 
 String::String(const ByteVector &v, Type t) :
-  d(std::make_shared<StringPrivate>())
+  d(v.isEmpty() ? StringPrivate::empty() : std::make_shared<StringPrivate>())
 {
   if(v.isEmpty())
     return;
@@ -264,8 +492,34 @@ String::~String() = default;
 
 std::string String::to8Bit(bool unicode) const
 {
-  const ByteVector v = data(unicode ? UTF8 : Latin1);
-  return std::string(v.data(), v.size());
+  if(!unicode) {
+    const ByteVector v = data(Latin1);
+    return std::string(v.data(), v.size());
+  }
+
+  std::string s(utf8Size(), '\0');
+  copyUTF8(&s[0], static_cast<unsigned int>(s.size()));
+  return s;
+}
+
+unsigned int String::utf8Size() const
+{
+  const size_t length = utf8Length(d->data.data(), d->data.size());
+  if(length == std::string::npos) {
+    debug("String::utf8Size() - Invalid UTF-16 string.");
+    return 0;
+  }
+
+  return static_cast<unsigned int>(length);
+}
+
+unsigned int String::copyUTF8(char *buffer, unsigned int size) const
+{
+  const size_t length = encodeUTF8(buffer, size, d->data.data(), d->data.size());
+  if(length == std::string::npos)
+    return 0;
+
+  return static_cast<unsigned int>(length);
 }
 
 std::wstring String::toWString() const
@@ -275,6 +529,10 @@ std::wstring String::toWString() const
 
 const char *String::toCString(bool unicode) const
 {
+  // Do not write to the cache of the shared empty representation.
+  if(d->data.empty())
+    return "";
+
   d->cstring = to8Bit(unicode);
   return d->cstring.c_str();
 }
@@ -358,6 +616,11 @@ String String::substr(unsigned int position, unsigned int n) const
 
 String &String::append(const String &s)
 {
+  if(isEmpty()) {
+    d = s.d;
+    return *this;
+  }
+
   detach();
   d->data += s.d->data;
   return *this;
@@ -371,7 +634,13 @@ String & String::clear()
 
 String String::upper() const
 {
+  // Keys passed to PropertyMap are usually upper case already, share them
+  // instead of building a copy.
+  if(std::none_of(begin(), end(), [](wchar_t c) { return c >= 'a' && c <= 'z'; }))
+    return *this;
+
   String s;
+  s.detach();
   s.d->data.reserve(size());
 
   for(wchar_t c : *this) {
@@ -406,27 +675,14 @@ ByteVector String::data(Type t) const
   case Latin1:
     {
       ByteVector v(size(), 0);
-      char *p = v.data();
-
-      for(wchar_t c : *this) {
-        *p++ = static_cast<char>(c);
-      }
+      narrowLatin1(v.data(), d->data.data(), d->data.size());
 
       return v;
     }
   case UTF8:
     {
-      ByteVector v(size() * 4, 0);
-
-      try {
-        const auto dstEnd = utf8::utf16to8(begin(), end(), v.begin());
-        v.resize(static_cast<unsigned int>(dstEnd - v.begin()));
-      }
-      catch(const utf8::exception &e) {
-        const String message(e.what());
-        debug("String::data() - UTF8-CPP error: " + message);
-        v.clear();
-      }
+      ByteVector v(utf8Size(), 0);
+      copyUTF8(v.data(), v.size());
 
       return v;
     }
@@ -538,7 +794,7 @@ bool String::isLatin1() const
 
 bool String::isAscii() const
 {
-  return std::none_of(this->begin(), this->end(), [](auto c) { return c >= 128; });
+  return asciiPrefixLength(d->data.data(), d->data.size()) == d->data.size();
 }
 
 String String::number(int n) // static
@@ -613,6 +869,11 @@ bool String::operator!=(const wchar_t *s) const
 
 String &String::operator+=(const String &s)
 {
+  if(isEmpty()) {
+    d = s.d;
+    return *this;
+  }
+
   detach();
 
   d->data += s.d->data;
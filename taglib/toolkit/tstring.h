@@ -196,6 +196,30 @@ namespace TagLib {
      */
     std::string to8Bit(bool unicode = false) const;
 
+    /*!
+     * Returns the number of bytes needed to encode this String in UTF8,
+     * without a terminating null byte.  Returns 0 if the String contains
+     * unpaired UTF-16 surrogates and cannot be encoded.
+     *
+     * \see copyUTF8()
+     */
+    unsigned int utf8Size() const;
+
+    /*!
+     * Encodes this String in UTF8 into \a buffer, which has room for \a size
+     * bytes, and returns the number of bytes written.  No terminating null
+     * byte is written.  0 is returned if the encoded string does not fit or
+     * the String cannot be encoded, the contents of \a buffer are undefined
+     * then.  The String is checked while it is encoded, so a caller with a
+     * buffer of at least 3 * size() bytes need not call utf8Size() first.
+     *
+     * Unlike toCString() this does not modify the String, so it can be used
+     * concurrently on shared Strings, and unlike to8Bit() it does not allocate.
+     *
+     * \see utf8Size()
+     */
+    unsigned int copyUTF8(char *buffer, unsigned int size) const;
+
     /*!
      * Returns a deep copy of this String as a \c wstring.  The returned string is
      * encoded in UTF-16 (without BOM/CPU byte order), not UTF-32 even if \c wchar_t
@@ -30,10 +30,12 @@
 #include "wavpackproperties.h"
 
 #include <cstdint>
+#include <algorithm>
 #include <array>
 
 #include "tstring.h"
 #include "tdebug.h"
+#include "tsearch.h"
 #include "wavpackfile.h"
 
 // Implementation of this class is based on the information at:
@@ -63,7 +65,7 @@ WavPack::Properties::Properties(File *file, offset_t streamLength, ReadStyle sty
   AudioProperties(style),
   d(std::make_unique<PropertiesPrivate>())
 {
-  read(file, streamLength);
+  read(file, streamLength, style);
 }
 
 WavPack::Properties::~Properties() = default;
@@ -141,8 +143,15 @@ unsigned int WavPack::Properties::sampleFrames() const
 #define ID_LARGE                0x80
 #define ID_SAMPLE_RATE          (ID_OPTIONAL_DATA | 0x7)
 
+#define MAX_BLOCK_SIZE  1048576
+
 namespace
 {
+  // A block is at most MAX_BLOCK_SIZE bytes, so the header of the final block
+  // is expected within this distance from the end of the stream. Fast read
+  // style does not search further back.
+  constexpr offset_t fastSearchDistance = MAX_BLOCK_SIZE + 2 * WavPack::Properties::HeaderSize;
+
   constexpr std::array sampleRates {
     6000U, 8000U, 9600U, 11025U, 12000U, 16000U, 22050U, 24000U,
     32000U, 44100U, 48000U, 64000U, 88200U, 96000U, 192000U, 0U
@@ -236,7 +245,7 @@ namespace
 
 }  // namespace
 
-void WavPack::Properties::read(File *file, offset_t streamLength)
+void WavPack::Properties::read(File *file, offset_t streamLength, ReadStyle style)
 {
   offset_t offset = 0;
 
@@ -260,7 +269,7 @@ void WavPack::Properties::read(File *file, offset_t streamLength)
     const unsigned int flags = data.toUInt(24, false);
     unsigned int smplRate = sampleRates[(flags & SRATE_MASK) >> SRATE_LSB];
 
-    if(blockSize < 24 || blockSize > 1048576) {
+    if(blockSize < 24 || blockSize > MAX_BLOCK_SIZE) {
       debug("WavPack::Properties::read() -- Invalid block header found.");
       break;
     }
@@ -309,8 +318,10 @@ void WavPack::Properties::read(File *file, offset_t streamLength)
     offset += blockSize + 8;
   }
 
+  // The total number of samples from the first block header is trusted if it
+  // is known, only streamed files without it need the final block.
   if(d->sampleFrames == ~0u)
-    d->sampleFrames = seekFinalIndex(file, streamLength);
+    d->sampleFrames = seekFinalIndex(file, streamLength, style);
 
   if(d->sampleFrames > 0 && d->sampleRate > 0) {
     const auto length = static_cast<double>(d->sampleFrames) * 1000.0 / d->sampleRate;
@@ -319,20 +330,25 @@ void WavPack::Properties::read(File *file, offset_t streamLength)
   }
 }
 
-unsigned int WavPack::Properties::seekFinalIndex(File *file, offset_t streamLength)
+unsigned int WavPack::Properties::seekFinalIndex(File *file, offset_t streamLength,
+                                                 ReadStyle style)
 {
-  offset_t offset = streamLength;
+  const offset_t minOffset = style == Fast
+    ? std::max<offset_t>(0, streamLength - fastSearchDistance) : 0;
 
-  while (offset >= 32) {
-    offset = file->rfind("wvpk", offset - 4);
-
-    if(offset == -1)
+  offset_t searchEnd = streamLength;
+  while(searchEnd - minOffset >= static_cast<offset_t>(HeaderSize)) {
+    const offset_t offset = Utils::rfindInFile(file, "wvpk", minOffset, searchEnd);
+    if(offset < 0)
       return 0;
 
+    // The next candidate must start before this one.
+    searchEnd = offset + 3;
+
     file->seek(offset);
-    const ByteVector data = file->readBlock(32);
-    if(data.size() < 32)
-      return 0;
+    const ByteVector data = file->readBlock(HeaderSize);
+    if(data.size() < HeaderSize)
+      continue;
 
     const unsigned int blockSize    = data.toUInt(4, false);
     const unsigned int blockIndex   = data.toUInt(16, false);
@@ -343,10 +359,10 @@ unsigned int WavPack::Properties::seekFinalIndex(File *file, offset_t streamLeng
     // try not to trigger on a spurious "wvpk" in WavPack binary block data
 
     if(vers < MIN_STREAM_VERS || vers > MAX_STREAM_VERS || (blockSize & 1) ||
-      blockSize < 24 || blockSize >= 1048576 || blockSamples > 131072)
+      blockSize < 24 || blockSize >= MAX_BLOCK_SIZE || blockSamples > 131072)
         continue;
 
-    if (blockSamples && (flags & FINAL_BLOCK))
+    if(blockSamples && (flags & FINAL_BLOCK))
       return blockIndex + blockSamples;
   }
 
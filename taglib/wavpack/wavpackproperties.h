@@ -112,8 +112,8 @@ namespace TagLib {
       int version() const;
 
     private:
-      void read(File *file, offset_t streamLength);
-      unsigned int seekFinalIndex(File *file, offset_t streamLength);
+      void read(File *file, offset_t streamLength, ReadStyle style);
+      unsigned int seekFinalIndex(File *file, offset_t streamLength, ReadStyle style);
 
       class PropertiesPrivate;
       TAGLIB_MSVC_SUPPRESS_WARNING_NEEDS_TO_HAVE_DLL_INTERFACE
@@ -2,7 +2,9 @@
 // Tests the core memory pool functionality for thread safety, RAII, and bounds checking
 
 #include "../src/capi/core/taglib_core.h"
+#include "../src/capi/core/taglib_slab.h"
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <vector>
 #include <thread>
@@ -273,6 +275,88 @@ bool test_large_allocations() {
     return true;
 }
 
+// Test: Slab allocator alignment, usable size and data integrity
+bool test_slab_allocator_basic() {
+    std::vector<void*> ptrs;
+    for (size_t size = 1; size <= 1024; size += 7) {
+        void* ptr = tl_slab_alloc(size);
+        TEST_ASSERT(ptr != nullptr);
+        TEST_ASSERT((reinterpret_cast<uintptr_t>(ptr) & 15) == 0);
+        TEST_ASSERT(tl_slab_usable_size(ptr) >= size);
+        memset(ptr, static_cast<int>(size & 0xFF), size);
+        ptrs.push_back(ptr);
+    }
+
+    size_t size = 1;
+    for (void* ptr : ptrs) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(ptr);
+        TEST_ASSERT(bytes[0] == (size & 0xFF));
+        TEST_ASSERT(bytes[size - 1] == (size & 0xFF));
+        tl_slab_free(ptr);
+        size += 7;
+    }
+
+    tl_slab_free(nullptr); // Should not crash
+    return true;
+}
+
+// Test: Slab realloc keeps contents across size classes and the large path
+bool test_slab_allocator_realloc() {
+    char* ptr = static_cast<char*>(tl_slab_alloc(10));
+    TEST_ASSERT(ptr != nullptr);
+    strcpy(ptr, "TagLib");
+
+    // Same size class: resized in place
+    char* same = static_cast<char*>(tl_slab_realloc(ptr, 14));
+    TEST_ASSERT(same == ptr);
+
+    char* grown = static_cast<char*>(tl_slab_realloc(same, 200));
+    TEST_ASSERT(grown != nullptr);
+    TEST_ASSERT(strcmp(grown, "TagLib") == 0);
+
+    char* large = static_cast<char*>(tl_slab_realloc(grown, 100000));
+    TEST_ASSERT(large != nullptr);
+    TEST_ASSERT(strcmp(large, "TagLib") == 0);
+    TEST_ASSERT(tl_slab_usable_size(large) == 100000);
+
+    char* shrunk = static_cast<char*>(tl_slab_realloc(large, 32));
+    TEST_ASSERT(shrunk != nullptr);
+    TEST_ASSERT(strcmp(shrunk, "TagLib") == 0);
+
+    TEST_ASSERT(tl_slab_realloc(shrunk, 0) == nullptr);
+    return true;
+}
+
+// Test: Freed chunks are returned, so churn does not grow the slab
+bool test_slab_allocator_steady_state() {
+    tl_slab_stats before;
+    tl_slab_get_stats(&before);
+
+    std::vector<void*> ptrs;
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 5000; i++) {
+            void* ptr = tl_slab_alloc(16 + (i % 15) * 16);
+            TEST_ASSERT(ptr != nullptr);
+            ptrs.push_back(ptr);
+        }
+        // Free in a different order than allocated
+        for (size_t i = 0; i < ptrs.size(); i += 2) tl_slab_free(ptrs[i]);
+        for (size_t i = 1; i < ptrs.size(); i += 2) tl_slab_free(ptrs[i]);
+        ptrs.clear();
+    }
+
+    tl_slab_stats after;
+    tl_slab_get_stats(&after);
+    TEST_ASSERT_EQ(before.small_bytes, after.small_bytes);
+    TEST_ASSERT_EQ(before.large_bytes, after.large_bytes);
+    // At most the current chunk of each size class stays behind
+    TEST_ASSERT(after.chunks <= before.chunks + TL_SLAB_MAX_SIZE / 16);
+    TEST_ASSERT(after.peak_chunks * TL_SLAB_CHUNK_SIZE < 4 * 1024 * 1024);
+
+    std::cout << "(Peak chunks: " << after.peak_chunks << ") ";
+    return true;
+}
+
 // Main test runner
 int main() {
     std::cout << "=== TagLib-Wasm C API Memory Pool Unit Tests ===" << std::endl;
@@ -292,6 +376,11 @@ int main() {
     // Safety and reliability tests
     RUN_TEST(test_memory_pool_thread_safety);
     RUN_TEST(test_memory_leak_detection);
+
+    // Slab allocator tests
+    RUN_TEST(test_slab_allocator_basic);
+    RUN_TEST(test_slab_allocator_realloc);
+    RUN_TEST(test_slab_allocator_steady_state);
     
     std::cout << std::endl;
     std::cout << "=== Test Results ===" << std::endl;
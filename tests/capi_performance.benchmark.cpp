@@ -2,6 +2,7 @@
 // Validates memory pool performance, SIMD alignment benefits, and MessagePack efficiency
 
 #include "../src/capi/core/taglib_core.h"
+#include "../src/capi/core/taglib_slab.h"
 #include <chrono>
 #include <iostream>
 #include <vector>
@@ -263,6 +264,78 @@ BenchmarkResult benchmark_pool_reset() {
     return BenchmarkResult("Pool Reset Operations", reset_time, num_resets);
 }
 
+// TagLib-like allocation trace: per file, mostly small objects
+// (control blocks, list nodes, short strings), some frame payloads and a
+// few larger buffers, freed in shuffled order; 1 in 64 objects outlives
+// the file (caches). The same seeded trace drives both allocators.
+struct AllocatorTrace {
+    std::vector<size_t> sizes;
+    std::vector<size_t> free_order;
+};
+
+static AllocatorTrace make_allocator_trace(size_t objects_per_file) {
+    std::mt19937 gen(42);
+    std::discrete_distribution<> bucket({70, 25, 5});
+    std::uniform_int_distribution<size_t> small(8, 48), medium(64, 256), large(512, 8192);
+
+    AllocatorTrace trace;
+    for (size_t i = 0; i < objects_per_file; i++) {
+        switch (bucket(gen)) {
+            case 0: trace.sizes.push_back(small(gen)); break;
+            case 1: trace.sizes.push_back(medium(gen)); break;
+            default: trace.sizes.push_back(large(gen)); break;
+        }
+        trace.free_order.push_back(i);
+    }
+    std::shuffle(trace.free_order.begin(), trace.free_order.end(), gen);
+    return trace;
+}
+
+template <typename Alloc, typename Free>
+static double run_allocator_trace(const AllocatorTrace& trace, size_t files,
+                                  Alloc alloc, Free release) {
+    std::vector<void*> live(trace.sizes.size());
+    std::vector<void*> retained;
+
+    Timer timer;
+    timer.start();
+    for (size_t file = 0; file < files; file++) {
+        for (size_t i = 0; i < trace.sizes.size(); i++) {
+            live[i] = alloc(trace.sizes[i]);
+            memset(live[i], static_cast<int>(i & 0xFF), std::min(trace.sizes[i], size_t(16)));
+        }
+        for (size_t i : trace.free_order) {
+            if (((file + i) & 63) == 0) retained.push_back(live[i]);
+            else release(live[i]);
+        }
+    }
+    double elapsed = timer.elapsed_ms();
+
+    for (void* ptr : retained) release(ptr);
+    return elapsed;
+}
+
+static constexpr size_t kTraceFiles = 10000;
+static constexpr size_t kTraceObjectsPerFile = 200;
+
+// Benchmark: malloc on the TagLib-like trace
+BenchmarkResult benchmark_trace_malloc() {
+    AllocatorTrace trace = make_allocator_trace(kTraceObjectsPerFile);
+    double time = run_allocator_trace(trace, kTraceFiles,
+        [](size_t size) { return malloc(size); },
+        [](void* ptr) { free(ptr); });
+    return BenchmarkResult("Trace: malloc", time, kTraceFiles * kTraceObjectsPerFile);
+}
+
+// Benchmark: slab allocator on the TagLib-like trace
+BenchmarkResult benchmark_trace_slab() {
+    AllocatorTrace trace = make_allocator_trace(kTraceObjectsPerFile);
+    double time = run_allocator_trace(trace, kTraceFiles,
+        [](size_t size) { return tl_slab_alloc(size); },
+        [](void* ptr) { tl_slab_free(ptr); });
+    return BenchmarkResult("Trace: slab allocator", time, kTraceFiles * kTraceObjectsPerFile);
+}
+
 int main() {
     std::cout << "🔥 TagLib-Wasm C API Performance Benchmarks\n";
     std::cout << "============================================\n\n";
@@ -280,6 +353,10 @@ int main() {
     results.push_back(benchmark_concurrent_allocations());
     results.push_back(benchmark_large_allocations());
     results.push_back(benchmark_pool_reset());
+
+    // Allocator comparison (TAGLIB_WASI_ALLOCATOR=slab)
+    results.push_back(benchmark_trace_malloc());
+    results.push_back(benchmark_trace_slab());
     
     print_results(results);
     
@@ -315,6 +392,16 @@ int main() {
                   << concurrency_factor << "x (4 threads, ideal = 4.0x)\n";
     }
     
+    if (results.size() >= 8) {
+        double speedup = results[7].ops_per_sec / results[6].ops_per_sec;
+        tl_slab_stats stats;
+        tl_slab_get_stats(&stats);
+        std::cout << "Slab vs malloc (TagLib-like trace): " << std::fixed << std::setprecision(2)
+                  << speedup << "x, slab high-water " << stats.peak_chunks << " chunks ("
+                  << (stats.peak_chunks * TL_SLAB_CHUNK_SIZE) / 1024 << " KiB) + "
+                  << stats.peak_bytes / 1024 << " KiB peak live\n";
+    }
+
     std::cout << "\n✅ All performance benchmarks completed successfully!\n";
     
     return 0;
@@ -0,0 +1,130 @@
+// PGO training and measurement workload for the native TagLib + C API build
+// Native counterpart of scripts/pgo-train.ts: runs the read/write corpus
+// (tests/test-files, one file per format) through the shim, so the profile
+// covers TagLib's parsers (atom walking, frame parsing, transcoding) and the
+// msgpack emission. Prints the time per format as JSON for build/pgo.sh.
+//
+// Usage: capi_pgo_train <tests/test-files> [iterations]
+
+#include "../src/capi/taglib_shim.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Same corpus as FORMAT_FILES in tests/wasi-test-helpers.ts
+const std::pair<const char*, const char*> FORMAT_FILES[] = {
+    {"FLAC", "flac/kiss-snippet.flac"},
+    {"MP3", "mp3/kiss-snippet.mp3"},
+    {"WAV", "wav/kiss-snippet.wav"},
+    {"M4A", "mp4/kiss-snippet.m4a"},
+    {"OGG", "ogg/kiss-snippet.ogg"},
+    {"OPUS", "opus/kiss-snippet.opus"},
+    {"MP4", "mp4/kiss-snippet.mp4"},
+    {"OGA", "oga/kiss-snippet.oga"},
+    {"WV", "wv/kiss-snippet.wv"},
+    {"TTA", "tta/kiss-snippet.tta"},
+    {"WMA", "wma/kiss-snippet.wma"},
+    {"MKA", "matroska/kiss-snippet.mka"},
+    {"MKV", "matroska/kiss-snippet.mkv"},
+    {"WEBM", "matroska/kiss-snippet.webm"},
+};
+
+std::vector<uint8_t> read_file(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), {});
+}
+
+void append_fixstr(std::vector<uint8_t>& out, const std::string& s) {
+    out.push_back(static_cast<uint8_t>(0xa0 | s.size()));
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+// tl_update_tags patch {set: {title, comment}}; every string is below 32
+// bytes, so fixmap/fixstr encoding is enough
+std::vector<uint8_t> title_patch(const std::string& title) {
+    std::vector<uint8_t> patch = {0x81};
+    append_fixstr(patch, "set");
+    patch.push_back(0x82);
+    append_fixstr(patch, "title");
+    append_fixstr(patch, title);
+    append_fixstr(patch, "comment");
+    append_fixstr(patch, "pgo-train");
+    return patch;
+}
+
+bool check(tl_error_code rc, const char* what, const char* file) {
+    if (rc == TL_SUCCESS) return true;
+    std::cerr << what << " failed for " << file << ": " << rc << "\n";
+    return false;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <tests/test-files> [iterations]\n";
+        return 1;
+    }
+    const fs::path corpus = argv[1];
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    // Writes go to copies, the corpus itself stays untouched
+    const fs::path scratch = fs::temp_directory_path() / "taglib-pgo-native";
+    fs::remove_all(scratch);
+
+    bool ok = true;
+    std::string json = "{";
+    for (const auto& [format, real] : FORMAT_FILES) {
+        const fs::path source = corpus / real;
+        const fs::path copy = scratch / real;
+        fs::create_directories(copy.parent_path());
+        fs::copy_file(source, copy, fs::copy_options::overwrite_existing);
+        const std::vector<uint8_t> data = read_file(source);
+        const std::string path = source.string();
+        const std::string copy_path = copy.string();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations && ok; i++) {
+            uint8_t* out = nullptr;
+            size_t out_size = 0;
+            ok = check(taglib_read_shim(path.c_str(), nullptr, 0, TL_FORMAT_AUTO,
+                                        &out, &out_size), "path read", real);
+            free(out);
+            out = nullptr;
+            ok = ok && check(taglib_read_shim(nullptr, data.data(), data.size(),
+                                              TL_FORMAT_AUTO, &out, &out_size),
+                             "buffer read", real);
+            free(out);
+
+            const std::vector<uint8_t> patch =
+                title_patch("PGO " + std::string(format) + " " + std::to_string(i));
+            ok = ok && check(taglib_update_shim(copy_path.c_str(), nullptr, 0,
+                                                patch.data(), patch.size(),
+                                                nullptr, nullptr, nullptr, nullptr),
+                             "path update", real);
+        }
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        char entry[64];
+        std::snprintf(entry, sizeof(entry), "%s\"%s\":%.3f",
+                      json.size() > 1 ? "," : "", format, elapsed.count());
+        json += entry;
+    }
+    json += "}";
+    fs::remove_all(scratch);
+
+    if (!ok) return 1;
+    std::cout << json << "\n";
+    return 0;
+}
@@ -41,6 +41,7 @@ echo "Compiling memory pool unit tests..."
 $COMPILER \
     "$SCRIPT_DIR/capi_memory_pool.test.cpp" \
     "$SRC_DIR/core/taglib_memory.cpp" \
+    "$SRC_DIR/core/taglib_slab.cpp" \
     "$SRC_DIR/core/taglib_error.cpp" \
     -I"$SRC_DIR" \
     -I"$SRC_DIR/core" \
@@ -76,6 +77,7 @@ if "$TEST_BUILD_DIR/capi_memory_pool_test"; then
     $COMPILER \
         "$SCRIPT_DIR/capi_performance.benchmark.cpp" \
         "$SRC_DIR/core/taglib_memory.cpp" \
+        "$SRC_DIR/core/taglib_slab.cpp" \
         "$SRC_DIR/core/taglib_error.cpp" \
         -I"$SRC_DIR" \
         -I"$SRC_DIR/core" \
@@ -8,6 +8,7 @@ import {
   detectRuntime,
   getEnvironmentDescription,
   supportsExnref,
+  supportsSimd,
 } from "../src/runtime/detector.ts";
 import type { RuntimeDetectionResult } from "../src/runtime/detector.ts";
 
@@ -94,6 +95,16 @@ describe("supportsExnref", () => {
   });
 });
 
+describe("supportsSimd", () => {
+  it("should return consistent results across calls", () => {
+    assertEquals(supportsSimd(), supportsSimd());
+  });
+
+  it("should return true in Deno (supports simd128 natively)", () => {
+    assertEquals(supportsSimd(), true);
+  });
+});
+
 describe("_forceRuntime / _getDetectionResult", () => {
   it("should override detection result", () => {
     const override: RuntimeDetectionResult = {
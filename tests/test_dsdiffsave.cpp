@@ -0,0 +1,283 @@
+/***************************************************************************
+ *   This library is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License version   *
+ *   2.1 as published by the Free Software Foundation.                     *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful, but   *
+ *   WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA         *
+ *   02110-1301  USA                                                       *
+ *                                                                         *
+ *   Alternatively, this file is available under the Mozilla Public        *
+ *   License Version 1.1.  You may obtain a copy of the License at         *
+ *   http://www.mozilla.org/MPL/                                           *
+ ***************************************************************************/
+
+/*
+ * Saving tags of DSDIFF files never moves the sound data chunk. The files
+ * are built in memory with the tag chunks in front of the DSD chunk, which
+ * is where a resize would move the sound data:
+ *
+ *     FRM8 DSD  FVER PROP(SND  FS   CHNL [ID3 ]) DIIN(DITI DIAR) DSD
+ */
+
+#include <string>
+
+#include "tbytevectorstream.h"
+#include "tag.h"
+#include "id3v2tag.h"
+#include "dsdifffile.h"
+#include "dsdiffdiintag.h"
+#include <cppunit/extensions/HelperMacros.h>
+#include "utils.h"
+
+using namespace std;
+using namespace TagLib;
+
+namespace
+{
+  constexpr unsigned int soundDataSize = 1000;
+
+  ByteVector chunk(const ByteVector &name, const ByteVector &data)
+  {
+    ByteVector out = name + ByteVector::fromLongLong(data.size()) + data;
+    if(data.size() & 1)
+      out.append('\x00');
+    return out;
+  }
+
+  ByteVector diinString(const String &value)
+  {
+    const ByteVector data = value.data(String::Latin1);
+    return ByteVector::fromUInt(data.size()) + data;
+  }
+
+  // A DSDIFF file with an optional ID3v2 tag in the PROP chunk and a DIIN
+  // chunk with title and artist, both in front of the sound data.
+  ByteVector buildFile(const ByteVector &id3Data)
+  {
+    ByteVector prop("SND ");
+    prop.append(chunk("FS  ", ByteVector::fromUInt(2822400)));
+    prop.append(chunk("CHNL", ByteVector::fromShort(2) + ByteVector("SLFTSRGT")));
+    if(!id3Data.isEmpty())
+      prop.append(chunk("ID3 ", id3Data));
+
+    const ByteVector diin = chunk("DITI", diinString("Diin title")) +
+                            chunk("DIAR", diinString("Diin artist"));
+
+    const ByteVector body = ByteVector("DSD ") +
+                            chunk("FVER", ByteVector::fromUInt(0x01050000)) +
+                            chunk("PROP", prop) +
+                            chunk("DIIN", diin) +
+                            chunk("DSD ", ByteVector(soundDataSize, '\x55'));
+    return ByteVector("FRM8") + ByteVector::fromLongLong(body.size()) + body;
+  }
+
+  ByteVector renderID3v2(const String &title, const String &comment)
+  {
+    ID3v2::Tag tag;
+    tag.setTitle(title);
+    tag.setComment(comment);
+    return tag.render();
+  }
+
+  // Offset of the sound data chunk header
+  int soundDataOffset(const ByteVector &data)
+  {
+    return data.find(ByteVector("DSD ") + ByteVector::fromLongLong(soundDataSize), 16);
+  }
+
+  bool soundDataUnchanged(const ByteVector &before, const ByteVector &after)
+  {
+    const int offset = soundDataOffset(before);
+    return offset > 0 &&
+           after.mid(offset, 12 + soundDataSize) == before.mid(offset, 12 + soundDataSize);
+  }
+}  // namespace
+
+class TestDSDIFFSave : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(TestDSDIFFSave);
+  CPPUNIT_TEST(testPadShrinkingID3v2);
+  CPPUNIT_TEST(testRelocateGrowingID3v2);
+  CPPUNIT_TEST(testReaddClearedID3v2);
+  CPPUNIT_TEST(testRelocateGrowingDIIN);
+  CPPUNIT_TEST(testFreeRemovedDIINString);
+  CPPUNIT_TEST(testStripDIIN);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testPadShrinkingID3v2()
+  {
+    const ByteVector data = buildFile(renderID3v2("Title", String(string(3000, 'c'))));
+    ByteVectorStream stream(data);
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT(f.hasID3v2Tag());
+      f.ID3v2Tag()->setComment("");
+      CPPUNIT_ASSERT(f.save());
+    }
+    // The smaller tag is zero padded to the old chunk size
+    const ByteVector *fileData = stream.data();
+    CPPUNIT_ASSERT_EQUAL(data.size(), fileData->size());
+    CPPUNIT_ASSERT(soundDataUnchanged(data, *fileData));
+    CPPUNIT_ASSERT_EQUAL(-1, fileData->find("FREE"));
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT_EQUAL(String("Title"), f.ID3v2Tag()->title());
+      CPPUNIT_ASSERT(f.ID3v2Tag()->comment().isEmpty());
+      CPPUNIT_ASSERT_EQUAL(2822400, f.audioProperties()->sampleRate());
+    }
+  }
+
+  void testRelocateGrowingID3v2()
+  {
+    const ByteVector data = buildFile(renderID3v2("Title", ""));
+    ByteVectorStream stream(data);
+    const String comment(string(3000, 'c'));
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      f.ID3v2Tag()->setComment(comment);
+      CPPUNIT_ASSERT(f.save());
+    }
+    // The PROP child is renamed to FREE, the tag moves behind the sound data
+    const ByteVector *fileData = stream.data();
+    CPPUNIT_ASSERT(soundDataUnchanged(data, *fileData));
+    const int soundOffset = soundDataOffset(data);
+    const int freeOffset = fileData->find("FREE");
+    CPPUNIT_ASSERT(freeOffset > 0 && freeOffset < soundOffset);
+    CPPUNIT_ASSERT(fileData->find("ID3 ", soundOffset) > soundOffset);
+    CPPUNIT_ASSERT_EQUAL(static_cast<long long>(fileData->size() - 12),
+                         fileData->toLongLong(4));
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT(f.hasID3v2Tag());
+      CPPUNIT_ASSERT_EQUAL(String("Title"), f.ID3v2Tag()->title());
+      CPPUNIT_ASSERT_EQUAL(comment, f.ID3v2Tag()->comment());
+      CPPUNIT_ASSERT_EQUAL(String("Diin title"), f.DIINTag()->title());
+    }
+  }
+
+  void testReaddClearedID3v2()
+  {
+    const ByteVector data = buildFile(renderID3v2("Title", ""));
+    ByteVectorStream stream(data);
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      f.ID3v2Tag()->setTitle("");
+      CPPUNIT_ASSERT(f.save());
+      CPPUNIT_ASSERT(!f.hasID3v2Tag());
+      // The same File saves a new tag behind the sound data instead of
+      // adding a child to the PROP chunk
+      f.ID3v2Tag()->setTitle("New title");
+      CPPUNIT_ASSERT(f.save());
+      CPPUNIT_ASSERT(f.hasID3v2Tag());
+    }
+    const ByteVector *fileData = stream.data();
+    CPPUNIT_ASSERT(soundDataUnchanged(data, *fileData));
+    const int soundOffset = soundDataOffset(data);
+    CPPUNIT_ASSERT_EQUAL(soundOffset, soundDataOffset(*fileData));
+    const int freeOffset = fileData->find("FREE");
+    CPPUNIT_ASSERT(freeOffset > 0 && freeOffset < soundOffset);
+    CPPUNIT_ASSERT(fileData->find("ID3 ", soundOffset) > soundOffset);
+    CPPUNIT_ASSERT_EQUAL(static_cast<long long>(fileData->size() - 12),
+                         fileData->toLongLong(4));
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT(f.hasID3v2Tag());
+      CPPUNIT_ASSERT_EQUAL(String("New title"), f.ID3v2Tag()->title());
+      CPPUNIT_ASSERT_EQUAL(2822400, f.audioProperties()->sampleRate());
+    }
+  }
+
+  void testRelocateGrowingDIIN()
+  {
+    const ByteVector data = buildFile(ByteVector());
+    ByteVectorStream stream(data);
+    const String title("A considerably longer Diin title");
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT(f.hasDIINTag());
+      f.DIINTag()->setTitle(title);
+      CPPUNIT_ASSERT(f.save(DSDIFF::File::DIIN));
+    }
+    // The DIIN chunk is copied behind the sound data and resized there
+    const ByteVector *fileData = stream.data();
+    CPPUNIT_ASSERT(soundDataUnchanged(data, *fileData));
+    const int soundOffset = soundDataOffset(data);
+    const int freeOffset = fileData->find("FREE");
+    CPPUNIT_ASSERT(freeOffset > 0 && freeOffset < soundOffset);
+    CPPUNIT_ASSERT(fileData->find("DIIN", soundOffset) > soundOffset);
+    CPPUNIT_ASSERT_EQUAL(static_cast<long long>(fileData->size() - 12),
+                         fileData->toLongLong(4));
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT_EQUAL(title, f.DIINTag()->title());
+      CPPUNIT_ASSERT_EQUAL(String("Diin artist"), f.DIINTag()->artist());
+    }
+  }
+
+  void testFreeRemovedDIINString()
+  {
+    const ByteVector data = buildFile(ByteVector());
+    ByteVectorStream stream(data);
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      f.DIINTag()->setArtist("");
+      CPPUNIT_ASSERT(f.save(DSDIFF::File::DIIN));
+    }
+    // Only the chunk ID of DIAR is overwritten
+    const ByteVector *fileData = stream.data();
+    CPPUNIT_ASSERT_EQUAL(data.size(), fileData->size());
+    CPPUNIT_ASSERT(soundDataUnchanged(data, *fileData));
+    CPPUNIT_ASSERT_EQUAL(data.find("DIAR"), fileData->find("FREE"));
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT(f.hasDIINTag());
+      CPPUNIT_ASSERT_EQUAL(String("Diin title"), f.DIINTag()->title());
+      CPPUNIT_ASSERT(f.DIINTag()->artist().isEmpty());
+    }
+  }
+
+  void testStripDIIN()
+  {
+    const ByteVector data = buildFile(ByteVector());
+    ByteVectorStream stream(data);
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      f.strip(DSDIFF::File::DIIN);
+    }
+    // DITI, DIAR and the DIIN chunk itself are renamed to FREE
+    const ByteVector *fileData = stream.data();
+    CPPUNIT_ASSERT_EQUAL(data.size(), fileData->size());
+    CPPUNIT_ASSERT(soundDataUnchanged(data, *fileData));
+    CPPUNIT_ASSERT_EQUAL(-1, fileData->find("DIIN"));
+    CPPUNIT_ASSERT_EQUAL(-1, fileData->find("DITI"));
+    CPPUNIT_ASSERT_EQUAL(-1, fileData->find("DIAR"));
+    {
+      DSDIFF::File f(&stream);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT(!f.hasDIINTag());
+      CPPUNIT_ASSERT(f.DIINTag()->title().isEmpty());
+    }
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestDSDIFFSave);
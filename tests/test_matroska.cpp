@@ -156,6 +156,10 @@ class TestMatroska : public CppUnit::TestFixture
   CPPUNIT_TEST(testOpenInvalid);
   CPPUNIT_TEST(testSegmentSizeChange);
   CPPUNIT_TEST(testChapters);
+  CPPUNIT_TEST(testUnknownSizeWebm);
+  CPPUNIT_TEST(testDeferredElements);
+  CPPUNIT_TEST(testDeferredSave);
+  CPPUNIT_TEST(testElementOffsets);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -1249,6 +1253,224 @@ public:
     CPPUNIT_ASSERT(origData == fileData);
   }
 
+  void testUnknownSizeWebm()
+  {
+    // Simulate a live recording by setting the sizes of the segment and
+    // the cluster to unknown (all bits set).
+    const ByteVector unknownSize("\x01\xFF\xFF\xFF\xFF\xFF\xFF\xFF", 8);
+    ByteVector data = PlainFile(TEST_FILE_PATH_C("no-tags.webm")).readAll();
+    CPPUNIT_ASSERT_EQUAL(ByteVector("\x18\x53\x80\x67", 4), data.mid(0x24, 4));
+    CPPUNIT_ASSERT_EQUAL(ByteVector("\x1F\x43\xB6\x75", 4), data.mid(0xFA, 4));
+    data = data.mid(0, 0x28) + unknownSize + data.mid(0x30, 0xFE - 0x30) +
+           unknownSize + data.mid(0x106);
+    ByteVectorStream stream(data);
+    {
+      Matroska::File f(&stream, true, AudioProperties::Accurate);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT_EQUAL(1, f.audioProperties()->lengthInMilliseconds());
+      CPPUNIT_ASSERT(!f.tag(false));
+
+      f.setProperties(SimplePropertyMap{
+        {"ARTIST", {"Live artist"}},
+        {"TITLE", {"Live title"}}
+      });
+      CPPUNIT_ASSERT(f.save());
+    }
+    {
+      Matroska::File f(&stream, true, AudioProperties::Accurate);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT(f.tag(false));
+      CPPUNIT_ASSERT_EQUAL(String("Live artist"), f.tag(false)->artist());
+      CPPUNIT_ASSERT_EQUAL(String("Live title"), f.tag(false)->title());
+    }
+    // The sizes are still unknown, the tags were appended to the segment.
+    const ByteVector *fileData = stream.data();
+    CPPUNIT_ASSERT_EQUAL(unknownSize, fileData->mid(0x28, 8));
+    CPPUNIT_ASSERT_EQUAL(unknownSize, fileData->mid(0xFE, 8));
+    CPPUNIT_ASSERT(fileData->size() > data.size());
+  }
+
+  void testDeferredElements()
+  {
+    // Without audio properties, cues, attachments and chapters are only
+    // read when they are accessed or when a save moves the clusters.
+    ScopedFileCopy copy("tags-before-cues", ".mkv");
+    string newname = copy.fileName();
+    const ByteVector cover(5000, 'c');
+    const String title(string(2000, 't'));
+    {
+      Matroska::File f(newname.c_str(), false);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT(!f.audioProperties());
+      f.tag(true)->setTitle(title);
+      f.attachments(true)->addAttachedFile(Matroska::AttachedFile(
+        cover, "cover.jpg", "image/jpeg", 1234567890ULL, "Cover"));
+      CPPUNIT_ASSERT(f.save());
+    }
+    {
+      Matroska::File f(newname.c_str(), true, AudioProperties::Accurate);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT_EQUAL(title, f.tag(false)->title());
+      CPPUNIT_ASSERT(f.attachments(false));
+    }
+    {
+      Matroska::File f(newname.c_str(), false);
+      CPPUNIT_ASSERT(f.isValid());
+      f.tag(false)->setTitle(title + title);
+      CPPUNIT_ASSERT(f.save());
+      // The unread attachments were moved by the save
+      const auto attachments = f.attachments(false);
+      CPPUNIT_ASSERT(attachments);
+      CPPUNIT_ASSERT_EQUAL(1U, attachments->attachedFileList().size());
+      CPPUNIT_ASSERT_EQUAL(cover, attachments->attachedFileList()[0].data());
+    }
+    {
+      Matroska::File f(newname.c_str(), true, AudioProperties::Accurate);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT_EQUAL(title + title, f.tag(false)->title());
+      const auto pictures = f.complexProperties("PICTURE");
+      CPPUNIT_ASSERT_EQUAL(1U, pictures.size());
+      CPPUNIT_ASSERT_EQUAL(cover, pictures[0].value("data").toByteVector());
+    }
+  }
+
+  void testDeferredSave()
+  {
+    // Saves without audio properties must write the same file as saves
+    // with everything read, also when the cues have to follow the moved
+    // clusters and the unread attachments and chapters are moved.
+    const ByteVector data = PlainFile(TEST_FILE_PATH_C("tags-before-cues.mkv")).readAll();
+    ByteVectorStream fullStream(data);
+    ByteVectorStream deferredStream(data);
+    const ByteVector cover(5000, 'c');
+    const String title(string(2000, 't'));
+    const Matroska::ChapterEdition edition(
+      List<Matroska::Chapter>{
+        Matroska::Chapter(
+          0, 60000,
+          List{Matroska::Chapter::Display("Intro", "eng")},
+          1),
+        Matroska::Chapter(
+          60000, 120000,
+          List{Matroska::Chapter::Display("Outro", "eng")},
+          2)
+      },
+      true, false);
+
+    for(ByteVectorStream *stream : {&fullStream, &deferredStream}) {
+      Matroska::File f(stream, stream == &fullStream);
+      CPPUNIT_ASSERT(f.isValid());
+      f.tag(true)->setTitle(title);
+      f.attachments(true)->addAttachedFile(Matroska::AttachedFile(
+        cover, "cover.jpg", "image/jpeg", 1234567890ULL, "Cover"));
+      f.chapters(true)->addChapterEdition(edition);
+      CPPUNIT_ASSERT(f.save());
+    }
+    CPPUNIT_ASSERT(*fullStream.data() == *deferredStream.data());
+
+    for(ByteVectorStream *stream : {&fullStream, &deferredStream}) {
+      Matroska::File f(stream, stream == &fullStream);
+      CPPUNIT_ASSERT(f.isValid());
+      f.tag(false)->setTitle(title + title);
+      CPPUNIT_ASSERT(f.save());
+    }
+    CPPUNIT_ASSERT(*fullStream.data() == *deferredStream.data());
+
+    {
+      // Accurate reading checks the cue points against the clusters
+      Matroska::File f(&deferredStream, true, AudioProperties::Accurate);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT_EQUAL(title + title, f.tag(false)->title());
+      const auto attachments = f.attachments(false);
+      CPPUNIT_ASSERT(attachments);
+      CPPUNIT_ASSERT_EQUAL(1U, attachments->attachedFileList().size());
+      CPPUNIT_ASSERT_EQUAL(cover, attachments->attachedFileList()[0].data());
+      const auto chapters = f.chapters(false);
+      CPPUNIT_ASSERT(chapters);
+      CPPUNIT_ASSERT_EQUAL(1U, chapters->chapterEditionList().size());
+      const auto &chapterAtoms = chapters->chapterEditionList().front().chapterList();
+      CPPUNIT_ASSERT_EQUAL(2U, chapterAtoms.size());
+      CPPUNIT_ASSERT_EQUAL(String("Intro"), chapterAtoms[0].displayList()[0].string());
+      CPPUNIT_ASSERT_EQUAL(String("Outro"), chapterAtoms[1].displayList()[0].string());
+    }
+  }
+
+  void testElementOffsets()
+  {
+    // SeekHead, Void, Info, Tracks, Tags and Cues of tags-before-cues.mkv,
+    // the cluster at 3269 is not read.
+    const ByteVector data = PlainFile(TEST_FILE_PATH_C("tags-before-cues.mkv")).readAll();
+    List<offset_t> offsets;
+    offsets.append(52);
+    offsets.append(116);
+    offsets.append(213);
+    offsets.append(329);
+    offsets.append(2905);
+    offsets.append(3390);
+    {
+      ByteVectorStream stream(data);
+      Matroska::File f(&stream, offsets, true, AudioProperties::Accurate);
+      CPPUNIT_ASSERT(f.isValid());
+      CPPUNIT_ASSERT_EQUAL(String("handbrake"), f.tag(false)->title());
+      CPPUNIT_ASSERT_EQUAL(String("Actors"), f.tag(false)->artist());
+      CPPUNIT_ASSERT_EQUAL(120, f.audioProperties()->lengthInMilliseconds());
+      CPPUNIT_ASSERT_EQUAL(String("handbrake"), f.audioProperties()->title());
+
+      ByteVectorStream scannedStream(data);
+      Matroska::File scanned(&scannedStream, true, AudioProperties::Accurate);
+      CPPUNIT_ASSERT(scanned.properties() == f.properties());
+      CPPUNIT_ASSERT_EQUAL(scanned.audioProperties()->bitrate(),
+                           f.audioProperties()->bitrate());
+    }
+    {
+      // Saves write the same file as after scanning the segment, with the
+      // clusters and cues moved behind the grown tags.
+      const String title(string(2000, 't'));
+      const ByteVector cover(5000, 'c');
+      ByteVectorStream stream(data);
+      ByteVectorStream scannedStream(data);
+      {
+        Matroska::File f(&stream, offsets, false);
+        Matroska::File scanned(&scannedStream, false);
+        CPPUNIT_ASSERT(f.isValid());
+        CPPUNIT_ASSERT(scanned.isValid());
+        for(Matroska::File *file : {&f, &scanned}) {
+          file->tag(false)->setTitle(title);
+          file->attachments(true)->addAttachedFile(Matroska::AttachedFile(
+            cover, "cover.jpg", "image/jpeg", 1234567890ULL, "Cover"));
+          CPPUNIT_ASSERT(file->save());
+        }
+      }
+      CPPUNIT_ASSERT(*stream.data() == *scannedStream.data());
+
+      Matroska::File g(&stream, true, AudioProperties::Accurate);
+      CPPUNIT_ASSERT(g.isValid());
+      CPPUNIT_ASSERT_EQUAL(title, g.tag(false)->title());
+      CPPUNIT_ASSERT_EQUAL(120, g.audioProperties()->lengthInMilliseconds());
+      CPPUNIT_ASSERT(g.attachments(false));
+      CPPUNIT_ASSERT_EQUAL(cover, g.attachments(false)->attachedFileList()[0].data());
+    }
+    {
+      // Offsets outside of the segment: the EBML header and the file end
+      List<offset_t> beforeSegment = offsets;
+      beforeSegment.prepend(0);
+      List<offset_t> afterSegment = offsets;
+      afterSegment.append(static_cast<offset_t>(data.size()));
+      for(const auto &outside : {beforeSegment, afterSegment}) {
+        ByteVectorStream stream(data);
+        Matroska::File f(&stream, outside);
+        CPPUNIT_ASSERT(!f.isValid());
+      }
+    }
+    {
+      // An offset which does not point to a top level element
+      offsets[2] = 214;
+      ByteVectorStream stream(data);
+      Matroska::File f(&stream, offsets);
+      CPPUNIT_ASSERT(!f.isValid());
+    }
+  }
+
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(TestMatroska);
@@ -0,0 +1,269 @@
+/***************************************************************************
+ *   This library is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License version   *
+ *   2.1 as published by the Free Software Foundation.                     *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful, but   *
+ *   WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA         *
+ *   02110-1301  USA                                                       *
+ *                                                                         *
+ *   Alternatively, this file is available under the Mozilla Public        *
+ *   License Version 1.1.  You may obtain a copy of the License at         *
+ *   http://www.mozilla.org/MPL/                                           *
+ ***************************************************************************/
+
+#include <cstring>
+#include <string>
+
+#include "tbytevector.h"
+#include "tbytevectorstream.h"
+#include "tfile.h"
+#include "tsearch.h"
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+using namespace TagLib;
+
+namespace
+{
+  // A File without tags over an in-memory stream, to search in.
+  class SearchFile : public File
+  {
+  public:
+    explicit SearchFile(IOStream *stream) : File(stream) {}
+    Tag *tag() const override { return nullptr; }
+    AudioProperties *audioProperties() const override { return nullptr; }
+    bool save() override { return false; }
+  };
+
+  ByteVector filler(unsigned int size)
+  {
+    return ByteVector(size, 'x');
+  }
+
+  ByteVector withPatternAt(unsigned int size, const ByteVector &pattern, unsigned int offset)
+  {
+    ByteVector data = filler(size);
+    ::memcpy(data.data() + offset, pattern.data(), pattern.size());
+    return data;
+  }
+}  // namespace
+
+class TestSearch : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(TestSearch);
+  CPPUNIT_TEST(testFindBytes);
+  CPPUNIT_TEST(testShortPatterns);
+  CPPUNIT_TEST(testPatternLongerThanData);
+  CPPUNIT_TEST(testWindowBoundary);
+  CPPUNIT_TEST(testBounds);
+  CPPUNIT_TEST(testPatternLongerThanRange);
+  CPPUNIT_TEST(testPositionRestored);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testFindBytes()
+  {
+    // Every position in and after the 16 byte blocks, with a near miss
+    // sharing the first and last byte in front of the match.
+    const ByteVector pattern("abcde");
+    for(unsigned int size = 5; size <= 70; ++size) {
+      for(unsigned int offset = 0; offset + 5 <= size; ++offset) {
+        ByteVector data = withPatternAt(size, pattern, offset);
+        if(offset >= 5)
+          ::memcpy(data.data(), "abxde", 5);
+        CPPUNIT_ASSERT_EQUAL(static_cast<long long>(offset),
+                             Utils::findBytes(data.data(), data.size(), "abcde", 5));
+        CPPUNIT_ASSERT_EQUAL(static_cast<long long>(offset),
+                             Utils::rfindBytes(data.data(), data.size(), "abcde", 5));
+      }
+      const ByteVector data = filler(size);
+      CPPUNIT_ASSERT_EQUAL(-1LL, Utils::findBytes(data.data(), data.size(), "abcde", 5));
+      CPPUNIT_ASSERT_EQUAL(-1LL, Utils::rfindBytes(data.data(), data.size(), "abcde", 5));
+    }
+
+    const ByteVector data("abcabcabcabcabcabcabcabcabcabcabc");
+    CPPUNIT_ASSERT_EQUAL(0LL, Utils::findBytes(data.data(), data.size(), "abc", 3));
+    CPPUNIT_ASSERT_EQUAL(30LL, Utils::rfindBytes(data.data(), data.size(), "abc", 3));
+    CPPUNIT_ASSERT_EQUAL(-1LL, Utils::findBytes(data.data(), data.size(), "", 0));
+    CPPUNIT_ASSERT_EQUAL(-1LL, Utils::rfindBytes(data.data(), data.size(), "", 0));
+  }
+
+  void testShortPatterns()
+  {
+    for(unsigned int size = 2; size <= 40; ++size) {
+      for(unsigned int offset = 0; offset + 2 <= size; ++offset) {
+        const ByteVector data = withPatternAt(size, "ab", offset);
+        CPPUNIT_ASSERT_EQUAL(static_cast<long long>(offset),
+                             Utils::findBytes(data.data(), data.size(), "a", 1));
+        CPPUNIT_ASSERT_EQUAL(static_cast<long long>(offset + 1),
+                             Utils::rfindBytes(data.data(), data.size(), "b", 1));
+        CPPUNIT_ASSERT_EQUAL(static_cast<long long>(offset),
+                             Utils::findBytes(data.data(), data.size(), "ab", 2));
+        CPPUNIT_ASSERT_EQUAL(static_cast<long long>(offset),
+                             Utils::rfindBytes(data.data(), data.size(), "ab", 2));
+        CPPUNIT_ASSERT_EQUAL(-1LL, Utils::findBytes(data.data(), data.size(), "ba", 2));
+        CPPUNIT_ASSERT_EQUAL(-1LL, Utils::rfindBytes(data.data(), data.size(), "ba", 2));
+      }
+    }
+
+    const ByteVector data("xxaaxx");
+    CPPUNIT_ASSERT_EQUAL(2LL, Utils::findBytes(data.data(), data.size(), "aa", 2));
+    CPPUNIT_ASSERT_EQUAL(2LL, Utils::rfindBytes(data.data(), data.size(), "aa", 2));
+    CPPUNIT_ASSERT_EQUAL(-1LL, Utils::findBytes(data.data(), data.size(), "c", 1));
+    CPPUNIT_ASSERT_EQUAL(-1LL, Utils::rfindBytes(data.data(), data.size(), "c", 1));
+  }
+
+  void testPatternLongerThanData()
+  {
+    CPPUNIT_ASSERT_EQUAL(-1LL, Utils::findBytes("abc", 3, "abcd", 4));
+    CPPUNIT_ASSERT_EQUAL(-1LL, Utils::rfindBytes("abc", 3, "abcd", 4));
+    CPPUNIT_ASSERT_EQUAL(-1LL, Utils::findBytes("", 0, "a", 1));
+    CPPUNIT_ASSERT_EQUAL(-1LL, Utils::rfindBytes("", 0, "a", 1));
+
+    ByteVector data("abc");
+    ByteVectorStream stream(data);
+    SearchFile file(&stream);
+    CPPUNIT_ASSERT_EQUAL(-1LL, static_cast<long long>(Utils::findInFile(&file, "abcd")));
+    CPPUNIT_ASSERT_EQUAL(-1LL, static_cast<long long>(Utils::rfindInFile(&file, "abcd")));
+    CPPUNIT_ASSERT_EQUAL(0LL, static_cast<long long>(Utils::findInFile(&file, "abc")));
+    CPPUNIT_ASSERT_EQUAL(0LL, static_cast<long long>(Utils::rfindInFile(&file, "abc")));
+  }
+
+  void testWindowBoundary()
+  {
+    // Window sizes around the pattern length, including ones below it,
+    // and every offset of the match relative to the window boundaries.
+    const ByteVector pattern("abcd");
+    for(size_t windowSize = 1; windowSize <= 9; ++windowSize) {
+      for(unsigned int offset = 0; offset + 4 <= 40; ++offset) {
+        ByteVector data = withPatternAt(40, pattern, offset);
+        ByteVectorStream stream(data);
+        SearchFile file(&stream);
+        CPPUNIT_ASSERT_EQUAL(static_cast<long long>(offset),
+          static_cast<long long>(Utils::findInFile(&file, pattern, 0, -1, windowSize)));
+        CPPUNIT_ASSERT_EQUAL(static_cast<long long>(offset),
+          static_cast<long long>(Utils::rfindInFile(&file, pattern, 0, -1, windowSize)));
+      }
+
+      ByteVector data = filler(40);
+      ByteVectorStream stream(data);
+      SearchFile file(&stream);
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::findInFile(&file, pattern, 0, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::rfindInFile(&file, pattern, 0, -1, windowSize)));
+    }
+
+    // The first and last match win, even when they share a window
+    ByteVector data = withPatternAt(40, pattern, 30);
+    ::memcpy(data.data() + 6, "abcd", 4);
+    ByteVectorStream stream(data);
+    SearchFile file(&stream);
+    for(size_t windowSize = 4; windowSize <= 40; windowSize += 6) {
+      CPPUNIT_ASSERT_EQUAL(6LL,
+        static_cast<long long>(Utils::findInFile(&file, pattern, 0, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(30LL,
+        static_cast<long long>(Utils::rfindInFile(&file, pattern, 0, -1, windowSize)));
+    }
+  }
+
+  void testBounds()
+  {
+    ByteVector data = withPatternAt(64, "abcd", 10);
+    ::memcpy(data.data() + 50, "abcd", 4);
+    ByteVectorStream stream(data);
+    SearchFile file(&stream);
+
+    for(size_t windowSize : {3, 4, 7, 64 * 1024}) {
+      // A match must start at or after fromOffset...
+      CPPUNIT_ASSERT_EQUAL(10LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", 10, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(50LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", 11, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(50LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 50, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 51, -1, windowSize)));
+
+      // ...and end at or before toOffset.
+      CPPUNIT_ASSERT_EQUAL(50LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", 11, 54, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", 11, 53, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(50LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 0, 54, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(10LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 0, 53, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 0, 13, windowSize)));
+
+      // Out of range offsets are clamped to the file
+      CPPUNIT_ASSERT_EQUAL(10LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", -5, 1000, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(50LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", -5, 1000, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", 64, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 64, -1, windowSize)));
+    }
+  }
+
+  void testPatternLongerThanRange()
+  {
+    ByteVector data = withPatternAt(64, "abcd", 10);
+    ByteVectorStream stream(data);
+    SearchFile file(&stream);
+
+    for(size_t windowSize : {1, 4, 64 * 1024}) {
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", 10, 13, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 10, 13, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", 20, 10, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 20, 10, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(10LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", 10, 14, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(10LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 10, 14, windowSize)));
+    }
+    CPPUNIT_ASSERT_EQUAL(-1LL, static_cast<long long>(Utils::findInFile(&file, ByteVector())));
+    CPPUNIT_ASSERT_EQUAL(-1LL, static_cast<long long>(Utils::rfindInFile(&file, ByteVector())));
+  }
+
+  void testPositionRestored()
+  {
+    ByteVector data = withPatternAt(64, "abcd", 40);
+    ByteVectorStream stream(data);
+    SearchFile file(&stream);
+
+    for(size_t windowSize : {4, 5, 64 * 1024}) {
+      file.seek(17);
+      CPPUNIT_ASSERT_EQUAL(40LL,
+        static_cast<long long>(Utils::findInFile(&file, "abcd", 0, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(17LL, static_cast<long long>(file.tell()));
+      CPPUNIT_ASSERT_EQUAL(40LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "abcd", 0, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(17LL, static_cast<long long>(file.tell()));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::findInFile(&file, "dcba", 0, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(17LL, static_cast<long long>(file.tell()));
+      CPPUNIT_ASSERT_EQUAL(-1LL,
+        static_cast<long long>(Utils::rfindInFile(&file, "dcba", 0, -1, windowSize)));
+      CPPUNIT_ASSERT_EQUAL(17LL, static_cast<long long>(file.tell()));
+    }
+    CPPUNIT_ASSERT_EQUAL(ByteVector("xxxx"), file.readBlock(4));
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestSearch);
@@ -0,0 +1,320 @@
+/***************************************************************************
+ *   This library is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License version   *
+ *   2.1 as published by the Free Software Foundation.                     *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful, but   *
+ *   WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA         *
+ *   02110-1301  USA                                                       *
+ *                                                                         *
+ *   Alternatively, this file is available under the Mozilla Public        *
+ *   License Version 1.1.  You may obtain a copy of the License at         *
+ *   http://www.mozilla.org/MPL/                                           *
+ ***************************************************************************/
+
+/*
+ * String transcoding checked against per-character reference codecs. The
+ * conversions take ASCII fast paths over blocks of up to 16 characters, so
+ * inputs are built with the first non-ASCII character at every position of
+ * a block.
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tbytevector.h"
+#include "tstring.h"
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+using namespace TagLib;
+
+namespace
+{
+  string encodeUTF8(const vector<unsigned int> &codePoints)
+  {
+    string s;
+    for(unsigned int c : codePoints) {
+      if(c < 0x80) {
+        s += static_cast<char>(c);
+      }
+      else if(c < 0x800) {
+        s += static_cast<char>(0xc0 | (c >> 6));
+        s += static_cast<char>(0x80 | (c & 0x3f));
+      }
+      else if(c < 0x10000) {
+        s += static_cast<char>(0xe0 | (c >> 12));
+        s += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (c & 0x3f));
+      }
+      else {
+        s += static_cast<char>(0xf0 | (c >> 18));
+        s += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+        s += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (c & 0x3f));
+      }
+    }
+    return s;
+  }
+
+  vector<unsigned int> encodeUTF16(const vector<unsigned int> &codePoints)
+  {
+    vector<unsigned int> units;
+    for(unsigned int c : codePoints) {
+      if(c < 0x10000) {
+        units.push_back(c);
+      }
+      else {
+        units.push_back(0xd800 + ((c - 0x10000) >> 10));
+        units.push_back(0xdc00 + ((c - 0x10000) & 0x3ff));
+      }
+    }
+    return units;
+  }
+
+  ByteVector encodeUTF16Bytes(const vector<unsigned int> &units, bool bigEndian)
+  {
+    ByteVector v;
+    for(unsigned int u : units)
+      v.append(ByteVector::fromShort(static_cast<short>(u), bigEndian));
+    return v;
+  }
+
+  // Mostly ASCII, like tag text, with runs of 2, 3 and 4 byte sequences
+  vector<unsigned int> randomCodePoints(mt19937 &random, size_t length)
+  {
+    vector<unsigned int> codePoints;
+    for(size_t i = 0; i < length; ++i) {
+      switch(random() % 8) {
+      case 0:
+        codePoints.push_back(0x80 + random() % (0x800 - 0x80));
+        break;
+      case 1: {
+        unsigned int c = 0x800 + random() % (0x10000 - 0x800);
+        if(c >= 0xd800 && c <= 0xdfff)
+          c -= 0x800;
+        codePoints.push_back(c);
+        break;
+      }
+      case 2:
+        codePoints.push_back(0x10000 + random() % (0x110000 - 0x10000));
+        break;
+      default:
+        codePoints.push_back(random() % 0x80);
+        break;
+      }
+    }
+    return codePoints;
+  }
+
+  bool hasUnits(const String &s, const vector<unsigned int> &units)
+  {
+    if(s.size() != units.size())
+      return false;
+    for(size_t i = 0; i < units.size(); ++i) {
+      if(static_cast<unsigned int>(s[static_cast<int>(i)]) != units[i])
+        return false;
+    }
+    return true;
+  }
+}  // namespace
+
+class TestStringTranscoding : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(TestStringTranscoding);
+  CPPUNIT_TEST(testRandomUTF8);
+  CPPUNIT_TEST(testRandomLatin1);
+  CPPUNIT_TEST(testUTF16ByteOrder);
+  CPPUNIT_TEST(testNonAsciiPosition);
+  CPPUNIT_TEST(testInvalidUTF8);
+  CPPUNIT_TEST(testUnpairedSurrogates);
+  CPPUNIT_TEST(testCopyUTF8BufferSize);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testRandomUTF8()
+  {
+    mt19937 random(80);
+    for(int i = 0; i < 2000; ++i) {
+      const vector<unsigned int> codePoints = randomCodePoints(random, random() % 70);
+      const string utf8 = encodeUTF8(codePoints);
+
+      const String s(utf8, String::UTF8);
+      CPPUNIT_ASSERT(hasUnits(s, encodeUTF16(codePoints)));
+      CPPUNIT_ASSERT(s.to8Bit(true) == utf8);
+      CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(utf8.size()), s.utf8Size());
+      CPPUNIT_ASSERT_EQUAL(ByteVector(utf8.data(), static_cast<unsigned int>(utf8.size())),
+                           s.data(String::UTF8));
+      CPPUNIT_ASSERT(String(ByteVector(utf8.data(), static_cast<unsigned int>(utf8.size())),
+                            String::UTF8) == s);
+    }
+  }
+
+  void testRandomLatin1()
+  {
+    mt19937 random(81);
+    for(int i = 0; i < 2000; ++i) {
+      string latin1(random() % 70, '\0');
+      for(auto &c : latin1)
+        c = static_cast<char>(random() % 4 == 0 ? random() % 0x100 : random() % 0x80);
+
+      const String s(latin1, String::Latin1);
+      CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(latin1.size()), s.size());
+      bool ascii = true;
+      for(size_t j = 0; j < latin1.size(); ++j) {
+        const auto c = static_cast<unsigned char>(latin1[j]);
+        CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(c),
+                             static_cast<unsigned int>(s[static_cast<int>(j)]));
+        ascii = ascii && c < 0x80;
+      }
+      CPPUNIT_ASSERT_EQUAL(ascii, s.isAscii());
+      CPPUNIT_ASSERT(s.to8Bit(false) == latin1);
+      CPPUNIT_ASSERT_EQUAL(ByteVector(latin1.data(), static_cast<unsigned int>(latin1.size())),
+                           s.data(String::Latin1));
+
+      // Latin-1 to UTF-8 and back
+      const string utf8 = s.to8Bit(true);
+      CPPUNIT_ASSERT(String(utf8, String::UTF8) == s);
+    }
+  }
+
+  void testUTF16ByteOrder()
+  {
+    mt19937 random(82);
+    for(int i = 0; i < 500; ++i) {
+      const vector<unsigned int> units = encodeUTF16(randomCodePoints(random, random() % 40));
+      const ByteVector le = encodeUTF16Bytes(units, false);
+      const ByteVector be = encodeUTF16Bytes(units, true);
+
+      // Either BOM, whichever byte order the CPU has
+      const String fromLE(ByteVector("\xff\xfe", 2) + le, String::UTF16);
+      const String fromBE(ByteVector("\xfe\xff", 2) + be, String::UTF16);
+      CPPUNIT_ASSERT(hasUnits(fromLE, units));
+      CPPUNIT_ASSERT(hasUnits(fromBE, units));
+      CPPUNIT_ASSERT(hasUnits(String(le, String::UTF16LE), units));
+      CPPUNIT_ASSERT(hasUnits(String(be, String::UTF16BE), units));
+
+      CPPUNIT_ASSERT_EQUAL(le, fromBE.data(String::UTF16LE));
+      CPPUNIT_ASSERT_EQUAL(be, fromLE.data(String::UTF16BE));
+    }
+
+    // A broken BOM gives an empty String
+    CPPUNIT_ASSERT(String(ByteVector("\x00\x41", 2), String::UTF16).isEmpty());
+  }
+
+  void testNonAsciiPosition()
+  {
+    for(unsigned int length = 1; length <= 48; ++length) {
+      for(unsigned int pos = 0; pos < length; ++pos) {
+        string latin1(length, 'a');
+        latin1[pos] = '\xe9';
+        const String fromLatin1(latin1, String::Latin1);
+        CPPUNIT_ASSERT_EQUAL(length, fromLatin1.size());
+        CPPUNIT_ASSERT_EQUAL(L'\x00e9', fromLatin1[static_cast<int>(pos)]);
+        CPPUNIT_ASSERT(!fromLatin1.isAscii());
+
+        string utf8(length, 'a');
+        utf8.replace(pos, 1, "\xc3\xa9");
+        const String fromUTF8(utf8, String::UTF8);
+        CPPUNIT_ASSERT(fromUTF8 == fromLatin1);
+        CPPUNIT_ASSERT(fromUTF8.to8Bit(true) == utf8);
+        CPPUNIT_ASSERT(fromLatin1.to8Bit(false) == latin1);
+
+        // A stray continuation byte makes the whole string invalid
+        string invalid(length, 'a');
+        invalid[pos] = '\x80';
+        CPPUNIT_ASSERT(String(invalid, String::UTF8).isEmpty());
+      }
+    }
+  }
+
+  void testInvalidUTF8()
+  {
+    // utf8-cpp rejected these sequences as a whole, the String is empty
+    const vector<string> invalid = {
+      "\xc0\x80",          // overlong U+0000
+      "\xc1\xbf",          // overlong U+007F
+      "\xe0\x80\x80",      // overlong in 3 bytes
+      "\xe0\x9f\xbf",      // overlong U+07FF
+      "\xf0\x80\x80\x80",  // overlong in 4 bytes
+      "\xf0\x8f\xbf\xbf",  // overlong U+FFFF
+      "\xed\xa0\x80",      // lead surrogate U+D800
+      "\xed\xbf\xbf",      // trail surrogate U+DFFF
+      "\xf4\x90\x80\x80",  // U+110000
+      "\xf5\x80\x80\x80",  // beyond any code point
+      "\xc3",              // truncated 2 byte sequence
+      "\xe2\x82",          // truncated 3 byte sequence
+      "\xf0\x9f\x98",      // truncated 4 byte sequence
+    };
+    for(const string &sequence : invalid) {
+      for(size_t prefix = 0; prefix <= 20; ++prefix) {
+        const string text = string(prefix, 'a') + sequence;
+        CPPUNIT_ASSERT(String(text, String::UTF8).isEmpty());
+        CPPUNIT_ASSERT(String(ByteVector(text.data(), static_cast<unsigned int>(text.size())),
+                              String::UTF8).isEmpty());
+        CPPUNIT_ASSERT(String(text + "bc", String::UTF8).isEmpty());
+      }
+    }
+
+    // The boundaries themselves are valid
+    CPPUNIT_ASSERT(hasUnits(String(string("\xc2\x80"), String::UTF8), { 0x80 }));
+    CPPUNIT_ASSERT(hasUnits(String(string("\xe0\xa0\x80"), String::UTF8), { 0x800 }));
+    CPPUNIT_ASSERT(hasUnits(String(string("\xed\x9f\xbf"), String::UTF8), { 0xd7ff }));
+    CPPUNIT_ASSERT(hasUnits(String(string("\xee\x80\x80"), String::UTF8), { 0xe000 }));
+    CPPUNIT_ASSERT(hasUnits(String(string("\xf0\x90\x80\x80"), String::UTF8),
+                            { 0xd800, 0xdc00 }));
+    CPPUNIT_ASSERT(hasUnits(String(string("\xf4\x8f\xbf\xbf"), String::UTF8),
+                            { 0xdbff, 0xdfff }));
+  }
+
+  void testUnpairedSurrogates()
+  {
+    // utf8-cpp rejected these Strings as a whole, nothing is encoded
+    const vector<vector<unsigned int>> invalid = {
+      { 0xD800 },          // lead surrogate at the end
+      { 0xD800, 0x0041 },  // lead surrogate followed by 'A'
+      { 0xDC00, 0x0041 },  // trail surrogate first
+      { 0xD800, 0xD800 },  // two lead surrogates
+    };
+    for(const auto &units : invalid) {
+      for(unsigned int prefix = 0; prefix <= 20; ++prefix) {
+        vector<unsigned int> all(prefix, 'a');
+        all.insert(all.end(), units.begin(), units.end());
+        const String s(encodeUTF16Bytes(all, true), String::UTF16BE);
+        CPPUNIT_ASSERT(hasUnits(s, all));
+        CPPUNIT_ASSERT(s.to8Bit(true).empty());
+        CPPUNIT_ASSERT_EQUAL(0U, s.utf8Size());
+        CPPUNIT_ASSERT(s.data(String::UTF8).isEmpty());
+        char buffer[128];
+        CPPUNIT_ASSERT_EQUAL(0U, s.copyUTF8(buffer, sizeof(buffer)));
+      }
+    }
+  }
+
+  void testCopyUTF8BufferSize()
+  {
+    // "a\u00e9\u20ac\U0001f600" takes 1 + 2 + 3 + 4 bytes
+    const String s(string("a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80"), String::UTF8);
+    CPPUNIT_ASSERT_EQUAL(10U, s.utf8Size());
+    char buffer[16];
+    for(unsigned int size = 0; size < 10; ++size)
+      CPPUNIT_ASSERT_EQUAL(0U, s.copyUTF8(buffer, size));
+    CPPUNIT_ASSERT_EQUAL(10U, s.copyUTF8(buffer, 10));
+    CPPUNIT_ASSERT(string(buffer, 10) == s.to8Bit(true));
+    CPPUNIT_ASSERT_EQUAL(10U, s.copyUTF8(buffer, sizeof(buffer)));
+
+    // The ASCII prefix alone does not fit either
+    const String ascii(string(20, 'a'));
+    CPPUNIT_ASSERT_EQUAL(0U, ascii.copyUTF8(buffer, sizeof(buffer)));
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestStringTranscoding);
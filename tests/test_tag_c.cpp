@@ -78,6 +78,7 @@ class TestTagC : public CppUnit::TestFixture
 {
   CPPUNIT_TEST_SUITE(TestTagC);
   CPPUNIT_TEST(testMp3);
+  CPPUNIT_TEST(testPropertyList);
 #ifdef TAGLIB_WITH_VORBIS
   CPPUNIT_TEST(testStream);
 #endif
@@ -170,6 +171,47 @@ public:
     taglib_tag_free_strings();
   }
 
+  void testPropertyList()
+  {
+    ScopedFileCopy copy("xing", ".mp3");
+
+    {
+      TagLib_File *file = taglib_file_new(copy.fileName().c_str());
+      CPPUNIT_ASSERT(taglib_file_is_valid(file));
+      taglib_property_set(file, "TITLE", "Title");
+      taglib_property_set(file, "COMPOSER", "Composer 1");
+      taglib_property_set_append(file, "COMPOSER", "Composer 2");
+      taglib_property_set(file, "COMMENT:\xE2\x80\xBB", "Comment (with description)");
+
+      TagLib_Property_List *list = taglib_property_get_all(file);
+      CPPUNIT_ASSERT(list);
+      std::unordered_map<std::string, std::list<std::string>> propertyMap;
+      for(unsigned int i = 0; i < list->count; ++i) {
+        propertyMap[list->data + list->keyOffsets[i]].push_back(
+          list->data + list->valueOffsets[i]);
+      }
+      CPPUNIT_ASSERT_EQUAL(4U, list->count);
+      CPPUNIT_ASSERT_EQUAL(list->keyOffsets[1], list->keyOffsets[2]);
+      taglib_property_list_free(list);
+
+      const std::unordered_map<std::string, std::list<std::string>> expected {
+        {"TITLE"s, {"Title"s}},
+        {"COMPOSER"s, {"Composer 1"s, "Composer 2"s}},
+        {"COMMENT:\xE2\x80\xBB"s, {"Comment (with description)"s}}
+      };
+      CPPUNIT_ASSERT(expected == propertyMap);
+
+      taglib_set_string_management_per_file(1);
+      TagLib_Tag *tag = taglib_file_tag(file);
+      CPPUNIT_ASSERT_EQUAL("Title"s, std::string(taglib_tag_title(tag)));
+      CPPUNIT_ASSERT_EQUAL(""s, std::string(taglib_tag_album(tag)));
+      taglib_file_free(file);
+      taglib_set_string_management_per_file(0);
+    }
+
+    taglib_tag_free_strings();
+  }
+
 #ifdef TAGLIB_WITH_VORBIS
   void testStream()
   {
@@ -339,6 +339,27 @@ describe("UnifiedLoaderComponents", () => {
     }
   });
 
+  it("WASI binary selection prefers SIMD only when supported", async () => {
+    const { wasiBinaryCandidates } = await import(
+      "../src/runtime/unified-loader/module-loading.ts"
+    );
+
+    const withSimd = wasiBinaryCandidates({}, true);
+    assertEquals(withSimd.length, 2);
+    assert(withSimd[0].endsWith("taglib_wasi_simd.wasm"));
+    assert(withSimd[1].endsWith("taglib_wasi.wasm"));
+
+    const withoutSimd = wasiBinaryCandidates({}, false);
+    assertEquals(withoutSimd.length, 1);
+    assert(withoutSimd[0].endsWith("taglib_wasi.wasm"));
+
+    assertEquals(wasiBinaryCandidates({ simd: false }, true), withoutSimd);
+    assertEquals(
+      wasiBinaryCandidates({ wasmUrl: "/custom.wasm" }, true),
+      ["/custom.wasm"],
+    );
+  });
+
   it("Memory cleanup works correctly", () => {
     // Test that resources are properly cleaned up
 
@@ -0,0 +1,206 @@
+/**
+ * @fileoverview Tests for WASI instance recycling
+ *
+ * Fake instances check when the recycling module may swap instances:
+ * only at the start of an operation and only once the host has freed
+ * every pointer it got from the current instance. With a built module,
+ * reads keep working across recycles.
+ */
+
+import { assertEquals, assertExists, assertGreater } from "@std/assert";
+import { describe, it } from "@std/testing/bdd";
+import { resolve } from "@std/path";
+import type { WasiModule } from "../src/runtime/wasmer-sdk-loader/types.ts";
+import {
+  createWasiHostFactory,
+  type WasiHostFactory,
+} from "../src/runtime/wasi-host-loader.ts";
+import {
+  createRecyclingWasiModule,
+  readHeapReport,
+} from "../src/runtime/unified-loader/instance-recycling.ts";
+import { readTagsFromWasmPath } from "../src/runtime/wasi-adapter/wasm-io.ts";
+import { fileExists, FORMAT_FILES } from "./wasi-test-helpers.ts";
+
+const PROJECT_ROOT = resolve(Deno.cwd());
+const TEST_FILES_DIR = resolve(PROJECT_ROOT, "tests/test-files");
+const WASM_PATH = resolve(PROJECT_ROOT, "dist/wasi/taglib_wasi.wasm");
+
+const HAS_WASM = fileExists(WASM_PATH);
+
+const PAGE = 65536;
+
+interface FakeInstance extends WasiModule, Disposable {
+  id: number;
+  disposed: boolean;
+  grow(pages: number): void;
+}
+
+// Bump allocator over a resizable buffer; tl_read_tags returns a fresh
+// allocation, tl_heap_report writes fixed numbers.
+function createFakeFactory(): WasiHostFactory & {
+  instances: FakeInstance[];
+} {
+  const instances: FakeInstance[] = [];
+  return {
+    instances,
+    instantiate() {
+      let buffer = new ArrayBuffer(PAGE);
+      let top = 1024;
+      const malloc = (size: number) => {
+        const ptr = top;
+        top += (size + 15) & ~15;
+        return ptr;
+      };
+      const sinks = new Map<number, (chunk: Uint8Array) => boolean>();
+      const instance: FakeInstance = {
+        id: instances.length,
+        disposed: false,
+        grow(pages) {
+          const grown = new ArrayBuffer(buffer.byteLength + pages * PAGE);
+          new Uint8Array(grown).set(new Uint8Array(buffer));
+          buffer = grown;
+        },
+        memory: {
+          get buffer() {
+            return buffer;
+          },
+        } as unknown as WebAssembly.Memory,
+        tl_version: () => "fake",
+        tl_api_version: () => 3,
+        malloc,
+        free: () => {},
+        tl_read_tags: () => malloc(32),
+        tl_write_tags: () => 0,
+        tl_read_tags_chunked: (_p, _b, _l, _f, _c, streamId) =>
+          sinks.get(streamId)?.(new Uint8Array([0x80])) ? 0 : 1,
+        setChunkSink: (streamId, sink) => {
+          if (sink) sinks.set(streamId, sink);
+          else sinks.delete(streamId);
+        },
+        tl_get_last_error: () => 0,
+        tl_get_last_error_code: () => 0,
+        tl_clear_error: () => {},
+        tl_heap_report: (ptr) => {
+          const view = new DataView(buffer, ptr, 24);
+          [buffer.byteLength, 1024, buffer.byteLength - 1024, 4096, 8192, 750]
+            .forEach((value, i) => view.setUint32(i * 4, value, true));
+          return 0;
+        },
+        [Symbol.dispose]() {
+          this.disposed = true;
+        },
+      };
+      instances.push(instance);
+      return instance;
+    },
+  };
+}
+
+describe("WASI instance recycling", () => {
+  it("keeps the instance while memory is under the threshold", () => {
+    const factory = createFakeFactory();
+    using wasi = createRecyclingWasiModule(factory, {
+      maxHeapBytes: 4 * PAGE,
+    });
+
+    for (let i = 0; i < 10; i++) {
+      wasi.free(wasi.tl_read_tags(0, 0, 0, 0));
+    }
+    assertEquals(wasi.recycleCount, 0);
+    assertEquals(factory.instances.length, 1);
+  });
+
+  it("swaps the instance once memory exceeds the threshold", () => {
+    const factory = createFakeFactory();
+    using wasi = createRecyclingWasiModule(factory, {
+      maxHeapBytes: 4 * PAGE,
+    });
+
+    wasi.free(wasi.tl_read_tags(0, 0, 0, 0));
+    factory.instances[0].grow(8);
+    assertEquals(wasi.memory.buffer.byteLength, 9 * PAGE);
+
+    wasi.free(wasi.tl_read_tags(0, 0, 0, 0));
+    assertEquals(wasi.recycleCount, 1);
+    assertEquals(factory.instances[0].disposed, true);
+    assertEquals(wasi.memory.buffer.byteLength, PAGE);
+  });
+
+  it("does not swap while the host holds pointers into the instance", () => {
+    const factory = createFakeFactory();
+    using wasi = createRecyclingWasiModule(factory, {
+      maxHeapBytes: 4 * PAGE,
+    });
+
+    const input = wasi.malloc(64);
+    factory.instances[0].grow(8);
+    const result = wasi.tl_read_tags(0, input, 64, 0);
+    assertEquals(wasi.recycleCount, 0);
+
+    // Error state and frees still reach the old instance
+    wasi.tl_get_last_error_code();
+    wasi.free(result);
+    wasi.free(input);
+    assertEquals(wasi.recycleCount, 0);
+
+    wasi.malloc(16);
+    assertEquals(wasi.recycleCount, 1);
+  });
+
+  it("hands registered chunk sinks to the new instance", () => {
+    const factory = createFakeFactory();
+    using wasi = createRecyclingWasiModule(factory, {
+      maxHeapBytes: 4 * PAGE,
+    });
+
+    const chunks: Uint8Array[] = [];
+    wasi.setChunkSink!(1, (chunk) => chunks.push(chunk) > 0);
+    factory.instances[0].grow(8);
+    assertEquals(wasi.tl_read_tags_chunked!(0, 0, 0, 0, 64, 1), 0);
+    assertEquals(wasi.recycleCount, 1);
+    assertEquals(chunks, [new Uint8Array([0x80])]);
+  });
+
+  it("decodes tl_heap_report", () => {
+    const factory = createFakeFactory();
+    using wasi = createRecyclingWasiModule(factory, {
+      maxHeapBytes: 4 * PAGE,
+    });
+
+    const report = wasi.heapReport();
+    assertExists(report);
+    assertEquals(report.memoryBytes, PAGE);
+    assertEquals(report.heapBase, 1024);
+    assertEquals(report.liveBytes, 4096);
+    assertEquals(report.peakLiveBytes, 8192);
+    assertEquals(report.fragmentation, 0.75);
+  });
+});
+
+describe(
+  { name: "WASI instance recycling - built module", ignore: !HAS_WASM },
+  () => {
+    it("reads across recycles", async () => {
+      const factory = await createWasiHostFactory({
+        wasmPath: WASM_PATH,
+        preopens: { "/test": TEST_FILES_DIR },
+      });
+      // Below the initial memory, so every operation starts a new instance
+      using wasi = createRecyclingWasiModule(factory, {
+      maxHeapBytes: PAGE,
+    });
+
+      for (const paths of Object.values(FORMAT_FILES)) {
+        const data = readTagsFromWasmPath(wasi, paths.virtual);
+        assertGreater(data.length, 0);
+      }
+      assertGreater(wasi.recycleCount, 0);
+
+      const report = readHeapReport(wasi);
+      if (report) {
+        assertEquals(report.memoryBytes, wasi.memory.buffer.byteLength);
+      }
+    });
+  },
+);
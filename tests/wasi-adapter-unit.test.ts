@@ -2,7 +2,13 @@ import { assertEquals, assertExists, assertThrows } from "@std/assert";
 import { describe, it } from "@std/testing/bdd";
 import { WasiToTagLibAdapter } from "../src/runtime/wasi-adapter/index.ts";
 import {
+  estimateWriteToWasm,
+  lastWriteSkipped,
   readTagsFromWasm,
+  readTagsFromWasmChunked,
+  readTagsFromWasmPathWithSnapshot,
+  snapshotStructureFromWasmPath,
+  updateTagsInWasm,
   writeTagsToWasm,
 } from "../src/runtime/wasi-adapter/wasm-io.ts";
 import { WasmMemoryError } from "../src/runtime/wasi-memory.ts";
@@ -696,6 +702,327 @@ describe("writeTagsToWasm", () => {
   });
 });
 
+describe("lastWriteSkipped", () => {
+  it("should report the module's skip flag", () => {
+    const mock = createMockWasiModule();
+    mock.tl_write_skipped = () => 1;
+    assertEquals(lastWriteSkipped(mock), true);
+    mock.tl_write_skipped = () => 0;
+    assertEquals(lastWriteSkipped(mock), false);
+  });
+
+  it("should return false for modules without tl_write_skipped", () => {
+    assertEquals(lastWriteSkipped(createMockWasiModule()), false);
+  });
+});
+
+describe("estimateWriteToWasm", () => {
+  it("should decode the estimate struct", () => {
+    const mock = createMockWasiModule();
+    let next = 1024;
+    mock.malloc = (size: number) => {
+      const ptr = next;
+      next += (size + 15) & ~15;
+      return ptr;
+    };
+    mock.tl_estimate_write = (
+      _pathPtr: number,
+      _bufPtr: number,
+      _len: number,
+      _tagsPtr: number,
+      _tagsSize: number,
+      outPtr: number,
+    ) => {
+      const view = new DataView(mock.memory.buffer, outPtr, 72);
+      [5000, 5100, 0, 900, 1000, 4100, 4100, 5100].forEach((value, i) =>
+        view.setBigUint64(i * 8, BigInt(value), true)
+      );
+      view.setUint32(64, 0, true);
+      view.setUint32(68, 0, true);
+      return 0;
+    };
+
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0, 0, 0, 0, 0]);
+    const tagData = { title: "Test" } as unknown as ExtendedTag;
+    const estimate = estimateWriteToWasm(mock, fileData, tagData);
+    assertExists(estimate);
+    assertEquals(estimate.fileSize, 5000);
+    assertEquals(estimate.newFileSize, 5100);
+    assertEquals(estimate.newRegionSize, 1000);
+    assertEquals(estimate.bytesMoved, 4100);
+    assertEquals(estimate.bytesWritten, 5100);
+    assertEquals(estimate.fitsInPlace, false);
+    assertEquals(estimate.unchanged, false);
+  });
+
+  it("should throw WasmMemoryError when tl_estimate_write fails", () => {
+    const mock = createMockWasiModule();
+    mock.tl_estimate_write = () => -6;
+    mock.tl_get_last_error_code = () => -6;
+
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0]);
+    const tagData = { title: "Test" } as unknown as ExtendedTag;
+    assertThrows(
+      () => estimateWriteToWasm(mock, fileData, tagData),
+      WasmMemoryError,
+      "error code -6",
+    );
+  });
+
+  it("should return undefined for modules without tl_estimate_write", () => {
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0]);
+    const tagData = { title: "Test" } as unknown as ExtendedTag;
+    assertEquals(
+      estimateWriteToWasm(createMockWasiModule(), fileData, tagData),
+      undefined,
+    );
+  });
+});
+
+describe("updateTagsInWasm", () => {
+  it("should return the new buffer and the tags from the same call", () => {
+    const mock = createMockWasiModule();
+    let next = 1024;
+    mock.malloc = (size: number) => {
+      const ptr = next;
+      next += (size + 15) & ~15;
+      return ptr;
+    };
+    const freed: number[] = [];
+    mock.free = (ptr: number) => freed.push(ptr);
+    let patchSize = 0;
+    mock.tl_update_tags = (
+      _pathPtr: number,
+      _bufPtr: number,
+      _len: number,
+      _patchPtr: number,
+      size: number,
+      outBufPtr: number,
+      outSizePtr: number,
+      outTagsPtr: number,
+      outTagsSizePtr: number,
+    ) => {
+      patchSize = size;
+      const heap = new Uint8Array(mock.memory.buffer);
+      const view = new DataView(mock.memory.buffer);
+      heap.set([1, 2, 3], 8192);
+      view.setUint32(outBufPtr, 8192, true);
+      view.setUint32(outSizePtr, 3, true);
+      heap[8256] = 0x80;
+      view.setUint32(outTagsPtr, 8256, true);
+      view.setUint32(outTagsSizePtr, 1, true);
+      return 0;
+    };
+
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0]);
+    const result = updateTagsInWasm(
+      mock,
+      fileData,
+      { append: { genre: ["Jazz"] }, remove: ["comment"] },
+      true,
+    );
+    assertEquals(result.buffer, new Uint8Array([1, 2, 3]));
+    assertEquals(result.tags, new Uint8Array([0x80]));
+    assertEquals(patchSize > 0, true);
+    assertEquals(freed.includes(8192) && freed.includes(8256), true);
+  });
+
+  it("should fall back to the input when no buffer comes back", () => {
+    const mock = createMockWasiModule();
+    mock.tl_update_tags = () => 0;
+
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0]);
+    const result = updateTagsInWasm(mock, fileData, { set: { title: "T" } });
+    assertEquals(result.buffer, fileData);
+    assertEquals(result.tags, null);
+  });
+
+  it("should throw WasmMemoryError when tl_update_tags fails", () => {
+    const mock = createMockWasiModule();
+    mock.tl_update_tags = () => -3;
+    mock.tl_get_last_error_code = () => -3;
+
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0]);
+    assertThrows(
+      () => updateTagsInWasm(mock, fileData, { remove: ["title"] }),
+      WasmMemoryError,
+      "error code -3",
+    );
+  });
+
+  it("should throw for modules without tl_update_tags", () => {
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0]);
+    assertThrows(
+      () => updateTagsInWasm(createMockWasiModule(), fileData, {}),
+      WasmMemoryError,
+      "tl_update_tags",
+    );
+  });
+});
+
+describe("readTagsFromWasmChunked", () => {
+  function withChunkedRead(mock: any, result: Uint8Array) {
+    const sinks = new Map<number, (chunk: Uint8Array) => boolean>();
+    mock.setChunkSink = (
+      id: number,
+      sink: ((chunk: Uint8Array) => boolean) | undefined,
+    ) => {
+      if (sink) sinks.set(id, sink);
+      else sinks.delete(id);
+    };
+    mock.tl_read_tags_chunked = (
+      _pathPtr: number,
+      _bufPtr: number,
+      _len: number,
+      _format: number,
+      chunkSize: number,
+      streamId: number,
+    ) => {
+      for (let i = 0; i < result.length; i += chunkSize) {
+        if (!sinks.get(streamId)?.(result.slice(i, i + chunkSize))) return -7;
+      }
+      return 0;
+    };
+    return sinks;
+  }
+
+  it("should hand the result over in chunks of at most chunkSize", () => {
+    const mock = createMockWasiModule();
+    const result = new Uint8Array(300).map((_, i) => i & 0xff);
+    const sinks = withChunkedRead(mock, result);
+
+    const chunks: Uint8Array[] = [];
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0]);
+    assertEquals(
+      readTagsFromWasmChunked(mock, fileData, (c) => chunks.push(c), 128),
+      true,
+    );
+    assertEquals(chunks.map((c) => c.length), [128, 128, 44]);
+    const joined = new Uint8Array(300);
+    let offset = 0;
+    for (const chunk of chunks) {
+      joined.set(chunk, offset);
+      offset += chunk.length;
+    }
+    assertEquals(joined, result);
+    assertEquals(sinks.size, 0);
+  });
+
+  it("should rethrow an error from the chunk callback", () => {
+    const mock = createMockWasiModule();
+    const sinks = withChunkedRead(mock, new Uint8Array(300));
+    mock.tl_get_last_error_code = () => -7;
+
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0]);
+    assertThrows(
+      () =>
+        readTagsFromWasmChunked(mock, fileData, () => {
+          throw new Error("consumer gone");
+        }),
+      Error,
+      "consumer gone",
+    );
+    assertEquals(sinks.size, 0);
+  });
+
+  it("should return false for modules without tl_read_tags_chunked", () => {
+    const fileData = new Uint8Array([0xFF, 0xFB, 0, 0]);
+    assertEquals(
+      readTagsFromWasmChunked(createMockWasiModule(), fileData, () => {}),
+      false,
+    );
+  });
+});
+
+describe("structure snapshots", () => {
+  function withBumpMalloc(mock: any) {
+    let next = 1024;
+    mock.malloc = (size: number) => {
+      const ptr = next;
+      next += (size + 15) & ~15;
+      return ptr;
+    };
+  }
+
+  it("should hand the snapshot back to the read that reopens with it", () => {
+    const mock = createMockWasiModule();
+    withBumpMalloc(mock);
+    const freed: number[] = [];
+    mock.free = (ptr: number) => freed.push(ptr);
+    mock.tl_snapshot_structure = (
+      _pathPtr: number,
+      outBufPtr: number,
+      outSizePtr: number,
+    ) => {
+      const view = new DataView(mock.memory.buffer);
+      new Uint8Array(mock.memory.buffer).set([7, 8, 9], 8192);
+      view.setUint32(outBufPtr, 8192, true);
+      view.setUint32(outSizePtr, 3, true);
+      return 0;
+    };
+    let received: number[] = [];
+    mock.tl_read_tags_snapshot = (
+      _pathPtr: number,
+      snapshotPtr: number,
+      snapshotSize: number,
+      outSizePtr: number,
+      outUsedPtr: number,
+    ) => {
+      const heap = new Uint8Array(mock.memory.buffer);
+      const view = new DataView(mock.memory.buffer);
+      received = [...heap.slice(snapshotPtr, snapshotPtr + snapshotSize)];
+      heap[8256] = 0x80;
+      view.setUint32(outSizePtr, 1, true);
+      view.setUint32(outUsedPtr, 1, true);
+      return 8256;
+    };
+
+    const snapshot = snapshotStructureFromWasmPath(mock, "/test/a.mp3");
+    assertEquals(snapshot, new Uint8Array([7, 8, 9]));
+    const result = readTagsFromWasmPathWithSnapshot(
+      mock,
+      "/test/a.mp3",
+      snapshot!,
+    );
+    assertEquals(received, [7, 8, 9]);
+    assertEquals(result.tags, new Uint8Array([0x80]));
+    assertEquals(result.snapshotUsed, true);
+    assertEquals(freed.includes(8192) && freed.includes(8256), true);
+  });
+
+  it("should throw WasmMemoryError when the snapshot read fails", () => {
+    const mock = createMockWasiModule();
+    withBumpMalloc(mock);
+    mock.tl_read_tags_snapshot = () => 0;
+    mock.tl_get_last_error_code = () => -3;
+
+    assertThrows(
+      () =>
+        readTagsFromWasmPathWithSnapshot(
+          mock,
+          "/test/a.mp3",
+          new Uint8Array([1]),
+        ),
+      WasmMemoryError,
+      "error code -3",
+    );
+  });
+
+  it("should fall back to a plain read for modules without snapshots", () => {
+    const mock = createMockWasiModule();
+    mock.tl_read_tags = stubTlReadTags(mock);
+
+    assertEquals(snapshotStructureFromWasmPath(mock, "/test/a.mp3"), undefined);
+    const result = readTagsFromWasmPathWithSnapshot(
+      mock,
+      "/test/a.mp3",
+      new Uint8Array([1]),
+    );
+    assertEquals(result.tags, new Uint8Array([0x80]));
+    assertEquals(result.snapshotUsed, false);
+  });
+});
+
 // --- Test helpers ---
 
 function createMockWasiModule(): any {
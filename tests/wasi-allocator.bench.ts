@@ -0,0 +1,83 @@
+/**
+ * @fileoverview Benchmark comparing the WASI allocators
+ *
+ * 1. dlmalloc: default build (TAGLIB_WASI_ALLOCATOR=dlmalloc)
+ * 2. Slab: operator new/delete served by the size-class slab allocator
+ *    (TAGLIB_WASI_ALLOCATOR=slab)
+ *
+ * Before the benchmarks, each module scans 10,000 files (the corpus in
+ * rotation, path and buffer reads) in one long-lived instance and reports
+ * its heap high-water mark: linear memory never shrinks, so its size after
+ * the scan is the steady-state footprint. Reads go through the adapter's
+ * readers, which free every result.
+ *
+ * Build both modules with:
+ *   ./build/build-wasi.sh && TAGLIB_WASI_ALLOCATOR=slab ./build/build-wasi.sh
+ * Run with: deno bench --allow-read --allow-write --allow-env tests/wasi-allocator.bench.ts
+ */
+
+import { resolve } from "@std/path";
+import type { WasiModule } from "../src/runtime/wasmer-sdk-loader/types.ts";
+import {
+  readTagsFromWasm,
+  readTagsFromWasmPath,
+} from "../src/runtime/wasi-adapter/wasm-io.ts";
+import { compareModules, FORMAT_FILES } from "./wasi-test-helpers.ts";
+
+const PROJECT_ROOT = resolve(Deno.cwd());
+const TEST_FILES_DIR = resolve(PROJECT_ROOT, "tests/test-files");
+const SCAN_FILES = 10_000;
+const SCAN_CHECKPOINTS = [1_000, 5_000, 10_000];
+
+const { hasWasm, baseline, variant } = await compareModules({
+  baseline: {
+    label: "dlmalloc",
+    wasmPath: resolve(PROJECT_ROOT, "dist/wasi/taglib_wasi.wasm"),
+  },
+  variant: {
+    label: "Slab",
+    wasmPath: resolve(PROJECT_ROOT, "dist/wasi/taglib_wasi_slab.wasm"),
+  },
+  testFilesDir: TEST_FILES_DIR,
+  read: readTagsFromWasmPath,
+});
+
+// --- Heap high-water over a 10k-file scan ---
+
+const corpus = Object.values(FORMAT_FILES).map((paths) => ({
+  virtual: paths.virtual,
+  data: hasWasm
+    ? Deno.readFileSync(resolve(TEST_FILES_DIR, paths.real))
+    : new Uint8Array(),
+}));
+
+function scan(wasi: WasiModule): { ms: number; heapKiB: number[] } {
+  const heapKiB: number[] = [];
+  const start = performance.now();
+  for (let i = 1; i <= SCAN_FILES; i++) {
+    const file = corpus[i % corpus.length];
+    if (i % 2 === 0) readTagsFromWasmPath(wasi, file.virtual);
+    else readTagsFromWasm(wasi, file.data);
+    if (SCAN_CHECKPOINTS.includes(i)) {
+      heapKiB.push(wasi.memory.buffer.byteLength / 1024);
+    }
+  }
+  return { ms: performance.now() - start, heapKiB };
+}
+
+if (hasWasm) {
+  const initialKiB = [baseline!, variant!].map((wasi) =>
+    wasi.memory.buffer.byteLength / 1024
+  );
+  const results = [scan(baseline!), scan(variant!)];
+  console.log(
+    `Heap high-water (KiB) after ${SCAN_CHECKPOINTS.join(" / ")} files:`,
+  );
+  ["dlmalloc", "slab"].forEach((name, i) => {
+    console.log(
+      `  ${name.padEnd(8)} initial ${initialKiB[i]}, ${
+        results[i].heapKiB.join(" / ")
+      }, scan ${results[i].ms.toFixed(0)} ms`,
+    );
+  });
+}
@@ -0,0 +1,30 @@
+/**
+ * @fileoverview Benchmark comparing the Wasm EH and no-EH WASI builds
+ *
+ * Quantifies the cost of exception handling support on the parse path:
+ * 1. Wasm EH: default build (-fwasm-exceptions, libunwind)
+ * 2. No EH: TAGLIB_WASI_EH=none build (-fno-exceptions)
+ *
+ * Both modules read the same files through WASI path I/O, so the difference
+ * is code size and landing pads, not I/O strategy.
+ *
+ * Build the no-EH module with: TAGLIB_WASI_EH=none ./build/build-wasi.sh
+ * Run with: deno bench --allow-read --allow-write --allow-env tests/wasi-eh-vs-noeh.bench.ts
+ */
+
+import { resolve } from "@std/path";
+import { compareModules } from "./wasi-test-helpers.ts";
+
+const PROJECT_ROOT = resolve(Deno.cwd());
+
+await compareModules({
+  baseline: {
+    label: "Wasm EH",
+    wasmPath: resolve(PROJECT_ROOT, "dist/wasi/taglib_wasi.wasm"),
+  },
+  variant: {
+    label: "No EH",
+    wasmPath: resolve(PROJECT_ROOT, "dist/wasi/taglib_wasi_noeh.wasm"),
+  },
+  testFilesDir: resolve(PROJECT_ROOT, "tests/test-files"),
+});
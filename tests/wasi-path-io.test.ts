@@ -5,18 +5,25 @@
  * filesystem syscalls instead of loading entire files into memory.
  */
 
-import { assertEquals, assertExists } from "@std/assert";
+import { assertEquals, assertExists, assertThrows } from "@std/assert";
 import { describe, it } from "@std/testing/bdd";
 import { resolve } from "@std/path";
 import { TagLib } from "../index.ts";
 import { applyTagsToFile, readTags } from "../simple.ts";
 import { loadWasiHost } from "../src/runtime/wasi-host-loader.ts";
 import {
+  estimateWriteToWasmPath,
+  lastWriteSkipped,
   readTagsFromWasmPath,
+  readTagsFromWasmPathChunked,
+  readTagsFromWasmPathWithSnapshot,
+  snapshotStructureFromWasmPath,
+  updateTagsInWasmPath,
   writeTagsToWasmPath,
 } from "../src/runtime/wasi-adapter/wasm-io.ts";
+import { decodeTagData } from "../src/msgpack/decoder.ts";
 import { supportsExnref } from "../src/runtime/detector.ts";
-import type { ExtendedTag } from "../src/types.ts";
+import type { ExtendedTag, TagPatch } from "../src/types.ts";
 
 const TEST_FILES_DIR = resolve("tests/test-files");
 const WASM_PATH = resolve("build/taglib_wasi.wasm");
@@ -92,6 +99,312 @@ describe("WASI path-based I/O", { ignore: !WASI_AVAILABLE }, () => {
         } catch { /* cleanup */ }
       }
     });
+
+    it("skips the save when the tags are unchanged", async () => {
+      const tmpPath = resolve(TEST_FILES_DIR, "../path-noop-test.mp3");
+      try {
+        await Deno.copyFile(
+          resolve(TEST_FILES_DIR, "mp3/kiss-snippet.mp3"),
+          tmpPath,
+        );
+        using wasi = await loadWasiHost({
+          wasmPath: WASM_PATH,
+          preopens: { "/tmp": resolve(TEST_FILES_DIR, "..") },
+        });
+
+        const tags: ExtendedTag = {
+          title: ["Written Once"],
+          artist: ["WASI Test"],
+        };
+        writeTagsToWasmPath(wasi, "/tmp/path-noop-test.mp3", tags);
+        assertEquals(lastWriteSkipped(wasi), false);
+        const before = await Deno.readFile(tmpPath);
+        const mtime = (await Deno.stat(tmpPath)).mtime;
+
+        writeTagsToWasmPath(wasi, "/tmp/path-noop-test.mp3", tags);
+        assertEquals(lastWriteSkipped(wasi), true);
+        assertEquals(await Deno.readFile(tmpPath), before);
+        assertEquals((await Deno.stat(tmpPath)).mtime, mtime);
+      } finally {
+        try {
+          await Deno.remove(tmpPath);
+        } catch { /* cleanup */ }
+      }
+    });
+
+    it("saves a date change within the same year", async () => {
+      const tmpPath = resolve(TEST_FILES_DIR, "../path-date-test.mp3");
+      try {
+        await Deno.copyFile(
+          resolve(TEST_FILES_DIR, "mp3/kiss-snippet.mp3"),
+          tmpPath,
+        );
+        using wasi = await loadWasiHost({
+          wasmPath: WASM_PATH,
+          preopens: { "/tmp": resolve(TEST_FILES_DIR, "..") },
+        });
+        const virtualPath = "/tmp/path-date-test.mp3";
+
+        writeTagsToWasmPath(wasi, virtualPath, {
+          title: ["Dated"],
+          date: ["2020-05-01"],
+        } as unknown as ExtendedTag);
+        const before = await Deno.readFile(tmpPath);
+
+        writeTagsToWasmPath(wasi, virtualPath, {
+          title: ["Dated"],
+          date: ["2020-06-01"],
+        } as unknown as ExtendedTag);
+        assertEquals(lastWriteSkipped(wasi), false);
+        assertEquals(
+          (await Deno.readFile(tmpPath)).some((byte, i) => byte !== before[i]),
+          true,
+        );
+
+        const taglib = await TagLib.initialize();
+        using file = await taglib.open(tmpPath);
+        assertEquals(file.getProperty("date"), "2020-06-01");
+      } finally {
+        try {
+          await Deno.remove(tmpPath);
+        } catch { /* cleanup */ }
+      }
+    });
+  });
+
+  describe("estimateWriteToWasmPath", () => {
+    it("reports the cost without touching the file", async () => {
+      const realPath = resolve(TEST_FILES_DIR, "mp3/kiss-snippet.mp3");
+      const before = await Deno.readFile(realPath);
+      using wasi = await loadWasiHost({
+        wasmPath: WASM_PATH,
+        preopens: { "/test": TEST_FILES_DIR },
+      });
+      const virtualPath = "/test/mp3/kiss-snippet.mp3";
+      const current = decodeTagData(
+        readTagsFromWasmPath(wasi, virtualPath),
+      ) as Record<string, unknown>;
+      const title = (current.title as string[])[0];
+      assertExists(title);
+
+      // One ASCII character swapped: the frame keeps its size
+      const sameSize = estimateWriteToWasmPath(wasi, virtualPath, {
+        title: [title.slice(0, -1) + (title.endsWith("x") ? "y" : "x")],
+      });
+      assertExists(sameSize);
+      assertEquals(sameSize.unchanged, false);
+      assertEquals(sameSize.fitsInPlace, true);
+      assertEquals(sameSize.bytesMoved, 0);
+      assertEquals(sameSize.newFileSize, before.length);
+
+      // Far more than any padding: the audio data has to move
+      const growing = estimateWriteToWasmPath(wasi, virtualPath, {
+        title: ["x".repeat(64 * 1024)],
+      });
+      assertExists(growing);
+      assertEquals(growing.fileSize, before.length);
+      assertEquals(growing.unchanged, false);
+      assertEquals(growing.fitsInPlace, false);
+      assertEquals(growing.bytesMoved > 0, true);
+      assertEquals(growing.newFileSize > growing.fileSize, true);
+      assertEquals(
+        growing.newFileSize - growing.fileSize,
+        growing.newRegionSize - growing.regionSize,
+      );
+      assertEquals(await Deno.readFile(realPath), before);
+    });
+  });
+
+  describe("same-size writes", () => {
+    it("patches only the changed bytes", async () => {
+      const tmpPath = resolve(TEST_FILES_DIR, "../path-patch-test.mp3");
+      try {
+        await Deno.copyFile(
+          resolve(TEST_FILES_DIR, "mp3/kiss-snippet.mp3"),
+          tmpPath,
+        );
+        using wasi = await loadWasiHost({
+          wasmPath: WASM_PATH,
+          preopens: { "/tmp": resolve(TEST_FILES_DIR, "..") },
+        });
+        const virtualPath = "/tmp/path-patch-test.mp3";
+        writeTagsToWasmPath(wasi, virtualPath, {
+          title: ["Kiss"],
+          artist: ["Prince"],
+        });
+        const before = await Deno.readFile(tmpPath);
+
+        const tags: ExtendedTag = { title: ["Kist"], artist: ["Prince"] };
+        const estimate = estimateWriteToWasmPath(wasi, virtualPath, tags);
+        assertExists(estimate);
+        assertEquals(estimate.fitsInPlace, true);
+        assertEquals(estimate.newFileSize, before.length);
+
+        writeTagsToWasmPath(wasi, virtualPath, tags);
+        const after = await Deno.readFile(tmpPath);
+        assertEquals(after.length, before.length);
+        const changed = after.filter((byte, i) => byte !== before[i]).length;
+        assertEquals(changed <= estimate.bytesWritten, true);
+
+        const taglib = await TagLib.initialize();
+        using file = await taglib.open(tmpPath);
+        assertEquals(file.tag().title, "Kist");
+      } finally {
+        try {
+          await Deno.remove(tmpPath);
+        } catch { /* cleanup */ }
+      }
+    });
+  });
+
+  describe("readTagsFromWasmPathChunked", () => {
+    it("streams the same bytes as readTagsFromWasmPath", async () => {
+      using wasi = await loadWasiHost({
+        wasmPath: WASM_PATH,
+        preopens: { "/test": TEST_FILES_DIR },
+      });
+      const path = "/test/mp3/kiss-snippet.mp3";
+      const whole = readTagsFromWasmPath(wasi, path);
+
+      const chunks: Uint8Array[] = [];
+      assertEquals(
+        readTagsFromWasmPathChunked(wasi, path, (c) => chunks.push(c), 64),
+        true,
+      );
+      assertEquals(chunks.every((c) => c.length <= 64), true);
+      const joined = new Uint8Array(
+        chunks.reduce((n, c) => n + c.length, 0),
+      );
+      let offset = 0;
+      for (const chunk of chunks) {
+        joined.set(chunk, offset);
+        offset += chunk.length;
+      }
+      assertEquals(joined, whole);
+    });
+  });
+
+  describe("updateTagsInWasmPath", () => {
+    it("applies set, append and remove and returns the result", async () => {
+      const tmpPath = resolve(TEST_FILES_DIR, "../path-update-test.mp3");
+      try {
+        await Deno.copyFile(
+          resolve(TEST_FILES_DIR, "mp3/kiss-snippet.mp3"),
+          tmpPath,
+        );
+        using wasi = await loadWasiHost({
+          wasmPath: WASM_PATH,
+          preopens: { "/tmp": resolve(TEST_FILES_DIR, "..") },
+        });
+        const virtualPath = "/tmp/path-update-test.mp3";
+        writeTagsToWasmPath(wasi, virtualPath, {
+          title: ["Kiss"],
+          genre: ["Funk"],
+          comment: ["Remove me"],
+        });
+
+        const returned = updateTagsInWasmPath(wasi, virtualPath, {
+          set: { title: ["Kissed"] },
+          append: { genre: ["Pop"] },
+          remove: ["comment"],
+        }, true);
+        assertExists(returned);
+        const tags = decodeTagData(returned) as Record<string, unknown>;
+        assertEquals(tags.title, ["Kissed"]);
+        assertEquals(tags.genre, ["Funk", "Pop"]);
+        assertEquals(tags.comment, undefined);
+
+        const reread = decodeTagData(
+          readTagsFromWasmPath(wasi, virtualPath),
+        ) as Record<string, unknown>;
+        assertEquals(reread.title, tags.title);
+        assertEquals(reread.genre, tags.genre);
+      } finally {
+        try {
+          await Deno.remove(tmpPath);
+        } catch { /* cleanup */ }
+      }
+    });
+
+    it("rejects appending ratings, lyrics and chapters", async () => {
+      using wasi = await loadWasiHost({
+        wasmPath: WASM_PATH,
+        preopens: { "/test": TEST_FILES_DIR },
+      });
+      const before = readTagsFromWasmPath(wasi, "/test/mp3/kiss-snippet.mp3");
+      for (const key of ["ratings", "lyrics", "chapters"]) {
+        const append = { [key]: [] } as unknown as TagPatch["append"];
+        assertThrows(() =>
+          updateTagsInWasmPath(wasi, "/test/mp3/kiss-snippet.mp3", { append })
+        );
+      }
+      assertEquals(
+        readTagsFromWasmPath(wasi, "/test/mp3/kiss-snippet.mp3"),
+        before,
+      );
+    });
+  });
+
+  describe("structure snapshots", () => {
+    it("reopens from a snapshot until the file changes", async () => {
+      const tmpPath = resolve(TEST_FILES_DIR, "../path-snapshot-test.m4a");
+      try {
+        await Deno.copyFile(
+          resolve(TEST_FILES_DIR, "mp4/kiss-snippet.m4a"),
+          tmpPath,
+        );
+        using wasi = await loadWasiHost({
+          wasmPath: WASM_PATH,
+          preopens: { "/tmp": resolve(TEST_FILES_DIR, "..") },
+        });
+        const virtualPath = "/tmp/path-snapshot-test.m4a";
+        const snapshot = snapshotStructureFromWasmPath(wasi, virtualPath);
+        assertExists(snapshot);
+
+        const fresh = readTagsFromWasmPathWithSnapshot(
+          wasi,
+          virtualPath,
+          snapshot,
+        );
+        assertEquals(fresh.snapshotUsed, true);
+        assertEquals(fresh.tags, readTagsFromWasmPath(wasi, virtualPath));
+
+        writeTagsToWasmPath(wasi, virtualPath, { title: ["Snapshot Stale"] });
+        const stale = readTagsFromWasmPathWithSnapshot(
+          wasi,
+          virtualPath,
+          snapshot,
+        );
+        assertEquals(stale.snapshotUsed, false);
+        const tags = decodeTagData(stale.tags) as Record<string, unknown>;
+        assertEquals(tags.title, ["Snapshot Stale"]);
+      } finally {
+        try {
+          await Deno.remove(tmpPath);
+        } catch { /* cleanup */ }
+      }
+    });
+
+    it("reopens Matroska and FLAC from their recorded structure", async () => {
+      using wasi = await loadWasiHost({
+        wasmPath: WASM_PATH,
+        preopens: { "/test": TEST_FILES_DIR },
+      });
+      for (
+        const file of ["matroska/kiss-snippet.mka", "flac/kiss-snippet.flac"]
+      ) {
+        const virtualPath = `/test/${file}`;
+        const snapshot = snapshotStructureFromWasmPath(wasi, virtualPath);
+        assertExists(snapshot);
+        const result = readTagsFromWasmPathWithSnapshot(
+          wasi,
+          virtualPath,
+          snapshot,
+        );
+        assertEquals(result.snapshotUsed, true);
+        assertEquals(result.tags, readTagsFromWasmPath(wasi, virtualPath));
+      }
+    });
   });
 
   describe("TagLib.open path mode", () => {
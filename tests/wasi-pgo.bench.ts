@@ -0,0 +1,30 @@
+/**
+ * @fileoverview Benchmark comparing the WASI build before and after PGO
+ *
+ * Per-format read times of:
+ * 1. Baseline: build without a profile, kept by build/pgo.sh
+ * 2. PGO: build optimized with the training profile and the tuned
+ *    wasm-opt level
+ *
+ * Both modules read the same files through WASI path I/O.
+ *
+ * Build both modules with: ./build/pgo.sh
+ * Run with: deno bench --allow-read --allow-write --allow-env tests/wasi-pgo.bench.ts
+ */
+
+import { resolve } from "@std/path";
+import { compareModules } from "./wasi-test-helpers.ts";
+
+const PROJECT_ROOT = resolve(Deno.cwd());
+
+await compareModules({
+  baseline: {
+    label: "Baseline",
+    wasmPath: resolve(PROJECT_ROOT, "build/pgo/taglib_wasi.baseline.wasm"),
+  },
+  variant: {
+    label: "PGO",
+    wasmPath: resolve(PROJECT_ROOT, "dist/wasi/taglib_wasi.wasm"),
+  },
+  testFilesDir: resolve(PROJECT_ROOT, "tests/test-files"),
+});
@@ -0,0 +1,30 @@
+/**
+ * @fileoverview Benchmark comparing the portable and SIMD WASI builds
+ *
+ * Quantifies the gain of the simd128 kernels on the read path:
+ * 1. Scalar: default build
+ * 2. SIMD: TAGLIB_WASI_SIMD=1 build (-msimd128)
+ *
+ * Both modules read the same files through WASI path I/O, so the difference
+ * is the transcoding and pattern search kernels, not I/O strategy.
+ *
+ * Build the SIMD module with: TAGLIB_WASI_SIMD=1 ./build/build-wasi.sh
+ * Run with: deno bench --allow-read --allow-write --allow-env tests/wasi-simd-vs-scalar.bench.ts
+ */
+
+import { resolve } from "@std/path";
+import { compareModules } from "./wasi-test-helpers.ts";
+
+const PROJECT_ROOT = resolve(Deno.cwd());
+
+await compareModules({
+  baseline: {
+    label: "Scalar",
+    wasmPath: resolve(PROJECT_ROOT, "dist/wasi/taglib_wasi.wasm"),
+  },
+  variant: {
+    label: "SIMD",
+    wasmPath: resolve(PROJECT_ROOT, "dist/wasi/taglib_wasi_simd.wasm"),
+  },
+  testFilesDir: resolve(PROJECT_ROOT, "tests/test-files"),
+});
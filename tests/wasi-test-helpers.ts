@@ -2,6 +2,7 @@
  * @fileoverview Shared helpers for WASI host tests and benchmarks.
  */
 
+import { loadWasiHost } from "../src/runtime/wasi-host-loader.ts";
 import { WasmArena, type WasmExports } from "../src/runtime/wasi-memory.ts";
 import { decodeTagData } from "../src/msgpack/decoder.ts";
 import { encodeTagData } from "../src/msgpack/encoder.ts";
@@ -159,3 +160,108 @@ export function writeTagsWasi(
     throw new Error(`tl_write_tags failed for ${virtualPath}: ${errMsg}`);
   }
 }
+
+export interface ComparedModule {
+  /** Bench name, also used in the module size log */
+  label: string;
+  wasmPath: string;
+}
+
+export interface ModuleComparison {
+  hasWasm: boolean;
+  baseline: (WasiModule & Disposable) | null;
+  variant: (WasiModule & Disposable) | null;
+}
+
+/**
+ * Register an A/B benchmark of two builds of the WASI module.
+ *
+ * Loads both modules with tests/test-files preopened as /test (skipping
+ * every benchmark when either binary is missing), logs their sizes and
+ * registers one group per entry of FORMAT_FILES plus a read-all-formats
+ * group, with `baseline` as the group baseline. Both modules are disposed
+ * on unload. The loaded modules are returned for variant-specific
+ * measurements.
+ */
+export async function compareModules(options: {
+  baseline: ComparedModule;
+  variant: ComparedModule;
+  testFilesDir: string;
+  read?: (wasi: WasiModule, virtualPath: string) => unknown;
+}): Promise<ModuleComparison> {
+  const { baseline, variant, testFilesDir } = options;
+  const read = options.read ?? readTagsViaPath;
+  const hasWasm = fileExists(baseline.wasmPath) &&
+    fileExists(variant.wasmPath);
+
+  if (!hasWasm) {
+    console.warn(
+      `WASI binaries not found (${baseline.wasmPath}, ${variant.wasmPath}) — all benchmarks skipped`,
+    );
+  }
+
+  let baselineWasi: (WasiModule & Disposable) | null = null;
+  let variantWasi: (WasiModule & Disposable) | null = null;
+  if (hasWasm) {
+    baselineWasi = await loadWasiHost({
+      wasmPath: baseline.wasmPath,
+      preopens: { "/test": testFilesDir },
+    });
+    variantWasi = await loadWasiHost({
+      wasmPath: variant.wasmPath,
+      preopens: { "/test": testFilesDir },
+    });
+  }
+
+  globalThis.addEventListener("unload", () => {
+    baselineWasi?.[Symbol.dispose]();
+    variantWasi?.[Symbol.dispose]();
+  });
+
+  if (hasWasm) {
+    const baselineSize = Deno.statSync(baseline.wasmPath).size;
+    const variantSize = Deno.statSync(variant.wasmPath).size;
+    const delta = (variantSize / baselineSize - 1) * 100;
+    console.log(
+      `Module size: ${baseline.label} ${baselineSize} bytes, ` +
+        `${variant.label} ${variantSize} bytes ` +
+        `(${delta >= 0 ? "+" : ""}${delta.toFixed(1)}%)`,
+    );
+  }
+
+  const modules: [ComparedModule, () => WasiModule][] = [
+    [baseline, () => baselineWasi!],
+    [variant, () => variantWasi!],
+  ];
+
+  for (const [format, paths] of Object.entries(FORMAT_FILES)) {
+    const group = `read-${format.toLowerCase()}`;
+    for (const [module, wasi] of modules) {
+      Deno.bench({
+        name: module.label,
+        group,
+        baseline: module === baseline,
+        ignore: !hasWasm,
+        fn() {
+          read(wasi(), paths.virtual);
+        },
+      });
+    }
+  }
+
+  for (const [module, wasi] of modules) {
+    Deno.bench({
+      name: module.label,
+      group: "read-all-formats",
+      baseline: module === baseline,
+      ignore: !hasWasm,
+      fn() {
+        for (const paths of Object.values(FORMAT_FILES)) {
+          read(wasi(), paths.virtual);
+        }
+      },
+    });
+  }
+
+  return { hasWasm, baseline: baselineWasi, variant: variantWasi };
+}